@@ -0,0 +1,59 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+
+namespace dsp56k
+{
+	// Keeps a producer of audio frames a limited number of frames ahead of its consumer. The producer blocks as soon as it is too
+	// far ahead and the consumer wakes it up once it has read frames, so the producer continues as soon as there is room instead
+	// of sleeping for an estimated amount of time
+	class AudioPacer
+	{
+	public:
+		// called by the consumer after it has read frames
+		void notifyConsumed()
+		{
+			// the producer evaluates the fill level while holding the mutex. Acquiring it here ensures that the notification cannot get
+			// lost between the evaluation and the start of the wait
+			{
+				std::lock_guard lock(m_mutex);
+			}
+			m_cv.notify_one();
+		}
+
+		// called by the producer. Blocks as long as _available() returns at least _leadFrames. The timeout is a fallback only, for
+		// consumers that do not call notifyConsumed(). Returns true if the producer had to wait
+		template<typename TFunc> bool pace(const TFunc& _available, const size_t _leadFrames, const std::chrono::microseconds _timeout)
+		{
+			if(_available() < _leadFrames)
+				return false;
+
+			std::unique_lock lock(m_mutex);
+
+			m_cv.wait_for(lock, _timeout, [&]
+			{
+				return m_terminated || _available() < _leadFrames;
+			});
+
+			return true;
+		}
+
+		// releases a waiting producer, pace() does not block anymore afterwards
+		void terminate()
+		{
+			{
+				std::lock_guard lock(m_mutex);
+				m_terminated = true;
+			}
+			m_cv.notify_all();
+		}
+
+	private:
+		std::mutex m_mutex;
+		std::condition_variable m_cv;
+		bool m_terminated = false;
+	};
+}
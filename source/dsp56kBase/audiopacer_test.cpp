@@ -0,0 +1,156 @@
+#include "audiopacer.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+
+static constexpr size_t LeadFrames = 256;
+static constexpr size_t BlockSize = 64;
+static constexpr uint32_t BlockCount = 200;
+
+// 64 frames at 48 kHz
+static constexpr std::chrono::microseconds BlockDuration(1333);
+
+static bool testLeadBounded()
+{
+	dsp56k::AudioPacer pacer;
+
+	std::atomic<size_t> fill{0};
+	std::atomic<bool> done{false};
+
+	uint32_t underruns = 0;
+	size_t maxFill = 0;
+	uint64_t waits = 0;
+
+	// fake audio consumer, reads one block per block period and wakes the producer
+	std::thread consumer([&]
+	{
+		auto next = std::chrono::steady_clock::now();
+
+		for(uint32_t i = 0; i < BlockCount; ++i)
+		{
+			next += BlockDuration;
+			std::this_thread::sleep_until(next);
+
+			if(fill.load() < BlockSize)
+			{
+				// the producer needs a few blocks to fill the buffer initially
+				if(i > 4)
+					++underruns;
+				continue;
+			}
+
+			fill.fetch_sub(BlockSize);
+			pacer.notifyConsumed();
+		}
+
+		done.store(true);
+		pacer.terminate();
+	});
+
+	// producer, generates frames as fast as it can
+	while(!done.load())
+	{
+		const auto f = fill.fetch_add(1) + 1;
+
+		if(f > maxFill)
+			maxFill = f;
+
+		if(pacer.pace([&] { return fill.load(); }, LeadFrames, std::chrono::milliseconds(100)))
+			++waits;
+	}
+
+	consumer.join();
+
+	std::cout << "maxFill=" << maxFill << " waits=" << waits << " underruns=" << underruns << std::endl;
+
+	if(maxFill > LeadFrames)
+	{
+		std::cerr << "FAILED: producer is " << maxFill << " frames ahead, lead is " << LeadFrames << std::endl;
+		return false;
+	}
+
+	// the producer is woken up once per consumed block instead of spinning or sleeping
+	if(waits < BlockCount / 2 || waits > BlockCount * 2)
+	{
+		std::cerr << "FAILED: unexpected number of waits " << waits << std::endl;
+		return false;
+	}
+
+	if(underruns)
+	{
+		std::cerr << "FAILED: consumer ran dry " << underruns << " times" << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+static bool testTimeoutAndTerminate()
+{
+	dsp56k::AudioPacer pacer;
+
+	// nothing to wait for
+	if(pacer.pace([] { return size_t(0); }, LeadFrames, std::chrono::seconds(10)))
+	{
+		std::cerr << "FAILED: waited although below lead" << std::endl;
+		return false;
+	}
+
+	// a consumer that never notifies, the timeout is the fallback
+	auto t0 = std::chrono::steady_clock::now();
+	pacer.pace([] { return LeadFrames; }, LeadFrames, std::chrono::milliseconds(20));
+	auto elapsed = std::chrono::steady_clock::now() - t0;
+
+	if(elapsed < std::chrono::milliseconds(15) || elapsed > std::chrono::seconds(2))
+	{
+		std::cerr << "FAILED: timeout not respected" << std::endl;
+		return false;
+	}
+
+	// terminating releases a waiting producer
+	std::thread terminator([&]
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		pacer.terminate();
+	});
+
+	t0 = std::chrono::steady_clock::now();
+	pacer.pace([] { return LeadFrames; }, LeadFrames, std::chrono::seconds(10));
+	elapsed = std::chrono::steady_clock::now() - t0;
+
+	terminator.join();
+
+	if(elapsed > std::chrono::seconds(2))
+	{
+		std::cerr << "FAILED: terminate did not release the producer" << std::endl;
+		return false;
+	}
+
+	// does not block anymore after termination
+	t0 = std::chrono::steady_clock::now();
+	pacer.pace([] { return LeadFrames; }, LeadFrames, std::chrono::seconds(10));
+	elapsed = std::chrono::steady_clock::now() - t0;
+
+	if(elapsed > std::chrono::seconds(2))
+	{
+		std::cerr << "FAILED: blocked after terminate" << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+int main()
+{
+	if(!testLeadBounded() || !testTimeoutAndTerminate())
+	{
+		std::cerr << "FAILED" << std::endl;
+		return 1;
+	}
+
+	std::cout << "PASSED" << std::endl;
+	return 0;
+}
@@ -62,6 +62,12 @@ namespace dsp56k
 			return m_value;
 		}
 
+		// direct access to the storage, for JIT code that writes the register without side effects
+		T& value()
+		{
+			return m_value;
+		}
+
 		Bitfield<T,B,C>& operator = (T _value)
 		{
 			m_value = _value;
@@ -0,0 +1,76 @@
+#include "hugepages.h"
+
+#include <atomic>
+#include <cstdint>
+
+#ifdef __linux__
+#	include <fstream>
+#	include <sstream>
+#	include <string>
+#	include <sys/mman.h>
+#endif
+
+namespace dsp56k
+{
+	namespace
+	{
+		std::atomic<bool> g_enabled{false};
+	}
+
+	void HugePages::setEnabled(const bool _enabled)
+	{
+		g_enabled = _enabled;
+	}
+
+	bool HugePages::isEnabled()
+	{
+		return g_enabled;
+	}
+
+	bool HugePages::advise(void* _ptr, const size_t _byteSize)
+	{
+		if(!isEnabled() || !_ptr)
+			return false;
+
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+		const auto begin = (reinterpret_cast<uintptr_t>(_ptr) + PageSize - 1) & ~(PageSize - 1);
+		const auto end = (reinterpret_cast<uintptr_t>(_ptr) + _byteSize) & ~(PageSize - 1);
+
+		if(end <= begin)
+			return false;
+
+		return madvise(reinterpret_cast<void*>(begin), end - begin, MADV_HUGEPAGE) == 0;
+#else
+		return false;
+#endif
+	}
+
+	size_t HugePages::getProcessHugePageBytes()
+	{
+#ifdef __linux__
+		std::ifstream file("/proc/self/smaps_rollup");
+
+		if(!file.is_open())
+			return 0;
+
+		size_t total = 0;
+		std::string line;
+
+		while(std::getline(file, line))
+		{
+			// sizes are listed in kB
+			if(line.rfind("AnonHugePages:", 0) == 0 || line.rfind("ShmemPmdMapped:", 0) == 0 || line.rfind("FilePmdMapped:", 0) == 0)
+			{
+				std::stringstream ss(line.substr(line.find(':') + 1));
+				size_t kb = 0;
+				ss >> kb;
+				total += kb * 1024;
+			}
+		}
+
+		return total;
+#else
+		return 0;
+#endif
+	}
+}
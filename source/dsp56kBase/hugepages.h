@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+
+namespace dsp56k
+{
+	// Optional huge page backing for X and Y memory and the JIT function table to reduce TLB misses. P memory is not backed by huge
+	// pages as JitPMemGuard write protects it with regular page granularity. On Linux, transparent huge pages are requested via
+	// madvise(). Shared memory mappings (MMU based DSP memory) require /sys/kernel/mm/transparent_hugepage/shmem_enabled to be set
+	// to 'advise'. Regular pages are used if huge pages are not available.
+	// JIT code buffers are not advised, they are owned by the asmjit allocator. If enabled, the JIT only asks asmjit for large
+	// pages, which are explicit huge pages (MAP_HUGETLB on Linux) that need to be reserved by the system and are rarely available
+	class HugePages
+	{
+	public:
+		static constexpr size_t PageSize = 2 * 1024 * 1024;
+
+		// only affects allocations made afterwards, enable before DSP instances are created
+		static void setEnabled(bool _enabled);
+		static bool isEnabled();
+
+		// requests huge pages for the part of the given range that covers entire huge pages. Returns true on success
+		static bool advise(void* _ptr, size_t _byteSize);
+
+		// number of bytes of the current process that are backed by huge pages, 0 if unknown
+		static size_t getProcessHugePageBytes();
+	};
+}
@@ -1,10 +1,14 @@
 #include "logging.h"
 
+#include <algorithm>
+#include <atomic>
 #include <fstream>
+#include <memory>
 #include <mutex>
 #include <thread>
 #include <vector>
 #include <cstring>
+#include <cstdio>
 
 #ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
@@ -108,5 +112,283 @@ namespace Logging
 	{
 		g_logFunc = _func;
 	}
-}
 
+	namespace rt
+	{
+		namespace
+		{
+			// single producer (the owning thread), single consumer (the logger thread or flush())
+			class ThreadBuffer
+			{
+			public:
+				static constexpr size_t Capacity = 512;
+
+				bool push(const Record& _record)
+				{
+					const auto w = m_writeCount.load(std::memory_order_relaxed);
+
+					if(w - m_readCount.load(std::memory_order_acquire) >= Capacity)
+					{
+						m_dropped.fetch_add(1, std::memory_order_relaxed);
+						return false;
+					}
+
+					m_records[w & (Capacity-1)] = _record;
+					m_writeCount.store(w + 1, std::memory_order_release);
+					return true;
+				}
+
+				template<typename TFunc> void pop(const TFunc& _func)
+				{
+					auto r = m_readCount.load(std::memory_order_relaxed);
+					const auto w = m_writeCount.load(std::memory_order_acquire);
+
+					for(; r != w; ++r)
+					{
+						_func(m_records[r & (Capacity-1)]);
+						m_readCount.store(r + 1, std::memory_order_release);
+					}
+				}
+
+				bool empty() const
+				{
+					return m_readCount.load(std::memory_order_acquire) == m_writeCount.load(std::memory_order_acquire);
+				}
+
+				uint32_t fetchDropped()
+				{
+					return m_dropped.exchange(0, std::memory_order_relaxed);
+				}
+
+				void setThreadExited()		{ m_threadExited = true; }
+				bool isThreadExited() const	{ return m_threadExited; }
+
+			private:
+				std::array<Record, Capacity> m_records;
+				std::atomic<size_t> m_writeCount{0};
+				std::atomic<size_t> m_readCount{0};
+				std::atomic<uint32_t> m_dropped{0};
+				std::atomic<bool> m_threadExited{false};
+			};
+
+			class Logger
+			{
+			public:
+				~Logger()
+				{
+					m_running = false;
+					if(m_thread)
+						m_thread->join();
+					flush();
+				}
+
+				void add(const std::shared_ptr<ThreadBuffer>& _buffer)
+				{
+					Guard g(m_mutex);
+
+					m_buffers.push_back(_buffer);
+
+					if(!m_thread)
+						m_thread.reset(new std::thread([this]() { threadFunc(); }));
+				}
+
+				void flush()
+				{
+					Guard g(m_mutex);
+
+					for(auto it = m_buffers.begin(); it != m_buffers.end();)
+					{
+						auto& b = **it;
+
+						b.pop([](const Record& _r)
+						{
+							g_logToConsole(format(_r));
+						});
+
+						if(const auto dropped = b.fetchDropped())
+							g_logToConsole(std::to_string(dropped) + " log messages dropped, log buffer full");
+
+						// keep the buffer until all messages of a thread that exited have been processed
+						if(b.isThreadExited() && b.empty())
+							it = m_buffers.erase(it);
+						else
+							++it;
+					}
+				}
+
+			private:
+				void threadFunc()
+				{
+					while(m_running)
+					{
+						flush();
+						std::this_thread::sleep_for(std::chrono::milliseconds(10));
+					}
+				}
+
+				using Guard = std::lock_guard<std::mutex>;
+
+				std::mutex m_mutex;
+				std::vector<std::shared_ptr<ThreadBuffer>> m_buffers;
+				std::unique_ptr<std::thread> m_thread;
+				std::atomic<bool> m_running{true};
+			};
+
+			Logger g_rtLogger;
+
+			// allocates and registers the buffer on the first log of a thread
+			struct ThreadBufferRef
+			{
+				ThreadBufferRef() : buffer(std::make_shared<ThreadBuffer>())
+				{
+					g_rtLogger.add(buffer);
+				}
+
+				~ThreadBufferRef()
+				{
+					buffer->setThreadExited();
+				}
+
+				std::shared_ptr<ThreadBuffer> buffer;
+			};
+
+			ThreadBuffer& getThreadBuffer()
+			{
+				thread_local ThreadBufferRef ref;
+				return *ref.buffer;
+			}
+
+			template<typename T> void formatArg(std::string& _out, const std::string& _spec, const T& _value)
+			{
+				char temp[128];
+				const auto len = snprintf(temp, sizeof(temp), _spec.c_str(), _value);
+				if(len > 0)
+					_out.append(temp, std::min(static_cast<size_t>(len), sizeof(temp) - 1));
+			}
+
+			void formatArg(std::string& _out, std::string& _spec, const char _conversion, const Record& _record, const ArgType _type, const uint64_t _arg)
+			{
+				int64_t i;
+				double d;
+
+				switch(_type)
+				{
+				case ArgType::Double:	std::memcpy(&d, &_arg, sizeof(d)); i = static_cast<int64_t>(d);	break;
+				default:				i = static_cast<int64_t>(_arg); d = static_cast<double>(i);		break;
+				}
+
+				switch(_conversion)
+				{
+				case 'd':
+				case 'i':
+					_spec.insert(_spec.size() - 1, "ll");
+					formatArg(_out, _spec, static_cast<long long>(i));
+					break;
+				case 'u':
+				case 'x':
+				case 'X':
+				case 'o':
+					_spec.insert(_spec.size() - 1, "ll");
+					formatArg(_out, _spec, static_cast<unsigned long long>(i));
+					break;
+				case 'c':
+					formatArg(_out, _spec, static_cast<int>(i));
+					break;
+				case 'f':
+				case 'F':
+				case 'e':
+				case 'E':
+				case 'g':
+				case 'G':
+				case 'a':
+				case 'A':
+					formatArg(_out, _spec, d);
+					break;
+				case 's':
+					if(_type == ArgType::String)
+						formatArg(_out, _spec, _arg < MaxStringBytes ? &_record.strings[_arg] : "(null)");
+					else
+						_out += "<not a string>";
+					break;
+				case 'p':
+					formatArg(_out, _spec, reinterpret_cast<const void*>(static_cast<uintptr_t>(_arg)));
+					break;
+				default:
+					_out += _spec;
+					break;
+				}
+			}
+		}
+
+		void push(const Record& _record)
+		{
+			getThreadBuffer().push(_record);
+		}
+
+		void registerThread()
+		{
+			getThreadBuffer();
+		}
+
+		std::string format(const Record& _record)
+		{
+			std::string out = _record.func;
+			out += '@';
+			out += std::to_string(_record.line);
+			out += ": ";
+
+			uint32_t argIndex = 0;
+
+			for(const char* f = _record.format; *f;)
+			{
+				if(*f != '%')
+				{
+					out += *f++;
+					continue;
+				}
+
+				if(f[1] == '%')
+				{
+					out += '%';
+					f += 2;
+					continue;
+				}
+
+				// flags, width and precision are passed on, length modifiers are dropped as all args are 64 bit wide
+				std::string spec = "%";
+				++f;
+
+				while(*f && std::strchr("-+ #0123456789.*", *f))
+					spec += *f++;
+
+				while(*f && std::strchr("hljztL", *f))
+					++f;
+
+				if(!*f)
+				{
+					out += spec;
+					break;
+				}
+
+				const auto conversion = *f++;
+				spec += conversion;
+
+				if(spec.find('*') != std::string::npos || argIndex >= _record.argCount)
+				{
+					out += "<?>";
+					continue;
+				}
+
+				formatArg(out, spec, conversion, _record, _record.types[argIndex], _record.args[argIndex]);
+				++argIndex;
+			}
+
+			return out;
+		}
+
+		void flush()
+		{
+			g_rtLogger.flush();
+		}
+	}
+}
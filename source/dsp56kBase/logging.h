@@ -1,8 +1,27 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <iomanip>
+#include <type_traits>
+
+// compile time log levels, logs above DSP56K_LOGLEVEL are removed entirely, including the evaluation of their arguments
+#define DSP56K_LOGLEVEL_NONE	0
+#define DSP56K_LOGLEVEL_ERROR	1
+#define DSP56K_LOGLEVEL_WARNING	2
+#define DSP56K_LOGLEVEL_INFO	3
+#define DSP56K_LOGLEVEL_DEBUG	4
+
+#ifndef DSP56K_LOGLEVEL
+#define DSP56K_LOGLEVEL			DSP56K_LOGLEVEL_INFO
+#endif
+
+#define DSP56K_LOG_ENABLED(LEVEL)	(DSP56K_LOGLEVEL_##LEVEL <= DSP56K_LOGLEVEL)
 
 namespace Logging
 {
@@ -11,20 +30,166 @@ namespace Logging
 	void g_logToConsole( const std::string& _s );
 	void g_logToFile( const std::string& _s );
 	void setLogFunc(LogFunc _func);
+
+	// Realtime safe logging. The calling thread only copies the format string pointer and the raw arguments into a lock-free
+	// buffer owned by that thread, formatting and output to the log function is done by a background thread.
+	// The format string needs to have static storage duration, it is read later. String arguments are copied into the record,
+	// up to MaxStringBytes per record in total, longer strings are truncated.
+	// If the buffer of a thread is full, messages are dropped and the number of dropped messages is logged later.
+	// The buffer of a thread is allocated on its first log, call registerThread() at the start of a realtime thread to do this upfront
+	namespace rt
+	{
+		enum class ArgType : uint8_t
+		{
+			Int,
+			UInt,
+			Double,
+			String,
+			Pointer
+		};
+
+		static constexpr size_t MaxArgs = 8;
+		static constexpr size_t MaxStringBytes = 128;
+
+		// string args hold an offset into the string storage of the record
+		static constexpr uint64_t NullString = ~0ull;
+
+		struct Record
+		{
+			const char* func;
+			const char* format;
+			uint32_t line;
+			uint32_t argCount;
+			std::array<ArgType, MaxArgs> types;
+			std::array<uint64_t, MaxArgs> args;
+			uint32_t stringBytes;
+			std::array<char, MaxStringBytes> strings;
+		};
+
+		inline uint64_t addString(Record& _r, const char* _str, const size_t _len)
+		{
+			const auto offset = _r.stringBytes;
+
+			if(offset >= MaxStringBytes)
+				return MaxStringBytes - 1;	// always the terminator of the last string
+
+			const auto len = std::min(_len, MaxStringBytes - 1 - offset);
+			std::memcpy(&_r.strings[offset], _str, len);
+			_r.strings[offset + len] = 0;
+			_r.stringBytes = static_cast<uint32_t>(offset + len + 1);
+
+			return offset;
+		}
+
+		template<typename T> void setArg(Record& _r, const size_t _i, const T& _arg)
+		{
+			using Type = std::decay_t<T>;
+
+			static_assert(std::is_arithmetic_v<Type> || std::is_enum_v<Type> || std::is_pointer_v<Type> || std::is_same_v<Type, std::string> || std::is_same_v<Type, std::string_view>,
+				"only arithmetic, enum, pointer and string arguments are supported");
+
+			if constexpr (std::is_array_v<T>)
+			{
+				// string literals and other arrays are passed as pointer, a null check of an array is always false and warned about
+				const std::remove_extent_t<T>* ptr = _arg;
+				setArg(_r, _i, ptr);
+			}
+			else if constexpr (std::is_same_v<Type, std::string> || std::is_same_v<Type, std::string_view>)
+			{
+				_r.types[_i] = ArgType::String;
+				_r.args[_i] = addString(_r, _arg.data(), _arg.size());
+			}
+			else if constexpr (std::is_enum_v<Type>)
+			{
+				setArg(_r, _i, static_cast<std::underlying_type_t<Type>>(_arg));
+			}
+			else if constexpr (std::is_floating_point_v<Type>)
+			{
+				const double d = static_cast<double>(_arg);
+				_r.types[_i] = ArgType::Double;
+				static_assert(sizeof(d) == sizeof(uint64_t));
+				std::memcpy(&_r.args[_i], &d, sizeof(d));
+			}
+			else if constexpr (std::is_same_v<Type, const char*> || std::is_same_v<Type, char*>)
+			{
+				_r.types[_i] = ArgType::String;
+				_r.args[_i] = _arg ? addString(_r, _arg, std::strlen(_arg)) : NullString;
+			}
+			else if constexpr (std::is_pointer_v<Type>)
+			{
+				_r.types[_i] = ArgType::Pointer;
+				_r.args[_i] = reinterpret_cast<uintptr_t>(_arg);
+			}
+			else if constexpr (std::is_signed_v<Type>)
+			{
+				_r.types[_i] = ArgType::Int;
+				_r.args[_i] = static_cast<uint64_t>(static_cast<int64_t>(_arg));
+			}
+			else
+			{
+				_r.types[_i] = ArgType::UInt;
+				_r.args[_i] = static_cast<uint64_t>(_arg);
+			}
+		}
+
+		void push(const Record& _record);
+
+		// allocates the log buffer of the calling thread, does nothing if the thread already has one
+		void registerThread();
+
+		template<typename... Ts> void log(const char* _func, const uint32_t _line, const char* _format, const Ts&... _args)
+		{
+			static_assert(sizeof...(Ts) <= MaxArgs, "too many arguments");
+
+			Record r;
+			r.func = _func;
+			r.format = _format;
+			r.line = _line;
+			r.argCount = static_cast<uint32_t>(sizeof...(Ts));
+			r.stringBytes = 0;
+
+			size_t i = 0;
+			(setArg(r, i++, _args), ...);
+
+			push(r);
+		}
+
+		// printf-style formatting of a record, integers are always passed as 64 bit, length modifiers in the format are ignored
+		std::string format(const Record& _record);
+
+		// formats and outputs all pending messages of all threads synchronously
+		void flush();
+	}
 }
 
 #define LOGTOCONSOLE(ss)	{ Logging::g_logToConsole( (ss).str() ); }
 #define LOGTOFILE(ss)		{ Logging::g_logToFile( (ss).str() ); }
 
-#define LOG(S)																												\
+#define LOGL(LEVEL, S)																										\
 do																															\
 {																															\
-	std::stringstream __ss__logging_h;	__ss__logging_h << __func__ << "@" << __LINE__ << ": " << S;						\
+	if constexpr (DSP56K_LOG_ENABLED(LEVEL))																				\
+	{																														\
+		std::stringstream __ss__logging_h;	__ss__logging_h << __func__ << "@" << __LINE__ << ": " << S;					\
 																															\
-	LOGTOCONSOLE(__ss__logging_h)																							\
+		LOGTOCONSOLE(__ss__logging_h)																						\
+	}																														\
 }																															\
 while(false)
 
+#define LOG(S)				LOGL(INFO, S)
+
+// printf-style, does not format or output on the calling thread, use this for logs on the DSP thread in the audio path
+#define LOGRTL(LEVEL, fmt, ...)																								\
+do																															\
+{																															\
+	if constexpr (DSP56K_LOG_ENABLED(LEVEL))																				\
+		Logging::rt::log(__func__, __LINE__, fmt, ##__VA_ARGS__);															\
+}																															\
+while(false)
+
+#define LOGRT(fmt, ...)		LOGRTL(INFO, fmt, ##__VA_ARGS__)
+
 #define LOGF(S)																												\
 do																															\
 {																															\
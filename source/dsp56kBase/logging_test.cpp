@@ -0,0 +1,183 @@
+#include "logging.h"
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+static std::mutex g_mutex;
+static std::vector<std::string> g_lines;
+
+static void captureLog(const std::string& _s)
+{
+	std::lock_guard lock(g_mutex);
+	g_lines.push_back(_s);
+}
+
+static std::string stripPrefix(const std::string& _s)
+{
+	const auto pos = _s.find(": ");
+	return pos == std::string::npos ? _s : _s.substr(pos + 2);
+}
+
+static int g_evaluated = 0;
+
+static int sideEffect()
+{
+	return ++g_evaluated;
+}
+
+enum class TestEnum : uint8_t { A = 3 };
+
+static bool expect(const std::string& _actual, const std::string& _expected)
+{
+	if(_actual == _expected)
+		return true;
+	std::cerr << "FAIL: expected '" << _expected << "', got '" << _actual << "'" << std::endl;
+	return false;
+}
+
+int main()
+{
+	Logging::setLogFunc(&captureLog);
+
+	bool ok = true;
+
+	// formatting
+	{
+		LOGRT("plain");
+		LOGRT("hex %06x dec %d unsigned %u", 0x1234u, -5, 0xffffffffu);
+		LOGRT("%lld %llu %zu", static_cast<int64_t>(-1), static_cast<uint64_t>(1) << 40, static_cast<size_t>(7));
+		LOGRT("%.2f %s %c %d%%", 1.5f, "str", 'x', TestEnum::A);
+		LOGRT("missing %d");
+
+		Logging::rt::flush();
+
+		std::lock_guard lock(g_mutex);
+
+		ok &= g_lines.size() == 5;
+
+		if(g_lines.size() == 5)
+		{
+			ok &= g_lines[0].find("main@") == 0;
+			ok &= expect(stripPrefix(g_lines[0]), "plain");
+			ok &= expect(stripPrefix(g_lines[1]), "hex 001234 dec -5 unsigned 4294967295");
+			ok &= expect(stripPrefix(g_lines[2]), "-1 1099511627776 7");
+			ok &= expect(stripPrefix(g_lines[3]), "1.50 str x 3%");
+			ok &= expect(stripPrefix(g_lines[4]), "missing <?>");
+		}
+
+		g_lines.clear();
+	}
+
+	// string arguments are copied, the source may be gone before the record is formatted
+	{
+		Logging::rt::registerThread();
+
+		{
+			char temp[16];
+			std::snprintf(temp, sizeof(temp), "temp %d", 42);
+			LOGRT("%s", temp);
+			std::memset(temp, 'x', sizeof(temp) - 1);
+		}
+
+		{
+			const std::string str("std::string");
+			LOGRT("%s|%s|%s", str, std::string_view(str).substr(0, 3), static_cast<const char*>(nullptr));
+		}
+
+		const std::string longStr(Logging::rt::MaxStringBytes * 2, 'a');
+		LOGRT("%s %s %d", longStr, "b", 1);
+
+		Logging::rt::flush();
+
+		std::lock_guard lock(g_mutex);
+
+		ok &= g_lines.size() == 3;
+
+		if(g_lines.size() == 3)
+		{
+			ok &= expect(stripPrefix(g_lines[0]), "temp 42");
+			ok &= expect(stripPrefix(g_lines[1]), "std::string|std|(null)");
+			ok &= expect(stripPrefix(g_lines[2]), std::string(Logging::rt::MaxStringBytes - 1, 'a') + "  1");
+		}
+
+		g_lines.clear();
+	}
+
+	// disabled levels do not evaluate their arguments
+	{
+		LOGRTL(DEBUG, "%d", sideEffect());
+		LOGL(DEBUG, sideEffect());
+
+		ok &= g_evaluated == 0;
+	}
+
+	// multiple producers, messages of one thread stay in order, nothing is lost without being reported
+	{
+		constexpr uint32_t ThreadCount = 4;
+		constexpr uint32_t MessageCount = 20000;
+
+		std::vector<std::thread> threads;
+
+		for(uint32_t t=0; t<ThreadCount; ++t)
+		{
+			threads.emplace_back([t]()
+			{
+				Logging::rt::registerThread();
+
+				for(uint32_t i=0; i<MessageCount; ++i)
+					LOGRT("%u %u", t, i);
+			});
+		}
+
+		for (auto& t : threads)
+			t.join();
+
+		Logging::rt::flush();
+
+		std::lock_guard lock(g_mutex);
+
+		std::vector<int64_t> last(ThreadCount, -1);
+		uint64_t received = 0;
+		uint64_t dropped = 0;
+
+		for (const auto& line : g_lines)
+		{
+			uint32_t t, i;
+
+			if(sscanf(stripPrefix(line).c_str(), "%u %u", &t, &i) == 2 && t < ThreadCount)
+			{
+				ok &= static_cast<int64_t>(i) > last[t];
+				last[t] = i;
+				++received;
+			}
+			else
+			{
+				dropped += std::stoull(line);
+			}
+		}
+
+		ok &= received + dropped == ThreadCount * MessageCount;
+
+		std::cout << "Received " << received << " messages, " << dropped << " dropped" << std::endl;
+	}
+
+	// the logger flushes once more at exit, do not capture into g_lines anymore
+	Logging::setLogFunc([](const std::string& _s) { std::cout << _s << std::endl; });
+
+	if(!ok)
+	{
+		std::cerr << "FAILED" << std::endl;
+		return 1;
+	}
+
+	std::cout << "PASSED" << std::endl;
+	return 0;
+}
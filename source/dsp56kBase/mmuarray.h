@@ -5,6 +5,7 @@
 #include <functional>
 #include <vector>
 
+#include "hugepages.h"
 #include "mmuhelper.h"
 
 namespace dsp56k
@@ -34,6 +35,8 @@ namespace dsp56k
 		// Callback fired when the backing memory is reallocated (non-MMU mode only)
 		using ResizedCallback = std::function<void()>;
 
+		static constexpr size_t DefaultBlockSize = 16384;
+
 		MmuArray() = default;
 		~MmuArray() = default;
 
@@ -46,15 +49,26 @@ namespace dsp56k
 		// _maxSize: maximum number of elements (defines virtual address range in MMU mode)
 		// _fillFunc: function to fill blocks with default values (called with pointer and count)
 		// _blockSize: number of elements per MMU block (must be power of 2, ignored in non-MMU mode)
+		// _hugePages: back the array with huge pages if they are enabled, see HugePages. Only useful for hot lookup tables as every
+		//             block that becomes private commits at least one huge page
 		// Returns true if MMU mode is active, false if using fallback
-		bool init(size_t _maxSize, FillFunc _fillFunc, size_t _blockSize = 16384)
+		bool init(size_t _maxSize, FillFunc _fillFunc, size_t _blockSize = DefaultBlockSize, bool _hugePages = false)
 		{
 			m_fillFunc = std::move(_fillFunc);
 			m_maxSize = _maxSize;
 			m_blockSize = _blockSize;
+			m_hugePages = _hugePages && HugePages::isEnabled();
 
 			assert((_blockSize & (_blockSize - 1)) == 0 && "block size must be power of 2");
 
+			// blocks need to span at least one huge page to be able to use them
+			if (m_hugePages)
+			{
+				while (_blockSize * sizeof(T) < HugePages::PageSize)
+					_blockSize <<= 1;
+				m_blockSize = _blockSize;
+			}
+
 			if (_maxSize == 0)
 				return false;
 
@@ -72,7 +86,7 @@ namespace dsp56k
 			const auto totalElements = m_numBlocks * _blockSize; // round up to full blocks
 			const auto totalBytes = totalElements * sizeof(T);
 
-			auto* basePtr = m_mmu.reserveAddressRange(totalBytes);
+			auto* basePtr = m_mmu.reserveAddressRange(totalBytes, m_hugePages);
 			if (!basePtr)
 				return initFallback();
 
@@ -90,7 +104,7 @@ namespace dsp56k
 			for (size_t i = 0; i < m_numBlocks; ++i)
 			{
 				auto* target = basePtr + i * _blockSize * sizeof(T);
-				if (!m_mmu.mapRegion(m_defaultBlockOffset, blockBytes, target))
+				if (!m_mmu.mapRegion(m_defaultBlockOffset, blockBytes, target, m_hugePages))
 				{
 					m_mmu.releaseAll();
 					return initFallback();
@@ -111,13 +125,13 @@ namespace dsp56k
 		}
 
 		// Convenience: initialize with a default value (requires T to be copyable)
-		bool init(size_t _maxSize, const T& _defaultValue, size_t _blockSize = 16384)
+		bool init(size_t _maxSize, const T& _defaultValue, size_t _blockSize = DefaultBlockSize, bool _hugePages = false)
 		{
 			return init(_maxSize, [_defaultValue](T* _ptr, size_t _count)
 			{
 				for (size_t i = 0; i < _count; ++i)
 					_ptr[i] = _defaultValue;
-			}, _blockSize);
+			}, _blockSize, _hugePages);
 		}
 
 		// Access — no bounds check, raw array speed
@@ -202,7 +216,7 @@ namespace dsp56k
 			m_mmu.unmapRegion(target);
 
 			// Map to the block's own private region in the backing store
-			if (!m_mmu.mapRegion(backingOffset, blockBytes, target))
+			if (!m_mmu.mapRegion(backingOffset, blockBytes, target, m_hugePages))
 				return false;
 
 			// Fill with default values
@@ -220,6 +234,8 @@ namespace dsp56k
 			const auto oldSize = m_fallback.size();
 			const auto newSize = _index + 1;
 			m_fallback.resize(newSize);
+			if (m_hugePages)
+				HugePages::advise(m_fallback.data(), m_fallback.size() * sizeof(T));
 			m_fillFunc(m_fallback.data() + oldSize, newSize - oldSize);
 			m_ptr = m_fallback.data();
 			m_size = m_fallback.size();
@@ -238,6 +254,7 @@ namespace dsp56k
 		size_t m_numBlocks = 0;
 		size_t m_defaultBlockOffset = 0;
 		bool m_useMmu = false;
+		bool m_hugePages = false;
 
 		std::vector<bool> m_blockIsPrivate;
 		std::vector<T> m_fallback;
@@ -2,6 +2,7 @@
 
 #ifndef __ANDROID__
 
+#include "hugepages.h"
 #include "logging.h"
 
 #ifdef _WIN32
@@ -87,7 +88,7 @@ namespace dsp56k
 
 	// ---- MmuHelper Windows implementation ----
 
-	uint8_t* MmuHelper::reserveAddressRange(const size_t _byteSize)
+	uint8_t* MmuHelper::reserveAddressRange(const size_t _byteSize, bool/* _hugePages*/)
 	{
 		auto& api = PlaceholderApi::instance();
 
@@ -101,7 +102,7 @@ namespace dsp56k
 				m_usePlaceholders = true;
 				return res;
 			}
-			LOG("MmuHelper: VirtualAlloc2 with placeholder failed, falling back to legacy path");
+			LOGL(WARNING, "MmuHelper: VirtualAlloc2 with placeholder failed, falling back to legacy path");
 		}
 
 		// Legacy path
@@ -126,7 +127,7 @@ namespace dsp56k
 		m_hBackingStore = CreateFileMapping(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, static_cast<DWORD>(_byteSize), nullptr);
 		if (m_hBackingStore == InvalidHandle)
 		{
-			LOG("MmuHelper: Failed to create file mapping");
+			LOGL(ERROR, "MmuHelper: Failed to create file mapping");
 			return false;
 		}
 
@@ -148,7 +149,7 @@ namespace dsp56k
 		m_hBackingStore = InvalidHandle;
 	}
 
-	void* MmuHelper::mapRegion(const size_t _backingByteOffset, const size_t _byteSize, void* _targetAddr)
+	void* MmuHelper::mapRegion(const size_t _backingByteOffset, const size_t _byteSize, void* _targetAddr, bool/* _hugePages*/)
 	{
 		if (m_usePlaceholders)
 		{
@@ -164,7 +165,7 @@ namespace dsp56k
 			}
 
 			const auto err = GetLastError();
-			LOG("MmuHelper: MapViewOfFile3 failed, err " << err);
+			LOGL(ERROR, "MmuHelper: MapViewOfFile3 failed, err " << err);
 			return nullptr;
 		}
 
@@ -177,7 +178,7 @@ namespace dsp56k
 		}
 
 		const auto err = GetLastError();
-		LOG("MmuHelper: Failed to create memory mapping, err " << err);
+		LOGL(ERROR, "MmuHelper: Failed to create memory mapping, err " << err);
 		return nullptr;
 	}
 
@@ -205,14 +206,33 @@ namespace dsp56k
 
 #else // Linux / macOS
 
-	uint8_t* MmuHelper::reserveAddressRange(const size_t _byteSize)
+	uint8_t* MmuHelper::reserveAddressRange(const size_t _byteSize, const bool _hugePages)
 	{
-		auto* ptr = mmap(nullptr, _byteSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, InvalidHandle, 0);
+		// huge pages can only be used for mappings that are aligned to the huge page size
+		const size_t alignment = _hugePages && HugePages::isEnabled() ? HugePages::PageSize : 0;
+
+		auto* ptr = mmap(nullptr, _byteSize + alignment, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, InvalidHandle, 0);
 		if (ptr == MAP_FAILED)
 		{
-			LOG("MmuHelper: mmap failed to reserve address range");
+			LOGL(ERROR, "MmuHelper: mmap failed to reserve address range");
 			return nullptr;
 		}
+
+		if (alignment)
+		{
+			// release the slack in front of and behind the aligned range, it is not covered by the individual mappings
+			auto* begin = reinterpret_cast<uint8_t*>(ptr);
+			auto* aligned = reinterpret_cast<uint8_t*>((reinterpret_cast<uintptr_t>(ptr) + alignment - 1) & ~(alignment - 1));
+			auto* end = begin + _byteSize + alignment;
+
+			if (aligned > begin)
+				munmap(begin, aligned - begin);
+			if (end > aligned + _byteSize)
+				munmap(aligned + _byteSize, end - (aligned + _byteSize));
+
+			ptr = aligned;
+		}
+
 		m_basePtr = reinterpret_cast<uint8_t*>(ptr);
 		m_basePtrSize = _byteSize;
 		return m_basePtr;
@@ -240,13 +260,13 @@ namespace dsp56k
 		int fd = shm_open(na.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
 		if (fd == InvalidHandle)
 		{
-			LOG("MmuHelper: shm_open failed, err " << errno);
+			LOGL(ERROR, "MmuHelper: shm_open failed, err " << errno);
 			return false;
 		}
 		shm_unlink(na.c_str());
 		if (ftruncate(fd, static_cast<off_t>(_byteSize)))
 		{
-			LOG("MmuHelper: Failed to ftruncate to size of " << _byteSize);
+			LOGL(ERROR, "MmuHelper: Failed to ftruncate to size of " << _byteSize);
 		}
 
 		m_hBackingStore = fd;
@@ -258,22 +278,25 @@ namespace dsp56k
 		if (m_hBackingStore == InvalidHandle)
 			return;
 		if (close(m_hBackingStore))
-			LOG("MmuHelper: Failed to close file descriptor " << m_hBackingStore);
+			LOGL(ERROR, "MmuHelper: Failed to close file descriptor " << m_hBackingStore);
 		m_hBackingStore = InvalidHandle;
 	}
 
-	void* MmuHelper::mapRegion(const size_t _backingByteOffset, const size_t _byteSize, void* _targetAddr)
+	void* MmuHelper::mapRegion(const size_t _backingByteOffset, const size_t _byteSize, void* _targetAddr, const bool _hugePages)
 	{
 		errno = 0;
 		auto* p = mmap(_targetAddr, _byteSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, m_hBackingStore, static_cast<off_t>(_backingByteOffset));
 		if (p == _targetAddr)
 		{
+			// needs to be done before mlock() faults in the pages
+			if (_hugePages)
+				HugePages::advise(p, _byteSize);
 			mlock(p, _byteSize);
 			m_mappedRegions.insert(std::make_pair(p, _byteSize));
 			return p;
 		}
 
-		LOG("MmuHelper: Failed to create memory mapping, err " << errno << ", ptr=" << p << " but requested " << _targetAddr);
+		LOGL(ERROR, "MmuHelper: Failed to create memory mapping, err " << errno << ", ptr=" << p << " but requested " << _targetAddr);
 		return nullptr;
 	}
 
@@ -282,14 +305,14 @@ namespace dsp56k
 		const auto it = m_mappedRegions.find(_addr);
 		if (it == m_mappedRegions.end())
 		{
-			LOG("MmuHelper: Failed to unmap memory, pointer not found");
+			LOGL(ERROR, "MmuHelper: Failed to unmap memory, pointer not found");
 			return false;
 		}
 		munlock(_addr, it->second);
 		const auto res = munmap(_addr, it->second) == 0;
 		m_mappedRegions.erase(it);
 		if (!res)
-			LOG("MmuHelper: Failed to unmap memory, err " << errno);
+			LOGL(ERROR, "MmuHelper: Failed to unmap memory, err " << errno);
 		return res;
 	}
 
@@ -15,9 +15,9 @@ namespace dsp56k
 
 		bool isValid() const { return false; }
 
-		uint8_t* reserveAddressRange(size_t _byteSize) { return nullptr; }
+		uint8_t* reserveAddressRange(size_t _byteSize, bool _hugePages = false) { return nullptr; }
 		bool createBackingStore(size_t _byteSize) { return false; }
-		void* mapRegion(size_t _backingByteOffset, size_t _byteSize, void* _targetAddr) { return nullptr; }
+		void* mapRegion(size_t _backingByteOffset, size_t _byteSize, void* _targetAddr, bool _hugePages = false) { return nullptr; }
 		bool unmapRegion(void* _addr) { return false; }
 		void releaseAll() {}
 	};
@@ -42,7 +42,8 @@ namespace dsp56k
 		MmuHelper& operator=(MmuHelper&&) = delete;
 
 		// Reserve a contiguous virtual address range without committing physical memory
-		uint8_t* reserveAddressRange(size_t _byteSize);
+		// _hugePages: align the range to the huge page size if huge pages are enabled, see HugePages
+		uint8_t* reserveAddressRange(size_t _byteSize, bool _hugePages = false);
 
 		// Create a backing store (page file / shared memory) of the given size
 		bool createBackingStore(size_t _byteSize);
@@ -51,8 +52,9 @@ namespace dsp56k
 		// _backingByteOffset: offset into the backing store
 		// _byteSize: number of bytes to map
 		// _targetAddr: desired virtual address (must be within reserved range)
+		// _hugePages: request huge pages for the region if huge pages are enabled, see HugePages
 		// Returns the mapped address on success, nullptr on failure
-		void* mapRegion(size_t _backingByteOffset, size_t _byteSize, void* _targetAddr);
+		void* mapRegion(size_t _backingByteOffset, size_t _byteSize, void* _targetAddr, bool _hugePages = false);
 
 		// Unmap a previously mapped region
 		bool unmapRegion(void* _addr);
@@ -0,0 +1,232 @@
+#include "pageguard.h"
+
+#ifndef __ANDROID__
+
+#include <array>
+#include <atomic>
+#include <mutex>
+
+#include "logging.h"
+#include "mutex.h"
+
+#ifdef _WIN32
+#	define NOMINMAX
+#	define NOSERVICE
+#	define WIN32_LEAN_AND_MEAN
+#	include <Windows.h>
+#else
+#	include <csignal>
+#	include <sys/mman.h>
+#	include <unistd.h>
+#endif
+
+namespace dsp56k
+{
+	namespace
+	{
+		// the fault handler must not take locks, guarded ranges are registered in a fixed size table
+		constexpr size_t g_maxGuards = 64;
+
+		std::array<std::atomic<PageGuard*>, g_maxGuards> g_guards{};
+
+		Mutex g_installMutex;
+		bool g_handlerInstalled = false;
+
+#ifdef _WIN32
+		LONG WINAPI onException(EXCEPTION_POINTERS* _info)
+		{
+			const auto* rec = _info->ExceptionRecord;
+
+			// ExceptionInformation[0] is 1 for a write access, [1] is the faulting address
+			if(rec->ExceptionCode != EXCEPTION_ACCESS_VIOLATION || rec->NumberParameters < 2 || rec->ExceptionInformation[0] != 1)
+				return EXCEPTION_CONTINUE_SEARCH;
+
+			if(!PageGuard::handleWriteFault(reinterpret_cast<const void*>(rec->ExceptionInformation[1])))
+				return EXCEPTION_CONTINUE_SEARCH;
+
+			return EXCEPTION_CONTINUE_EXECUTION;
+		}
+
+		bool installHandler()
+		{
+			return AddVectoredExceptionHandler(1, &onException) != nullptr;
+		}
+#else
+		struct sigaction g_prevSegv{};
+		struct sigaction g_prevBus{};
+
+		void onSignal(const int _sig, siginfo_t* _info, void* _context)
+		{
+			if(PageGuard::handleWriteFault(_info->si_addr))
+				return;
+
+			// not ours, forward to whoever was installed before
+			const auto& prev = _sig == SIGBUS ? g_prevBus : g_prevSegv;
+
+			if(prev.sa_flags & SA_SIGINFO)
+			{
+				if(prev.sa_sigaction)
+				{
+					prev.sa_sigaction(_sig, _info, _context);
+					return;
+				}
+			}
+			else if(prev.sa_handler != SIG_DFL && prev.sa_handler != SIG_IGN)
+			{
+				prev.sa_handler(_sig);
+				return;
+			}
+
+			// restore the default behaviour, the faulting instruction raises the signal again once we return
+			signal(_sig, SIG_DFL);
+		}
+
+		bool installHandler()
+		{
+			struct sigaction sa{};
+			sa.sa_sigaction = &onSignal;
+			sa.sa_flags = SA_SIGINFO | SA_NODEFER;
+			sigemptyset(&sa.sa_mask);
+
+			// macOS reports writes to protected pages as SIGBUS
+			return sigaction(SIGSEGV, &sa, &g_prevSegv) == 0 && sigaction(SIGBUS, &sa, &g_prevBus) == 0;
+		}
+#endif
+	}
+
+	PageGuard::PageGuard(void* _begin, const size_t _byteSize, const Callback _callback, void* _user)
+		: m_begin(static_cast<uint8_t*>(_begin))
+		, m_pageSize(getPageSize())
+		, m_callback(_callback)
+		, m_user(_user)
+	{
+		m_pageCount = _byteSize / m_pageSize;
+
+		if(!m_begin || !m_pageCount || (reinterpret_cast<uintptr_t>(m_begin) & (m_pageSize - 1)))
+		{
+			LOGL(ERROR, "PageGuard: Memory range " << HEX(_begin) << " is not page aligned or empty");
+			return;
+		}
+
+		{
+			std::lock_guard lock(g_installMutex);
+
+			if(!g_handlerInstalled)
+			{
+				if(!installHandler())
+				{
+					LOGL(ERROR, "PageGuard: Failed to install fault handler");
+					return;
+				}
+				g_handlerInstalled = true;
+			}
+		}
+
+		for (auto& g : g_guards)
+		{
+			PageGuard* expected = nullptr;
+
+			if(g.compare_exchange_strong(expected, this))
+			{
+				m_registered = true;
+				return;
+			}
+		}
+
+		LOG("PageGuard: Too many guarded memory ranges");
+	}
+
+	PageGuard::~PageGuard()
+	{
+		if(!m_registered)
+			return;
+
+		unprotectAll();
+
+		for (auto& g : g_guards)
+		{
+			PageGuard* expected = this;
+			if(g.compare_exchange_strong(expected, nullptr))
+				break;
+		}
+	}
+
+	bool PageGuard::protect(const size_t _page)
+	{
+		if(!m_registered || _page >= m_pageCount)
+			return false;
+
+		auto* addr = m_begin + _page * m_pageSize;
+
+#ifdef _WIN32
+		DWORD oldProtect;
+		return VirtualProtect(addr, m_pageSize, PAGE_READONLY, &oldProtect) != 0;
+#else
+		return mprotect(addr, m_pageSize, PROT_READ) == 0;
+#endif
+	}
+
+	bool PageGuard::unprotect(const size_t _page)
+	{
+		if(!m_registered || _page >= m_pageCount)
+			return false;
+
+		auto* addr = m_begin + _page * m_pageSize;
+
+#ifdef _WIN32
+		DWORD oldProtect;
+		return VirtualProtect(addr, m_pageSize, PAGE_READWRITE, &oldProtect) != 0;
+#else
+		return mprotect(addr, m_pageSize, PROT_READ | PROT_WRITE) == 0;
+#endif
+	}
+
+	void PageGuard::unprotectAll()
+	{
+		if(!m_registered)
+			return;
+
+#ifdef _WIN32
+		DWORD oldProtect;
+		VirtualProtect(m_begin, m_pageCount * m_pageSize, PAGE_READWRITE, &oldProtect);
+#else
+		mprotect(m_begin, m_pageCount * m_pageSize, PROT_READ | PROT_WRITE);
+#endif
+	}
+
+	size_t PageGuard::getPageSize()
+	{
+#ifdef _WIN32
+		SYSTEM_INFO info;
+		GetSystemInfo(&info);
+		return info.dwPageSize;
+#else
+		static const auto pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+		return pageSize;
+#endif
+	}
+
+	bool PageGuard::handleWriteFault(const void* _addr)
+	{
+		const auto* addr = static_cast<const uint8_t*>(_addr);
+
+		for (const auto& g : g_guards)
+		{
+			auto* guard = g.load(std::memory_order_acquire);
+
+			if(!guard || addr < guard->m_begin || addr >= guard->m_begin + guard->m_pageCount * guard->m_pageSize)
+				continue;
+
+			const auto page = static_cast<size_t>(addr - guard->m_begin) / guard->m_pageSize;
+
+			if(!guard->unprotect(page))
+				return false;
+
+			guard->m_callback(guard->m_user, page);
+			return true;
+		}
+		return false;
+	}
+}
+
+#endif
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace dsp56k
+{
+	// Write protection for a page aligned memory range. A write to a protected page raises an access violation that is handled by
+	// making the page writable again and reporting the page via the callback, the faulting write is then retried.
+	// The callback runs inside of the fault handler, it must not allocate memory or take locks.
+	// Note that a debugger attached to the process stops at every fault (SIGSEGV / first chance exception) unless told otherwise
+#ifdef __ANDROID__
+	class PageGuard
+	{
+	public:
+		using Callback = void(*)(void* _user, size_t _page);
+
+		PageGuard(void* _begin, size_t _byteSize, Callback _callback, void* _user) {}
+
+		bool isValid() const { return false; }
+
+		size_t getPageCount() const { return 0; }
+
+		bool protect(size_t _page) { return false; }
+		bool unprotect(size_t _page) { return false; }
+		void unprotectAll() {}
+
+		static size_t getPageSize() { return 4096; }
+	};
+#else
+	class PageGuard
+	{
+	public:
+		using Callback = void(*)(void* _user, size_t _page);
+
+		// _begin needs to be page aligned, a partial page at the end of the range is not covered
+		PageGuard(void* _begin, size_t _byteSize, Callback _callback, void* _user);
+		~PageGuard();
+
+		PageGuard(const PageGuard&) = delete;
+		PageGuard& operator=(const PageGuard&) = delete;
+		PageGuard(PageGuard&&) = delete;
+		PageGuard& operator=(PageGuard&&) = delete;
+
+		bool isValid() const { return m_registered; }
+
+		size_t getPageCount() const { return m_pageCount; }
+
+		bool protect(size_t _page);
+		bool unprotect(size_t _page);
+		void unprotectAll();
+
+		static size_t getPageSize();
+
+		// called by the platform specific fault handler, returns true if the address belongs to a guarded range
+		static bool handleWriteFault(const void* _addr);
+
+	private:
+		uint8_t* m_begin = nullptr;
+		size_t m_pageCount = 0;
+		size_t m_pageSize = 0;
+
+		Callback m_callback = nullptr;
+		void* m_user = nullptr;
+
+		bool m_registered = false;
+	};
+#endif
+}
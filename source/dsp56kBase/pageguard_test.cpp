@@ -0,0 +1,229 @@
+#include "pageguard.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#ifdef _WIN32
+#	define NOMINMAX
+#	define NOSERVICE
+#	define WIN32_LEAN_AND_MEAN
+#	include <Windows.h>
+#else
+#	include <csignal>
+#	include <sys/mman.h>
+#endif
+
+using namespace dsp56k;
+
+static constexpr size_t PageCount = 4;
+
+static std::vector<size_t> g_faults;
+
+// pages of a memory range that is not guarded, write protected by the test itself and made writable again by the previously installed handler
+static uint8_t* g_foreignPage = nullptr;
+static std::atomic<int> g_foreignFaults{0};
+
+static void onFault(void* _user, const size_t _page)
+{
+	// runs inside of the fault handler, the vector has enough capacity to not allocate
+	static_cast<std::vector<size_t>*>(_user)->push_back(_page);
+}
+
+static bool isForeignAddress(const void* _addr)
+{
+	const auto* a = static_cast<const uint8_t*>(_addr);
+	return g_foreignPage && a >= g_foreignPage && a < g_foreignPage + PageGuard::getPageSize();
+}
+
+#ifdef _WIN32
+static uint8_t* allocPages(const size_t _count)
+{
+	return static_cast<uint8_t*>(VirtualAlloc(nullptr, _count * PageGuard::getPageSize(), MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE));
+}
+
+static void freePages(uint8_t* _ptr, size_t)
+{
+	VirtualFree(_ptr, 0, MEM_RELEASE);
+}
+
+static void setWritable(uint8_t* _page, const bool _writable)
+{
+	DWORD oldProtect;
+	VirtualProtect(_page, PageGuard::getPageSize(), _writable ? PAGE_READWRITE : PAGE_READONLY, &oldProtect);
+}
+
+static LONG WINAPI onPreviousHandler(EXCEPTION_POINTERS* _info)
+{
+	const auto* rec = _info->ExceptionRecord;
+
+	if(rec->ExceptionCode != EXCEPTION_ACCESS_VIOLATION || rec->NumberParameters < 2 || !isForeignAddress(reinterpret_cast<const void*>(rec->ExceptionInformation[1])))
+		return EXCEPTION_CONTINUE_SEARCH;
+
+	++g_foreignFaults;
+	setWritable(g_foreignPage, true);
+	return EXCEPTION_CONTINUE_EXECUTION;
+}
+
+static bool installPreviousHandler()
+{
+	// the page guard handler is added in front of this one
+	return AddVectoredExceptionHandler(0, &onPreviousHandler) != nullptr;
+}
+#else
+static uint8_t* allocPages(const size_t _count)
+{
+	auto* ptr = mmap(nullptr, _count * PageGuard::getPageSize(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	return ptr == MAP_FAILED ? nullptr : static_cast<uint8_t*>(ptr);
+}
+
+static void freePages(uint8_t* _ptr, const size_t _count)
+{
+	munmap(_ptr, _count * PageGuard::getPageSize());
+}
+
+static void setWritable(uint8_t* _page, const bool _writable)
+{
+	mprotect(_page, PageGuard::getPageSize(), _writable ? PROT_READ | PROT_WRITE : PROT_READ);
+}
+
+static void onPreviousHandler(int, siginfo_t* _info, void*)
+{
+	if(!isForeignAddress(_info->si_addr))
+		std::abort();
+
+	++g_foreignFaults;
+	setWritable(g_foreignPage, true);
+}
+
+static bool installPreviousHandler()
+{
+	// installed before the first page guard is created, the page guard handler needs to forward faults that it does not own
+	struct sigaction sa{};
+	sa.sa_sigaction = &onPreviousHandler;
+	sa.sa_flags = SA_SIGINFO;
+	sigemptyset(&sa.sa_mask);
+	return sigaction(SIGSEGV, &sa, nullptr) == 0 && sigaction(SIGBUS, &sa, nullptr) == 0;
+}
+#endif
+
+static bool expect(const bool _condition, const char* _what)
+{
+	if(_condition)
+		return true;
+	std::cerr << "FAIL: " << _what << std::endl;
+	return false;
+}
+
+static void write(uint8_t* _ptr, const uint8_t _value)
+{
+	*static_cast<volatile uint8_t*>(_ptr) = _value;
+}
+
+int main()
+{
+	bool ok = true;
+
+	const auto pageSize = PageGuard::getPageSize();
+
+	auto* mem = allocPages(PageCount);
+	auto* foreign = allocPages(1);
+
+	if(!mem || !foreign || !installPreviousHandler())
+	{
+		std::cerr << "FAILED: test setup" << std::endl;
+		return 1;
+	}
+
+	g_faults.reserve(64);
+
+	{
+		// misaligned or empty ranges are refused
+		PageGuard misaligned(mem + 1, pageSize, &onFault, &g_faults);
+		ok &= expect(!misaligned.isValid(), "misaligned range is refused");
+
+		PageGuard empty(mem, pageSize - 1, &onFault, &g_faults);
+		ok &= expect(!empty.isValid(), "range smaller than a page is refused");
+	}
+
+	{
+		PageGuard guard(mem, PageCount * pageSize, &onFault, &g_faults);
+
+#ifdef __ANDROID__
+		ok &= expect(!guard.isValid(), "page guard is not supported");
+		std::cout << (ok ? "PASSED" : "FAILED") << std::endl;
+		return ok ? 0 : 1;
+#endif
+
+		ok &= expect(guard.isValid(), "guard is valid");
+		ok &= expect(guard.getPageCount() == PageCount, "page count");
+		ok &= expect(!guard.protect(PageCount), "protecting a page outside of the range fails");
+
+		// unprotected pages do not fault
+		write(mem, 1);
+		ok &= expect(g_faults.empty(), "no fault for an unprotected page");
+
+		// trap: the callback reports the page, the write is retried and succeeds
+		ok &= expect(guard.protect(2), "protect page 2");
+
+		write(mem + 2 * pageSize + 17, 0x42);
+
+		ok &= expect(g_faults.size() == 1 && g_faults[0] == 2, "fault reports page 2");
+		ok &= expect(mem[2 * pageSize + 17] == 0x42, "faulting write has been retried");
+
+		// restore: the page is writable again after the first fault
+		write(mem + 2 * pageSize, 0x43);
+		ok &= expect(g_faults.size() == 1, "no fault once the page has been unprotected");
+
+		// other pages of the range are not affected
+		write(mem + 3 * pageSize, 0x44);
+		ok &= expect(g_faults.size() == 1, "no fault for a neighbouring page");
+
+		// protecting again traps again, explicit unprotect does not report anything
+		ok &= expect(guard.protect(2), "protect page 2 again");
+		ok &= expect(guard.protect(0), "protect page 0");
+		write(mem + 2 * pageSize + 1, 0x45);
+		ok &= expect(g_faults.size() == 2 && g_faults[1] == 2, "second fault reports page 2");
+
+		ok &= expect(guard.unprotect(0), "unprotect page 0");
+		write(mem, 0x46);
+		ok &= expect(g_faults.size() == 2, "no fault after unprotect");
+
+		ok &= expect(guard.protect(1), "protect page 1");
+		guard.unprotectAll();
+		write(mem + pageSize, 0x47);
+		ok &= expect(g_faults.size() == 2, "no fault after unprotectAll");
+
+		// chaining: a fault outside of all guarded ranges is forwarded to the previously installed handler
+		g_foreignPage = foreign;
+		setWritable(foreign, false);
+
+		write(foreign + 5, 0x48);
+
+		ok &= expect(g_foreignFaults == 1, "foreign fault has been forwarded to the previous handler");
+		ok &= expect(foreign[5] == 0x48, "foreign write has been retried");
+		ok &= expect(g_faults.size() == 2, "foreign fault is not reported by the guard");
+
+		// leave a page protected, the destructor has to make it writable again
+		ok &= expect(guard.protect(3), "protect page 3");
+	}
+
+	// the guard is gone, the page is writable again and nothing is reported anymore
+	write(mem + 3 * pageSize, 0x49);
+	ok &= expect(mem[3 * pageSize] == 0x49, "page is writable after the guard has been destroyed");
+	ok &= expect(g_faults.size() == 2, "no fault after the guard has been destroyed");
+
+	freePages(foreign, 1);
+	freePages(mem, PageCount);
+
+	if(!ok)
+	{
+		std::cerr << "FAILED" << std::endl;
+		return 1;
+	}
+
+	std::cout << "PASSED" << std::endl;
+	return 0;
+}
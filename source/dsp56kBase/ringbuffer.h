@@ -27,6 +27,10 @@ namespace dsp56k
 		size_t size() const					{ return m_writeCount - m_readCount; }
 		size_t remaining() const			{ return (C - size()); }
 
+		// time the reader blocked because the buffer was empty / the writer blocked because it was full, zero if Lock is false
+		uint64_t getReadWaitNs() const		{ return m_readSem.getWaitNs(); }
+		uint64_t getWriteWaitNs() const		{ return m_writeSem.getWaitNs(); }
+
 		void push_back( const T& _val )
 		{
 	//		assert( m_usage < C && "ring buffer is already full!" );
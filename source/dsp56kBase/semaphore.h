@@ -2,6 +2,7 @@
 
 #include <mutex>
 #include <atomic>
+#include <chrono>
 
 #include "conditionvariable.h"
 #include "trigger.h"
@@ -112,7 +113,11 @@ namespace dsp56k
 			const int prev = m_count.fetch_sub(1, std::memory_order_acquire);
 
 			if (prev < 1)
+			{
+				const auto t = Clock::now();
 				m_sem.wait();
+				addWaitTime(t);
+			}
 		}
 
 		void wait(const uint32_t _count)
@@ -123,20 +128,38 @@ namespace dsp56k
 
 			if (prev  < count)
 			{
+				const auto t = Clock::now();
 				for (int i = prev; i < count; ++i)
 					m_sem.wait();
+				addWaitTime(t);
 			}
 		}
+
+		// total time spent blocking in wait(), only measured if a wait blocks
+		uint64_t getWaitNs() const
+		{
+			return m_waitNs.load(std::memory_order_relaxed);
+		}
+
 	private:
+		using Clock = std::chrono::steady_clock;
+
+		void addWaitTime(const Clock::time_point& _begin)
+		{
+			m_waitNs.fetch_add(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - _begin).count()), std::memory_order_relaxed);
+		}
+
 		std::atomic<int> m_count;
 		Semaphore m_sem;
+		std::atomic<uint64_t> m_waitNs{0};
 	};
 	
 	class NopSemaphore
 	{
 	public:
-		explicit NopSemaphore (const uint32_t _count = 0)	{}
-	    void notify(uint32_t _count = 1)					{}
-		void wait(uint32_t _count = 1)						{}
+		explicit NopSemaphore (const uint32_t = 0)			{}
+		void notify(uint32_t = 1)							{}
+		void wait(uint32_t = 1)								{}
+		uint64_t getWaitNs() const							{ return 0; }
 	};
 };
@@ -1,17 +1,107 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <atomic>
 #include <cassert>
 #include <cstdint>
-#include <cstring>
 #include <functional>
 #include <mutex>
+#include <type_traits>
+#include <utility>
 
 #include "conditionvariable.h"
 
 namespace dsp56k
 {
+	template<typename TFrame, typename = void>
+	struct FrameHasResize : std::false_type {};
+
+	template<typename TFrame>
+	struct FrameHasResize<TFrame, std::void_t<decltype(std::declval<TFrame&>().resize(std::declval<const TFrame&>().size()))>> : std::true_type {};
+
+	// Built-in reducer for frames that are indexable as frame[slot][channel]. Frames are either resizable, the result then has as
+	// many slots as the largest source, or of fixed size. The channel count of a slot is fixed.
+	// The sample type selects the implementation at compile time: floating point samples are summed, integer samples are treated as
+	// 24 bit fixed point. They are accumulated as 32 bit values and saturated once, after all sources have been added.
+	// All loops run over the contiguous channels of one slot without dependencies between them, they are written to be vectorized
+	// by the compiler
+	template<typename TFrame>
+	struct AudioSumReduce
+	{
+		using Sample = std::decay_t<decltype(std::declval<const TFrame&>()[0][0])>;
+
+		static_assert(std::is_floating_point_v<Sample> || (std::is_integral_v<Sample> && sizeof(Sample) >= sizeof(int32_t)), "unsupported sample type");
+
+		// the 32 bit accumulator does not overflow for up to 256 sources of 24 bit samples
+		static constexpr uint32_t MaxSources = 256;
+
+		void operator()(TFrame& _dst, const TFrame* const* _src, const uint32_t _count) const
+		{
+			assert(_count <= MaxSources);
+
+			size_t slotCount = 0;
+			for(uint32_t p = 0; p < _count; ++p)
+				slotCount = std::max<size_t>(slotCount, _src[p]->size());
+
+			if constexpr (FrameHasResize<TFrame>::value)
+				_dst.resize(slotCount);
+			else
+				assert(_dst.size() == slotCount);
+
+			for(size_t s = 0; s < slotCount; ++s)
+			{
+				auto& d = _dst[s];
+				const auto channelCount = static_cast<uint32_t>(d.size());
+
+				for(uint32_t c = 0; c < channelCount; ++c)
+					d[c] = Sample(0);
+
+				for(uint32_t p = 0; p < _count; ++p)
+				{
+					const auto& src = *_src[p];
+					if(s >= static_cast<size_t>(src.size()))
+						continue;
+
+					const auto& srcSlot = src[s];
+
+					for(uint32_t c = 0; c < channelCount; ++c)
+						d[c] = accumulate(d[c], srcSlot[c]);
+				}
+
+				if constexpr (!std::is_floating_point_v<Sample>)
+				{
+					for(uint32_t c = 0; c < channelCount; ++c)
+						d[c] = saturate(d[c]);
+				}
+			}
+		}
+
+		static Sample accumulate(const Sample _acc, const Sample _sample)
+		{
+			if constexpr (std::is_floating_point_v<Sample>)
+			{
+				return _acc + _sample;
+			}
+			else
+			{
+				// sign extend the 24 bit sample, the accumulator is a 32 bit value
+				const auto s = static_cast<int32_t>(static_cast<uint32_t>(_sample) << 8) >> 8;
+				return static_cast<Sample>(static_cast<uint32_t>(static_cast<int32_t>(_acc) + s));
+			}
+		}
+
+		static Sample saturate(const Sample _acc)
+		{
+			auto r = static_cast<int32_t>(_acc);
+
+			r = r > 0x7fffff ? 0x7fffff : r;
+			r = r < -0x800000 ? -0x800000 : r;
+
+			return static_cast<Sample>(static_cast<uint32_t>(r) & 0xffffff);
+		}
+	};
+
 	// Multi-producer ring buffer that sums frames from all producers.
 	//
 	// Lock-free producer path: each producer writes to its own lane.
@@ -21,23 +111,22 @@ namespace dsp56k
 	// Backpressure uses a condition variable with a fast-path atomic
 	// check — the mutex is only taken when producers are actually
 	// blocked (buffer full), which is rare in steady-state operation.
-	template<typename TFrame, uint32_t Capacity, uint32_t MaxProducers, typename TReduceFunc>
+	//
+	// Lanes and per-producer counters are cache line aligned so that
+	// producers running on different cores do not share cache lines.
+	//
+	// The reduce function either receives all frames of a slot at once,
+	// operator()(TFrame& dst, const TFrame* const* src, uint32_t count),
+	// or is called pairwise, operator()(TFrame& dst, const TFrame& src).
+	template<typename TFrame, uint32_t Capacity, uint32_t MaxProducers, typename TReduceFunc = AudioSumReduce<TFrame>>
 	class SharedAudioReducer
 	{
 	public:
 		static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of 2");
 
-		using CompletionCallback = std::function<void(uint64_t, const TFrame&)>;
+		static constexpr size_t CacheLineSize = 64;
 
-		SharedAudioReducer()
-		{
-			for(auto& slot : m_data)
-			{
-				slot.contributions.store(0, std::memory_order_relaxed);
-				for(auto& lane : slot.lanes)
-					::memset(&lane, 0, sizeof(lane));
-			}
-		}
+		using CompletionCallback = std::function<void(uint64_t, const TFrame&)>;
 
 		void setCompletionCallback(CompletionCallback _callback)
 		{
@@ -48,89 +137,146 @@ namespace dsp56k
 		{
 			const auto idx = m_producerCount++;
 			assert(idx < MaxProducers);
-			m_writeCounts[idx].store(0, std::memory_order_relaxed);
+			m_writeCounts[idx].count.store(0, std::memory_order_relaxed);
 			return idx;
 		}
 
 		void addFrame(const uint32_t _index, const TFrame& _frame)
 		{
-			if(m_terminated)
-				return;
+			addFrames(_index, &_frame, 1);
+		}
+
+		// Adds multiple consecutive frames of one producer. Backpressure is only checked once per run of free slots
+		void addFrames(const uint32_t _index, const TFrame* _frames, const size_t _count)
+		{
+			auto& writeCount = m_writeCounts[_index].count;
+
+			size_t i = 0;
 
-			auto& writeCount = m_writeCounts[_index];
-			const auto wc = writeCount.load(std::memory_order_relaxed);
+			while(i < _count)
+			{
+				if(m_terminated)
+					return;
+
+				const auto wc = writeCount.load(std::memory_order_relaxed);
+
+				const auto free = waitForSpace(wc);
+				if(!free)
+					return;
+
+				const auto n = std::min<uint64_t>(_count - i, free);
+
+				for(uint64_t j = 0; j < n; ++j, ++i)
+					contribute(_index, wc + j, _frames[i]);
+			}
+		}
+
+		void terminate()
+		{
+			m_terminated = true;
+			{
+				std::lock_guard<std::mutex> lock(m_readMtx);
+			}
+			m_readCv.notify_all();
+		}
+
+		bool isTerminated() const { return m_terminated; }
+		uint32_t producerCount() const { return m_producerCount; }
+		uint64_t readCount() const { return m_readCount.load(std::memory_order_relaxed); }
+
+	private:
+		static constexpr uint64_t wrap(const uint64_t _count)
+		{
+			return _count & (Capacity - 1);
+		}
+
+		// returns the number of slots that can be written starting at _writeCount, blocks if there are none. Returns 0 if terminated
+		uint64_t waitForSpace(const uint64_t _writeCount)
+		{
+			auto used = _writeCount - m_readCount.load(std::memory_order_acquire);
 
 			// Fast path: no backpressure, skip mutex entirely
-			if(wc - m_readCount.load(std::memory_order_acquire) >= Capacity)
+			if(used >= Capacity)
 			{
 				std::unique_lock<std::mutex> lock(m_readMtx);
 				m_readCv.wait(lock, [&]()
 				{
-					return m_terminated || wc - m_readCount.load(std::memory_order_acquire) < Capacity;
+					used = _writeCount - m_readCount.load(std::memory_order_acquire);
+					return m_terminated || used < Capacity;
 				});
 				if(m_terminated)
-					return;
+					return 0;
 			}
 
-			auto& slot = m_data[wrap(wc)];
+			return Capacity - used;
+		}
+
+		void contribute(const uint32_t _index, const uint64_t _writeCount, const TFrame& _frame)
+		{
+			auto& slot = m_data[wrap(_writeCount)];
 
-			slot.lanes[_index] = _frame;
+			slot.lanes[_index].frame = _frame;
 
 			std::atomic_thread_fence(std::memory_order_release);
 
-			writeCount.store(wc + 1, std::memory_order_release);
+			m_writeCounts[_index].count.store(_writeCount + 1, std::memory_order_release);
 
 			const auto contrib = slot.contributions.fetch_add(1, std::memory_order_acq_rel) + 1;
-			if(contrib == m_producerCount)
-			{
-				TFrame result = slot.lanes[0];
+			if(contrib != m_producerCount)
+				return;
 
-				for(uint32_t p = 1; p < m_producerCount; ++p)
-					m_reduceFunc(result, slot.lanes[p]);
+			TFrame result{};
 
-				m_completionCallback(wc, result);
+			if constexpr (std::is_invocable_v<TReduceFunc&, TFrame&, const TFrame* const*, uint32_t>)
+			{
+				// reducers that support it get all frames at once
+				std::array<const TFrame*, MaxProducers> frames;
+				for(uint32_t p = 0; p < m_producerCount; ++p)
+					frames[p] = &slot.lanes[p].frame;
 
-				slot.contributions.store(0, std::memory_order_relaxed);
-				m_readCount.store(wc + 1, std::memory_order_release);
+				m_reduceFunc(result, frames.data(), m_producerCount);
+			}
+			else
+			{
+				result = slot.lanes[0].frame;
 
-				{
-					std::lock_guard<std::mutex> lock(m_readMtx);
-				}
-				m_readCv.notify_all();
+				for(uint32_t p = 1; p < m_producerCount; ++p)
+					m_reduceFunc(result, slot.lanes[p].frame);
 			}
-		}
 
-		void terminate()
-		{
-			m_terminated = true;
+			m_completionCallback(_writeCount, result);
+
+			slot.contributions.store(0, std::memory_order_relaxed);
+			m_readCount.store(_writeCount + 1, std::memory_order_release);
+
 			{
 				std::lock_guard<std::mutex> lock(m_readMtx);
 			}
 			m_readCv.notify_all();
 		}
 
-		bool isTerminated() const { return m_terminated; }
-		uint32_t producerCount() const { return m_producerCount; }
-		uint64_t readCount() const { return m_readCount.load(std::memory_order_relaxed); }
+		struct alignas(CacheLineSize) Lane
+		{
+			TFrame frame{};
+		};
 
-	private:
-		static constexpr uint64_t wrap(const uint64_t _count)
+		struct alignas(CacheLineSize) WriteCount
 		{
-			return _count & (Capacity - 1);
-		}
+			std::atomic<uint64_t> count{0};
+		};
 
 		struct Slot
 		{
-			std::atomic<uint32_t> contributions{0};
-			std::array<TFrame, MaxProducers> lanes{};
+			alignas(CacheLineSize) std::atomic<uint32_t> contributions{0};
+			std::array<Lane, MaxProducers> lanes{};
 		};
 
 		std::array<Slot, Capacity> m_data{};
 
-		std::atomic<uint64_t> m_readCount{0};
+		alignas(CacheLineSize) std::atomic<uint64_t> m_readCount{0};
 		uint32_t m_producerCount = 0;
 		bool m_terminated = false;
-		std::array<std::atomic<uint64_t>, MaxProducers> m_writeCounts{};
+		std::array<WriteCount, MaxProducers> m_writeCounts{};
 
 		std::mutex m_readMtx;
 		ConditionVariable m_readCv;
@@ -1,5 +1,7 @@
 #include "sharedaudioreducer.h"
 
+#include <algorithm>
+#include <array>
 #include <atomic>
 #include <cassert>
 #include <chrono>
@@ -45,8 +47,169 @@ struct DefaultReduce
 	}
 };
 
+struct Fixed24Frame
+{
+	using Slot = std::array<uint32_t, 2>;
+
+	std::array<Slot, 2> slots{};
+	uint32_t slotCount = 0;
+
+	Slot& operator[](size_t i) { return slots[i]; }
+	const Slot& operator[](size_t i) const { return slots[i]; }
+	uint32_t size() const { return slotCount; }
+	void resize(uint32_t s) { slotCount = s; }
+};
+
+// Two producers contributing batches via addFrames, reduced by the built-in 24 bit reducer
+static bool testBatchedFixed24()
+{
+	constexpr uint64_t frameCount = 1000;
+	constexpr size_t batchSize = 24;
+
+	dsp56k::SharedAudioReducer<Fixed24Frame, 16, 2> reducer;
+
+	const auto p0 = reducer.addProducer();
+	const auto p1 = reducer.addProducer();
+
+	bool failed = false;
+	uint64_t consumed = 0;
+
+	reducer.setCompletionCallback([&](uint64_t _frameIndex, const Fixed24Frame& _frame)
+	{
+		const auto expectedSum = static_cast<uint32_t>(_frameIndex * 3) & 0xffffff;
+
+		if(_frame.size() != 2 || _frame[0][0] != expectedSum || _frame[0][1] != 0x7fffff || _frame[1][0] != 0x800000 || _frame[1][1] != 0xfffffe)
+		{
+			std::cerr << "Fixed24 frame " << _frameIndex << " mismatch" << std::endl;
+			failed = true;
+		}
+		++consumed;
+	});
+
+	auto produce = [&](const uint32_t _producer, const uint32_t _factor)
+	{
+		std::vector<Fixed24Frame> frames(batchSize);
+
+		for(uint64_t i = 0; i < frameCount; i += batchSize)
+		{
+			const auto count = static_cast<size_t>(std::min<uint64_t>(batchSize, frameCount - i));
+
+			for(size_t f = 0; f < count; ++f)
+			{
+				auto& frame = frames[f];
+				frame.resize(2);
+				frame[0][0] = static_cast<uint32_t>((i + f) * _factor);
+				frame[0][1] = 0x600000;		// positive overflow
+				frame[1][0] = 0x9fffff;		// negative overflow
+				frame[1][1] = 0xffffff;		// -1 + -1
+			}
+
+			reducer.addFrames(_producer, frames.data(), count);
+		}
+	};
+
+	std::thread t0([&] { produce(p0, 1); });
+	std::thread t1([&] { produce(p1, 2); });
+
+	t0.join();
+	t1.join();
+
+	if(failed || consumed != frameCount)
+	{
+		std::cerr << "FAILED: batched fixed 24 bit reduction, consumed " << consumed << " / " << frameCount << std::endl;
+		return false;
+	}
+	return true;
+}
+
+// Sources are accumulated first and saturated once, an intermediate overflow does not change the result
+static bool testSaturateOnce()
+{
+	Fixed24Frame a, b, c;
+
+	a.resize(2);
+	b.resize(1);
+	c.resize(2);
+
+	a[0] = {0x600000, 0x7fffff};
+	b[0] = {0x600000, 0x7fffff};
+	c[0] = {0xa00000, 0x800001};	// -0x600000, -0x7fffff
+
+	a[1] = {0x800000, 0x000001};
+	c[1] = {0x800000, 0xffffff};	// slot 1 is not present in b
+
+	const Fixed24Frame* frames[] = {&a, &b, &c};
+
+	Fixed24Frame result;
+	dsp56k::AudioSumReduce<Fixed24Frame>()(result, frames, 3);
+
+	if(result.size() != 2 || result[0][0] != 0x600000 || result[0][1] != 0x7fffff || result[1][0] != 0x800000 || result[1][1] != 0)
+	{
+		std::cerr << "FAILED: 24 bit samples are not saturated once" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+// Frames without resize(), reduced by the built-in reducer for floating point samples
+static bool testFixedSizeFrames()
+{
+	using Frame = std::array<std::array<float, 2>, 3>;
+
+	constexpr uint32_t producerCount = 3;
+	constexpr uint64_t frameCount = 100;
+
+	dsp56k::SharedAudioReducer<Frame, 8, producerCount> reducer;
+
+	for(uint32_t p = 0; p < producerCount; ++p)
+		reducer.addProducer();
+
+	bool failed = false;
+	uint64_t consumed = 0;
+
+	reducer.setCompletionCallback([&](uint64_t _frameIndex, const Frame& _frame)
+	{
+		for(uint32_t s = 0; s < 3; ++s)
+		{
+			// producers contribute 1, 2 and 3 times the frame index plus the slot
+			const auto expected = static_cast<float>((_frameIndex + s) * 6);
+
+			if(_frame[s][0] != expected || _frame[s][1] != -expected)
+			{
+				std::cerr << "Fixed size frame " << _frameIndex << " slot " << s << " mismatch" << std::endl;
+				failed = true;
+			}
+		}
+		++consumed;
+	});
+
+	for(uint64_t i = 0; i < frameCount; ++i)
+	{
+		for(uint32_t p = 0; p < producerCount; ++p)
+		{
+			Frame frame;
+			for(uint32_t s = 0; s < 3; ++s)
+			{
+				const auto v = static_cast<float>((i + s) * (p + 1));
+				frame[s] = {v, -v};
+			}
+			reducer.addFrame(p, frame);
+		}
+	}
+
+	if(failed || consumed != frameCount)
+	{
+		std::cerr << "FAILED: fixed size frames, consumed " << consumed << " / " << frameCount << std::endl;
+		return false;
+	}
+	return true;
+}
+
 int main()
 {
+	if(!testBatchedFixed24() || !testSaturateOnce() || !testFixedSizeFrames())
+		return 1;
+
 	dsp56k::SharedAudioReducer<TestFrame, BufferCapacity, ProducerCount, DefaultReduce> reducer;
 
 	std::vector<uint32_t> producerIds(ProducerCount);
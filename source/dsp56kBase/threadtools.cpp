@@ -111,7 +111,7 @@ namespace dsp56k
 		}
 		if( !::SetThreadPriority(GetCurrentThread(), prio))
 		{
-			LOG("Failed to set thread priority to " << prio);
+			LOGL(WARNING, "Failed to set thread priority to " << prio);
 			return false;
 		}
 #elif defined(__APPLE__)
@@ -139,7 +139,7 @@ namespace dsp56k
 
 		const auto result = pthread_setschedparam(id, SCHED_OTHER, &sch_params);
 		if(result)
-			LOG("Failed to set thread priority to " << prio << ", error code " << result);
+			LOGL(WARNING, "Failed to set thread priority to " << prio << ", error code " << result);
 
 		if (_priority == ThreadPriority::Highest)
 		{
@@ -167,14 +167,14 @@ namespace dsp56k
 		const auto tid = syscall(SYS_gettid);
 		if (!tid)
 		{
-			LOG("Failed to get thread id for setting priority");
+			LOGL(WARNING, "Failed to get thread id for setting priority");
 			return false;
 		}
 		const auto result = setpriority(PRIO_PROCESS, tid, prio);
 #endif
 		if (result != 0)
 		{
-			LOG("Failed to set thread priority to " << prio << ", error code " << result);
+			LOGL(WARNING, "Failed to set thread priority to " << prio << ", error code " << result);
 		}
 #endif
 		return true;
@@ -225,7 +225,7 @@ namespace dsp56k
 			LOG("Success setting thread realtime parameters: period=" << period << " us, computation=" << computation << " us, constraint=" << constraint << " us");
 	        return false;
 	    }
-		LOG("Failed to set thread realtime parameters, error code " << result);
+		LOGL(WARNING, "Failed to set thread realtime parameters, error code " << result);
 #endif
 		return false;
 	}
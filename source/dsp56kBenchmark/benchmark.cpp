@@ -0,0 +1,400 @@
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#include <Psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include "commandline.h"
+
+#include "dsp56kEmu/benchmarkkernels.h"
+#include "dsp56kEmu/dsp.h"
+#include "dsp56kEmu/jitconfig.h"
+#include "dsp56kEmu/jitperfcounters.h"
+#include "dsp56kEmu/memory.h"
+#include "dsp56kEmu/peripherals.h"
+
+#include "dsp56kBase/hugepages.h"
+
+using namespace dsp56k;
+
+namespace
+{
+	DefaultMemoryValidator g_memoryValidator;
+
+	constexpr TWord g_memSize = 0x010000;
+
+	struct BenchmarkConfig
+	{
+		std::string name;
+		bool jit = true;
+		std::function<void(JitConfig&)> apply;
+		bool hugePages = false;
+		MemoryLayout memoryLayout = MemoryLayout::Planar;
+	};
+
+	struct Result
+	{
+		std::string kernel;
+		std::string config;
+		uint64_t instructions = 0;		// per run
+		double firstRunMs = 0.0;		// includes JIT compilation
+		double avgRunMs = 0.0;
+		double mips = 0.0;
+		double compileMs = 0.0;			// all runs
+		uint64_t compiledBlocks = 0;
+		uint64_t recompiledBlocks = 0;
+		size_t codeBytes = 0;
+		size_t chainCount = 0;
+		uint64_t dtlbMisses = 0;		// per run, 0 if performance counters are not available
+		uint32_t checksum = 0;
+		bool outputMatches = true;		// compared to the interpreter
+	};
+
+	std::vector<BenchmarkConfig> createConfigs()
+	{
+		std::vector<BenchmarkConfig> configs;
+
+		configs.push_back({"interpreter", false, [](JitConfig&) {}});
+		configs.push_back({"interp-interleave", false, [](JitConfig&) {}, false, MemoryLayout::InterleavedXY});
+		configs.push_back({"jit", true, [](JitConfig&) {}});
+		configs.push_back({"jit-nolink", true, [](JitConfig& _c) { _c.linkJitBlocks = false; }});
+		configs.push_back({"jit-indirect", true, [](JitConfig& _c) { _c.linkIndirectBranches = true; }});
+		configs.push_back({"jit-liveness", true, [](JitConfig& _c) { _c.interBlockLiveness = true; }});
+		configs.push_back({"jit-pmemguard", true, [](JitConfig& _c) { _c.guardProgramMemory = true; }});
+		configs.push_back({"jit-sharechains", true, [](JitConfig& _c) { _c.shareChainsAcrossModes = true; }});
+		configs.push_back({"jit-hugepages", true, [](JitConfig&) {}, true});
+		configs.push_back({"jit-interleave", true, [](JitConfig&) {}, false, MemoryLayout::InterleavedXY});
+		configs.push_back({"jit-all", true, [](JitConfig& _c)
+		{
+			_c.linkIndirectBranches = true;
+			_c.interBlockLiveness = true;
+			_c.guardProgramMemory = true;
+			_c.shareChainsAcrossModes = true;
+		}});
+
+		return configs;
+	}
+
+	bool isSupported(const BenchmarkConfig& _config)
+	{
+		if(_config.jit && !g_useJIT)
+			return false;
+
+		// interleaved X/Y memory is not available on all hosts, memory falls back to planar
+		const Memory mem(g_memoryValidator, g_memSize, g_memSize, g_memSize, nullptr, _config.memoryLayout);
+		return mem.getLayout() == _config.memoryLayout;
+	}
+
+	uint32_t fnv1a(const std::vector<TWord>& _data)
+	{
+		uint32_t hash = 2166136261u;
+
+		for (const auto w : _data)
+		{
+			for(uint32_t i=0; i<3; ++i)
+			{
+				hash ^= (w >> (i<<3)) & 0xff;
+				hash *= 16777619u;
+			}
+		}
+		return hash;
+	}
+
+	size_t getPeakMemoryUsage()
+	{
+#ifdef _WIN32
+		PROCESS_MEMORY_COUNTERS pmc{};
+		if(GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+			return pmc.PeakWorkingSetSize;
+		return 0;
+#else
+		rusage usage{};
+		if(getrusage(RUSAGE_SELF, &usage) != 0)
+			return 0;
+#ifdef __APPLE__
+		return static_cast<size_t>(usage.ru_maxrss);			// bytes
+#else
+		return static_cast<size_t>(usage.ru_maxrss) * 1024;	// kilobytes
+#endif
+#endif
+	}
+
+	Result runKernel(const BenchmarkKernel& _kernel, const BenchmarkConfig& _config, const uint32_t _repetitions, std::ostream* _compileReport)
+	{
+		using Clock = std::chrono::high_resolution_clock;
+
+		// needs to be set before memory and JIT are created
+		HugePages::setEnabled(_config.hugePages);
+
+		Peripherals56362 peripheralsX;
+		Peripherals56367 peripheralsY;
+		Memory mem(g_memoryValidator, g_memSize, g_memSize, g_memSize, nullptr, _config.memoryLayout);
+		DSP dsp(mem, &peripheralsX, &peripheralsY);
+
+		if(_config.jit)
+		{
+			auto c = dsp.getJit().getConfig();
+			_config.apply(c);
+			dsp.getJit().setConfig(c);
+			dsp.getJit().resetCompileStats();
+		}
+
+		const auto prog = _kernel.setup(dsp, peripheralsX);
+
+		// everything above that is a broken kernel
+		constexpr uint64_t maxExecs = 1ull << 32;
+
+		auto run = [&]()
+		{
+			runBenchmarkKernel(dsp, peripheralsX, _kernel, prog, _config.jit, maxExecs);
+		};
+
+		Result r;
+		r.kernel = _kernel.name;
+		r.config = _config.name;
+
+		// first run creates the JIT blocks
+		const auto firstStart = Clock::now();
+		run();
+		r.firstRunMs = std::chrono::duration<double, std::milli>(Clock::now() - firstStart).count();
+
+		const auto instructionsStart = dsp.getInstructionCounter();
+
+		// compare jit and jit-hugepages to see the effect of huge pages
+		const JitPerfCounters::EventCounter dtlbMisses(JitPerfCounters::Event::DTLBMisses);
+		dtlbMisses.start();
+
+		const auto start = Clock::now();
+
+		for(uint32_t i=0; i<_repetitions; ++i)
+			run();
+
+		const auto durationMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+		r.dtlbMisses = dtlbMisses.stop() / _repetitions;
+
+		r.instructions = (dsp.getInstructionCounter() - instructionsStart) / _repetitions;
+		r.avgRunMs = durationMs / _repetitions;
+		r.mips = r.avgRunMs > 0.0 ? static_cast<double>(r.instructions) / (r.avgRunMs * 1000.0) : 0.0;
+
+		if(_config.jit)
+		{
+			const auto& jit = dsp.getJit();
+			const auto& compileStats = jit.getCompileStats().getTotals();
+
+			r.compileMs = static_cast<double>(compileStats.getTotalNs()) / 1000000.0;
+			r.compiledBlocks = compileStats.blocks;
+			r.recompiledBlocks = compileStats.recompiledBlocks;
+
+			const auto chainStats = jit.getChainStats();
+			r.codeBytes = chainStats.codeBytes;
+			r.chainCount = chainStats.chainCount;
+
+			if(_compileReport)
+			{
+				*_compileReport << std::endl << "Kernel " << _kernel.name << ", config " << _config.name << std::endl;
+				jit.writeCompileReport(*_compileReport, 10);
+			}
+		}
+
+		r.checksum = fnv1a(readBenchmarkOutput(dsp, _kernel));
+
+		return r;
+	}
+
+	void writeText(std::ostream& _out, const std::vector<Result>& _results, const uint32_t _repetitions, const size_t _peakMemory)
+	{
+		_out << "DSP 56300 benchmark, " << _repetitions << " repetitions" << std::endl << std::endl;
+
+		_out << std::left << std::setw(16) << "kernel" << std::setw(18) << "config" << std::right
+			<< std::setw(12) << "instr/run" << std::setw(12) << "ms/run" << std::setw(10) << "MIPS"
+			<< std::setw(12) << "compile ms" << std::setw(8) << "blocks" << std::setw(8) << "recomp" << std::setw(12) << "code bytes" << std::setw(8) << "chains"
+			<< std::setw(12) << "dTLB-miss" << "  checksum" << std::endl;
+
+		for (const auto& r : _results)
+		{
+			_out << std::left << std::setw(16) << r.kernel << std::setw(18) << r.config << std::right << std::fixed
+				<< std::setw(12) << r.instructions
+				<< std::setw(12) << std::setprecision(3) << r.avgRunMs
+				<< std::setw(10) << std::setprecision(1) << r.mips
+				<< std::setw(12) << std::setprecision(3) << r.compileMs
+				<< std::setw(8) << r.compiledBlocks
+				<< std::setw(8) << r.recompiledBlocks
+				<< std::setw(12) << r.codeBytes
+				<< std::setw(8) << r.chainCount
+				<< std::setw(12) << r.dtlbMisses
+				<< "  " << std::hex << std::setfill('0') << std::setw(8) << r.checksum << std::dec << std::setfill(' ')
+				<< (r.outputMatches ? "" : " MISMATCH") << std::endl;
+		}
+
+		_out << std::endl << "Peak memory usage: " << (_peakMemory >> 10) << " KiB" << std::endl;
+	}
+
+	std::string escapeJson(const std::string& _s)
+	{
+		std::string res;
+
+		for (const auto c : _s)
+		{
+			if(c == '"' || c == '\\')
+				res += '\\';
+			res += c;
+		}
+		return res;
+	}
+
+	void writeJson(std::ostream& _out, const std::vector<Result>& _results, const uint32_t _repetitions, const uint32_t _samples, const size_t _peakMemory)
+	{
+		_out << "{" << std::endl;
+		_out << "\t\"repetitions\": " << _repetitions << "," << std::endl;
+		_out << "\t\"samples\": " << _samples << "," << std::endl;
+		_out << "\t\"jit\": " << (g_useJIT ? "true" : "false") << "," << std::endl;
+		_out << "\t\"peakMemoryBytes\": " << _peakMemory << "," << std::endl;
+		_out << "\t\"results\": [" << std::endl;
+
+		for(size_t i=0; i<_results.size(); ++i)
+		{
+			const auto& r = _results[i];
+
+			_out << std::fixed << std::setprecision(6)
+				<< "\t\t{"
+				<< "\"kernel\": \"" << escapeJson(r.kernel) << "\", "
+				<< "\"config\": \"" << escapeJson(r.config) << "\", "
+				<< "\"instructionsPerRun\": " << r.instructions << ", "
+				<< "\"firstRunMs\": " << r.firstRunMs << ", "
+				<< "\"avgRunMs\": " << r.avgRunMs << ", "
+				<< "\"mips\": " << r.mips << ", "
+				<< "\"compileMs\": " << r.compileMs << ", "
+				<< "\"compiledBlocks\": " << r.compiledBlocks << ", "
+				<< "\"recompiledBlocks\": " << r.recompiledBlocks << ", "
+				<< "\"codeBytes\": " << r.codeBytes << ", "
+				<< "\"chainCount\": " << r.chainCount << ", "
+				<< "\"dtlbMissesPerRun\": " << r.dtlbMisses << ", "
+				<< "\"checksum\": " << r.checksum << ", "
+				<< "\"outputMatches\": " << (r.outputMatches ? "true" : "false")
+				<< "}" << (i + 1 < _results.size() ? "," : "") << std::endl;
+		}
+
+		_out << "\t]" << std::endl;
+		_out << "}" << std::endl;
+	}
+}
+
+int main(int _argc, char* _argv[])
+{
+	try
+	{
+		const CommandLine cmd(_argc, _argv);
+
+		if(cmd.contains("help") || cmd.contains("h"))
+		{
+			std::cout << "DSP 56300 Benchmark" << std::endl;
+			std::cout << std::endl;
+			std::cout << "Usage:" << std::endl;
+			std::cout << std::endl;
+			std::cout << "dsp56kBenchmark [-json outputfile] [-repetitions count] [-samples count] [-kernel name] [-config name] [compilereport] [list]" << std::endl;
+			std::cout << std::endl;
+			std::cout << "Options:" << std::endl;
+			std::cout << "-json filename     Write results as JSON to a file in addition to the text output." << std::endl;
+			std::cout << "-repetitions count Number of timed runs per kernel, after one untimed run that creates the JIT code. Default 10." << std::endl;
+			std::cout << "-samples count     Number of samples processed per run by streaming kernels, 1...4095. Default 2048." << std::endl;
+			std::cout << "-kernel name       Only run kernels whose name contains the given text." << std::endl;
+			std::cout << "-config name       Only run configurations whose name contains the given text." << std::endl;
+			std::cout << "compilereport      Print JIT compile statistics for every JIT run." << std::endl;
+			std::cout << "list               List kernels and configurations and exit." << std::endl;
+			std::cout << std::endl;
+			std::cout << "The return value is non-zero if a configuration produces different output than the interpreter." << std::endl;
+			return 0;
+		}
+
+		const auto repetitions = static_cast<uint32_t>(std::max(1, cmd.contains("repetitions") ? cmd.getInt("repetitions") : 10));
+		const auto samples = static_cast<uint32_t>(std::max(1, cmd.contains("samples") ? cmd.getInt("samples") : 2048));
+		const auto kernelFilter = cmd.tryGet("kernel");
+		const auto configFilter = cmd.tryGet("config");
+		const bool compileReport = cmd.contains("compilereport");
+
+		const auto kernels = createBenchmarkKernels(samples);
+		const auto configs = createConfigs();
+
+		if(cmd.contains("list"))
+		{
+			std::cout << "Kernels:" << std::endl;
+			for (const auto& k : kernels)
+				std::cout << "  " << std::left << std::setw(16) << k.name << k.description << std::endl;
+			std::cout << "Configurations:" << std::endl;
+			for (const auto& c : configs)
+				std::cout << "  " << c.name << std::endl;
+			return 0;
+		}
+
+		std::vector<Result> results;
+		bool mismatch = false;
+
+		for (const auto& k : kernels)
+		{
+			if(!kernelFilter.empty() && k.name.find(kernelFilter) == std::string::npos)
+				continue;
+
+			// the interpreter is the reference, always run it
+			const auto reference = runKernel(k, configs.front(), repetitions, nullptr);
+
+			for (const auto& c : configs)
+			{
+				if(!configFilter.empty() && c.name.find(configFilter) == std::string::npos)
+					continue;
+
+				if(!isSupported(c))
+					continue;
+
+				auto r = &c == &configs.front() ? reference : runKernel(k, c, repetitions, c.jit && compileReport ? &std::cout : nullptr);
+
+				r.outputMatches = r.checksum == reference.checksum;
+				mismatch |= !r.outputMatches;
+
+				results.push_back(r);
+			}
+		}
+
+		const auto peakMemory = getPeakMemoryUsage();
+
+		writeText(std::cout, results, repetitions, peakMemory);
+
+		if(cmd.contains("json"))
+		{
+			const auto jsonFile = cmd.get("json");
+			std::ofstream out(jsonFile, std::ios::out);
+
+			if(!out.is_open())
+			{
+				std::cout << "Failed to create output file " << jsonFile << std::endl;
+				return -1;
+			}
+
+			writeJson(out, results, repetitions, samples, peakMemory);
+		}
+
+		return mismatch ? 1 : 0;
+	}
+	catch (const std::exception& e)
+	{
+		std::cout << "Fatal error: " << e.what() << std::endl;
+		return -1;
+	}
+	catch (const std::string& e)
+	{
+		std::cout << "Fatal error: " << e << std::endl;
+		return -1;
+	}
+}
@@ -3,6 +3,7 @@
 #include "mainWindow.h"
 #include "dsp56kEmu/jitblock.h"
 #include "dsp56kEmu/jitdspmode.h"
+#include "dsp56kBase/logging.h"
 #include "wx/app.h"
 
 wxDEFINE_EVENT(dspUpdate, wxCommandEvent);
@@ -35,6 +36,16 @@ private:
 
 namespace dsp56kDebugger
 {
+	namespace
+	{
+		bool canDestroyJitBlocks(const dsp56k::DSP& _dsp)
+		{
+			if(_dsp.getSR().toWord() & dsp56k::SR_LF)
+				return false;
+			return _dsp.getProcessingMode() == dsp56k::DSP::Default;
+		}
+	}
+
 	Debugger::Debugger(dsp56k::DSP& _dsp)
 		: dsp56k::DebuggerInterface(_dsp)
 		, m_disasm(_dsp.opcodes())
@@ -147,9 +158,7 @@ namespace dsp56kDebugger
 
 		dspExec().runOnDspThread([&d]()
 		{
-			if(d.getSR().toWord() & dsp56k::SR_LF)
-				return false;
-			if(d.getProcessingMode() != dsp56k::DSP::Default)
+			if(!canDestroyJitBlocks(d))
 				return false;
 
 			d.getJit().destroyAllBlocks();
@@ -157,6 +166,43 @@ namespace dsp56kDebugger
 		});
 	}
 
+	bool Debugger::setJitBreakpoint(const dsp56k::TWord _addr, const bool _enable)
+	{
+		if(dsp56k::g_useJIT && _enable && !dsp56k::Jit::supportsBreakpoint(_addr))
+		{
+			LOGL(WARNING, "Breakpoints in the vector table are not supported by the JIT");
+			return false;
+		}
+
+		auto& d = dsp();
+
+		// the JIT compiles breakpoints into blocks, the blocks covering the address are destroyed on change
+		dspExec().runOnDspThread([&d, _addr, _enable]()
+		{
+			if(!canDestroyJitBlocks(d))
+				return false;
+
+			d.getJit().setBreakpoint(_addr, _enable);
+			return true;
+		});
+
+		return true;
+	}
+
+	void Debugger::setJitWatchpoint(const dsp56k::EMemArea _area, const dsp56k::TWord _addr, const bool _enable)
+	{
+		auto& d = dsp();
+
+		dspExec().runOnDspThread([&d, _area, _addr, _enable]()
+		{
+			if(!canDestroyJitBlocks(d))
+				return false;
+
+			d.getJit().setWatchpoint(_area, _addr, _enable);
+			return true;
+		});
+	}
+
 	bool Debugger::getMemoryAddress(dsp56k::TWord& _addr, dsp56k::EMemArea& _area, const dsp56k::TWord& _memAddr)
 	{
 		dsp56k::TWord opA, opB;
@@ -58,6 +58,9 @@ namespace dsp56kDebugger
 
 		void setJitConfig(const dsp56k::JitConfig& _config);
 		void destroyAllJitBlocks();
+		// returns false if the JIT does not support a breakpoint at the given address
+		bool setJitBreakpoint(dsp56k::TWord _addr, bool _enable);
+		void setJitWatchpoint(dsp56k::EMemArea _area, dsp56k::TWord _addr, bool _enable);
 		bool getMemoryAddress(dsp56k::TWord& _addr, dsp56k::EMemArea& _area, const dsp56k::TWord& _memAddr);
 
 	private:
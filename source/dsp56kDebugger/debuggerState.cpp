@@ -30,9 +30,16 @@ namespace dsp56kDebugger
 	{
 		const auto it = m_breakpoints.find(_addr);
 		if(it != m_breakpoints.end())
+		{
 			m_breakpoints.erase(it);
+			debugger().setJitBreakpoint(_addr, false);
+		}
 		else
+		{
+			if(!debugger().setJitBreakpoint(_addr, true))
+				return;
 			m_breakpoints.insert(_addr);
+		}
 
 		debugger().sendEvent(&DebuggerListener::evBreakpointsChanged);
 	}
@@ -55,6 +62,7 @@ namespace dsp56kDebugger
 		else
 			m_memoryBreakpoints[_area].insert(_addr);
 
+		debugger().setJitWatchpoint(_area, _addr, hasMemBreakpoint(_area, _addr));
 		debugger().sendEvent(&DebuggerListener::evMemBreakpointsChanged, _area);
 	}
 
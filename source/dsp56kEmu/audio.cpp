@@ -31,6 +31,8 @@ namespace dsp56k
 
 		setCallback([](Audio*) {});
 
+		m_outputPacer.terminate();
+
 		if (m_useRingBuffers)
 		{
 			while(true)
@@ -7,7 +7,9 @@
 #include <array>
 #include <cstring> // memcpy
 
+#include "dsp56kBase/audiopacer.h"
 #include "dsp56kBase/fastmath.h"
+#include "dsp56kBase/logging.h"
 #include "dsp56kBase/ringbuffer.h"
 #include "utils.h"
 
@@ -146,6 +148,9 @@ namespace dsp56k
 		template<typename T, typename TFunc>
 		void processAudioInput(const uint32_t _frames, const size_t _latency, const TFunc& _createRxFrame)
 		{
+			// host audio threads are not created by us, allocate their realtime log buffer on the first block
+			Logging::rt::registerThread();
+
 			for (uint32_t s = 0; s < _frames; ++s)
 			{
 				// INPUT
@@ -204,6 +209,8 @@ namespace dsp56k
 		template<typename T, typename TFunc>
 		void processAudioOutput(const uint32_t _frames, const TFunc& _readOutputCbk)
 		{
+			Logging::rt::registerThread();
+
 			for (uint32_t i = 0; i < _frames; ++i)
 			{
 				m_audioOutputs.waitNotEmpty();
@@ -212,6 +219,8 @@ namespace dsp56k
 					_readOutputCbk(i, _frame);
 				});
 			}
+
+			m_outputPacer.notifyConsumed();
 		}
 
 		template<typename T>
@@ -262,6 +271,9 @@ namespace dsp56k
 		auto& getAudioInputs() { return m_audioInputs; }
 		auto& getAudioOutputs() { return m_audioOutputs; }
 
+		// woken up whenever the host has read a block of output frames
+		AudioPacer& getOutputPacer() const { return m_outputPacer; }
+
 	public:
 		static constexpr uint32_t RingBufferSize = 8192 * 4;
 
@@ -289,6 +301,8 @@ namespace dsp56k
 		RingBuffer<TxFrame, RingBufferSize, true, false> m_audioOutputs;
 		size_t m_latency = 0;
 
+		mutable AudioPacer m_outputPacer;
+
 		std::atomic<bool> m_terminated{false};
 
 		ReadRxCallback m_readRxCallback;
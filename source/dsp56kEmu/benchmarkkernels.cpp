@@ -0,0 +1,557 @@
+#include "benchmarkkernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+#include "assembler.h"
+#include "dsp.h"
+#include "hdi08.h"
+#include "interrupts.h"
+#include "peripherals.h"
+
+namespace dsp56k
+{
+	namespace
+	{
+		constexpr TWord g_codeAddr = 0x000100;
+		constexpr TWord g_handlerAddr = 0x000c00;	// P, interrupt handler, reachable via short jsr
+		constexpr TWord g_flagAddr = 0x000010;		// X, set by the interrupt handler
+		constexpr TWord g_counterAddr = 0x000011;	// X
+		constexpr TWord g_stateAddr = 0x000100;	// X, filter state and delay lines
+		constexpr TWord g_coefAddr = 0x000200;		// Y, filter coefficients
+		constexpr TWord g_fftCoefAddr = 0x000800;	// Y, needs to be aligned to half the FFT size
+		constexpr TWord g_inputAddr = 0x001000;	// X
+		constexpr TWord g_fftDataAddr = 0x002000;	// X, needs to be aligned to the FFT size
+		constexpr TWord g_uploadAddr = 0x003000;	// X
+		constexpr TWord g_outputAddr = 0x004000;	// Y
+
+		constexpr TWord g_firTaps = 32;
+		constexpr TWord g_biquadSections = 8;
+		constexpr TWord g_fftOrder = 10;
+		constexpr TWord g_fftSize = 1 << g_fftOrder;
+		constexpr TWord g_delaySize = 64;
+		constexpr TWord g_delayStrideWrite = 5;
+		constexpr TWord g_delayStrideRead = 3;
+
+		std::string hex(const TWord _value)
+		{
+			std::stringstream ss;
+			ss << '$' << std::hex << _value;
+			return ss.str();
+		}
+
+		struct AsmWriter
+		{
+			DSP& dsp;
+			TWord pc;
+			Assembler assembler;
+
+			AsmWriter(DSP& _dsp, const TWord _pc) : dsp(_dsp), pc(_pc)
+			{
+			}
+
+			AsmWriter& operator << (const std::string& _line)
+			{
+				const auto res = assembler.assemble(_line.c_str());
+
+				if(!res.success())
+					throw std::string("Failed to assemble '") + _line + "', error " + std::to_string(static_cast<int>(res.error));
+
+				for(uint32_t i=0; i<res.wordCount; ++i)
+					dsp.memWriteP(pc++, res.word[i]);
+
+				return *this;
+			}
+
+			TWord doLoop(const std::string& _count)
+			{
+				*this << ("do " + _count + ",$1");		// loop address is patched once the loop body is known
+				return pc - 1;
+			}
+
+			void patchLoopAddress(const TWord _laAddr)
+			{
+				dsp.memWriteP(_laAddr, pc - 1);
+			}
+
+			TWord jmpToSelf()
+			{
+				const auto addr = pc;
+				*this << ("jmp " + hex(addr));
+				return addr;
+			}
+		};
+
+		BenchmarkProgram program(const TWord _endAddr, const TWord _waitAddr = 0xffffffff)
+		{
+			BenchmarkProgram p;
+			p.startAddr = g_codeAddr;
+			p.endAddr = _endAddr;
+			p.waitAddr = _waitAddr;
+			return p;
+		}
+
+		void writeInput(DSP& _dsp, const TWord _count)
+		{
+			uint32_t seed = 0x12345;
+
+			for(TWord i=0; i<_count; ++i)
+			{
+				seed = seed * 1664525 + 1013904223;
+
+				// keep some headroom to not saturate all the time
+				const auto sample = static_cast<TWord>(static_cast<int32_t>(seed) >> 10) & 0xffffff;
+
+				_dsp.memWrite(MemArea_X, g_inputAddr + i, sample);
+			}
+		}
+
+		BenchmarkProgram setupFir(DSP& _dsp, const TWord _samples)
+		{
+			writeInput(_dsp, _samples);
+
+			for(TWord i=0; i<g_firTaps; ++i)
+			{
+				_dsp.memWrite(MemArea_X, g_stateAddr + i, 0);
+				_dsp.memWrite(MemArea_Y, g_coefAddr + i, 0x020000 + i * 0x001000);
+			}
+
+			AsmWriter w(_dsp, g_codeAddr);
+
+			w << "move #" + hex(g_stateAddr) + ",r0";
+			w << "move #>" + hex(g_firTaps - 1) + ",m0";
+			w << "move #" + hex(g_coefAddr) + ",r4";
+			w << "move #>" + hex(g_firTaps - 1) + ",m4";
+			w << "move #" + hex(g_inputAddr) + ",r1";
+			w << "move #" + hex(g_outputAddr) + ",r5";
+
+			const auto laSamples = w.doLoop("#" + hex(_samples));
+			w << "move x:(r1)+,x1";
+			w << "move x1,x:(r0)";
+			w << "clr a";
+
+			const auto laTaps = w.doLoop("#" + hex(g_firTaps));
+			w << "move x:(r0)+,x0 y:(r4)+,y0";
+			w << "mac y0,x0,a";
+			w.patchLoopAddress(laTaps);
+
+			w << "move (r0)-";
+			w << "rnd a";
+			w << "move a,y:(r5)+";
+			w.patchLoopAddress(laSamples);
+
+			return program(w.jmpToSelf());
+		}
+
+		BenchmarkProgram setupBiquad(DSP& _dsp, const TWord _samples)
+		{
+			writeInput(_dsp, _samples);
+
+			// direct form II, per section: state w1,w2 in X, coefficients a1,a2,b1,b2 in Y
+			for(TWord i=0; i<g_biquadSections; ++i)
+			{
+				_dsp.memWrite(MemArea_X, g_stateAddr + i * 2, 0);
+				_dsp.memWrite(MemArea_X, g_stateAddr + i * 2 + 1, 0);
+
+				_dsp.memWrite(MemArea_Y, g_coefAddr + i * 4    , 0x200000);
+				_dsp.memWrite(MemArea_Y, g_coefAddr + i * 4 + 1, 0xf00000);
+				_dsp.memWrite(MemArea_Y, g_coefAddr + i * 4 + 2, 0x300000);
+				_dsp.memWrite(MemArea_Y, g_coefAddr + i * 4 + 3, 0x100000);
+			}
+
+			AsmWriter w(_dsp, g_codeAddr);
+
+			w << "move #" + hex(g_stateAddr) + ",r0";
+			w << "move #>" + hex(g_biquadSections * 2 - 1) + ",m0";
+			w << "move #" + hex(g_coefAddr) + ",r4";
+			w << "move #>" + hex(g_biquadSections * 4 - 1) + ",m4";
+			w << "move #" + hex(g_inputAddr) + ",r1";
+			w << "move #" + hex(g_outputAddr) + ",r5";
+
+			const auto laSamples = w.doLoop("#" + hex(_samples));
+			w << "move x:(r1)+,a";
+
+			const auto laSections = w.doLoop("#" + hex(g_biquadSections));
+			w << "move x:(r0)+,x0 y:(r4)+,y0";		// x0 = w1, y0 = a1
+			w << "mac y0,x0,a";
+			w << "move x:(r0)-,x1 y:(r4)+,y0";		// x1 = w2, y0 = a2
+			w << "mac x1,y0,a";
+			w << "rnd a";							// a = w0
+			w << "move a,b";
+			w << "move a,x:(r0)+";					// w1 = w0
+			w << "move x0,x:(r0)+";					// w2 = w1
+			w << "move y:(r4)+,y0";					// b1
+			w << "mac y0,x0,b";
+			w << "move y:(r4)+,y0";					// b2
+			w << "mac x1,y0,b";
+			w << "move b,a";
+			w.patchLoopAddress(laSections);
+
+			w << "move a,y:(r5)+";
+			w.patchLoopAddress(laSamples);
+
+			return program(w.jmpToSelf());
+		}
+
+		BenchmarkProgram setupFft(DSP& _dsp)
+		{
+			writeInput(_dsp, g_fftSize);
+
+			// cosine twiddle factors in natural order, read in bit-reversed order
+			constexpr auto halfSize = g_fftSize >> 1;
+
+			for(TWord i=0; i<halfSize; ++i)
+			{
+				const auto c = std::cos(3.14159265358979323846 * static_cast<double>(i) / static_cast<double>(halfSize));
+				_dsp.memWrite(MemArea_Y, g_fftCoefAddr + i, static_cast<TWord>(static_cast<int32_t>(c * 8388607.0)) & 0xffffff);
+			}
+
+			AsmWriter w(_dsp, g_codeAddr);
+
+			// reorder input into bit-reversed order
+			w << "move #" + hex(g_inputAddr) + ",r1";
+			w << "move #" + hex(g_fftDataAddr) + ",r4";
+			w << "move #0,m4";
+			w << "move #>" + hex(halfSize) + ",n4";
+
+			const auto la = w.doLoop("#" + hex(g_fftSize));
+			w << "move x:(r1)+,a";
+			w << "move a,x:(r4)+n4";
+			w.patchLoopAddress(la);
+
+			// butterfly passes, n0 = butterflies per group, n2 = groups, twiddles are addressed via bit-reversed r6
+			w << "move #>" + hex(halfSize) + ",n0";
+			w << "move #>1,n2";
+			w << "move #>" + hex(halfSize >> 1) + ",n6";
+			w << "move #0,m6";
+
+			const auto laPass = w.doLoop("#" + hex(g_fftOrder));
+			w << "move #" + hex(g_fftDataAddr) + ",r0";
+			w << "move #" + hex(g_fftCoefAddr) + ",r6";
+			w << "move n0,n1";
+			w << "lua (r0)+n0,r1";
+
+			const auto laGroup = w.doLoop("n2");
+			w << "move y:(r6)+n6,y0";
+
+			const auto laButterfly = w.doLoop("n0");
+			w << "move x:(r1),x0";
+			w << "mpyr y0,x0,a x:(r0),b";	// a = w * bottom, b = top
+			w << "asr a";
+			w << "asr b";
+			w << "add a,b";
+			w << "move b,x:(r0)+";			// top = (top + w * bottom) / 2
+			w << "sub a,b";
+			w << "sub a,b";
+			w << "move b,x:(r1)+";			// bottom = (top - w * bottom) / 2
+			w.patchLoopAddress(laButterfly);
+
+			w << "lua (r0)+n0,r0";
+			w << "lua (r1)+n1,r1";
+			w.patchLoopAddress(laGroup);
+
+			w << "move n0,a1";
+			w << "lsr a n2,b1";
+			w << "lsl b a1,n0";
+			w << "move b1,n2";
+			w.patchLoopAddress(laPass);
+
+			return program(w.jmpToSelf());
+		}
+
+		BenchmarkProgram setupCircularBuffer(DSP& _dsp, const TWord _samples)
+		{
+			writeInput(_dsp, _samples);
+
+			for(TWord i=0; i<g_delaySize; ++i)
+				_dsp.memWrite(MemArea_X, g_stateAddr + i, 0);
+
+			AsmWriter w(_dsp, g_codeAddr);
+
+			// write and read taps move through the buffer with different strides
+			w << "move #" + hex(g_stateAddr) + ",r0";
+			w << "move #>" + hex(g_delaySize - 1) + ",m0";
+			w << "move #>" + hex(g_delayStrideWrite) + ",n0";
+			w << "move #" + hex(g_stateAddr + (g_delaySize >> 1)) + ",r2";
+			w << "move #>" + hex(g_delaySize - 1) + ",m2";
+			w << "move #>" + hex(g_delayStrideRead) + ",n2";
+			w << "move #" + hex(g_inputAddr) + ",r1";
+			w << "move #" + hex(g_outputAddr) + ",r5";
+
+			const auto la = w.doLoop("#" + hex(_samples));
+			w << "move x:(r1)+,a";
+			w << "asr a";
+			w << "move x:(r0),b";
+			w << "asr b";
+			w << "add a,b a,x:(r0)+n0";
+			w << "move x:(r2)-n2,x0";
+			w << "add x0,b";
+			w << "move b,y:(r5)+";
+			w.patchLoopAddress(la);
+
+			return program(w.jmpToSelf());
+		}
+
+		BenchmarkProgram setupHdi08Upload(DSP& _dsp, const TWord _samples)
+		{
+			AsmWriter w(_dsp, g_codeAddr);
+
+			w << "move #" + hex(g_uploadAddr) + ",r0";
+
+			const auto la = w.doLoop("#" + hex(_samples));
+			const auto waitAddr = w.pc;
+			w << "jclr #" + std::to_string(HDI08::HSR_HRDF) + ",x:<<" + hex(HDI08::HSR) + "," + hex(waitAddr);
+			w << "movep x:<<" + hex(HDI08::HORX) + ",x:(r0)+";
+			w.patchLoopAddress(la);
+
+			return program(w.jmpToSelf());
+		}
+
+		void prepareHdi08Upload(Peripherals56362& _periph, const TWord _samples)
+		{
+			std::vector<TWord> data;
+			data.reserve(_samples);
+
+			for(TWord i=0; i<_samples; ++i)
+				data.push_back((i * 0x010203) & 0xffffff);
+
+			auto& hdi = _periph.getHDI08();
+			hdi.clearRX();
+			hdi.writeRX(data);
+		}
+
+		BenchmarkProgram setupPolling(DSP& _dsp, const TWord _samples)
+		{
+			AsmWriter w(_dsp, g_codeAddr);
+
+			w << "clr b";
+			w << "move #0,y0";
+			w << "move #0,y1";
+
+			const auto la = w.doLoop("#" + hex(_samples));
+			w << "movep x:<<" + hex(HDI08::HSR) + ",x0";
+			w << "add x0,b";
+			w << "btst #" + std::to_string(HDI08::HSR_HF0) + ",x:<<" + hex(HDI08::HSR);
+			w << "adc y,b";
+			w.patchLoopAddress(la);
+
+			w << "move #" + hex(g_outputAddr) + ",r5";
+			w << "move b,y:(r5)";
+
+			return program(w.jmpToSelf());
+		}
+
+		BenchmarkProgram setupEsaiInterrupt(DSP& _dsp, const TWord _samples)
+		{
+			writeInput(_dsp, _samples);
+
+			for(TWord i=0; i<g_delaySize; ++i)
+				_dsp.memWrite(MemArea_X, g_stateAddr + i, 0);
+
+			_dsp.memWrite(MemArea_X, g_counterAddr, 0);
+
+			// long interrupt
+			{
+				AsmWriter w(_dsp, Vba_ESAI_Transmit_Data);
+				w << "jsr " + hex(g_handlerAddr);
+				w << "nop";
+			}
+
+			// receivers are disabled, RX0 reads zero. The handler mixes it with input data and a delay line
+			{
+				AsmWriter w(_dsp, g_handlerAddr);
+				w << "movep x:<<" + hex(Esai::M_RX0) + ",x0";
+				w << "move x:(r1)+,a";
+				w << "add x0,a x:(r6),b";
+				w << "asr a";
+				w << "asr b";
+				w << "add b,a";
+				w << "move a,x:(r6)+";
+				w << "movep a,x:<<" + hex(Esai::M_TX0);
+				w << "move a,y:(r5)+";
+				w << "bset #0,x:<" + hex(g_flagAddr);
+				w << "rti";
+			}
+
+			AsmWriter w(_dsp, g_codeAddr);
+
+			w << "move #" + hex(g_inputAddr) + ",r1";
+			w << "move #" + hex(g_outputAddr) + ",r5";
+			w << "move #" + hex(g_stateAddr) + ",r6";
+			w << "move #>" + hex(g_delaySize - 1) + ",m6";
+			w << "bclr #0,x:<" + hex(g_flagAddr);
+			w << "andi #$fc,mr";
+
+			// no DO loop here, the interpreter executes DO loops without returning, the host would never get the chance to inject the interrupt
+			w << "move #>" + hex(_samples) + ",r7";
+
+			const auto waitAddr = w.pc;
+			w << "jclr #0,x:<" + hex(g_flagAddr) + "," + hex(waitAddr);
+			w << "bclr #0,x:<" + hex(g_flagAddr);
+
+			// background processing between interrupts
+			w << "move x:<" + hex(g_counterAddr) + ",a";
+			w << "inc a";
+			w << "move a,x:<" + hex(g_counterAddr);
+
+			w << "move (r7)-";
+			w << "move r7,b";
+			w << "tst b";
+			w << "jne " + hex(waitAddr);
+
+			w << "ori #$03,mr";
+
+			return program(w.jmpToSelf(), waitAddr);
+		}
+
+		BenchmarkProgram setupSelfModifyingCode(DSP& _dsp, const TWord _samples)
+		{
+			writeInput(_dsp, _samples);
+
+			AsmWriter w(_dsp, g_codeAddr);
+
+			w << "move #" + hex(g_inputAddr) + ",r1";
+			w << "move #" + hex(g_outputAddr) + ",r5";
+
+			const auto patchPointerAddr = w.pc + 1;
+			w << "move #>$0,r2";					// address of the immediate that is patched, see below
+
+			const auto la = w.doLoop("#" + hex(_samples));
+			w << "move x:(r1)+,x0";
+			w << "move x0,p:(r2)";
+
+			_dsp.memWriteP(patchPointerAddr, w.pc + 1);
+			w << "move #>$0,y0";
+			w << "move y0,y:(r5)+";
+			w.patchLoopAddress(la);
+
+			return program(w.jmpToSelf());
+		}
+	}
+
+	std::vector<BenchmarkKernel> createBenchmarkKernels(const uint32_t _sampleCount)
+	{
+		// DO immediate is 12 bits, HDI08 receive buffer holds 8192 words
+		const TWord samples = std::min<TWord>(std::max<TWord>(_sampleCount, 1), 0xfff);
+
+		std::vector<BenchmarkKernel> kernels;
+
+		{
+			BenchmarkKernel k;
+			k.name = "fir";
+			k.description = "FIR " + std::to_string(g_firTaps) + " taps, modulo addressing";
+			k.setup = [samples](DSP& _dsp, Peripherals56362&) { return setupFir(_dsp, samples); };
+			k.outputAddr = g_outputAddr;
+			k.outputSize = samples;
+			kernels.push_back(k);
+		}
+		{
+			BenchmarkKernel k;
+			k.name = "biquad";
+			k.description = "Biquad cascade, " + std::to_string(g_biquadSections) + " sections";
+			k.setup = [samples](DSP& _dsp, Peripherals56362&) { return setupBiquad(_dsp, samples); };
+			k.outputAddr = g_outputAddr;
+			k.outputSize = samples;
+			kernels.push_back(k);
+		}
+		{
+			BenchmarkKernel k;
+			k.name = "fft";
+			k.description = "Radix-2 FFT " + std::to_string(g_fftSize) + " points, bit-reversed addressing";
+			k.setup = [](DSP& _dsp, Peripherals56362&) { return setupFft(_dsp); };
+			k.outputArea = MemArea_X;
+			k.outputAddr = g_fftDataAddr;
+			k.outputSize = g_fftSize;
+			kernels.push_back(k);
+		}
+		{
+			BenchmarkKernel k;
+			k.name = "circularbuffer";
+			k.description = "Delay line with " + std::to_string(g_delaySize) + " words, modulo addressing with strides";
+			k.setup = [samples](DSP& _dsp, Peripherals56362&) { return setupCircularBuffer(_dsp, samples); };
+			k.outputAddr = g_outputAddr;
+			k.outputSize = samples;
+			kernels.push_back(k);
+		}
+		{
+			BenchmarkKernel k;
+			k.name = "hdi08upload";
+			k.description = "HDI08 bulk upload, polling HRDF";
+			k.setup = [samples](DSP& _dsp, Peripherals56362&) { return setupHdi08Upload(_dsp, samples); };
+			k.prepareRun = [samples](DSP&, Peripherals56362& _periph) { prepareHdi08Upload(_periph, samples); };
+			k.outputArea = MemArea_X;
+			k.outputAddr = g_uploadAddr;
+			k.outputSize = samples;
+			kernels.push_back(k);
+		}
+		{
+			BenchmarkKernel k;
+			k.name = "esaiinterrupt";
+			k.description = "ESAI interrupt driven I/O, long interrupts";
+			k.setup = [samples](DSP& _dsp, Peripherals56362&) { return setupEsaiInterrupt(_dsp, samples); };
+			k.interruptVector = Vba_ESAI_Transmit_Data;
+			k.outputAddr = g_outputAddr;
+			k.outputSize = samples;
+			kernels.push_back(k);
+		}
+		{
+			BenchmarkKernel k;
+			k.name = "polling";
+			k.description = "Peripheral polling loop";
+			k.setup = [samples](DSP& _dsp, Peripherals56362&) { return setupPolling(_dsp, samples); };
+			k.prepareRun = [](DSP&, Peripherals56362& _periph) { _periph.getHDI08().setHostFlags(1, 0); };
+			k.outputAddr = g_outputAddr;
+			k.outputSize = 1;
+			kernels.push_back(k);
+		}
+		{
+			BenchmarkKernel k;
+			k.name = "selfmodifying";
+			k.description = "Self-modifying code, patches an immediate every sample";
+			k.setup = [samples](DSP& _dsp, Peripherals56362&) { return setupSelfModifyingCode(_dsp, samples); };
+			k.outputAddr = g_outputAddr;
+			k.outputSize = samples;
+			kernels.push_back(k);
+		}
+
+		return kernels;
+	}
+
+	void runBenchmarkKernel(DSP& _dsp, Peripherals56362& _periph, const BenchmarkKernel& _kernel, const BenchmarkProgram& _program, const bool _jit, const uint64_t _maxExecs)
+	{
+		if(_kernel.prepareRun)
+			_kernel.prepareRun(_dsp, _periph);
+
+		_dsp.setPC(_program.startAddr);
+
+		for(uint64_t i=0;; ++i)
+		{
+			const auto pc = _dsp.getPC().toWord();
+
+			if(pc == _program.endAddr)
+				return;
+
+			if(i >= _maxExecs)
+				throw std::string("Kernel " + _kernel.name + " did not finish");
+
+			if(pc == _program.waitAddr && !_dsp.hasPendingInterrupts())
+				_dsp.injectInterrupt(_kernel.interruptVector);
+
+			if(_jit)
+				_dsp.execJit();
+			else
+				_dsp.execInterpreter();
+		}
+	}
+
+	std::vector<TWord> readBenchmarkOutput(const DSP& _dsp, const BenchmarkKernel& _kernel)
+	{
+		std::vector<TWord> output(_kernel.outputSize);
+
+		for(TWord i=0; i<_kernel.outputSize; ++i)
+			output[i] = _dsp.memory().get(_kernel.outputArea, _kernel.outputAddr + i);
+
+		return output;
+	}
+}
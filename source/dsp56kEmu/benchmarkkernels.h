@@ -0,0 +1,49 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "types.h"
+
+namespace dsp56k
+{
+	class DSP;
+	class Peripherals56362;
+
+	struct BenchmarkProgram
+	{
+		TWord startAddr = 0;
+		TWord endAddr = 0;				// address of the final jmp to self
+		TWord waitAddr = 0xffffffff;	// address of the loop that waits for the host to inject an interrupt, if any
+	};
+
+	struct BenchmarkKernel
+	{
+		std::string name;
+		std::string description;
+
+		// writes program and data
+		std::function<BenchmarkProgram(DSP&, Peripherals56362&)> setup;
+
+		// optional, called before every run to provide data to peripherals
+		std::function<void(DSP&, Peripherals56362&)> prepareRun;
+
+		// injected whenever the program reaches waitAddr and no interrupt is pending
+		TWord interruptVector = 0;
+
+		EMemArea outputArea = MemArea_Y;
+		TWord outputAddr = 0;
+		TWord outputSize = 0;
+	};
+
+	// Small DSP programs that are used by dsp56kBenchmark to measure the performance of interpreter and JIT and by BenchmarkKernelTests
+	// to verify that all configurations produce the same output
+	std::vector<BenchmarkKernel> createBenchmarkKernels(uint32_t _sampleCount);
+
+	// executes the program once from its start address. Injects the interrupt of the kernel whenever the program waits for it.
+	// Throws if the program does not reach its end address within _maxExecs calls to execJit/execInterpreter
+	void runBenchmarkKernel(DSP& _dsp, Peripherals56362& _periph, const BenchmarkKernel& _kernel, const BenchmarkProgram& _program, bool _jit, uint64_t _maxExecs);
+
+	std::vector<TWord> readBenchmarkOutput(const DSP& _dsp, const BenchmarkKernel& _kernel);
+}
@@ -0,0 +1,95 @@
+#include "benchmarkkerneltests.h"
+
+#include "benchmarkkernels.h"
+#include "dsp.h"
+#include "jitconfig.h"
+#include "memory.h"
+#include "peripherals.h"
+#include "unittests.h"
+
+namespace dsp56k
+{
+	namespace
+	{
+		constexpr TWord g_memSize = 0x010000;
+		constexpr uint32_t g_samples = 64;
+		constexpr uint32_t g_runs = 2;
+		constexpr uint64_t g_maxExecs = 10000000;
+
+		DefaultMemoryValidator g_memoryValidator;
+	}
+
+	BenchmarkKernelTests::BenchmarkKernelTests()
+	{
+		LOG("Running Benchmark Kernel Tests...");
+
+		const auto kernels = createBenchmarkKernels(g_samples);
+
+		for (const auto& kernel : kernels)
+		{
+			const auto reference = runKernel(kernel, Mode::Interpreter, MemoryLayout::Planar);
+
+			auto test = [&](const Mode _mode, const MemoryLayout _layout)
+			{
+				// interleaved X/Y memory is not available on all hosts
+				const Memory mem(g_memoryValidator, g_memSize, g_memSize, g_memSize, nullptr, _layout);
+				if(mem.getLayout() != _layout)
+					return;
+
+				if(runKernel(kernel, _mode, _layout) != reference)
+					throw std::string("Kernel " + kernel.name + " produces different output with " + toString(_mode, _layout));
+			};
+
+			test(Mode::Interpreter, MemoryLayout::InterleavedXY);
+
+			if(g_useJIT)
+			{
+				test(Mode::Jit, MemoryLayout::Planar);
+				test(Mode::Jit, MemoryLayout::InterleavedXY);
+				test(Mode::JitAllOptions, MemoryLayout::Planar);
+			}
+		}
+
+		LOG("Benchmark Kernel Tests finished.");
+	}
+
+	std::vector<TWord> BenchmarkKernelTests::runKernel(const BenchmarkKernel& _kernel, const Mode _mode, const MemoryLayout _layout)
+	{
+		Peripherals56362 peripheralsX;
+		Peripherals56367 peripheralsY;
+		Memory mem(g_memoryValidator, g_memSize, g_memSize, g_memSize, nullptr, _layout);
+		DSP dsp(mem, &peripheralsX, &peripheralsY);
+
+		if(_mode == Mode::JitAllOptions)
+		{
+			auto c = dsp.getJit().getConfig();
+			c.linkIndirectBranches = true;
+			c.interBlockLiveness = true;
+			c.guardProgramMemory = true;
+			c.shareChainsAcrossModes = true;
+			dsp.getJit().setConfig(c);
+		}
+
+		const auto prog = _kernel.setup(dsp, peripheralsX);
+
+		// the second run executes JIT code that has been created by the first one
+		for(uint32_t i=0; i<g_runs; ++i)
+			runBenchmarkKernel(dsp, peripheralsX, _kernel, prog, _mode != Mode::Interpreter, g_maxExecs);
+
+		return readBenchmarkOutput(dsp, _kernel);
+	}
+
+	std::string BenchmarkKernelTests::toString(const Mode _mode, const MemoryLayout _layout)
+	{
+		std::string res;
+
+		switch (_mode)
+		{
+		case Mode::Interpreter:		res = "interpreter";				break;
+		case Mode::Jit:				res = "JIT";						break;
+		case Mode::JitAllOptions:	res = "JIT with all options";		break;
+		}
+
+		return res + (_layout == MemoryLayout::InterleavedXY ? ", interleaved memory" : ", planar memory");
+	}
+}
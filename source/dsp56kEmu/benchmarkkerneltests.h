@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "types.h"
+
+namespace dsp56k
+{
+	struct BenchmarkKernel;
+	enum class MemoryLayout;
+
+	// Runs the dsp56kBenchmark kernels with a small sample count. Every kernel needs to finish and the JIT and the interleaved
+	// memory layout need to produce the same output as the interpreter with planar memory
+	class BenchmarkKernelTests
+	{
+	public:
+		BenchmarkKernelTests();
+
+	private:
+		enum class Mode
+		{
+			Interpreter,
+			Jit,
+			JitAllOptions
+		};
+
+		static std::vector<TWord> runKernel(const BenchmarkKernel& _kernel, Mode _mode, MemoryLayout _layout);
+		static std::string toString(Mode _mode, MemoryLayout _layout);
+	};
+}
@@ -4,6 +4,7 @@
 
 #include "dsp.h"
 #include "peripherals.h"
+#include "statestream.h"
 #include "utils.h"
 
 #include <cstring> // memcpy
@@ -191,6 +192,44 @@ namespace dsp56k
 		m_peripherals.setDelayCycles(0);
 	}
 
+	void DmaChannel::saveState(StateWriter& _w) const
+	{
+		_w.write(m_dsr);
+		_w.write(m_ddr);
+		_w.write(m_dco);
+		_w.write(m_dcr);
+		_w.write(m_dcoh);
+		_w.write(m_dcom);
+		_w.write(m_dcol);
+		_w.write(m_dcohInit);
+		_w.write(m_dcomInit);
+		_w.write(m_dcolInit);
+		_w.write(m_pendingTransfer);
+		_w.write(m_lastClock);
+	}
+
+	void DmaChannel::loadState(StateReader& _r)
+	{
+		// the request targets depend on DCR, do not use setDCR() as it would start a transfer
+		m_dma.removeTriggerTarget(this);
+
+		_r.read(m_dsr);
+		_r.read(m_ddr);
+		_r.read(m_dco);
+		_r.read(m_dcr);
+		_r.read(m_dcoh);
+		_r.read(m_dcom);
+		_r.read(m_dcol);
+		_r.read(m_dcohInit);
+		_r.read(m_dcomInit);
+		_r.read(m_dcolInit);
+		_r.read(m_pendingTransfer);
+		_r.read(m_lastClock);
+
+		if(bitvalue(m_dcr, De) && isRequestTrigger())
+			m_dma.addTriggerTarget(this);
+	}
+
 	const TWord& DmaChannel::getDSR() const
 	{
 		return m_dsr;
@@ -344,7 +383,7 @@ namespace dsp56k
 //			auto& dsp = m_peripherals.getDSP();
 //			auto& mem = dsp.memory();
 
-			if (bridgedOverlap(_dstArea, _dstAddr, _count) || bridgedOverlap(_srcArea, _srcAddr, _count))
+			if (bridgedOverlap(_dstArea, _dstAddr, _count) || bridgedOverlap(_srcArea, _srcAddr, _count) || !canAccessMemoryDirectly())
 			{
 				copyIndividual();
 			}
@@ -365,7 +404,7 @@ namespace dsp56k
 		if(_dstAddr >= m_peripherals.getDSP().memory().getBridgedMemoryAddress())
 			_dstArea = MemArea_P;
 
-		const auto writeIndividual = _dstArea == MemArea_P || isPeripheralAddr(_dstArea, _dstAddr, _count) || bridgedOverlap(_dstArea, _dstAddr, _count);
+		const auto writeIndividual = _dstArea == MemArea_P || isPeripheralAddr(_dstArea, _dstAddr, _count) || bridgedOverlap(_dstArea, _dstAddr, _count) || !canAccessMemoryDirectly();
 
 		if (readMultiple)
 		{
@@ -524,6 +563,13 @@ namespace dsp56k
 		return basePtr + _addr;
 	}
 
+	bool DmaChannel::canAccessMemoryDirectly() const
+	{
+		// bulk copies need consecutive words and must not bypass dirty page tracking
+		const auto& mem = m_peripherals.getDSP().memory();
+		return mem.getLayout() == MemoryLayout::Planar && !mem.isDirtyPageTrackingEnabled();
+	}
+
 	bool DmaChannel::execTransfer()
 	{
 		const auto areaS = getSourceSpace();
@@ -794,4 +840,22 @@ namespace dsp56k
 		if (it != channels.end())
 			channels.erase(it);
 	}
+
+	void Dma::saveState(StateWriter& _w) const
+	{
+		_w.write(m_dstr);
+		_w.write(m_dor);
+
+		for (const auto& c : m_channels)
+			c.saveState(_w);
+	}
+
+	void Dma::loadState(StateReader& _r)
+	{
+		_r.read(m_dstr);
+		_r.read(m_dor);
+
+		for (auto& c : m_channels)
+			c.loadState(_r);
+	}
 }
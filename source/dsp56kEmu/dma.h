@@ -9,6 +9,8 @@ namespace dsp56k
 {
 	class Dma;
 	class IPeripherals;
+	class StateReader;
+	class StateWriter;
 
 	class DmaChannel
 	{
@@ -111,6 +113,10 @@ namespace dsp56k
 		const TWord& getDCO() const;
 		const TWord& getDCR() const;
 
+		TWord& getDSR()	{ return m_dsr; }
+		TWord& getDDR()	{ return m_ddr; }
+		TWord& getDCO()	{ return m_dco; }
+
 		uint32_t exec();
 
 		void triggerByRequest();
@@ -136,6 +142,9 @@ namespace dsp56k
 
 		void extractDCOHML(TWord& _h, TWord& _m, TWord& _l) const;
 
+		void saveState(StateWriter& _w) const;
+		void loadState(StateReader& _r);
+
 	private:
 		void memCopy(EMemArea _dstArea, TWord _dstAddr, EMemArea _srcArea, TWord _srcAddr, TWord _count) const;
 		void memFill(EMemArea _dstArea, TWord _dstAddr, EMemArea _srcArea, TWord _srcAddr, TWord _count) const;
@@ -147,6 +156,7 @@ namespace dsp56k
 		void memWrite(EMemArea _area, TWord _addr, TWord _value) const;
 
 		TWord* getMemPtr(EMemArea _area, TWord _addr) const;
+		bool canAccessMemoryDirectly() const;
 
 		bool execTransfer();
 		void finishTransfer();
@@ -206,6 +216,10 @@ namespace dsp56k
 		const TWord& getDCO(const TWord _channel) const { return m_channels[_channel].getDCO(); }
 		const TWord& getDCR(const TWord _channel) const { return m_channels[_channel].getDCR(); }
 
+		TWord& getDSR(const TWord _channel) { return m_channels[_channel].getDSR(); }
+		TWord& getDDR(const TWord _channel) { return m_channels[_channel].getDDR(); }
+		TWord& getDCO(const TWord _channel) { return m_channels[_channel].getDCO(); }
+
 		uint32_t exec() noexcept;
 		void setActiveChannel(TWord _channel);
 		void clearActiveChannel();
@@ -215,6 +229,9 @@ namespace dsp56k
 		void addTriggerTarget(DmaChannel* _channel);
 		void removeTriggerTarget(const DmaChannel* _channel);
 
+		void saveState(StateWriter& _w) const;
+		void loadState(StateReader& _r);
+
 	private:
 		TWord m_dstr;
 		std::array<DmaChannel, 6> m_channels;
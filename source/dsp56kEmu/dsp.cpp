@@ -2,6 +2,7 @@
 
 #include "dsp.h"
 
+#include <algorithm>
 #include <iomanip>
 #include <cstring>
 
@@ -25,6 +26,7 @@
 #include "dsp_jumptable.inl"
 
 #include "jit.h"
+#include "statestream.h"
 
 #if 0
 #	define LOGSC(F)	logSC(F)
@@ -160,6 +162,7 @@ namespace dsp56k
 
 		if(interrupt >= Vba_End)
 		{
+			m_metrics.addInterrupt(interrupt);
 			m_customInterrupts[interrupt - Vba_End]();
 
 			{
@@ -180,6 +183,8 @@ namespace dsp56k
 		if(isInterruptMasked(vba))
 			return;
 
+		m_metrics.addInterrupt(vba);
+
 		// it is important that the processing mode is switched first before popping the vector to prevent a possible race condition in hasPendingInterrupt()
 		{
 			m_processingMode = FastInterrupt;
@@ -278,12 +283,143 @@ namespace dsp56k
 			m_interruptFunc = &dspExecInterrupts;
 	}
 
+	uint32_t DSP::getInterruptFuncIndex() const
+	{
+		if(m_interruptFunc == &dspExecInterrupts)				return 1;
+		if(m_interruptFunc == &dspExecDefaultPreventInterrupt)	return 2;
+		if(m_interruptFunc == &dspExecNop)						return 3;
+		return 0;
+	}
+
+	void DSP::setInterruptFuncIndex(const uint32_t _index)
+	{
+		switch (_index)
+		{
+		case 1:		m_interruptFunc = &dspExecInterrupts;				break;
+		case 2:		m_interruptFunc = &dspExecDefaultPreventInterrupt;	break;
+		case 3:		m_interruptFunc = &dspExecNop;						break;
+		default:	m_interruptFunc = m_execPeripheralsFunc;			break;
+		}
+	}
+
 	void DSP::terminate()
 	{
 		for(size_t i=0; i<perif.size(); ++i)
 			perif[i]->terminate();
 	}
 
+	void DSP::enableExecutionTrace(const size_t _capacity, const bool _captureRegisters)
+	{
+		m_executionTrace.reset(new ExecutionTrace(_capacity, _captureRegisters));
+
+		if constexpr(g_useJIT)
+			m_jit.destroyAllBlocks();
+	}
+
+	void DSP::disableExecutionTrace()
+	{
+		if(!m_executionTrace)
+			return;
+
+		m_executionTrace.reset();
+
+		if constexpr(g_useJIT)
+			m_jit.destroyAllBlocks();
+	}
+
+	void DSP::enableDirtyPageTracking(const bool _enable)
+	{
+		if(_enable == mem.isDirtyPageTrackingEnabled())
+			return;
+
+		mem.enableDirtyPageTracking(_enable);
+
+		// JIT code marks dirty pages inline, existing blocks need to be recreated to start or stop doing so
+		if constexpr(g_useJIT)
+			m_jit.destroyAllBlocks();
+	}
+
+	void DSP::enableMemoryHeatMap(const uint32_t _samplePeriod, const TWord _granularityShift)
+	{
+		// existing blocks refer to the countdown of the current heat map, they have to be gone before it is replaced
+		if constexpr(g_useJIT)
+			m_jit.destroyAllBlocks();
+
+		// addresses are recorded before bridging, X and Y addresses may extend into the P memory range
+		const auto addressCount = std::max({mem.size(MemArea_X), mem.size(MemArea_Y), mem.size(MemArea_P)});
+
+		mem.setHeatMap(nullptr);
+		m_memoryHeatMap.reset(new MemoryHeatMap(_samplePeriod, addressCount, _granularityShift));
+		mem.setHeatMap(m_memoryHeatMap.get());
+	}
+
+	void DSP::disableMemoryHeatMap()
+	{
+		if(!m_memoryHeatMap)
+			return;
+
+		if constexpr(g_useJIT)
+			m_jit.destroyAllBlocks();
+
+		mem.setHeatMap(nullptr);
+		m_memoryHeatMap.reset();
+	}
+
+	bool DSP::copyStateFrom(const DSP& _source)
+	{
+		for(size_t i=0; i<perif.size(); ++i)
+		{
+			if(perif[i]->getType() != _source.perif[i]->getType())
+			{
+				LOGL(ERROR, "Unable to copy DSP state, peripherals " << i << " do not match");
+				return false;
+			}
+		}
+
+		if(!mem.copyFrom(_source.mem))
+			return false;
+
+		// peripheral registers and timing, data queued by the host is not copied, see IPeripherals::saveState()
+		for(size_t i=0; i<perif.size(); ++i)
+		{
+			std::vector<uint8_t> state;
+			StateWriter w(state);
+			_source.perif[i]->saveState(w);
+
+			StateReader r(state);
+			perif[i]->loadState(r);
+			assert(r.ok() && !r.getRemaining());
+		}
+
+		reg = _source.reg;
+		ccrCache = _source.ccrCache;
+		cache = _source.cache;
+
+		m_instructions = _source.m_instructions;
+		m_cycles = _source.m_cycles;
+		m_processingMode = _source.m_processingMode;
+		m_interruptFunc = _source.m_interruptFunc;
+		pcCurrentInstruction = _source.pcCurrentInstruction;
+
+		m_pendingInterrupts.clear();
+		for(size_t i=0; i<_source.m_pendingInterrupts.size(); ++i)
+			m_pendingInterrupts.push_back(_source.m_pendingInterrupts[i]);
+
+		m_pendingExternalInterrupts.clear();
+		for(size_t i=0; i<_source.m_pendingExternalInterrupts.size(); ++i)
+			m_pendingExternalInterrupts.push_back(_source.m_pendingExternalInterrupts[i]);
+
+		clearOpcodeCache();
+
+		if constexpr(g_useJIT)
+		{
+			m_jit.destroyAllBlocks();
+			m_jit.copyAnalysisFrom(_source.m_jit);
+		}
+
+		return true;
+	}
+
 	void DSP::setDebugger(DebuggerInterface* _debugger)
 	{
 		if(m_debugger == _debugger)
@@ -1015,6 +1151,7 @@ namespace dsp56k
 
 	bool DSP::memWritePeriph( EMemArea _area, TWord _offset, TWord _value )
 	{
+		m_metrics.add(DspMetrics::periphAccess(_area, true), 1);
 		perif[_area - MemArea_X]->write(_offset | 0xff0000, _value );
 		return true;
 	}
@@ -1075,6 +1212,7 @@ namespace dsp56k
 
 	TWord DSP::memReadPeriph(EMemArea _area, TWord _offset, Instruction _inst) const
 	{
+		m_metrics.add(DspMetrics::periphAccess(_area, false), 1);
 		return perif[_area - MemArea_X]->read(_offset | 0xff0000, _inst);
 	}
 	TWord DSP::memReadPeriphFFFF80(EMemArea _area, TWord _offset, Instruction _inst) const
@@ -1245,6 +1383,8 @@ namespace dsp56k
 		if(isInterruptMasked(_interruptVectorAddress))
 			return false;
 
+		m_metrics.addInterrupt(_interruptVectorAddress);
+
 		execInterrupt(_interruptVectorAddress);
 
 		while(m_processingMode != Default)
@@ -1253,6 +1393,30 @@ namespace dsp56k
 		return true;
 	}
 
+	void DSP::updateMetrics()
+	{
+		using Metric = DspMetrics::Metric;
+
+		m_metrics.set(Metric::Instructions, m_instructions);
+		m_metrics.set(Metric::Cycles, m_cycles);
+		m_metrics.set(Metric::IdleCycles, m_idleCycles);
+
+		if(g_useJIT)
+		{
+			const auto& compileStats = m_jit.getCompileStats().getTotals();
+
+			m_metrics.set(Metric::JitChains, m_jit.getChainCount());
+			m_metrics.set(Metric::JitCodeBytes, m_jit.getCodeSize());
+			m_metrics.set(Metric::JitBlocks, compileStats.blocks);
+			m_metrics.set(Metric::JitRecompiledBlocks, compileStats.recompiledBlocks);
+			m_metrics.set(Metric::JitCompileNs, compileStats.getTotalNs());
+		}
+
+		perif[0]->updateMetrics(m_metrics);
+		if(perif[1] != perif[0])
+			perif[1]->updateMetrics(m_metrics);
+	}
+
 	bool DSP::isInterruptMasked(const TWord _vba) const
 	{
 		const auto prio = _vba < Vba_IRQA ? 3 : 2;
@@ -1471,6 +1635,7 @@ aar0=$000008 aar1=$000000 aar2=$000000 aar3=$000000
 //			LOG("Delay " << delay);
 			m_instructions += delay;
 			m_cycles += delay;
+			m_idleCycles += delay;
 
 			m_execPeripheralsFunc(this);
 		}
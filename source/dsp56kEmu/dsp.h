@@ -2,9 +2,12 @@
 
 #include "disasm.h"
 #include "dspconfig.h"
+#include "dspmetrics.h"
 #include "dspregs.h"
+#include "executiontrace.h"
 #include "registers.h"
 #include "memory.h"
+#include "memoryheatmap.h"
 #include "utils.h"
 #include "instructioncache.h"
 #include "opcodes.h"
@@ -46,6 +49,7 @@ namespace dsp56k
 		friend class Jit;
 		friend class AotRuntime;
 		friend class DebuggerInterface;
+		friend class SaveState;
 
 		// _____________________________________________________________________________
 		// types
@@ -157,6 +161,12 @@ namespace dsp56k
 
 		DebuggerInterface*	m_debugger = nullptr;
 
+		std::unique_ptr<ExecutionTrace>	m_executionTrace;
+
+		uint64_t		m_idleCycles = 0;
+		mutable DspMetrics	m_metrics;		// peripheral reads are counted by const accessors
+		std::unique_ptr<MemoryHeatMap>	m_memoryHeatMap;
+
 		// _____________________________________________________________________________
 		// implementation
 		//
@@ -184,6 +194,8 @@ namespace dsp56k
 
 		ASMJIT_FORCE_INLINE void execJit() noexcept
 		{
+			m_jit.resetLinkedIndirectBranches();
+
 			m_interruptFunc(this);
 
 			const auto pc = getPC().toWord();
@@ -220,6 +232,8 @@ namespace dsp56k
 		template<typename Ta, typename Tb> ASMJIT_NOINLINE void execPeripherals() noexcept
 		{
 			// we do not have any Y peripherals that need processing atm
+			m_metrics.add(DspMetrics::Metric::PeriphExecs, 1);
+
 			const auto delayA = static_cast<Ta*>(perif[0])->exec();
 //			const auto delayB = static_cast<Tb*>(perif[1])->exec();
 
@@ -301,6 +315,26 @@ namespace dsp56k
 		void			dumpRegisters					(std::stringstream& _ss) const;
 		void			enableTrace						(TraceMode _trace) { m_trace = _trace; }
 
+		// JIT blocks are recreated to add or remove the trace hook, only call this while no DSP code is being executed
+		void			enableExecutionTrace			(size_t _capacity, bool _captureRegisters = false);
+		void			disableExecutionTrace			();
+		ExecutionTrace*	getExecutionTrace				() const { return m_executionTrace.get(); }
+
+		// Copies memory, registers, counters, pending interrupts and peripheral state of an already booted DSP with identical memory
+		// layout and peripherals to skip the boot process of additional instances. No JIT code is compiled here, the clone compiles
+		// its blocks on first entry with the analysis of the source, see Jit::copyAnalysisFrom(). Neither DSP may execute code while this is called
+		bool			copyStateFrom					(const DSP& _source);
+
+		// Tracks modified memory pages, see Memory::fetchDirtyPages(). JIT code marks the pages it writes to inline,
+		// blocks are recreated. Only call this while no DSP code is being executed
+		void			enableDirtyPageTracking			(bool _enable);
+
+		// Samples X/Y/P memory accesses at runtime, counted per block of 2^_granularityShift words. JIT blocks are recreated with
+		// instrumented memory accesses while enabled, only call this while no DSP code is being executed
+		void			enableMemoryHeatMap				(uint32_t _samplePeriod = 64, TWord _granularityShift = 4);
+		void			disableMemoryHeatMap			();
+		MemoryHeatMap*	getMemoryHeatMap				() const { return m_memoryHeatMap.get(); }
+
 		Memory&			memory							()											{ return mem; }
 		const Memory&	memory							() const									{ return mem; }
 
@@ -350,8 +384,32 @@ namespace dsp56k
 			m_cycles += _cycles;
 		}
 
+		// used if the DSP is idle, for example in a polling loop waiting for host data. Skips to the point in time where peripherals need to be processed next
+		void fastForwardToPeripheralsDeadline()
+		{
+			const auto cycles = getRemainingPeripheralsCycles();
+			if(!cycles)
+				return;
+			fastForward(cycles, cycles);
+			m_idleCycles += cycles;
+		}
+
+		// number of cycles that have been skipped while the DSP was waiting, either via WAIT or in a detected polling loop
+		uint64_t getIdleCycles() const { return m_idleCycles; }
+
+		// can be read from any thread. Interrupt counts are updated immediately, everything else by updateMetrics()
+		const DspMetrics& getMetrics() const { return m_metrics; }
+		DspMetrics& getMetrics() { return m_metrics; }
+
+		// publishes counters of the DSP, its peripherals and the JIT. Needs to be called on the DSP thread
+		void updateMetrics();
+
 	private:
 
+		// used to serialize the interrupt processing state
+		uint32_t getInterruptFuncIndex() const;
+		void setInterruptFuncIndex(uint32_t _index);
+
 		std::string getSSindent() const;
 
 		TWord	fetchOpWordB()
@@ -791,13 +849,13 @@ namespace dsp56k
 		bool	memWritePeriph		( EMemArea _area, TWord _offset, TWord _value );
 		bool	memWritePeriphFFFF80( EMemArea _area, TWord _offset, TWord _value );
 		bool	memWritePeriphFFFFC0( EMemArea _area, TWord _offset, TWord _value );
+		TWord	memReadPeriph		( EMemArea _area, TWord _offset, Instruction _inst) const;
 
 	private:
 		void	notifyProgramMemWrite(TWord _offset);
 		
 		TWord	memRead				( EMemArea _area, TWord _offset ) const;
 		void	memReadOpcode		( TWord _offset, TWord& _wordA, TWord& _wordB ) const;
-		TWord	memReadPeriph		( EMemArea _area, TWord _offset, Instruction _inst) const;
 		TWord	memReadPeriphFFFF80	( EMemArea _area, TWord _offset, Instruction _inst) const;
 		TWord	memReadPeriphFFFFC0	( EMemArea _area, TWord _offset, Instruction _inst) const;
 
@@ -0,0 +1,135 @@
+#include "dspmetrics.h"
+
+#include <algorithm>
+#include <iomanip>
+
+#include "dsp56kBase/logging.h"
+
+namespace dsp56k
+{
+	uint64_t DspMetrics::Snapshot::getInterruptCount() const
+	{
+		uint64_t count = customInterrupts;
+		for (const auto i : interrupts)
+			count += i;
+		return count;
+	}
+
+	double DspMetrics::Snapshot::getHeadroom() const
+	{
+		const auto runNs = (*this)[Metric::ThreadRunNs];
+		if(!runNs)
+			return 0.0;
+
+		const auto idleNs = (*this)[Metric::ThreadBlockedNs] + (*this)[Metric::ThreadPacingSleepNs];
+		return std::min(1.0, static_cast<double>(idleNs) / static_cast<double>(runNs));
+	}
+
+	DspMetrics::Snapshot DspMetrics::snapshot() const
+	{
+		Snapshot s;
+
+		for(size_t i=0; i<MetricCount; ++i)
+			s.values[i] = m_values[i].load(std::memory_order_relaxed);
+
+		for(size_t i=0; i<VectorCount; ++i)
+			s.interrupts[i] = m_interrupts[i].load(std::memory_order_relaxed);
+
+		s.customInterrupts = m_customInterrupts.load(std::memory_order_relaxed);
+
+		return s;
+	}
+
+	const char* DspMetrics::getName(const Metric _m)
+	{
+		switch (_m)
+		{
+		case Metric::Instructions:			return "instructions";
+		case Metric::Cycles:				return "cycles";
+		case Metric::IdleCycles:			return "idleCycles";
+		case Metric::ThreadRunNs:			return "threadRunNs";
+		case Metric::ThreadBlockedNs:		return "threadBlockedNs";
+		case Metric::ThreadPacingSleepNs:	return "threadPacingSleepNs";
+		case Metric::PeriphExecs:			return "periphExecs";
+		case Metric::PeriphXReads:			return "periphXReads";
+		case Metric::PeriphXWrites:			return "periphXWrites";
+		case Metric::PeriphYReads:			return "periphYReads";
+		case Metric::PeriphYWrites:			return "periphYWrites";
+		case Metric::EsaiTxFrames:			return "esaiTxFrames";
+		case Metric::EsaiRxFrames:			return "esaiRxFrames";
+		case Metric::EsaiTxUnderruns:		return "esaiTxUnderruns";
+		case Metric::EsaiRxOverruns:		return "esaiRxOverruns";
+		case Metric::AudioInputLevel:		return "audioInputLevel";
+		case Metric::AudioOutputLevel:		return "audioOutputLevel";
+		case Metric::AudioInputCapacity:	return "audioInputCapacity";
+		case Metric::AudioOutputCapacity:	return "audioOutputCapacity";
+		case Metric::Hdi08RxWords:			return "hdi08RxWords";
+		case Metric::Hdi08RxEmptyReads:		return "hdi08RxEmptyReads";
+		case Metric::Hdi08TxWords:			return "hdi08TxWords";
+		case Metric::Hdi08TxOverwrites:		return "hdi08TxOverwrites";
+		case Metric::Hdi08RxLevel:			return "hdi08RxLevel";
+		case Metric::Hdi08TxLevel:			return "hdi08TxLevel";
+		case Metric::JitChains:				return "jitChains";
+		case Metric::JitCodeBytes:			return "jitCodeBytes";
+		case Metric::JitBlocks:				return "jitBlocks";
+		case Metric::JitRecompiledBlocks:	return "jitRecompiledBlocks";
+		case Metric::JitCompileNs:			return "jitCompileNs";
+		case Metric::Count:					break;
+		}
+		return "?";
+	}
+
+	void DspMetrics::writeText(std::ostream& _out, const Snapshot& _snapshot)
+	{
+		for(size_t i=0; i<MetricCount; ++i)
+		{
+			const auto m = static_cast<Metric>(i);
+			_out << std::left << std::setfill(' ') << std::setw(24) << getName(m) << std::right << std::dec << _snapshot[m] << std::endl;
+		}
+
+		_out << std::left << std::setw(24) << "headroom" << std::right << std::fixed << std::setprecision(3) << _snapshot.getHeadroom() << std::endl;
+		_out << std::left << std::setw(24) << "interrupts" << std::right << _snapshot.getInterruptCount() << std::endl;
+
+		for(size_t i=0; i<VectorCount; ++i)
+		{
+			if(_snapshot.interrupts[i])
+				_out << "  P:" << HEXN(i<<1, 2) << std::setfill(' ') << std::setw(18) << ' ' << std::dec << _snapshot.interrupts[i] << std::endl;
+		}
+
+		if(_snapshot.customInterrupts)
+			_out << "  custom" << std::setw(16) << ' ' << _snapshot.customInterrupts << std::endl;
+	}
+
+	void DspMetrics::writeJson(std::ostream& _out, const Snapshot& _snapshot)
+	{
+		_out << '{' << std::dec;
+
+		for(size_t i=0; i<MetricCount; ++i)
+		{
+			const auto m = static_cast<Metric>(i);
+			_out << '"' << getName(m) << "\": " << _snapshot[m] << ", ";
+		}
+
+		_out << "\"headroom\": " << std::fixed << std::setprecision(6) << _snapshot.getHeadroom() << ", ";
+		_out << "\"customInterrupts\": " << _snapshot.customInterrupts << ", ";
+
+		// vector address => count, only vectors that have been taken at least once
+		_out << "\"interrupts\": {";
+
+		bool first = true;
+
+		for(size_t i=0; i<VectorCount; ++i)
+		{
+			if(!_snapshot.interrupts[i])
+				continue;
+
+			if(!first)
+				_out << ", ";
+			first = false;
+
+			_out << "\"" << (i<<1) << "\": " << _snapshot.interrupts[i];
+		}
+
+		_out << "}}";
+	}
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+
+#include "interrupts.h"
+#include "types.h"
+
+namespace dsp56k
+{
+	// Runtime metrics of one DSP. Values are written by the DSP thread only and can be read by any other thread at any rate
+	// without locking. Counters are accumulated since the DSP has been created, levels are the state at the time of the last update.
+	// Most values are published by DSP::updateMetrics(), which is called by the DSPThread regularly
+	class DspMetrics
+	{
+	public:
+		enum class Metric
+		{
+			Instructions,
+			Cycles,
+			IdleCycles,				// cycles skipped because the DSP has been waiting
+
+			// the DSP thread
+			ThreadRunNs,			// wall time since the thread has been started
+			ThreadBlockedNs,		// time blocked on full/empty audio and HDI08 buffers
+			ThreadPacingSleepNs,	// time slept by audio pacing
+
+			// peripherals
+			PeriphExecs,			// runs of the peripheral service, IPeripherals::exec()
+			PeriphXReads,			// register accesses by the DSP, including those that JIT code performs inline
+			PeriphXWrites,
+			PeriphYReads,
+			PeriphYWrites,
+
+			// ESAI
+			EsaiTxFrames,
+			EsaiRxFrames,
+			EsaiTxUnderruns,		// the DSP did not write all enabled transmitters before the next slot
+			EsaiRxOverruns,			// the DSP did not read the receivers before the next slot
+			AudioInputLevel,		// frames in the audio input buffer
+			AudioOutputLevel,		// frames in the audio output buffer
+			AudioInputCapacity,
+			AudioOutputCapacity,
+
+			// HDI08
+			Hdi08RxWords,			// words read by the DSP
+			Hdi08RxEmptyReads,		// reads while no data was available
+			Hdi08TxWords,			// words written by the DSP
+			Hdi08TxOverwrites,		// writes that replaced a word that the host did not read yet
+			Hdi08RxLevel,
+			Hdi08TxLevel,
+
+			// JIT
+			JitChains,
+			JitCodeBytes,
+			JitBlocks,
+			JitRecompiledBlocks,
+			JitCompileNs,
+
+			Count
+		};
+
+		static constexpr size_t MetricCount = static_cast<size_t>(Metric::Count);
+		static constexpr size_t VectorCount = Vba_End >> 1;
+
+		struct Snapshot
+		{
+			std::array<uint64_t, MetricCount> values{};
+			std::array<uint64_t, VectorCount> interrupts{};		// interrupts taken, indexed by vector address / 2
+			uint64_t customInterrupts = 0;
+
+			uint64_t operator[](const Metric _m) const { return values[static_cast<size_t>(_m)]; }
+
+			uint64_t getInterruptCount() const;
+
+			// share of the wall time the DSP thread did not need to keep up, zero if it runs at its limit
+			double getHeadroom() const;
+		};
+
+		void set(const Metric _m, const uint64_t _value)
+		{
+			m_values[static_cast<size_t>(_m)].store(_value, std::memory_order_relaxed);
+		}
+
+		uint64_t get(const Metric _m) const
+		{
+			return m_values[static_cast<size_t>(_m)].load(std::memory_order_relaxed);
+		}
+
+		// single writer, no need for an atomic read-modify-write
+		void add(const Metric _m, const uint64_t _value)
+		{
+			auto& v = m_values[static_cast<size_t>(_m)];
+			v.store(v.load(std::memory_order_relaxed) + _value, std::memory_order_relaxed);
+		}
+
+		static Metric periphAccess(const EMemArea _area, const bool _write)
+		{
+			if(_area == MemArea_Y)
+				return _write ? Metric::PeriphYWrites : Metric::PeriphYReads;
+			return _write ? Metric::PeriphXWrites : Metric::PeriphXReads;
+		}
+
+		// JIT code increments counters inline. The DSP thread is the only writer
+		uint64_t& getStorage(const Metric _m)
+		{
+			static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t) && std::atomic<uint64_t>::is_always_lock_free);
+			return *reinterpret_cast<uint64_t*>(&m_values[static_cast<size_t>(_m)]);
+		}
+
+		void addInterrupt(const TWord _vba)
+		{
+			auto& v = _vba < Vba_End ? m_interrupts[_vba >> 1] : m_customInterrupts;
+			v.store(v.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		}
+
+		Snapshot snapshot() const;
+
+		static const char* getName(Metric _m);
+
+		static void writeText(std::ostream& _out, const Snapshot& _snapshot);
+		static void writeJson(std::ostream& _out, const Snapshot& _snapshot);
+
+	private:
+		std::array<std::atomic<uint64_t>, MetricCount> m_values{};
+		std::array<std::atomic<uint64_t>, VectorCount> m_interrupts{};
+		std::atomic<uint64_t> m_customInterrupts{0};
+	};
+}
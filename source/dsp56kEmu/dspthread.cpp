@@ -1,10 +1,13 @@
 #include "dspthread.h"
 
+#include <algorithm>
 #include <chrono>
 #include <iostream>
 
+#include "audio.h"
 #include "debuggerinterface.h"
 #include "dsp.h"
+#include "dsp56kBase/logging.h"
 #include "dsp56kBase/threadtools.h"
 
 #if DSP56300_DEBUGGER
@@ -73,6 +76,13 @@ namespace dsp56k
 		m_callback = c;
 	}
 
+	void DSPThread::setAudioPacing(const AudioPacing& _pacing)
+	{
+		Guard g(m_mutex);
+		m_pacing = _pacing;
+		++m_pacingVersion;
+	}
+
 	void DSPThread::setDebugger(DebuggerInterface* _debugger)
 	{
 		std::lock_guard lock(m_debuggerMutex);
@@ -94,6 +104,7 @@ namespace dsp56k
 	{
 		ThreadTools::setCurrentThreadPriority(ThreadPriority::Highest);
 		ThreadTools::setCurrentThreadName(m_name.empty() ? "DSP" : "DSP " + m_name);
+		Logging::rt::registerThread();
 
 		uint64_t instructions = 0;
 		uint64_t cycles = 0;
@@ -107,11 +118,15 @@ namespace dsp56k
 		auto t = Clock::now();
 		const auto tStart = t;
 
+		AudioPacing pacing;
+		uint32_t pacingVersion = 0;
+
 #ifdef _DEBUG
 		constexpr size_t ipsStep = 0x0400000;
 #else
 		constexpr size_t ipsStep = 0x2000000;
 #endif
+		constexpr size_t metricsStep = 0x800;
 		while(m_runThread)
 		{
 			{
@@ -148,11 +163,28 @@ namespace dsp56k
 
 				m_callback(static_cast<uint32_t>(di));
 
+				if((counter & (metricsStep-1)) == 0)
+				{
+					m_dsp.updateMetrics();
+					m_dsp.getMetrics().set(DspMetrics::Metric::ThreadRunNs, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - tStart).count()));
+				}
+
 #if DSP56300_DEBUGGER
 				m_dsp.setDebugger(m_nextDebugger);
 #endif
+				if(pacingVersion != m_pacingVersion)
+				{
+					pacingVersion = m_pacingVersion;
+					pacing = m_pacing;
+
+					if(pacing.audio)
+						ThreadTools::setCurrentThreadRealtimeParameters(static_cast<int>(pacing.samplerate), static_cast<int>(pacing.blocksize));
+				}
 			}
 
+			if(pacing.audio)
+				pace(pacing);
+
 			if((counter & (ipsStep-1)) == 0)
 			{
 				const auto t2 = Clock::now();
@@ -189,4 +221,27 @@ namespace dsp56k
 
 		m_runThread = true;
 	}
+
+	void DSPThread::pace(const AudioPacing& _pacing)
+	{
+		const auto available = _pacing.audio->getAudioOutputs().size();
+
+		if(available < _pacing.leadFrames || !_pacing.samplerate)
+			return;
+
+		// The host consumes a whole block at once and wakes us up afterwards. The timeout is a fallback for hosts that read the
+		// ring buffer directly instead of calling processAudioOutput
+		const auto timeoutUs = static_cast<int64_t>(std::max<uint32_t>(_pacing.blocksize, 1)) * 4 * 1000000 / _pacing.samplerate;
+
+		const auto& outputs = _pacing.audio->getAudioOutputs();
+
+		const auto t = std::chrono::steady_clock::now();
+
+		if(!_pacing.audio->getOutputPacer().pace([&] { return outputs.size(); }, _pacing.leadFrames, std::chrono::microseconds(timeoutUs)))
+			return;
+
+		++m_pacingSleepCount;
+
+		m_dsp.getMetrics().add(DspMetrics::Metric::ThreadPacingSleepNs, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t).count()));
+	}
 }
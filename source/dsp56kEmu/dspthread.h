@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <functional>
 #include <mutex>
 #include <memory>
@@ -10,6 +11,7 @@
 
 namespace dsp56k
 {
+	class Audio;
 	class DSP;
 
 	class DSPThread final
@@ -18,6 +20,14 @@ namespace dsp56k
 		using Guard = std::lock_guard<std::mutex>;
 		using Callback = std::function<void(uint32_t)>;
 
+		struct AudioPacing
+		{
+			const Audio* audio = nullptr;	// audio whose output fill level is used to pace the DSP, free-running if null
+			uint32_t samplerate = 44100;	// host audio rate
+			uint32_t blocksize = 64;		// host audio block size in frames
+			uint32_t leadFrames = 256;		// number of frames the DSP is allowed to run ahead of the host
+		};
+
 		explicit DSPThread(DSP& _dsp, const char* _name = nullptr, std::shared_ptr<DebuggerInterface> _debugger = {});
 		~DSPThread();
 		void join();
@@ -27,6 +37,11 @@ namespace dsp56k
 
 		void setCallback(const Callback& _callback);
 
+		// Instead of running until the audio output ring buffer is full and then blocking on it, the DSP thread waits
+		// as soon as it is the given number of frames ahead of the host and continues once the host has read audio
+		void setAudioPacing(const AudioPacing& _pacing);
+		uint64_t getPacingSleepCount() const { return m_pacingSleepCount; }
+
 		void setLogToDebug(const bool _log) { m_logToDebug = _log; }
 		void setLogToStdout(const bool _log) { m_logToStdout = _log; }
 
@@ -43,6 +58,7 @@ namespace dsp56k
 
 	private:
 		void threadFunc();
+		void pace(const AudioPacing& _pacing);
 
 		DSP& m_dsp;
 		const std::string m_name;
@@ -54,6 +70,10 @@ namespace dsp56k
 
 		Callback m_callback;
 
+		AudioPacing m_pacing;
+		uint32_t m_pacingVersion = 0;
+		std::atomic<uint64_t> m_pacingSleepCount{0};
+
 		std::recursive_mutex m_debuggerMutex;
 		DebuggerInterface* m_nextDebugger = nullptr;
 
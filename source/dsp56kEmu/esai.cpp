@@ -60,6 +60,56 @@ namespace dsp56k
 		*/
 	}
 
+	void Esai::saveState(StateWriter& _w) const
+	{
+		_w.write<uint32_t>(m_sr);
+		_w.write(m_cr);
+		_w.write<uint32_t>(m_tcr);
+		_w.write<uint32_t>(m_rcr);
+		_w.write(m_rccr);
+		_w.write(m_tccr);
+		_w.write(m_tx);
+		_w.write(m_rx);
+		saveFrame(_w, m_txFrame);
+		saveFrame(_w, m_rxFrame);
+		_w.write(m_writtenTX);
+		_w.write(m_readRX);
+		_w.write(m_txSlotCounter);
+		_w.write(m_txFrameCounter);
+		_w.write(m_rxSlotCounter);
+		_w.write(m_rxFrameCounter);
+		_w.write(m_tsma);
+		_w.write(m_tsmb);
+		_w.write(m_rsma);
+		_w.write(m_rsmb);
+		_w.write(m_vbaRead);
+	}
+
+	void Esai::loadState(StateReader& _r)
+	{
+		_r.read(m_sr.value());
+		_r.read(m_cr);
+		_r.read(m_tcr.value());
+		_r.read(m_rcr.value());
+		_r.read(m_rccr);
+		_r.read(m_tccr);
+		_r.read(m_tx);
+		_r.read(m_rx);
+		loadFrame(_r, m_txFrame);
+		loadFrame(_r, m_rxFrame);
+		_r.read(m_writtenTX);
+		_r.read(m_readRX);
+		_r.read(m_txSlotCounter);
+		_r.read(m_txFrameCounter);
+		_r.read(m_rxSlotCounter);
+		_r.read(m_rxFrameCounter);
+		_r.read(m_tsma);
+		_r.read(m_tsmb);
+		_r.read(m_rsma);
+		_r.read(m_rsmb);
+		_r.read(m_vbaRead);
+	}
+
 	void Esai::setDSP(DSP* _dsp)
 	{
 		m_vbaRead = _dsp->registerInterruptFunc([this]
@@ -331,7 +381,10 @@ namespace dsp56k
 			return;
 
 		if(m_readRX)
+		{
 			m_sr.set(M_ROE);
+			++m_rxOverruns;
+		}
 
 		if (m_rxSlotCounter == 0)
 			readRXimpl(m_rxFrame);
@@ -359,8 +412,9 @@ namespace dsp56k
 
 		if((m_writtenTX & tem) != tem)
 		{
-			LOG("ESAI transmit underrun, written is " << HEX(m_writtenTX) << ", enabled is " << HEX(tem));
+			LOGRTL(WARNING, "ESAI transmit underrun, written is %06x, enabled is %06x", m_writtenTX, tem);
 			m_sr.set(M_TUE);
+			++m_txUnderruns;
 		}
 
 		m_sr.set(M_TDE);
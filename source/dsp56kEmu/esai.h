@@ -3,6 +3,7 @@
 #pragma once
 
 #include "esxi.h"
+#include "periphaccess.h"
 #include "dsp56kBase/logging.h"
 #include "dsp56kBase/bitfield.h"
 
@@ -268,6 +269,9 @@ namespace dsp56k
 		void reset();
 		void setDSP(DSP* _dsp);
 
+		void saveState(StateWriter& _w) const;
+		void loadState(StateReader& _r);
+
 		void execTX() override;
 		void execRX() override;
 
@@ -329,6 +333,16 @@ namespace dsp56k
 		void writeTX(uint32_t _index, TWord _val);
 		TWord readRX(uint32_t _index);
 
+		PeriphAccess getTXAccess(const uint32_t _index)
+		{
+			return PeriphAccess::slot(m_tx[_index], m_writtenTX, 1 << _index, m_tcr, M_TEM);
+		}
+
+		PeriphAccess getRXAccess(const uint32_t _index)
+		{
+			return PeriphAccess::slot(m_rx[_index], m_readRX, 1 << _index, m_rcr, 1 << _index);
+		}
+
 		TWord readTSMA() const
 		{
 			return m_tsma;
@@ -359,6 +373,10 @@ namespace dsp56k
 		EMemArea getMemArea() const { return m_area; }
 
 		uint32_t getTxFrameCounter() const { return m_txFrameCounter; }
+		uint32_t getRxFrameCounter() const { return m_rxFrameCounter; }
+
+		uint64_t getTxUnderruns() const { return m_txUnderruns; }
+		uint64_t getRxOverruns() const { return m_rxOverruns; }
 
 		uint32_t getTxWordCount() const
 		{
@@ -456,6 +474,8 @@ namespace dsp56k
 		uint32_t m_txFrameCounter = 0;
 		uint32_t m_rxSlotCounter = 0;
 		uint32_t m_rxFrameCounter = 0;
+		uint64_t m_txUnderruns = 0;
+		uint64_t m_rxOverruns = 0;
 
 		TWord m_tsma = 0xffff;
 		TWord m_tsmb = 0xffff;
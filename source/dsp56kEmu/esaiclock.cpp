@@ -6,6 +6,7 @@
 #include "dsp56kBase/logging.h"
 
 #include "peripherals.h"
+#include "statestream.h"
 
 namespace dsp56k
 {
@@ -136,6 +137,41 @@ namespace dsp56k
 		return std::min(static_cast<uint32_t>(diff), periphCycles - offset);
 	}
 
+	void EsxiClock::saveState(StateWriter& _w) const
+	{
+		_w.write(m_pctl);
+		_w.write(m_lastClock);
+		_w.write(static_cast<uint32_t>(m_esais.size()));
+
+		for (const auto& e : m_esais)
+		{
+			_w.write(e.tx.divider);
+			_w.write(e.tx.counter);
+			_w.write(e.rx.divider);
+			_w.write(e.rx.counter);
+		}
+	}
+
+	void EsxiClock::loadState(StateReader& _r)
+	{
+		setPCTL(_r.read<TWord>());
+		_r.read(m_lastClock);
+
+		if(_r.read<uint32_t>() != m_esais.size())
+		{
+			_r.fail();
+			return;
+		}
+
+		for (auto& e : m_esais)
+		{
+			_r.read(e.tx.divider);
+			_r.read(e.tx.counter);
+			_r.read(e.rx.divider);
+			_r.read(e.rx.counter);
+		}
+	}
+
 	void EsxiClock::setClockSource(const DSP* _dsp, const ClockSource _clockSource)
 	{
 		switch (_clockSource)
@@ -11,6 +11,8 @@ namespace dsp56k
 	class Esxi;
 	class IPeripherals;
 	class DSP;
+	class StateReader;
+	class StateWriter;
 
 	class EsxiClock
 	{
@@ -56,6 +58,10 @@ namespace dsp56k
 
 		TWord getRemainingInstructionsForFrameSync() const;
 
+		// the clock configuration of the host (samplerate, speed, external clock) is not part of the state
+		void saveState(StateWriter& _w) const;
+		void loadState(StateReader& _r);
+
 	protected:
 		auto getDspInstructionCounter() const { return *m_dspInstructionCounter; }
 		auto getLastClock() const { return m_lastClock; }
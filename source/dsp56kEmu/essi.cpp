@@ -30,6 +30,52 @@ namespace dsp56k
 		I/O signals is programmed as an ESSI signal. */
 	}
 
+	void Essi::saveState(StateWriter& _w) const
+	{
+		_w.write(m_tx);
+		_w.write(m_tsr);
+		_w.write(m_rx);
+		_w.write<uint32_t>(m_sr);
+		_w.write<uint32_t>(m_cra);
+		_w.write<uint32_t>(m_crb);
+		_w.write(m_tsma);
+		_w.write(m_tsmb);
+		_w.write(m_rsma);
+		_w.write(m_rsmb);
+		_w.write(m_vbaRead);
+		_w.write(m_rxSlotCounter);
+		_w.write(m_rxFrameCounter);
+		_w.write(m_txSlotCounter);
+		_w.write(m_txFrameCounter);
+		_w.write(m_readRX);
+		_w.write(m_writtenTX);
+		saveFrame(_w, m_txFrame);
+		saveFrame(_w, m_rxFrame);
+	}
+
+	void Essi::loadState(StateReader& _r)
+	{
+		_r.read(m_tx);
+		_r.read(m_tsr);
+		_r.read(m_rx);
+		_r.read(m_sr.value());
+		_r.read(m_cra.value());
+		_r.read(m_crb.value());
+		_r.read(m_tsma);
+		_r.read(m_tsmb);
+		_r.read(m_rsma);
+		_r.read(m_rsmb);
+		_r.read(m_vbaRead);
+		_r.read(m_rxSlotCounter);
+		_r.read(m_rxFrameCounter);
+		_r.read(m_txSlotCounter);
+		_r.read(m_txFrameCounter);
+		_r.read(m_readRX);
+		_r.read(m_writtenTX);
+		loadFrame(_r, m_txFrame);
+		loadFrame(_r, m_rxFrame);
+	}
+
 	void Essi::execTX()
 	{
 		const auto tem = m_crb.testMask(RegCRBbits::CRB_TE);
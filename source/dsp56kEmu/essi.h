@@ -3,6 +3,7 @@
 #pragma once
 
 #include "esxi.h"
+#include "periphaccess.h"
 #include "types.h"
 
 #include <string>
@@ -165,6 +166,9 @@ namespace dsp56k
 
 		void reset();
 
+		void saveState(StateWriter& _w) const;
+		void loadState(StateReader& _r);
+
 		void execTX() override;
 		void execRX() override;
 
@@ -190,6 +194,11 @@ namespace dsp56k
 		TWord readRSMB();
 
 		void writeTX(uint32_t _index, TWord _val);
+
+		PeriphAccess getTXAccess(const uint32_t _index)
+		{
+			return PeriphAccess::slot(m_tx[_index], m_writtenTX, 1 << (RegCRBbits::CRB_TE0 - _index), m_crb, RegCRBbits::CRB_TE);
+		}
 		void writeTSR(TWord _val);
 		void writeRX(TWord _val);
 		void writeSR(TWord _val);
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "audio.h"
+#include "statestream.h"
 
 namespace dsp56k
 {
@@ -14,5 +15,27 @@ namespace dsp56k
 
 		virtual TWord hasEnabledTransmitters() const = 0;
 		virtual TWord hasEnabledReceivers() const = 0;
+
+	protected:
+		// frames that are currently assembled by the DSP are part of the peripheral state, queued audio data is not
+		template<typename TFrame> static void saveFrame(StateWriter& _w, const TFrame& _frame)
+		{
+			_w.write(_frame.size());
+			for(uint32_t i=0; i<_frame.size(); ++i)
+				_w.write(_frame[i]);
+		}
+
+		template<typename TFrame> static void loadFrame(StateReader& _r, TFrame& _frame)
+		{
+			const auto size = _r.read<uint32_t>();
+			if(size > MaxSlotsPerFrame)
+			{
+				_r.fail();
+				return;
+			}
+			_frame.resize(size);
+			for(uint32_t i=0; i<size; ++i)
+				_r.read(_frame[i]);
+		}
 	};
 }
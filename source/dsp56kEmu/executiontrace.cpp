@@ -0,0 +1,400 @@
+#include "executiontrace.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <unordered_set>
+
+#include "disasm.h"
+#include "dsp.h"
+#include "memory.h"
+
+#include "dsp56kBase/logging.h"
+
+namespace dsp56k
+{
+	namespace
+	{
+		struct FileHeader
+		{
+			char magic[4] = {'D', 'S', 'P', 'T'};
+			uint32_t version = ExecutionTrace::FileVersion;
+			uint32_t entrySize = sizeof(ExecutionTrace::Entry);
+			uint32_t entryCount = 0;
+			uint32_t codeCount = 0;
+			uint32_t reserved = 0;
+		};
+
+		// followed by wordCount P memory words
+		struct CodeHeader
+		{
+			uint64_t firstEntry;
+			TWord pc;
+			uint32_t wordCount;
+		};
+
+		// the code for every block address, ordered by first entry
+		using CodeByAddress = std::map<TWord, std::vector<const ExecutionTrace::BlockCode*>>;
+
+		CodeByAddress sortByAddress(const std::vector<ExecutionTrace::BlockCode>& _code)
+		{
+			CodeByAddress res;
+			for (const auto& c : _code)
+				res[c.pc].push_back(&c);
+			for (auto& [pc, codes] : res)
+			{
+				std::stable_sort(codes.begin(), codes.end(), [](const ExecutionTrace::BlockCode* _a, const ExecutionTrace::BlockCode* _b)
+				{
+					return _a->firstEntry < _b->firstEntry;
+				});
+			}
+			return res;
+		}
+
+		const ExecutionTrace::BlockCode* findCode(const CodeByAddress& _code, const TWord _pc, const uint64_t _entryIndex)
+		{
+			const auto it = _code.find(_pc);
+			if(it == _code.end())
+				return nullptr;
+
+			const auto& codes = it->second;
+
+			const auto itCode = std::upper_bound(codes.begin(), codes.end(), _entryIndex, [](const uint64_t _index, const ExecutionTrace::BlockCode* _c)
+			{
+				return _index < _c->firstEntry;
+			});
+
+			return itCode != codes.begin() ? *(itCode - 1) : nullptr;
+		}
+
+		void readCode(const Memory& _memory, ExecutionTrace::BlockCode& _code, const TWord _pc, const TWord _length)
+		{
+			_code.pc = _pc;
+			_code.words.clear();
+
+			for(TWord i=0; i<=_length && _pc + i < _memory.sizeP(); ++i)
+				_code.words.push_back(_memory.get(MemArea_P, _pc + i));
+		}
+
+		size_t nextPowerOfTwo(const size_t _value)
+		{
+			size_t res = 1;
+			while(res < _value)
+				res <<= 1;
+			return res;
+		}
+	}
+
+	ExecutionTrace::ExecutionTrace(const size_t _capacity, const bool _captureRegisters) : m_captureRegisters(_captureRegisters)
+	{
+		m_entries.resize(nextPowerOfTwo(std::max<size_t>(_capacity, 16)));
+		m_mask = m_entries.size() - 1;
+		m_blockCodeLimit = m_entries.size();
+	}
+
+	void ExecutionTrace::addBlock(const TWord _pc, const TWord _length, const uint64_t _instructions, const uint64_t _cycles)
+	{
+		Entry e;
+		e.type = EntryType::Block;
+		e.length = static_cast<uint16_t>(std::min<TWord>(_length, 0xffff));
+		e.pc = _pc;
+		e.instructions = _instructions;
+		e.value = _cycles;
+		push(e);
+	}
+
+	void ExecutionTrace::addBlockCode(const Memory& _memory, const TWord _pc, const TWord _length)
+	{
+		const auto pos = m_writePos.load(std::memory_order_relaxed);
+		const auto size = static_cast<uint64_t>(m_entries.size());
+
+		BlockCode code;
+		code.firstEntry = pos;
+		readCode(_memory, code, _pc, _length);
+
+		std::lock_guard lock(m_blockCodeMutex);
+
+		m_blockCode.push_back(std::move(code));
+
+		if(m_blockCode.size() <= m_blockCodeLimit)
+			return;
+
+		// drop the code that no entry in the ring refers to anymore: code that has been replaced before the oldest entry
+		const auto oldest = pos > size ? pos - size : 0;
+
+		std::unordered_set<TWord> replaced;
+
+		for(auto i = m_blockCode.size(); i > 0; --i)
+		{
+			auto& c = m_blockCode[i-1];
+
+			if(replaced.find(c.pc) != replaced.end())
+				c.words.clear();
+			else if(c.firstEntry <= oldest)
+				replaced.insert(c.pc);
+		}
+
+		m_blockCode.erase(std::remove_if(m_blockCode.begin(), m_blockCode.end(), [](const BlockCode& _c)
+		{
+			return _c.words.empty();
+		}), m_blockCode.end());
+
+		// do not scan again for every block if most of the code is still referenced
+		m_blockCodeLimit = std::max(m_entries.size(), m_blockCode.size() * 2);
+	}
+
+	std::vector<ExecutionTrace::Entry> ExecutionTrace::getEntries() const
+	{
+		uint64_t firstPos;
+		return getEntries(firstPos);
+	}
+
+	std::vector<ExecutionTrace::Entry> ExecutionTrace::getEntries(uint64_t& _firstPos) const
+	{
+		const auto end = m_writePos.load(std::memory_order_acquire);
+		const auto count = std::min<uint64_t>(end, m_entries.size());
+
+		std::vector<Entry> res;
+		res.reserve(static_cast<size_t>(count));
+
+		for(auto i = end - count; i < end; ++i)
+			res.push_back(m_entries[i & m_mask]);
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+
+		// The writer may have continued while we were copying. Position p is stored into the slot of entry p - size, the slot of the entry
+		// at endAfter may be written right now without being published yet. Drop all entries whose slot may have been touched
+		const auto endAfter = m_writePos.load(std::memory_order_relaxed);
+		const auto firstValid = endAfter + 1 > m_entries.size() ? endAfter + 1 - m_entries.size() : 0;
+		const auto first = end - count;
+		const auto overwritten = firstValid > first ? std::min<uint64_t>(firstValid - first, res.size()) : 0;
+		res.erase(res.begin(), res.begin() + static_cast<ptrdiff_t>(overwritten));
+
+		_firstPos = first + overwritten;
+
+		return res;
+	}
+
+	void ExecutionTrace::clear()
+	{
+		m_writePos.store(0, std::memory_order_release);
+		m_prevRegs.fill(0);
+		m_pendingRegs = AllRegisters;
+
+		// compiled blocks are not compiled again, their latest code remains valid for all entries that follow
+		std::lock_guard lock(m_blockCodeMutex);
+
+		std::unordered_set<TWord> latest;
+
+		for(auto i = m_blockCode.size(); i > 0; --i)
+		{
+			auto& c = m_blockCode[i-1];
+
+			if(latest.insert(c.pc).second)
+				c.firstEntry = 0;
+			else
+				c.words.clear();
+		}
+
+		m_blockCode.erase(std::remove_if(m_blockCode.begin(), m_blockCode.end(), [](const BlockCode& _c)
+		{
+			return _c.words.empty();
+		}), m_blockCode.end());
+	}
+
+	bool ExecutionTrace::writeToFile(const std::string& _filename, const Memory& _memory) const
+	{
+		uint64_t firstPos;
+		const auto entries = getEntries(firstPos);
+
+		std::vector<BlockCode> allCode;
+		{
+			std::lock_guard lock(m_blockCodeMutex);
+			allCode = m_blockCode;
+		}
+
+		const auto codeByAddress = sortByAddress(allCode);
+
+		// store the code of all traced blocks so that the decoder is able to disassemble them. Entry indices are stored relative to the first entry
+		std::vector<BlockCode> code;
+		std::unordered_set<const BlockCode*> written;
+		std::unordered_set<TWord> readFromMemory;
+
+		for(size_t i=0; i<entries.size(); ++i)
+		{
+			const auto& e = entries[i];
+
+			if(e.type != EntryType::Block)
+				continue;
+
+			if(const auto* c = findCode(codeByAddress, e.pc, firstPos + i))
+			{
+				if(!written.insert(c).second)
+					continue;
+
+				code.push_back(*c);
+				code.back().firstEntry = c->firstEntry > firstPos ? c->firstEntry - firstPos : 0;
+			}
+			else if(readFromMemory.insert(e.pc).second)
+			{
+				// the block has not been registered, P memory may have been changed since it has been executed
+				BlockCode c;
+				readCode(_memory, c, e.pc, e.length);
+				code.push_back(std::move(c));
+			}
+		}
+
+		std::ofstream file(_filename, std::ios::out | std::ios::binary);
+
+		if(!file.is_open())
+		{
+			LOGL(ERROR, "Failed to create execution trace file " << _filename);
+			return false;
+		}
+
+		FileHeader header;
+		header.entryCount = static_cast<uint32_t>(entries.size());
+		header.codeCount = static_cast<uint32_t>(code.size());
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+		if(!entries.empty())
+			file.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(Entry)));
+
+		for (const auto& c : code)
+		{
+			const CodeHeader h{c.firstEntry, c.pc, static_cast<uint32_t>(c.words.size())};
+			file.write(reinterpret_cast<const char*>(&h), sizeof(h));
+			file.write(reinterpret_cast<const char*>(c.words.data()), static_cast<std::streamsize>(c.words.size() * sizeof(TWord)));
+		}
+
+		return file.good();
+	}
+
+	bool ExecutionTrace::readFromFile(const std::string& _filename, std::vector<Entry>& _entries, std::vector<BlockCode>& _code)
+	{
+		std::ifstream file(_filename, std::ios::in | std::ios::binary);
+
+		if(!file.is_open())
+			return false;
+
+		FileHeader header;
+		const FileHeader expected;
+
+		file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+		if(!file.good() || std::equal(std::begin(header.magic), std::end(header.magic), std::begin(expected.magic)) == false)
+		{
+			LOGL(ERROR, "File " << _filename << " is not an execution trace");
+			return false;
+		}
+
+		if(header.version != FileVersion || header.entrySize != sizeof(Entry))
+		{
+			LOGL(ERROR, "Unsupported execution trace version " << header.version << ", entry size " << header.entrySize);
+			return false;
+		}
+
+		_entries.resize(header.entryCount);
+
+		if(header.entryCount)
+			file.read(reinterpret_cast<char*>(_entries.data()), static_cast<std::streamsize>(_entries.size() * sizeof(Entry)));
+
+		_code.clear();
+
+		for(uint32_t i=0; i<header.codeCount && file.good(); ++i)
+		{
+			CodeHeader h{};
+			file.read(reinterpret_cast<char*>(&h), sizeof(h));
+
+			// a block cannot be larger than the maximum block length plus the extra word
+			if(!file.good() || h.wordCount > 0x10000)
+				return false;
+
+			BlockCode c;
+			c.firstEntry = h.firstEntry;
+			c.pc = h.pc;
+			c.words.resize(h.wordCount);
+			file.read(reinterpret_cast<char*>(c.words.data()), static_cast<std::streamsize>(c.words.size() * sizeof(TWord)));
+
+			_code.push_back(std::move(c));
+		}
+
+		return file.good();
+	}
+
+	void ExecutionTrace::addRegisterDeltas(const DSP& _dsp, const TWord _pc, const RegisterMask _writtenRegs)
+	{
+		const auto pending = m_pendingRegs;
+		m_pendingRegs = _writtenRegs;
+
+		for (const auto& r : RegistersToCapture)
+		{
+			if(!any(pending, r.mask))
+				continue;
+
+			const auto reg = r.reg;
+
+			int64_t v;
+			if(!_dsp.readRegToInt(reg, v) || v == m_prevRegs[reg])
+				continue;
+
+			m_prevRegs[reg] = v;
+
+			Entry e;
+			e.type = EntryType::Register;
+			e.reg = static_cast<uint8_t>(reg);
+			e.pc = _pc;
+			e.instructions = _dsp.getInstructionCounter();
+			e.value = static_cast<uint64_t>(v);
+			push(e);
+		}
+	}
+
+	void ExecutionTrace::decode(std::ostream& _out, const std::vector<Entry>& _entries, const std::vector<BlockCode>& _code, Disassembler* _disasm, const size_t _first)
+	{
+		const auto codeByAddress = sortByAddress(_code);
+
+		std::string assembly;
+
+		for(size_t i=_first; i<_entries.size(); ++i)
+		{
+			const auto& e = _entries[i];
+
+			switch (e.type)
+			{
+			case EntryType::Block:
+				_out << std::dec << std::setfill(' ') << std::setw(12) << e.instructions << ' ' << std::setw(12) << e.value << " P:" << HEXN(e.pc, 6) << " (" << std::dec << e.length << " words)" << std::endl;
+
+				if(_disasm)
+				{
+					const auto* code = findCode(codeByAddress, e.pc, i);
+
+					auto getPWord = [&](const TWord _addr)
+					{
+						const auto offset = _addr - e.pc;
+						return code && offset < code->words.size() ? code->words[offset] : 0;
+					};
+
+					TWord pc = e.pc;
+					const TWord pcEnd = e.pc + e.length;
+
+					while(pc < pcEnd)
+					{
+						const auto len = _disasm->disassemble(assembly, getPWord(pc), getPWord(pc + 1), 0, 0, pc);
+
+						_out << "    P:" << HEXN(pc, 6) << ' ' << assembly << std::endl;
+
+						pc += len ? len : 1;
+					}
+				}
+				break;
+			case EntryType::Register:
+				if(e.reg < Reg_COUNT)
+					_out << "    " << g_regNames[e.reg] << " = " << HEX(e.value) << std::endl;
+				break;
+			}
+		}
+	}
+}
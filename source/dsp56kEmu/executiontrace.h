@@ -0,0 +1,143 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "opcodeanalysis.h"
+#include "registers.h"
+#include "types.h"
+
+namespace dsp56k
+{
+	class DSP;
+	class Disassembler;
+	class Memory;
+
+	// Low overhead binary execution trace. The DSP thread appends entries without locking, the oldest entries are overwritten
+	// once the buffer is full. Use writeToFile() to save it for the offline decoder (dsp56kTraceDecoder)
+	class ExecutionTrace
+	{
+	public:
+		static constexpr uint32_t FileVersion = 2;
+
+		enum class EntryType : uint8_t
+		{
+			Block,			// execution of a JIT block has started
+			Register		// a register has changed since the previous block entry
+		};
+
+		struct Entry
+		{
+			EntryType type = EntryType::Block;
+			uint8_t reg = 0;				// Register: EReg
+			uint16_t length = 0;			// Block: size in P memory words
+			TWord pc = 0;
+			uint64_t instructions = 0;		// DSP instruction counter
+			uint64_t value = 0;				// Block: DSP cycle counter, Register: new register value
+		};
+
+		static_assert(sizeof(Entry) == 24, "trace entries are written to files as-is, keep them compact");
+		static_assert(offsetof(Entry, pc) == 4 && offsetof(Entry, instructions) == 8 && offsetof(Entry, value) == 16, "JIT code writes block entries directly");
+
+		// P memory words of a block as they were when the block has been compiled, plus one word to be able to disassemble a two-word
+		// instruction at the end of the block. Block entries use the last code of their address whose first entry is not above their own index
+		struct BlockCode
+		{
+			uint64_t firstEntry = 0;
+			TWord pc = 0;
+			std::vector<TWord> words;
+		};
+
+		explicit ExecutionTrace(size_t _capacity = 65536, bool _captureRegisters = false);
+
+		// JIT blocks append their block entry inline, see JitBlock::traceExecution(). This is the equivalent for all other callers
+		void addBlock(TWord _pc, TWord _length, uint64_t _instructions, uint64_t _cycles);
+
+		// to be called when a block is compiled, before it is executed the first time. Self-modifying code causes blocks to be recompiled,
+		// storing their code at compile time makes sure that entries are decoded with the code that has actually been executed
+		void addBlockCode(const Memory& _memory, TWord _pc, TWord _length);
+
+		// records the registers that changed since the previous call. Only the registers in the written mask of the previous call are compared,
+		// _writtenRegs are the registers that the block at _pc may modify
+		void addRegisterDeltas(const DSP& _dsp, TWord _pc, RegisterMask _writtenRegs);
+
+		// returns all valid entries, oldest first. May be called from any thread
+		std::vector<Entry> getEntries() const;
+
+		void clear();
+
+		bool captureRegisters() const { return m_captureRegisters; }
+		size_t capacity() const { return m_entries.size(); }
+
+		// the code of blocks that have not been registered via addBlockCode() is read from _memory
+		bool writeToFile(const std::string& _filename, const Memory& _memory) const;
+		static bool readFromFile(const std::string& _filename, std::vector<Entry>& _entries, std::vector<BlockCode>& _code);
+
+		// writes the entries as text, one line per entry. Blocks are disassembled if a disassembler is given
+		static void decode(std::ostream& _out, const std::vector<Entry>& _entries, const std::vector<BlockCode>& _code, Disassembler* _disasm, size_t _first = 0);
+
+		// the first four bytes of a block entry: type, reg, length
+		static constexpr uint32_t blockHeader(const TWord _length)
+		{
+			return static_cast<uint32_t>(EntryType::Block) | (static_cast<uint32_t>(_length < 0xffff ? _length : 0xffff) << 16);
+		}
+
+		// accessed by JIT code. The DSP thread is the only writer
+		Entry* getEntryStorage() { return m_entries.data(); }
+		uint64_t& getWritePosStorage()
+		{
+			static_assert(sizeof(m_writePos) == sizeof(uint64_t) && std::atomic<uint64_t>::is_always_lock_free);
+			return *reinterpret_cast<uint64_t*>(&m_writePos);
+		}
+		size_t getMask() const { return m_mask; }
+
+	private:
+		struct CapturedRegister
+		{
+			EReg reg;
+			RegisterMask mask;
+		};
+
+		// SR, SP, LA and LC are always compared, they are modified implicitly by interrupts, loops and the system stack
+		static constexpr auto AllRegisters = static_cast<RegisterMask>(~0ull);
+
+		static constexpr std::array<CapturedRegister, 33> RegistersToCapture =
+		{{
+			{Reg_X, RegisterMask::X}, {Reg_Y, RegisterMask::Y}, {Reg_A, RegisterMask::A}, {Reg_B, RegisterMask::B},
+			{Reg_SR, AllRegisters}, {Reg_OMR, RegisterMask::OMR}, {Reg_LA, AllRegisters}, {Reg_LC, AllRegisters}, {Reg_SP, AllRegisters},
+			{Reg_R0, RegisterMask::R0}, {Reg_R1, RegisterMask::R1}, {Reg_R2, RegisterMask::R2}, {Reg_R3, RegisterMask::R3},
+			{Reg_R4, RegisterMask::R4}, {Reg_R5, RegisterMask::R5}, {Reg_R6, RegisterMask::R6}, {Reg_R7, RegisterMask::R7},
+			{Reg_N0, RegisterMask::N0}, {Reg_N1, RegisterMask::N1}, {Reg_N2, RegisterMask::N2}, {Reg_N3, RegisterMask::N3},
+			{Reg_N4, RegisterMask::N4}, {Reg_N5, RegisterMask::N5}, {Reg_N6, RegisterMask::N6}, {Reg_N7, RegisterMask::N7},
+			{Reg_M0, RegisterMask::M0}, {Reg_M1, RegisterMask::M1}, {Reg_M2, RegisterMask::M2}, {Reg_M3, RegisterMask::M3},
+			{Reg_M4, RegisterMask::M4}, {Reg_M5, RegisterMask::M5}, {Reg_M6, RegisterMask::M6}, {Reg_M7, RegisterMask::M7}
+		}};
+
+		std::vector<Entry> getEntries(uint64_t& _firstPos) const;
+
+		void push(const Entry& _entry)
+		{
+			const auto pos = m_writePos.load(std::memory_order_relaxed);
+			m_entries[pos & m_mask] = _entry;
+			m_writePos.store(pos + 1, std::memory_order_release);
+		}
+
+		std::vector<Entry> m_entries;
+		size_t m_mask = 0;
+		std::atomic<uint64_t> m_writePos{0};
+
+		const bool m_captureRegisters;
+		std::array<int64_t, Reg_COUNT> m_prevRegs{};
+		RegisterMask m_pendingRegs = AllRegisters;		// registers that may have changed since the last call to addRegisterDeltas()
+
+		mutable std::mutex m_blockCodeMutex;
+		std::vector<BlockCode> m_blockCode;				// ordered by first entry
+		size_t m_blockCodeLimit = 0;					// unreferenced code is removed once the number of blocks exceeds this limit
+	};
+}
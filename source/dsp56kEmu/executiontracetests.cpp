@@ -0,0 +1,335 @@
+#include "executiontracetests.h"
+
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include "disasm.h"
+#include "executiontrace.h"
+#include "unittests.h"
+
+namespace dsp56k
+{
+	namespace
+	{
+		// all fields are derived from the index to be able to detect entries that have been read while being written
+		void addTestBlock(ExecutionTrace& _trace, const uint64_t _index)
+		{
+			_trace.addBlock(static_cast<TWord>(_index & 0xffffff), static_cast<TWord>(_index & 0xff), _index, _index * 3);
+		}
+
+		bool isTestBlock(const ExecutionTrace::Entry& _e, const uint64_t _index)
+		{
+			return _e.type == ExecutionTrace::EntryType::Block && _e.pc == (_index & 0xffffff) && _e.length == (_index & 0xff) && _e.instructions == _index && _e.value == _index * 3;
+		}
+
+		std::string getTempFile(const char* _name)
+		{
+			return (std::filesystem::temp_directory_path() / _name).string();
+		}
+	}
+
+	ExecutionTraceTests::ExecutionTraceTests() : m_mem(m_memValidator, 0x1000)
+	{
+		LOG("Running Execution Trace Tests...");
+
+		testRing();
+		testConcurrentRead();
+		testFileRoundTrip();
+		testFileValidation();
+		testDecode();
+		testDecodeModifiedCode();
+
+		LOG("Execution Trace Tests finished.");
+	}
+
+	void ExecutionTraceTests::testRing()
+	{
+		ExecutionTrace trace(16);
+
+		verify(trace.capacity() == 16);
+		verify(trace.getEntries().empty());
+
+		for(uint64_t i=0; i<10; ++i)
+			addTestBlock(trace, i);
+
+		auto entries = trace.getEntries();
+		verify(entries.size() == 10);
+		for(uint64_t i=0; i<10; ++i)
+			verify(isTestBlock(entries[i], i));
+
+		// once the ring is full, the oldest slot is the one that is written next and is not returned
+		for(uint64_t i=10; i<30; ++i)
+			addTestBlock(trace, i);
+
+		entries = trace.getEntries();
+		verify(entries.size() == 15);
+		for(uint64_t i=0; i<entries.size(); ++i)
+			verify(isTestBlock(entries[i], i + 15));
+
+		trace.clear();
+		verify(trace.getEntries().empty());
+
+		addTestBlock(trace, 42);
+		entries = trace.getEntries();
+		verify(entries.size() == 1 && isTestBlock(entries[0], 42));
+
+		// the capacity is rounded up to a power of two
+		verify(ExecutionTrace(100).capacity() == 128);
+	}
+
+	void ExecutionTraceTests::testConcurrentRead()
+	{
+		ExecutionTrace trace(256);
+
+		constexpr uint64_t Count = 2000000;
+
+		std::atomic<bool> done{false};
+
+		std::thread writer([&]()
+		{
+			for(uint64_t i=0; i<Count; ++i)
+				addTestBlock(trace, i);
+			done = true;
+		});
+
+		bool valid = true;
+		uint64_t reads = 0;
+
+		while(!done || reads == 0)
+		{
+			const auto entries = trace.getEntries();
+
+			for(size_t i=0; i<entries.size(); ++i)
+			{
+				// entries are consecutive and none of them is torn
+				if(!isTestBlock(entries[i], entries.front().instructions + i))
+					valid = false;
+			}
+
+			++reads;
+		}
+
+		writer.join();
+
+		verify(valid);
+
+		const auto entries = trace.getEntries();
+		verify(entries.size() == trace.capacity() - 1);
+		verify(isTestBlock(entries.back(), Count - 1));
+	}
+
+	void ExecutionTraceTests::testFileRoundTrip()
+	{
+		TWord pc = 0x100;
+		pc = emitToMemory("move #$12,r0", pc);
+		pc = emitToMemory("move #$345678,a", pc);
+		emitToMemory("rts", pc);
+
+		ExecutionTrace trace(16);
+		trace.addBlock(0x100, 4, 10, 20);
+		trace.addBlock(0x100, 4, 14, 28);
+
+		const auto filename = getTempFile("dsp56k_executiontrace_test.bin");
+
+		verify(trace.writeToFile(filename, m_mem));
+
+		std::vector<ExecutionTrace::Entry> entries;
+		std::vector<ExecutionTrace::BlockCode> code;
+
+		verify(ExecutionTrace::readFromFile(filename, entries, code));
+
+		std::remove(filename.c_str());
+
+		const auto expected = trace.getEntries();
+		verify(entries.size() == expected.size());
+
+		for(size_t i=0; i<entries.size(); ++i)
+		{
+			verify(entries[i].type == expected[i].type);
+			verify(entries[i].pc == expected[i].pc);
+			verify(entries[i].length == expected[i].length);
+			verify(entries[i].instructions == expected[i].instructions);
+			verify(entries[i].value == expected[i].value);
+		}
+
+		// the block and one more word to decode two-word instructions at the end of a block. The block has not been registered, its code is read when writing
+		verify(code.size() == 1);
+		verify(code[0].pc == 0x100 && code[0].firstEntry == 0 && code[0].words.size() == 5);
+		for(TWord a=0x100; a<0x105; ++a)
+			verify(code[0].words[a - 0x100] == m_mem.get(MemArea_P, a));
+	}
+
+	void ExecutionTraceTests::testFileValidation()
+	{
+		std::vector<ExecutionTrace::Entry> entries;
+		std::vector<ExecutionTrace::BlockCode> code;
+
+		verify(!ExecutionTrace::readFromFile(getTempFile("dsp56k_executiontrace_missing.bin"), entries, code));
+
+		ExecutionTrace trace(16);
+		trace.addBlock(0x100, 1, 1, 1);
+
+		const auto filename = getTempFile("dsp56k_executiontrace_test.bin");
+
+		auto patchFile = [&](const std::streamoff _offset, const uint32_t _value)
+		{
+			verify(trace.writeToFile(filename, m_mem));
+			std::fstream f(filename, std::ios::in | std::ios::out | std::ios::binary);
+			f.seekp(_offset);
+			f.write(reinterpret_cast<const char*>(&_value), sizeof(_value));
+		};
+
+		// header: magic, version, entry size, entry count, code count
+		patchFile(0, 0x12345678);
+		verify(!ExecutionTrace::readFromFile(filename, entries, code));
+
+		patchFile(4, ExecutionTrace::FileVersion + 1);
+		verify(!ExecutionTrace::readFromFile(filename, entries, code));
+
+		patchFile(8, sizeof(ExecutionTrace::Entry) + 4);
+		verify(!ExecutionTrace::readFromFile(filename, entries, code));
+
+		// truncated
+		patchFile(12, 1000);
+		verify(!ExecutionTrace::readFromFile(filename, entries, code));
+
+		std::remove(filename.c_str());
+	}
+
+	void ExecutionTraceTests::testDecode()
+	{
+		TWord pc = 0x200;
+		pc = emitToMemory("nop", pc);
+		emitToMemory("rts", pc);
+
+		ExecutionTrace trace(16);
+		trace.addBlock(0x200, 2, 5, 7);
+
+		const auto filename = getTempFile("dsp56k_executiontrace_test.bin");
+		verify(trace.writeToFile(filename, m_mem));
+
+		std::vector<ExecutionTrace::Entry> entries;
+		std::vector<ExecutionTrace::BlockCode> code;
+		verify(ExecutionTrace::readFromFile(filename, entries, code));
+		std::remove(filename.c_str());
+
+		ExecutionTrace::Entry reg;
+		reg.type = ExecutionTrace::EntryType::Register;
+		reg.reg = Reg_R0;
+		reg.pc = 0x200;
+		reg.value = 0x12;
+		entries.push_back(reg);
+
+		Opcodes opcodes;
+		Disassembler disasm(opcodes);
+
+		std::string nop, rts;
+		disasm.disassemble(nop, m_mem.get(MemArea_P, 0x200), m_mem.get(MemArea_P, 0x201), 0, 0, 0x200);
+		disasm.disassemble(rts, m_mem.get(MemArea_P, 0x201), m_mem.get(MemArea_P, 0x202), 0, 0, 0x201);
+		verify(nop.find("nop") != std::string::npos && rts.find("rts") != std::string::npos);
+
+		std::stringstream ss;
+		ExecutionTrace::decode(ss, entries, code, &disasm);
+
+		std::vector<std::string> lines;
+		std::string line;
+		while(std::getline(ss, line))
+			lines.push_back(line);
+
+		verify(lines.size() == 4);
+		verify(lines[0] == "           5            7 P:000200 (2 words)");
+		verify(lines[1] == "    P:000200 " + nop);
+		verify(lines[2] == "    P:000201 " + rts);
+		verify(lines[3] == std::string("    ") + g_regNames[Reg_R0] + " = 000012");
+
+		// without disassembler, only the entries themselves are written
+		std::stringstream noAsm;
+		ExecutionTrace::decode(noAsm, entries, code, nullptr, 1);
+		verify(noAsm.str() == lines[3] + "\n");
+	}
+
+	void ExecutionTraceTests::testDecodeModifiedCode()
+	{
+		// the block at 0x300 is executed, modified by the DSP, recompiled and executed again
+		emitToMemory("nop", 0x300);
+
+		ExecutionTrace trace(16);
+
+		// a block that has not been registered, its code is read from memory when writing the file
+		trace.addBlock(0x310, 1, 0, 0);
+
+		trace.addBlockCode(m_mem, 0x300, 1);
+		trace.addBlock(0x300, 1, 1, 1);
+		trace.addBlock(0x300, 1, 2, 2);
+
+		emitToMemory("rts", 0x300);
+
+		trace.addBlockCode(m_mem, 0x300, 1);
+		trace.addBlock(0x300, 1, 3, 3);
+
+		// P memory at the time the file is written is not used for registered blocks
+		emitToMemory("nop", 0x300);
+
+		const auto filename = getTempFile("dsp56k_executiontrace_test.bin");
+		verify(trace.writeToFile(filename, m_mem));
+
+		std::vector<ExecutionTrace::Entry> entries;
+		std::vector<ExecutionTrace::BlockCode> code;
+		verify(ExecutionTrace::readFromFile(filename, entries, code));
+		std::remove(filename.c_str());
+
+		verify(entries.size() == 4);
+
+		// one unregistered block and two versions of the block at 0x300, indices are relative to the first entry in the file
+		verify(code.size() == 3);
+		verify(code[1].pc == 0x300 && code[1].firstEntry == 1);
+		verify(code[2].pc == 0x300 && code[2].firstEntry == 3);
+
+		Opcodes opcodes;
+		Disassembler disasm(opcodes);
+
+		std::stringstream ss;
+		ExecutionTrace::decode(ss, entries, code, &disasm, 1);
+
+		std::vector<std::string> lines;
+		std::string line;
+		while(std::getline(ss, line))
+			lines.push_back(line);
+
+		verify(lines.size() == 6);
+		verify(lines[1].find("nop") != std::string::npos);
+		verify(lines[3].find("nop") != std::string::npos);
+		verify(lines[5].find("rts") != std::string::npos);
+
+		// recompile more often than the ring can hold, only the code that is referenced by the remaining entries is written
+		for(uint64_t i=0; i<trace.capacity() * 2; ++i)
+		{
+			trace.addBlockCode(m_mem, 0x300, 1);
+			trace.addBlock(0x300, 1, i, i);
+		}
+
+		verify(trace.writeToFile(filename, m_mem));
+		verify(ExecutionTrace::readFromFile(filename, entries, code));
+		std::remove(filename.c_str());
+
+		verify(entries.size() == trace.capacity() - 1);
+		verify(code.size() == entries.size());
+	}
+
+	TWord ExecutionTraceTests::emitToMemory(const char* _text, const TWord _pc)
+	{
+		const auto result = m_assembler.assemble(_text);
+		if(!result.success())
+			throw std::string("Assembly failed for: ") + _text;
+
+		*m_mem.getHostPtr(MemArea_P, _pc) = result.word[0];
+		if(result.wordCount > 1)
+			*m_mem.getHostPtr(MemArea_P, _pc + 1) = result.word[1];
+
+		return _pc + result.wordCount;
+	}
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "assembler.h"
+#include "memory.h"
+
+namespace dsp56k
+{
+	// Tests for the execution trace ring buffer, its file format and the decoder, including code that is modified while being traced. JIT generated block entries are tested in JitUnittests
+	class ExecutionTraceTests
+	{
+	public:
+		ExecutionTraceTests();
+
+	private:
+		void testRing();
+		void testConcurrentRead();
+		void testFileRoundTrip();
+		void testFileValidation();
+		void testDecode();
+		void testDecodeModifiedCode();
+
+		TWord emitToMemory(const char* _text, TWord _pc);
+
+		DefaultMemoryValidator m_memValidator;
+		Memory m_mem;
+		Assembler m_assembler;
+	};
+}
@@ -2,6 +2,7 @@
 
 #include <functional>
 
+#include "statestream.h"
 #include "types.h"
 
 namespace dsp56k
@@ -76,6 +77,23 @@ namespace dsp56k
 			m_callbackConfigChanged();
 		}
 
+		virtual void saveState(StateWriter& _w) const
+		{
+			_w.write(m_direction);
+			_w.write(m_control);
+			_w.write(m_dspWrite);
+			_w.write(m_hostWrite);
+		}
+
+		// callbacks are not invoked
+		virtual void loadState(StateReader& _r)
+		{
+			_r.read(m_direction);
+			_r.read(m_control);
+			_r.read(m_dspWrite);
+			_r.read(m_hostWrite);
+		}
+
 	protected:
 		TWord m_direction = 0;	// bitmask, bit clear = Host to DSP, bit set = DSP to Host
 		TWord m_control = 0;	// bitmask, bit enabled = GPIO enabled
@@ -130,6 +148,18 @@ namespace dsp56k
 			return m_esaiControl;
 		}
 
+		void saveState(StateWriter& _w) const override
+		{
+			Gpio::saveState(_w);
+			_w.write(m_esaiControl);
+		}
+
+		void loadState(StateReader& _r) override
+		{
+			Gpio::loadState(_r);
+			_r.read(m_esaiControl);
+		}
+
 	private:
 		TWord m_esaiControl = 0;
 	};
@@ -1,6 +1,7 @@
 #include "dsp.h"
 #include "interrupts.h"
 #include "hdi08.h"
+#include "statestream.h"
 
 namespace dsp56k
 {
@@ -121,8 +122,9 @@ namespace dsp56k
 
 		if (m_dataRX.empty())
 		{
-			LOG("Empty read, PC=" << HEX(m_periph.getDSP().getPC().toWord()) << ", processingMode=" << m_periph.getDSP().getProcessingMode());
+			LOGRTL(WARNING, "Empty read, PC=%06x, processingMode=%d", m_periph.getDSP().getPC().toWord(), m_periph.getDSP().getProcessingMode());
 			m_waitServeRXInterrupt = false;
+			++m_rxEmptyReads;
 			return 0;
 		}
 
@@ -141,6 +143,7 @@ namespace dsp56k
 		default:
 			res = m_dataRX.pop_front();
 			m_waitServeRXInterrupt = false;
+			++m_rxWords;
 			m_callbackRx();
 //			LOG("HDI08 RX = " << HEX(res) << " (pop)");
 			break;
@@ -214,6 +217,32 @@ namespace dsp56k
 		// m_hdr is not affected by reset
 	}
 
+	void HDI08::saveState(StateWriter& _w) const
+	{
+		_w.write(m_hsr);
+		_w.write(m_hcr);
+		_w.write(m_hpcr);
+		_w.write(m_hdr);
+		_w.write(m_hddr);
+		_w.write(m_pendingTXInterrupts.load());
+		_w.write(m_lastRXClock);
+		_w.write(m_waitServeRXInterrupt);
+		_w.write(m_pendingHostFlags01);
+	}
+
+	void HDI08::loadState(StateReader& _r)
+	{
+		_r.read(m_hsr);
+		_r.read(m_hcr);
+		_r.read(m_hpcr);
+		_r.read(m_hdr);
+		_r.read(m_hddr);
+		m_pendingTXInterrupts = _r.read<uint32_t>();
+		_r.read(m_lastRXClock);
+		_r.read(m_waitServeRXInterrupt);
+		_r.read(m_pendingHostFlags01);
+	}
+
 	bool HDI08::dataRXFull() const
 	{
 		return m_dataRX.full();
@@ -309,13 +338,15 @@ namespace dsp56k
 	{
 		if(!m_transmitDataAlwaysEmpty && !m_dataTX.empty())
 		{
-			LOG("Write HDI08 HOTX: Discarding " << HEX(m_dataTX.front()) << ", HOTX is full, replacing with " << HEX(_val));
+			LOGRTL(WARNING, "Write HDI08 HOTX: Discarding %06x, HOTX is full, replacing with %06x", m_dataTX.front(), _val);
 			m_dataTX.front() = _val;
+			++m_txOverwrites;
 			return;
 		}
 
 		m_dataTX.waitNotFull();
 		m_dataTX.push_back(_val);
+		++m_txWords;
 
 //		LOG("Write HDI08 HOTX " << HEX(_val));
 //		LOG("HTDE=0");
@@ -14,6 +14,8 @@ namespace dsp56k
 {
 	class IPeripherals;
 	class Disassembler;
+	class StateReader;
+	class StateWriter;
 
 	class HDI08
 	{
@@ -101,6 +103,12 @@ namespace dsp56k
 
 		bool hasRXData() const {return !m_dataRX.empty();}
 
+		// accessed by the DSP thread, see DspMetrics
+		uint64_t getRxWords() const { return m_rxWords; }
+		uint64_t getRxEmptyReads() const { return m_rxEmptyReads; }
+		uint64_t getTxWords() const { return m_txWords; }
+		uint64_t getTxOverwrites() const { return m_txOverwrites; }
+
 		void setPendingHostFlags01(uint32_t _pendingHostFlags)
 		{
 			m_pendingHostFlags01 = static_cast<int32_t>(_pendingHostFlags);
@@ -118,6 +126,10 @@ namespace dsp56k
 
 		void reset();
 
+		// data that has been queued by the host is not part of the state
+		void saveState(StateWriter& _w) const;
+		void loadState(StateReader& _r);
+
 		bool dataRXFull() const;
 
 		void terminate();
@@ -196,6 +208,11 @@ namespace dsp56k
 		bool m_waitServeRXInterrupt = false;
 		int32_t m_pendingHostFlags01 = -1;
 
+		uint64_t m_rxWords = 0;
+		uint64_t m_rxEmptyReads = 0;
+		uint64_t m_txWords = 0;
+		uint64_t m_txOverwrites = 0;
+
 		DmaChannel::RequestSource m_dmaReqSourceReceive;
 		DmaChannel::RequestSource m_dmaReqSourceTransmit;
 		Dma* m_dma;
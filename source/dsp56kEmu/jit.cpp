@@ -3,11 +3,14 @@
 #include "dsp.h"
 #include "jitblock.h"
 #include "jitdspmode.h"
+#include "jitperfcounters.h"
 #include "jitprofilingsupport.h"
 #include "jitblockemitter.h"
 
 #include "asmjit/core/jitruntime.h"
 
+#include "dsp56kBase/hugepages.h"
+
 #define WAIT_FOR_PROFILER 0
 
 using namespace asmjit;
@@ -87,7 +90,29 @@ namespace dsp56k
 		Jit::toJitPtr(_jit)->run(_pc);
 	}
 
-	Jit::Jit(DSP& _dsp) : m_dsp(_dsp), m_rt(new JitRuntime())
+	void funcRunBreakpoint(JitDspPtr* _jit, const TWord _pc) noexcept
+	{
+		Jit::toJitPtr(_jit)->runBreakpoint(_pc);
+	}
+
+	namespace
+	{
+		JitRuntime* createRuntime()
+		{
+#if defined(ASMJIT_LIBRARY_MAKE_VERSION) && ASMJIT_LIBRARY_VERSION >= ASMJIT_LIBRARY_MAKE_VERSION(1, 10, 0)
+			if(HugePages::isEnabled())
+			{
+				// asmjit falls back to regular pages if large pages cannot be allocated
+				JitAllocator::CreateParams params;
+				params.options = JitAllocatorOptions::kUseLargePages;
+				return new JitRuntime(&params);
+			}
+#endif
+			return new JitRuntime();
+		}
+	}
+
+	Jit::Jit(DSP& _dsp) : m_dsp(_dsp), m_rt(createRuntime()), m_liveness(_dsp), m_pMemGuard(_dsp)
 	{
 		m_emitters.reserve(16);
 		m_blockRuntimeDatas.reserve(0x10000);
@@ -112,7 +137,7 @@ namespace dsp56k
 			}
 			catch (const std::exception& e)
 			{
-				LOG("Failed to create profiler: " << e.what());
+				LOGL(ERROR, "Failed to create profiler: " << e.what());
 				m_profiling.reset();
 			}
 		}
@@ -193,14 +218,14 @@ namespace dsp56k
 
 	void Jit::destroy(TWord _pc)
 	{
-		for (auto& it : m_chains)
-			it.second->destroy(_pc);
+		for (const auto& chain : m_chains)
+			chain->destroy(_pc);
 	}
 
 	void Jit::destroyToRecreate(TWord _pc)
 	{
-		for (auto& it : m_chains)
-			it.second->destroyToRecreate(_pc);
+		for (const auto& chain : m_chains)
+			chain->destroyToRecreate(_pc);
 	}
 
 	Jit* Jit::toJitPtr(DspRegs* _regs)
@@ -213,10 +238,26 @@ namespace dsp56k
 
 	void Jit::notifyProgramMemWrite(const TWord _offset)
 	{
-		for (auto& it : m_chains)
-			it.second->notifyPMemWrite(_offset, it.second.get() == m_currentChain);
+		for (const auto& chain : m_chains)
+			chain->notifyPMemWrite(_offset, chain.get() == m_currentChain);
 
 		m_maxUsedPAddress = std::max(m_maxUsedPAddress, static_cast<size_t>(_offset));
+
+		// a loop copied from another DSP is not removed by a block if its do instruction is overwritten
+		removeLoop(_offset + 1);
+		removeLoop(_offset + 2);
+
+		m_liveness.notifyProgramMemWrite(_offset, m_livenessInvalidBlocks);
+
+		if(!m_livenessInvalidBlocks.empty())
+		{
+			for (const auto pc : m_livenessInvalidBlocks)
+				destroy(pc);
+			m_livenessInvalidBlocks.clear();
+		}
+
+		if(m_pMemGuard.isActive())
+			m_pMemGuard.onWrite(_offset);
 	}
 
 	void Jit::run(const TWord _pc) noexcept
@@ -256,6 +297,22 @@ namespace dsp56k
 		checkModeChange();
 	}
 
+	void Jit::setConfig(const JitConfig& _config)
+	{
+		m_config = _config;
+
+		if(m_config.guardProgramMemory == m_pMemGuard.isActive())
+			return;
+
+		// JIT code that writes to P memory differs depending on the guard being active or not
+		if(m_config.guardProgramMemory)
+			m_pMemGuard.activate();
+		else
+			m_pMemGuard.deactivate();
+
+		destroyAllBlocks();
+	}
+
 	JitConfig Jit::getConfig(const TWord _pc) const
 	{
 		auto& globalConfig = getConfig();
@@ -272,9 +329,40 @@ namespace dsp56k
 		checkModeChange();
 	}
 
+	void Jit::runBreakpoint(const TWord _pc) noexcept
+	{
+#if DSP56300_DEBUGGER
+		// trap before the block is executed. The debugger is free to modify the DSP state or to destroy blocks while the DSP is halted
+		if(m_breakpointResumePC != _pc)
+		{
+			if(auto* debugger = m_dsp.getDebugger())
+				debugger->onExec(_pc);
+		}
+#endif
+		m_breakpointResumePC = g_pcInvalid;
+
+		const auto* block = m_currentChain->getBlock(_pc);
+
+		if(block && block->getPCFirst() == _pc)
+		{
+			getRunFunc(*block)(&m_dsp.regs(), _pc);
+			return;
+		}
+
+		// block is gone, recreate it without trapping twice
+		m_breakpointResumePC = _pc;
+		m_currentChain->exec(_pc);
+		m_breakpointResumePC = g_pcInvalid;
+	}
+
 	TJitFunc Jit::updateRunFunc(const JitCacheEntry& e)
 	{
-		const auto& i = e.block->getInfo();
+		return getRunFunc(*e.block);
+	}
+
+	TJitFunc Jit::getRunFunc(const JitBlockRuntimeData& _block)
+	{
+		const auto& i = _block.getInfo();
 
 		if(i.terminationReason == JitBlockInfo::TerminationReason::WritePMem)
 		{
@@ -288,11 +376,11 @@ namespace dsp56k
 
 		if constexpr(g_traceOps)
 		{
-			if(e.block->getFunc())
+			if(_block.getFunc())
 				return &funcRun;
 		}
 
-		return e.block->getFunc();
+		return _block.getFunc();
 	}
 
 	void Jit::checkPMemWrite() noexcept
@@ -300,20 +388,35 @@ namespace dsp56k
 		// if JIT code has written to P memory, destroy a JIT block if present at the write location
 		const TWord pMemWriteAddr = m_runtimeData.m_pMemWriteAddress;
 
+		if(m_pMemGuard.isActive())
+		{
+			if(!m_pMemGuard.hasModifiedPages())
+				return;
+
+			for (const auto addr : m_pMemGuard.processModifiedPages())
+				onJitPMemWrite(addr);
+			return;
+		}
+
 		if (pMemWriteAddr == g_pcInvalid)
 			return;
 
-		for (const auto& it : m_chains)
+		onJitPMemWrite(pMemWriteAddr);
+	}
+
+	void Jit::onJitPMemWrite(const TWord _addr)
+	{
+		for (const auto& chain : m_chains)
 		{
-			if (it.second->getBlock(pMemWriteAddr))
+			if (chain->getBlock(_addr))
 			{
-				m_volatileP.insert(pMemWriteAddr);
+				m_volatileP.insert(_addr);
 				break;
 			}
 		}
 
-		notifyProgramMemWrite(pMemWriteAddr);
-		m_dsp.notifyProgramMemWrite(pMemWriteAddr);
+		notifyProgramMemWrite(_addr);
+		m_dsp.notifyProgramMemWrite(_addr);
 	}
 
 	void Jit::checkModeChange() noexcept
@@ -327,28 +430,55 @@ namespace dsp56k
 
 //		LOG("DSP mode change to " << HEX(mode.get()));
 
-		const auto itExisting = m_chains.find(mode);
+		++m_chainStats.modeChanges;
 
-		if(itExisting == m_chains.end())
+		// the code of the current chain might not depend on the mode bits that changed
+		if(m_currentChain && m_currentChain->isCompatible(mode))
 		{
-			m_currentChain = new JitBlockChain(*this, mode, m_maxUsedPAddress);
-			m_chains.insert(std::make_pair(mode, m_currentChain));
+			m_currentChain->activate(mode);
+			++m_chainStats.sharedModeChanges;
+			return;
+		}
+
+		JitBlockChain* chain = nullptr;
+
+		for (const auto& c : m_chains)
+		{
+			if(c->isCompatible(mode))
+			{
+				chain = c.get();
+				break;
+			}
+		}
+
+		if(chain)
+		{
+			if(chain->getInitialMode() != mode)
+				++m_chainStats.sharedModeChanges;
+
+			chain->activate(mode);
+			chain->setMaxUsedPAddress(m_maxUsedPAddress);
 		}
 		else
 		{
-			m_currentChain = itExisting->second.get();
-			m_currentChain->setMaxUsedPAddress(m_maxUsedPAddress);
+			chain = new JitBlockChain(*this, mode, m_maxUsedPAddress);
+			m_chains.emplace_back(chain);
+			++m_chainStats.createdChains;
 		}
 
+		m_currentChain = chain;
+
 		m_dsp.setJitEntries(m_currentChain->getFuncs().data());
+
+		// indirect targets point to blocks of the previous chain
+		++m_runtimeData.m_funcsGeneration;
 	}
 
 	void Jit::onDebuggerAttached(DebuggerInterface& _debugger) const
 	{
-		for (auto& it : m_chains)
+		for (const auto& chain : m_chains)
 		{
-			const auto mode = it.first;
-			auto* chain = (it.second).get();
+			const auto& mode = chain->getInitialMode();
 
 			const auto pSize = m_dsp.memory().sizeP();
 
@@ -364,13 +494,152 @@ namespace dsp56k
 		}
 	}
 
+	bool Jit::setBreakpoint(const TWord _pc, const bool _enable)
+	{
+		if(_enable && !supportsBreakpoint(_pc))
+		{
+			LOGL(ERROR, "Breakpoint at " << HEX(_pc) << " not supported, addresses below " << HEX(Vba_End) << " are compiled as fast interrupts");
+			return false;
+		}
+
+		const auto changed = _enable ? m_breakpoints.insert(_pc).second : m_breakpoints.erase(_pc) > 0;
+
+		// the block that covers the address needs to be split or to trap on entry, blocks linked to it need to use the function table.
+		// Same as for a P memory write
+		if(changed)
+			destroy(_pc);
+
+		return true;
+	}
+
+	void Jit::setWatchpoint(const EMemArea _area, const TWord _addr, const bool _enable)
+	{
+		auto& w = m_watchpoints[_area];
+
+		const auto changed = _enable ? w.insert(_addr).second : w.erase(_addr) > 0;
+
+		if(changed)
+			destroyAllBlocks();
+	}
+
 	void Jit::destroyAllBlocks()
 	{
+		if(!m_chains.empty())
+			m_compileStats.onDestroyAllBlocks();
+
 		m_chains.clear();
+		m_chainStats = {};
+		m_pMemGuard.reset();
 		m_currentChain = nullptr;
 		checkModeChange();
 	}
 
+	void Jit::copyAnalysisFrom(const Jit& _source)
+	{
+		m_volatileP.insert(_source.m_volatileP.begin(), _source.m_volatileP.end());
+		m_maxUsedPAddress = std::max(m_maxUsedPAddress, _source.m_maxUsedPAddress);
+
+		if(m_currentChain)
+			m_currentChain->setMaxUsedPAddress(m_maxUsedPAddress);
+
+		// loops are known once the block with their do instruction has been created. The DSP might continue inside of a loop body
+		for (const auto& it : _source.m_loops)
+			addLoop(it.first, it.second);
+	}
+
+	JitChainStats Jit::getChainStats() const
+	{
+		auto stats = m_chainStats;
+
+		stats.chainCount = m_chains.size();
+
+		const auto pSize = m_dsp.memory().sizeP();
+
+		for (size_t i=0; i<m_chains.size(); ++i)
+		{
+			const auto& chain = m_chains[i];
+
+			stats.codeBytes += chain->getCodeSize();
+
+			// blocks that have been generated for the same PC in more than one chain, every additional copy is counted
+			for(TWord pc=0; pc<pSize; ++pc)
+			{
+				const auto* block = chain->getBlock(pc);
+
+				if(!block || block->getPCFirst() != pc)
+					continue;
+
+				for (size_t j=0; j<i; ++j)
+				{
+					const auto* other = m_chains[j]->getBlock(pc);
+
+					if(other && other->getPCFirst() == pc)
+					{
+						stats.duplicatedCodeBytes += block->getCodeSize();
+						break;
+					}
+				}
+			}
+		}
+
+		return stats;
+	}
+
+	size_t Jit::getCodeSize() const
+	{
+		size_t size = 0;
+		for (const auto& chain : m_chains)
+			size += chain->getCodeSize();
+		return size;
+	}
+
+	void Jit::writeCompileReport(std::ostream& _out, const size_t _maxBlocks) const
+	{
+		const auto chainStats = getChainStats();
+
+		_out << "JIT chains " << std::dec << chainStats.chainCount << ", created " << chainStats.createdChains
+			<< ", mode changes " << chainStats.modeChanges << ", shared " << chainStats.sharedModeChanges
+			<< ", code bytes " << chainStats.codeBytes << ", duplicated " << chainStats.duplicatedCodeBytes << std::endl;
+
+		for (size_t i=0; i<m_chains.size(); ++i)
+		{
+			const auto& residency = m_chains[i]->getResidencyStats();
+
+			_out << "  chain " << i << ": linked blocks " << residency.linkedBlocks << ", linked entries " << residency.linkedEntries
+				<< ", spills avoided " << residency.spillsAvoided << std::endl;
+		}
+
+		m_compileStats.writeReport(_out, _maxBlocks);
+	}
+
+	JitOptimizer::MemoryStats Jit::getMemoryOptimizerStats() const
+	{
+		JitOptimizer::MemoryStats stats;
+		for (const auto& chain : m_chains)
+			stats += chain->getMemoryOptimizerStats();
+		return stats;
+	}
+
+	bool Jit::enablePerfCounters(const uint64_t _samplePeriod)
+	{
+		m_perfCounters.reset(new JitPerfCounters(_samplePeriod));
+
+		if(!m_perfCounters->isValid())
+		{
+			m_perfCounters.reset();
+			return false;
+		}
+
+		// recreate all blocks to let the perf counters know about their code locations
+		destroyAllBlocks();
+		return true;
+	}
+
+	void Jit::disablePerfCounters()
+	{
+		m_perfCounters.reset();
+	}
+
 	JitBlockEmitter* Jit::acquireEmitter(JitConfig&& _config)
 	{
 		if(m_emitters.empty())
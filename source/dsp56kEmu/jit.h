@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <memory>
 
 #include "types.h"
@@ -9,11 +10,15 @@
 #include <unordered_map>
 
 #include "debuggerinterface.h"
+#include "interrupts.h"
 
 #include "jitblockchain.h"
 #include "jitcacheentry.h"
+#include "jitcompilestats.h"
 #include "jitconfig.h"
 #include "jitdspmode.h"
+#include "jitliveness.h"
+#include "jitpmemguard.h"
 #include "jitruntimedata.h"
 
 namespace asmjit
@@ -31,9 +36,20 @@ namespace dsp56k
 	struct JitBlockInfo;
 	class DSP;
 	class JitBlock;
+	class JitPerfCounters;
 	class JitProfilingSupport;
 	struct JitBlockEmitter;
 
+	struct JitChainStats
+	{
+		size_t chainCount = 0;
+		uint64_t createdChains = 0;			// since the last call to destroyAllBlocks()
+		uint64_t modeChanges = 0;
+		uint64_t sharedModeChanges = 0;		// mode changes that continued with a chain that has been created for a different mode
+		size_t codeBytes = 0;
+		size_t duplicatedCodeBytes = 0;		// code of blocks that have been generated for the same PC in more than one chain
+	};
+
 	class Jit final
 	{
 	public:
@@ -54,20 +70,29 @@ namespace dsp56k
 		void runCheckPMemWrite(TWord _pc) noexcept;
 		void runCheckPMemWriteAndModeChange(TWord _pc) noexcept;
 		void runCheckModeChange(TWord _pc) noexcept;
+		void runBreakpoint(TWord _pc) noexcept;
 
 		const JitConfig& getConfig() const { return m_config; }
 		JitConfig getConfig(TWord _pc) const;
-		void setConfig(const JitConfig& _config) { m_config = _config; }
+		void setConfig(const JitConfig& _config);
 		void resetHW();
 		const std::map<TWord, TWord>& getLoops() const { return m_loops; }
 		const std::set< TWord>& getLoopEnds() const { return m_loopEnds; }
 
 		static TJitFunc updateRunFunc(const JitCacheEntry& e);
+		static TJitFunc getRunFunc(const JitBlockRuntimeData& _block);
 
 		auto* getRuntime() { return m_rt; }
 		auto& getRuntimeData() { return m_runtimeData; }
+
+		// called by the dispatcher before it calls a JIT function, starts a new time slice for linked indirect branches
+		void resetLinkedIndirectBranches() { m_runtimeData.m_linkedIndirectBranches = 0; }
 		const auto& getVolatileP()  { return m_volatileP; }
 		auto* getProfilingSupport() const { return m_profiling.get(); }
+		auto* getPerfCounters() const { return m_perfCounters.get(); }
+		auto& getLiveness() { return m_liveness; }
+		auto& getPMemGuard() { return m_pMemGuard; }
+		const auto& getPMemGuard() const { return m_pMemGuard; }
 
 		bool isVolatileP(const TWord _pc) const
 		{
@@ -89,8 +114,61 @@ namespace dsp56k
 
 		void onDebuggerAttached(DebuggerInterface& _debugger) const;
 
+		// blocks are split at breakpoints and the block at a breakpoint address traps on entry. Changing a breakpoint invalidates the blocks
+		// covering its address and the blocks linked to them. Addresses in the vector table are compiled as fast interrupt blocks that cannot
+		// trap, setBreakpoint() fails for them
+		static bool supportsBreakpoint(const TWord _pc) { return _pc >= Vba_End; }
+		bool setBreakpoint(TWord _pc, bool _enable);
+		bool hasBreakpoint(const TWord _pc) const
+		{
+			return !m_breakpoints.empty() && m_breakpoints.find(_pc) != m_breakpoints.end();
+		}
+
+		// watchpoints are compiled as guarded stores into blocks that may write to a watched address. As any block might do that, changing
+		// a watchpoint invalidates all blocks
+		void setWatchpoint(EMemArea _area, TWord _addr, bool _enable);
+		bool hasWatchpoint(const EMemArea _area, const TWord _addr) const
+		{
+			const auto& w = m_watchpoints[_area];
+			return !w.empty() && w.find(_addr) != w.end();
+		}
+		bool hasWatchpoints(const EMemArea _area) const { return !m_watchpoints[_area].empty(); }
+		TWord getWatchpointMin(const EMemArea _area) const { return *m_watchpoints[_area].begin(); }
+		TWord getWatchpointMax(const EMemArea _area) const { return *m_watchpoints[_area].rbegin(); }
+
 		void destroyAllBlocks();
 
+		// Emitted code references host addresses of the DSP that created it and cannot be shared. The analysis of _source is reused
+		// instead, blocks are compiled on first entry: P memory that is known to be written by DSP code is not compiled into larger
+		// blocks and loops are known even if their do instruction is not executed again. Both DSPs must have identical P memory, see
+		// DSP::copyStateFrom()
+		void copyAnalysisFrom(const Jit& _source);
+
+		// accumulated since the last call to destroyAllBlocks()
+		JitOptimizer::MemoryStats getMemoryOptimizerStats() const;
+
+		// iterates all chains, expensive
+		JitChainStats getChainStats() const;
+
+		size_t getChainCount() const { return m_chains.size(); }
+		const JitBlockChain& getChain(const size_t _index) const { return *m_chains[_index]; }
+		const JitBlockChain* getCurrentChain() const { return m_currentChain; }
+		size_t getCodeSize() const;
+
+		// accumulated until resetCompileStats() is called
+		JitCompileStats& getCompileStats() { return m_compileStats; }
+		const JitCompileStats& getCompileStats() const { return m_compileStats; }
+		void resetCompileStats() { m_compileStats.reset(); }
+
+		// compile statistics + chain statistics
+		void writeCompileReport(std::ostream& _out, size_t _maxBlocks = 20) const;
+
+		const JitIndirectBranchStats& getIndirectBranchStats() const { return m_runtimeData.m_indirectBranchStats; }
+
+		// host performance counters are sampled for the calling thread, needs to be called from the DSP thread
+		bool enablePerfCounters(uint64_t _samplePeriod = 100000);
+		void disablePerfCounters();
+
 		JitBlockEmitter* acquireEmitter(JitConfig&& _config);
 		JitBlockEmitter* acquireEmitter(TWord _pc);
 		void releaseEmitter(JitBlockEmitter* _emitter);
@@ -102,25 +180,33 @@ namespace dsp56k
 
 	private:
 		void checkPMemWrite() noexcept;
+		void onJitPMemWrite(TWord _addr);
 
 		DSP& m_dsp;
 
 		asmjit::ASMJIT_ABI_NAMESPACE::JitRuntime* m_rt = nullptr;
 
-		struct DspModeHash
-		{
-		    std::size_t operator () (const JitDspMode& m) const	{ return m.get(); }
-		};
-
-		std::unordered_map<JitDspMode, std::unique_ptr<JitBlockChain>, DspModeHash> m_chains;
+		// one chain per set of DSP modes that are compatible with the code of the chain, see JitBlockChain::isCompatible()
+		std::vector<std::unique_ptr<JitBlockChain>> m_chains;
 		JitBlockChain* m_currentChain = nullptr;
+		JitChainStats m_chainStats;
+		JitCompileStats m_compileStats;
 
 		std::vector<TJitFunc> m_jitFuncs;
 		std::set<TWord> m_volatileP;
 		std::map<TWord, TWord> m_loops;
 		std::set<TWord> m_loopEnds;
 
+		std::set<TWord> m_breakpoints;
+		std::array<std::set<TWord>, MemArea_COUNT> m_watchpoints;
+		TWord m_breakpointResumePC = g_pcInvalid;
+
 		std::unique_ptr<JitProfilingSupport> m_profiling;
+		std::unique_ptr<JitPerfCounters> m_perfCounters;
+
+		JitLiveness m_liveness;
+		std::vector<TWord> m_livenessInvalidBlocks;
+		JitPMemGuard m_pMemGuard;
 
 		std::vector<JitBlockEmitter*> m_emitters;
 		std::vector<JitBlockRuntimeData*> m_blockRuntimeDatas;
@@ -11,11 +11,11 @@ namespace dsp56k
 	{
 		if(m_block)
 		{
-			LOG("Error: " << err << " - " << message << ", block at PC " << HEX(m_block->getPCFirst()) << ", P mem size " << m_block->getPMemSize() << ", disasm = " << m_block->getDisasm());
+			LOGL(ERROR, "Error: " << err << " - " << message << ", block at PC " << HEX(m_block->getPCFirst()) << ", P mem size " << m_block->getPMemSize() << ", disasm = " << m_block->getDisasm());
 		}
 		else
 		{
-			LOG("Error: " << err << " - " << message);
+			LOGL(ERROR, "Error: " << err << " - " << message);
 		}
 		assert(false);
 	}
@@ -9,8 +9,40 @@
 #include "memory.h"
 #include "opcodecycles.h"
 
+#include <algorithm>
+#include <cstddef>
+
 namespace dsp56k
 {
+	namespace
+	{
+		JitMemPtr makeIndirectTargetPtr(const JitReg64& _entry, const size_t _offset)
+		{
+#ifdef HAVE_ARM64
+			auto p = asmjit::a64::ptr(_entry, static_cast<int32_t>(_offset));
+			p.setSize(sizeof(uint64_t));
+			return p;
+#else
+			return asmjit::x86::qword_ptr(_entry, static_cast<int32_t>(_offset));
+#endif
+		}
+
+		// vector registers that hold the entry registers of a child block while jumping to its linked entry. Both are free at a block
+		// transition, lazy CCR updates have been done by the parent and a block does not read the last modified ALU before writing it.
+		// They are reserved while they carry a value, see JitBlock::reserveEntryRegCarriers()
+		constexpr JitReg128 g_entryRegCarriers[JitBlockRuntimeData::MaxEntryRegs] = { regLastModAlu, regXMMTempA };
+
+		const TReg24& getAguReg(const DspRegs& _regs, const PoolReg _reg)
+		{
+			return _reg >= DspN0 ? _regs.n[_reg - DspN0] : _regs.r[_reg - DspR0];
+		}
+	}
+
+	void callDSPTraceRegisters(DSP* const _dsp, const TWord _pc, const uint64_t _writtenRegs)
+	{
+		_dsp->getExecutionTrace()->addRegisterDeltas(*_dsp, _pc, static_cast<RegisterMask>(_writtenRegs));
+	}
+
 	JitBlock::JitBlock(JitEmitter& _a, DSP& _dsp, JitRuntimeData& _runtimeData, JitConfig&& _config)
 	: m_runtimeData(_runtimeData)
 	, m_asm(_a)
@@ -21,6 +53,7 @@ namespace dsp56k
 	, m_dspRegs(*this)
 	, m_dspRegPool(*this)
 	, m_mem(*this)
+	, m_entryRegCarrierTemp(*this, false)
 	, m_config(std::move(_config))
 	{
 	}
@@ -169,6 +202,7 @@ namespace dsp56k
 					terminationReason = JitBlockInfo::TerminationReason::Branch;
 					_info.branchTarget = getBranchTarget(instA, opA, opB, pc);
 					_info.branchIsConditional = hasField(instA, Field_CCCC) || hasField(instA, Field_bbbbb);
+					_info.branchIsSubroutineCall = (flags & OpFlagPushPC) != 0;
 					break;
 				}
 				if(flags & OpFlagPopPC)
@@ -221,6 +255,13 @@ namespace dsp56k
 				terminationReason = JitBlockInfo::TerminationReason::InstructionLimit;
 				break;
 			}
+
+			// a breakpoint needs to be at the start of a block to be trapped when the block is entered
+			if(!isRep && !isFastInterrupt && _dsp.getJit().hasBreakpoint(_pc + numWords))
+			{
+				terminationReason = JitBlockInfo::TerminationReason::Breakpoint;
+				break;
+			}
 		}
 	}
 
@@ -236,11 +277,31 @@ namespace dsp56k
 
 		m_chain = _chain;
 
+		if(_chain)
+		{
+			m_chainMode = _chain->getMode();
+			m_chainMode.clearUsedBits();
+		}
+
 		const bool isFastInterrupt = _pc < Vba_End;
 		const auto fastInterruptMode = isFastInterrupt ? (m_config.dynamicFastInterrupts ? JitOps::FastInterruptMode::Dynamic : JitOps::FastInterruptMode::Static) : JitOps::FastInterruptMode::None;
 
 		dspAsm.clear();
 
+		getInfo(info, dsp(), _pc, m_config, _cache, _volatileP, _loopStarts, _loopEnds);
+
+		// blocks that are entered from C++ have a second entry point for linked parents, which pass some DSP registers in host registers.
+		// Loop bodies jump back to the beginning of the block, which has to be entered with the DSP registers in memory
+		const auto isLoopStart = info.hasFlag(JitBlockInfo::Flags::IsLoopBodyBegin);
+		const auto isLoopEnd = info.terminationReason == JitBlockInfo::TerminationReason::LoopEnd;
+		const auto isLoopBody = isLoopStart && isLoopEnd;
+
+		if(_chain && m_config.registerResidency && !isFastInterrupt && !isLoopBody && !m_dsp.getExecutionTrace())
+			selectEntryRegs(_rt);
+
+		if(_rt.m_entryRegCount)
+			emitEntryRegsLoad(_rt);
+
 		// needed so that the dsp register is available
 		m_asm.mov(regDspPtr, g_funcArgGPs[0]);
 		dspRegPool().makeDspPtr(&m_dsp.getInstructionCounter(), sizeof(uint64_t));
@@ -260,15 +321,19 @@ namespace dsp56k
 
 		PushAllUsed pm(*this);
 
+		if(_rt.m_entryRegCount)
+			emitEntryRegsReceive(_rt);
+
 		auto loopBegin = m_asm.newNamedLabel("loopBegin");
 		m_asm.bind(loopBegin);
 
+		if(m_dsp.getExecutionTrace())
+			traceExecution(_pc, info.memSize, info.writtenRegs);
+
 		asmjit::BaseNode* cursorInsertIncreaseInstructionCount = m_asm.cursor();	// inserted later
 
 		uint32_t blockFlags = 0;
 
-		getInfo(info, dsp(), _pc, m_config, _cache, _volatileP, _loopStarts, _loopEnds);
-
 		const auto pcNext = _pc + info.memSize;
 
 		if(fastInterruptMode != JitOps::FastInterruptMode::Static && info.terminationReason != JitBlockInfo::TerminationReason::PopPC)
@@ -379,10 +444,6 @@ namespace dsp56k
 		if (info.terminationReason == JitBlockInfo::TerminationReason::PopPC)
 			blockFlags |= JitOps::PopPC;
 
-		const auto isLoopStart = info.hasFlag(JitBlockInfo::Flags::IsLoopBodyBegin);
-		const auto isLoopEnd = info.terminationReason == JitBlockInfo::TerminationReason::LoopEnd;
-		const auto isLoopBody = isLoopStart && isLoopEnd;
-
 		bool childIsConditional = false;
 
 		JitBlockRuntimeData* child = nullptr;
@@ -570,8 +631,29 @@ namespace dsp56k
 			profileEnd(pl);
 		}
 
+		// registers that are not read anymore before being overwritten do not need to be written back
+		auto liveOut = JitLiveness::AllLive;
+
+		auto& liveness = m_dsp.getJit().getLiveness();
+
+		if(m_config.interBlockLiveness && !isFastInterrupt && !m_dsp.getDebugger())
+		{
+			liveOut = liveness.getLiveOut(_pc, info.memSize);
+
+			// the block is destroyed if a P memory write makes registers live that it does not write back
+			liveness.registerBlock(_pc, info.memSize, liveOut);
+		}
+
+		auto& livenessStats = liveness.getStats();
+
 		auto ccrDirty = m_dspRegs.ccrDirtyFlags();
 
+		if(ccrDirty && (liveOut & RegisterMask::CCR) == RegisterMask::None)
+		{
+			ccrDirty = static_cast<CCRMask>(0);
+			++livenessStats.skippedCCRUpdates;
+		}
+
 		if(ccrDirty)
 		{
 			// we can omit CCR updates for all CCR bits that are overwritten by child blocks
@@ -618,13 +700,30 @@ namespace dsp56k
 			}
 		}
 
+		// an unconditionally linked child receives its entry registers in host registers. Conditional links use the C++ entry of the children
+		const JitBlockRuntimeData* linkedChild = child ? (childIsConditional ? nullptr : child) : nonBranchChild;
+		const auto useLinkedEntry = linkedChild && linkedChild->getEntryRegCount() && !isLoopBody;
+
+		if(useLinkedEntry)
+			emitEntryRegsPass(_rt, *linkedChild);
+
+		// indirect branches (rts, jmp (rn), ...) can jump to the next block via inline caches. Mode changes and P memory writes need the dispatcher
+		const auto canLinkIndirect = _chain && m_config.linkIndirectBranches && !isFastInterrupt && !info.hasFlag(JitBlockInfo::Flags::ModeChange);
+
+		const auto linkIndirect = canLinkIndirect && (blockFlags & ~static_cast<uint32_t>(JitOps::PopPC)) == 0 &&
+			(info.terminationReason == JitBlockInfo::TerminationReason::PopPC || childAddr == g_dynamicAddress);
+
+		// subroutine calls push the return address to predict the target of the matching rts
+		const auto pushReturn = canLinkIndirect && info.terminationReason == JitBlockInfo::TerminationReason::Branch &&
+			info.branchIsSubroutineCall && !info.branchIsConditional && childAddr != g_dynamicAddress && pcNext < m_dsp.memory().sizeP();
+
 		auto pl = profileBegin("release");
 
 		RegScratch scratch(*this, false);
 
 		JitReg32 regPC;
 
-		if((child && childIsConditional) || isLoopBody)
+		if((child && childIsConditional) || isLoopBody || linkIndirect)
 		{
 			regPC = r32(m_dspRegPool.get(PoolReg::DspPC, true, false));
 
@@ -672,16 +771,28 @@ namespace dsp56k
 			}
 		}
 
+		if(liveOut != JitLiveness::AllLive)
+			livenessStats.discardedWritebacks += m_dspRegPool.discardDead(liveOut);
+
 		m_dspRegPool.releaseAll();
 
 		pm.end();
 
 		jumpIfLoop(loopBegin, regPC, regLC, regLC);
 
+		if(useLinkedEntry)
+			assertEntryRegCarriersUntouched();
+
 		m_stack.popAll();
 
 		m_stack.reset();
 
+		if(pushReturn)
+			pushReturnAddress(pcNext);
+
+		if(useLinkedEntry)
+			assertEntryRegCarriersUntouched();
+
 		profileEnd(pl);
 
 		asmjit::Label lj;
@@ -718,12 +829,21 @@ namespace dsp56k
 			}
 			else
 			{
-				jumpToChild(child);
+				if(useLinkedEntry)
+					assertEntryRegCarriersUntouched();
+				jumpToChild(child, JitCondCode::kMaxValue, useLinkedEntry);
 			}
 		}
 		else if(nonBranchChild)
 		{
-			jumpToChild(nonBranchChild);
+			if(useLinkedEntry)
+				assertEntryRegCarriersUntouched();
+			jumpToChild(nonBranchChild, JitCondCode::kMaxValue, useLinkedEntry);
+		}
+		else if(linkIndirect)
+		{
+			lj = profileBegin("jumpIndirect");
+			jumpIndirect(_rt, regPC, info.terminationReason == JitBlockInfo::TerminationReason::PopPC);
 		}
 		else
 		{
@@ -732,6 +852,11 @@ namespace dsp56k
 
 		profileEnd(lj);
 
+		if(useLinkedEntry)
+			releaseEntryRegCarriers();
+
+		_rt.m_modeDependencies = m_chain ? m_chainMode.getUsedBits() : ~0u;
+
 		m_currentJitBlockRuntimeData = nullptr;
 		return true;
 	}
@@ -751,6 +876,72 @@ namespace dsp56k
 		increaseUint64(_count, m_dsp.getCycles());
 	}
 
+	void JitBlock::traceExecution(const TWord _pc, const TWord _length, const RegisterMask _writtenRegs)
+	{
+		auto& trace = *m_dsp.getExecutionTrace();
+
+		trace.addBlockCode(m_dsp.memory(), _pc, _length);
+
+		// append the block entry inline, equivalent to ExecutionTrace::addBlock()
+		{
+			const RegGP pos(*this);
+			const RegGP entry(*this);
+			const RegGP temp(*this);
+
+			assert(trace.getMask() <= 0x7fffffff);
+
+			mem().mov(r64(pos), trace.getWritePosStorage());
+
+			// entry = entries + (pos & mask) * 24
+			static_assert(sizeof(ExecutionTrace::Entry) == 24);
+			m_asm.mov(r64(entry), r64(pos));
+			m_asm.and_(r64(entry), asmjit::Imm(trace.getMask()));
+			m_asm.shl(r64(entry), asmjit::Imm(3));
+			m_asm.mov(r64(temp), r64(entry));
+			m_asm.shl(r64(temp), asmjit::Imm(1));
+			m_asm.add(r64(entry), r64(temp));
+			mem().makeBasePtr(r64(temp), trace.getEntryStorage());
+			m_asm.add(r64(entry), r64(temp));
+
+			m_asm.mov(r32(temp), asmjit::Imm(ExecutionTrace::blockHeader(_length)));
+			m_asm.mov(Jitmem::makePtr(r64(entry), sizeof(uint32_t)), r32(temp));
+			m_asm.add(r64(entry), asmjit::Imm(sizeof(uint32_t)));
+
+			m_asm.mov(r32(temp), asmjit::Imm(_pc));
+			m_asm.mov(Jitmem::makePtr(r64(entry), sizeof(uint32_t)), r32(temp));
+			m_asm.add(r64(entry), asmjit::Imm(sizeof(uint32_t)));
+
+			mem().mov(r64(temp), m_dsp.getInstructionCounter());
+			m_asm.mov(Jitmem::makePtr(r64(entry), sizeof(uint64_t)), r64(temp));
+			m_asm.add(r64(entry), asmjit::Imm(sizeof(uint64_t)));
+
+			mem().mov(r64(temp), m_dsp.getCycles());
+			m_asm.mov(Jitmem::makePtr(r64(entry), sizeof(uint64_t)), r64(temp));
+
+			// publish the entry, readers must not see the new position before the entry has been written
+			m_asm.inc(r64(pos));
+#ifdef HAVE_ARM64
+			mem().makeBasePtr(r64(temp), &trace.getWritePosStorage());
+			m_asm.stlr(r64(pos), asmjit::a64::ptr(r64(temp)));
+#else
+			mem().mov(trace.getWritePosStorage(), r64(pos));
+#endif
+		}
+
+		if(!trace.captureRegisters())
+			return;
+
+		const FuncArg r0(*this, 0);
+		const FuncArg r1(*this, 1);
+		const FuncArg r2(*this, 2);
+
+		mem().makeDspPtr(r0);
+		m_asm.mov(r32(r1), asmjit::Imm(_pc));
+		m_asm.mov(r64(r2), asmjit::Imm(static_cast<uint64_t>(_writtenRegs)));
+
+		m_stack.call(asmjit::func_as_ptr(&callDSPTraceRegisters));
+	}
+
 	void JitBlock::increaseUint64(const asmjit::Operand& _count, const uint64_t& _target)
 	{
 		const auto ptr = dspRegPool().makeDspPtr(&_target, sizeof(uint64_t));
@@ -799,7 +990,7 @@ namespace dsp56k
 
 	const JitDspMode* JitBlock::getMode() const
 	{
-		return m_chain ? &m_chain->getMode() : m_mode;
+		return m_chain ? &m_chainMode : m_mode;
 	}
 
 	void JitBlock::setMode(JitDspMode* _mode)
@@ -809,6 +1000,8 @@ namespace dsp56k
 
 	void JitBlock::reset(JitConfig&& _config)
 	{
+		assert(!m_entryRegCarriersReserved);
+
 		m_config = std::move(_config);
 		m_stack.reset();
 		m_xmmPool.reset({regXMMTempA});
@@ -829,9 +1022,9 @@ namespace dsp56k
 		m_block.setGenerating(false);
 	}
 
-	JitReg64 JitBlock::getJumpTarget(const JitReg64& _dst, const JitBlockRuntimeData* _child) const
+	JitReg64 JitBlock::getJumpTarget(const JitReg64& _dst, const JitBlockRuntimeData* _child, const bool _linkedEntry/* = false*/) const
 	{
-		auto* p = asmjit::func_as_ptr(_child->getFunc());
+		auto* p = asmjit::func_as_ptr(_linkedEntry ? _child->getLinkedFunc() : _child->getFunc());
 		const auto addr = reinterpret_cast<uint64_t>(p);
 
 		if(const auto offset = Jitmem::pointerOffset(p, &m_dsp.regs()))
@@ -842,13 +1035,13 @@ namespace dsp56k
 		return _dst;
 	}
 
-	void JitBlock::jumpToChild(const JitBlockRuntimeData* _child, const JitCondCode _cc/* = JitCondCode::kMaxValue*/) const
+	void JitBlock::jumpToChild(const JitBlockRuntimeData* _child, const JitCondCode _cc/* = JitCondCode::kMaxValue*/, const bool _linkedEntry/* = false*/) const
 	{
 		const auto tempReg = r64(g_funcArgGPs[1]);
 
-		auto initTemp = [this, &tempReg, &_child]
+		auto initTemp = [this, &tempReg, &_child, _linkedEntry]
 		{
-			return getJumpTarget(tempReg, _child);
+			return getJumpTarget(tempReg, _child, _linkedEntry);
 		};
 
 		if(_cc == JitCondCode::kMaxValue)
@@ -889,4 +1082,280 @@ namespace dsp56k
 		m_asm.jmp(regFalse);
 #endif
 	}
+
+	void JitBlock::selectEntryRegs(JitBlockRuntimeData& _rt)
+	{
+		// AGU registers are not aliased by other pool registers and fit into the lower 32 bits of a vector register
+		constexpr PoolReg candidates[] =
+		{
+			DspR0, DspR1, DspR2, DspR3, DspR4, DspR5, DspR6, DspR7,
+			DspN0, DspN1, DspN2, DspN3, DspN4, DspN5, DspN6, DspN7
+		};
+
+		for (const auto reg : candidates)
+		{
+			if(_rt.m_entryRegCount == JitBlockRuntimeData::MaxEntryRegs)
+				break;
+
+			if((m_dspRegPool.toRegisterMask(reg, false) & _rt.getInfo().readRegs) != RegisterMask::None)
+				_rt.m_entryRegs[_rt.m_entryRegCount++] = reg;
+		}
+	}
+
+	void JitBlock::emitEntryRegsLoad(JitBlockRuntimeData& _rt)
+	{
+		// entry from C++: load the entry registers into the carriers and continue the same way as if a linked parent jumped to us
+		reserveEntryRegCarriers();
+
+		m_asm.mov(regDspPtr, g_funcArgGPs[0]);
+
+		for(uint32_t i=0; i<_rt.m_entryRegCount; ++i)
+			m_asm.movd(g_entryRegCarriers[i], m_dspRegPool.makeDspPtr(getAguReg(m_dsp.regs(), _rt.m_entryRegs[i])));
+
+		_rt.m_linkedEntry = m_asm.newNamedLabel("linkedEntry");
+		m_asm.bind(_rt.m_linkedEntry);
+	}
+
+	void JitBlock::emitEntryRegsReceive(const JitBlockRuntimeData& _rt)
+	{
+		assertEntryRegCarriersUntouched();
+
+		// the parent did not write the entry registers back, they are marked as written so that we store them at exit
+		for(uint32_t i=0; i<_rt.m_entryRegCount; ++i)
+		{
+			const auto r = m_dspRegPool.get(_rt.m_entryRegs[i], false, true);
+			m_asm.movd(r32(r), g_entryRegCarriers[i]);
+		}
+
+		releaseEntryRegCarriers();
+	}
+
+	void JitBlock::emitEntryRegsPass(JitBlockRuntimeData& _rt, const JitBlockRuntimeData& _child)
+	{
+		const auto& regs = _child.getEntryRegs();
+		const auto count = _child.getEntryRegCount();
+
+		std::array<JitRegGP, JitBlockRuntimeData::MaxEntryRegs> values;
+
+		for(uint32_t i=0; i<count; ++i)
+		{
+			values[i] = m_dspRegPool.get(regs[i], true, false);
+			m_dspRegPool.lock(regs[i]);
+		}
+
+		reserveEntryRegCarriers();
+
+		for(uint32_t i=0; i<count; ++i)
+			m_asm.movd(g_entryRegCarriers[i], r32(values[i]));
+
+		// the child stores them at exit, no need to write them back
+		for(uint32_t i=0; i<count; ++i)
+		{
+			m_dspRegPool.unlock(regs[i]);
+			m_dspRegPool.discard(regs[i]);
+			_rt.m_residentRegs = _rt.m_residentRegs | m_dspRegPool.toRegisterMask(regs[i], false);
+		}
+	}
+
+	void JitBlock::reserveEntryRegCarriers()
+	{
+		assert(!m_entryRegCarriersReserved && "entry register carriers are already reserved");
+		assert(!m_xmmPool.isInUse(regXMMTempA) && "vector temp is in use, it cannot carry entry registers");
+
+		// the vector temp is taken from the pool, the last modified ALU is written by lazy CCR updates only, see JitOps::ccr_dirty().
+		// Both are preserved across C++ calls while they are marked as used
+		m_entryRegCarrierTemp.acquire();
+
+		m_lastModAluWasUsed = m_stack.isUsed(regLastModAlu);
+		m_stack.setUsed(regLastModAlu);
+
+		m_entryRegCarriersReserved = true;
+	}
+
+	void JitBlock::releaseEntryRegCarriers()
+	{
+		assert(m_entryRegCarriersReserved && "entry register carriers are not reserved");
+
+		m_entryRegCarrierTemp.release();
+
+		if(!m_lastModAluWasUsed)
+			m_stack.setUnused(regLastModAlu);
+
+		m_entryRegCarriersReserved = false;
+	}
+
+	bool JitBlock::isEntryRegCarrierReserved(const JitReg128& _reg) const
+	{
+		if(!m_entryRegCarriersReserved)
+			return false;
+
+		for (const auto& carrier : g_entryRegCarriers)
+		{
+			if(carrier.equals(_reg))
+				return true;
+		}
+		return false;
+	}
+
+	void JitBlock::assertEntryRegCarriersUntouched() const
+	{
+		// called on every path between writing and reading the carriers. They must still be reserved by us, must not be restored
+		// from the stack and must not be saved by the callee
+		assert(m_entryRegCarriersReserved && "entry register carriers have been released too early");
+		assert(m_entryRegCarrierTemp.isValid() && m_entryRegCarrierTemp.get().equals(regXMMTempA) && "vector temp carrier has been taken");
+
+		for (const auto& carrier : g_entryRegCarriers)
+		{
+			assert(!JitStackHelper::isNonVolatile(carrier) && "entry register carriers must be volatile");
+			assert(!m_stack.isPushed(carrier) && "entry register carrier is restored from the stack");
+			(void)carrier;
+		}
+	}
+
+	void JitBlock::pushReturnAddress(const TWord _pc)
+	{
+		// called after the stack has been restored, only volatile registers that are not used as DSP pointer are available
+		const auto addr = r64(g_funcArgGPs[1]);
+		const auto key = r64(regReturnVal);
+		const auto base = r64(g_regGPTemps.begin()->as<JitRegGP>());
+		const auto func = r64(g_funcArgGPs[3]);
+
+		auto& rtd = m_runtimeData;
+
+		// the function that the dispatcher would call for the return address at this point in time
+		m_asm.mov(func, m_mem.makePtr(func, &m_dsp.getJitEntries(), sizeof(uint64_t)));
+		m_asm.mov(r32(addr), asmjit::Imm(_pc));
+		m_asm.mov(func, Jitmem::makePtr(func, addr, 3, sizeof(uint64_t)));
+
+		m_asm.mov(r32(key), m_mem.makePtr(key, &rtd.m_funcsGeneration, sizeof(uint32_t)));
+		m_asm.shl(key, asmjit::Imm(32));
+		m_asm.or_(key, addr);
+
+		m_asm.mov(r32(addr), m_mem.makePtr(base, &rtd.m_returnStackIndex, sizeof(uint32_t)));
+		m_asm.shl(addr, asmjit::Imm(4));
+		m_mem.makeBasePtr(base, rtd.m_returnStack.data());
+		m_asm.add(base, addr);
+
+		m_asm.mov(makeIndirectTargetPtr(base, offsetof(JitIndirectTarget, key)), key);
+		m_asm.mov(makeIndirectTargetPtr(base, offsetof(JitIndirectTarget, func)), func);
+
+		m_asm.mov(r32(addr), m_mem.makePtr(base, &rtd.m_returnStackIndex, sizeof(uint32_t)));
+		m_asm.inc(r32(addr));
+		m_asm.and_(r32(addr), asmjit::Imm(JitRuntimeData::ReturnStackSize - 1));
+		m_asm.mov(m_mem.makePtr(base, &rtd.m_returnStackIndex, sizeof(uint32_t)), r32(addr));
+	}
+
+	void JitBlock::jumpIndirect(JitBlockRuntimeData& _rt, const JitReg32& _regPC, const bool _isReturn)
+	{
+		// called after the stack has been restored, only volatile registers that are not used as DSP pointer are available.
+		// The PC is passed as second argument to the target function
+		const auto pc = r32(g_funcArgGPs[1]);
+		const auto key = r64(regReturnVal);
+		const auto base = r64(g_regGPTemps.begin()->as<JitRegGP>());
+		const auto temp = r64(g_funcArgGPs[3]);
+
+		auto& rtd = m_runtimeData;
+		auto& stats = rtd.m_indirectBranchStats;
+
+		// always copied, this zero-extends the PC as it is used as index below
+		m_asm.mov(pc, _regPC);
+
+		// return to the dispatcher after a number of linked indirect branches to give interrupts and peripherals a time slice
+		const auto exit = m_asm.newLabel();
+		const auto maxLinked = std::clamp<uint32_t>(m_config.maxLinkedIndirectBranches, 1, 0xfff);
+
+		m_asm.mov(r32(temp), m_mem.makePtr(base, &rtd.m_linkedIndirectBranches, sizeof(uint32_t)));
+		m_asm.inc(r32(temp));
+		m_asm.mov(m_mem.makePtr(base, &rtd.m_linkedIndirectBranches, sizeof(uint32_t)), r32(temp));
+		m_asm.cmp(r32(temp), asmjit::Imm(maxLinked));
+		m_asm.jge(exit);
+
+		m_asm.mov(r32(key), pc);
+		m_asm.mov(r32(temp), m_mem.makePtr(temp, &rtd.m_funcsGeneration, sizeof(uint32_t)));
+		m_asm.shl(temp, asmjit::Imm(32));
+		m_asm.or_(key, temp);
+
+		if(_isReturn)
+		{
+			const auto miss = m_asm.newLabel();
+
+			// pop the return address that has been pushed by the matching subroutine call
+			m_asm.mov(r32(temp), m_mem.makePtr(base, &rtd.m_returnStackIndex, sizeof(uint32_t)));
+			m_asm.dec(r32(temp));
+			m_asm.and_(r32(temp), asmjit::Imm(JitRuntimeData::ReturnStackSize - 1));
+			m_asm.mov(m_mem.makePtr(base, &rtd.m_returnStackIndex, sizeof(uint32_t)), r32(temp));
+
+			m_asm.shl(temp, asmjit::Imm(4));
+			m_mem.makeBasePtr(base, rtd.m_returnStack.data());
+			m_asm.add(base, temp);
+
+			jumpToIndirectTarget(base, key, temp, miss, stats.returnHits);
+
+			m_asm.bind(miss);
+			increaseCounter(stats.returnMisses, base, temp);
+		}
+
+		// inline cache of this branch site, indexed by the lower bits of the target PC
+		const auto miss = m_asm.newLabel();
+
+		m_asm.mov(r32(temp), pc);
+		m_asm.and_(r32(temp), asmjit::Imm(JitBlockRuntimeData::IndirectBranchCacheSize - 1));
+		m_asm.shl(temp, asmjit::Imm(4));
+		m_mem.makeBasePtr(base, _rt.m_indirectBranchCache.data());
+		m_asm.add(base, temp);
+
+		jumpToIndirectTarget(base, key, temp, miss, stats.cacheHits);
+
+		// miss: replace the cache entry with the function that the dispatcher would call
+		m_asm.bind(miss);
+
+		m_asm.mov(temp, m_mem.makePtr(temp, &m_dsp.getJitEntries(), sizeof(uint64_t)));
+		m_asm.mov(temp, Jitmem::makePtr(temp, r64(pc), 3, sizeof(uint64_t)));
+
+		m_asm.mov(makeIndirectTargetPtr(base, offsetof(JitIndirectTarget, key)), key);
+		m_asm.mov(makeIndirectTargetPtr(base, offsetof(JitIndirectTarget, func)), temp);
+
+		increaseCounter(stats.cacheMisses, base, key);
+
+		m_asm.mov(g_funcArgGPs[0], regDspPtr);
+#ifdef HAVE_ARM64
+		m_asm.br(temp);
+#else
+		m_asm.jmp(temp);
+#endif
+
+		// the dispatcher resets the counter before it calls the next JIT function
+		m_asm.bind(exit);
+
+		increaseCounter(stats.timeSliceExits, base, temp);
+
+		m_asm.ret();
+	}
+
+	void JitBlock::jumpToIndirectTarget(const JitReg64& _entry, const JitReg64& _key, const JitReg64& _temp, const asmjit::Label& _miss, const uint64_t& _hitCounter)
+	{
+		m_asm.mov(_temp, makeIndirectTargetPtr(_entry, offsetof(JitIndirectTarget, key)));
+		m_asm.cmp(_key, _temp);
+		m_asm.jnz(_miss);
+
+		m_asm.mov(_temp, makeIndirectTargetPtr(_entry, offsetof(JitIndirectTarget, func)));
+
+		increaseCounter(_hitCounter, _entry, _key);
+
+		m_asm.mov(g_funcArgGPs[0], regDspPtr);
+#ifdef HAVE_ARM64
+		m_asm.br(_temp);
+#else
+		m_asm.jmp(_temp);
+#endif
+	}
+
+	void JitBlock::increaseCounter(const uint64_t& _counter, const JitReg64& _scratch, const JitReg64& _temp)
+	{
+		const auto p = m_mem.makePtr(_scratch, &_counter, sizeof(uint64_t));
+
+		m_asm.mov(_temp, p);
+		m_asm.inc(_temp);
+		m_asm.mov(p, _temp);
+	}
 }
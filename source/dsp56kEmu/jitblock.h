@@ -1,6 +1,7 @@
 #pragma once
 
 #include "jitcacheentry.h"
+#include "jitdspmode.h"
 #include "jitdspregs.h"
 #include "jitdspregpool.h"
 #include "jitmem.h"
@@ -9,6 +10,7 @@
 #include "jitstackhelper.h"
 #include "jittypes.h"
 #include "jitconfig.h"
+#include "opcodeanalysis.h"
 
 #include <vector>
 #include <set>
@@ -65,6 +67,7 @@ namespace dsp56k
 		void increaseInstructionCount(const asmjit::Operand& _count);
 		void increaseCycleCount(const asmjit::Operand& _count);
 		void increaseUint64(const asmjit::Operand& _count, const uint64_t& _target);
+		void traceExecution(TWord _pc, TWord _length, RegisterMask _writtenRegs);
 
 		const JitConfig& getConfig() const { return m_config; }
 
@@ -98,6 +101,9 @@ namespace dsp56k
 
 		void reset(JitConfig&& _config);
 
+		// true while a carrier of entry registers holds a value that is passed to or received from a linked block, see JitConfig::registerResidency
+		bool isEntryRegCarrierReserved(const JitReg128& _reg) const;
+
 	private:
 		class JitBlockGenerating
 		{
@@ -108,11 +114,25 @@ namespace dsp56k
 			JitBlockRuntimeData& m_block;
 		};
 
-		JitReg64 getJumpTarget(const JitReg64& _dst, const JitBlockRuntimeData* _child) const;
+		JitReg64 getJumpTarget(const JitReg64& _dst, const JitBlockRuntimeData* _child, bool _linkedEntry = false) const;
 
-		void jumpToChild(const JitBlockRuntimeData* _child, JitCondCode _cc = JitCondCode::kMaxValue) const;
+		void jumpToChild(const JitBlockRuntimeData* _child, JitCondCode _cc = JitCondCode::kMaxValue, bool _linkedEntry = false) const;
 		void jumpToOneOf(JitCondCode _ccTrue, const JitBlockRuntimeData* _childTrue, const JitBlockRuntimeData* _childFalse) const;
 
+		void selectEntryRegs(JitBlockRuntimeData& _rt);
+		void emitEntryRegsLoad(JitBlockRuntimeData& _rt);
+		void emitEntryRegsReceive(const JitBlockRuntimeData& _rt);
+		void emitEntryRegsPass(JitBlockRuntimeData& _rt, const JitBlockRuntimeData& _child);
+
+		void reserveEntryRegCarriers();
+		void releaseEntryRegCarriers();
+		void assertEntryRegCarriersUntouched() const;
+
+		void pushReturnAddress(TWord _pc);
+		void jumpIndirect(JitBlockRuntimeData& _rt, const JitReg32& _regPC, bool _isReturn);
+		void jumpToIndirectTarget(const JitReg64& _entry, const JitReg64& _key, const JitReg64& _temp, const asmjit::Label& _miss, const uint64_t& _hitCounter);
+		void increaseCounter(const uint64_t& _counter, const JitReg64& _scratch, const JitReg64& _temp);
+
 		JitRuntimeData& m_runtimeData;
 
 		JitEmitter& m_asm;
@@ -123,6 +143,9 @@ namespace dsp56k
 		JitDspRegs m_dspRegs;
 		JitDspRegPool m_dspRegPool;
 		Jitmem m_mem;
+		RegXMM m_entryRegCarrierTemp;	// holds the vector temp while it carries an entry register, acquiring a RegXMM in the meantime asserts
+		bool m_entryRegCarriersReserved = false;
+		bool m_lastModAluWasUsed = false;
 
 		JitConfig m_config;
 		JitBlockChain* m_chain = nullptr;
@@ -131,6 +154,7 @@ namespace dsp56k
 		bool m_shiftLocked = false;
 
 		JitDspMode* m_mode = nullptr;
+		JitDspMode m_chainMode;		// copy of the mode of the chain, tracks which mode bits are used by the generated code
 		JitBlockRuntimeData* m_currentJitBlockRuntimeData = nullptr;
 	};
 }
@@ -6,17 +6,21 @@
 #include "jitblock.h"
 #include "jitemitter.h"
 #include "jitoptimizer.h"
+#include "jitperfcounters.h"
 #include "jitprofilingsupport.h"
 #include "asmjit/core/jitruntime.h"
 #include "jitblockemitter.h"
 
+#include <bitset>
+
 namespace dsp56k
 {
 	void funcRun(JitDspPtr* _jit, TWord _pc) noexcept;
 	void funcCreate(JitDspPtr* _jit, TWord _pc) noexcept;
 	void funcRecreate(JitDspPtr* _jit, TWord _pc) noexcept;
+	void funcRunBreakpoint(JitDspPtr* _jit, TWord _pc) noexcept;
 
-	JitBlockChain::JitBlockChain(Jit& _jit, const JitDspMode& _mode, const size_t _usedFuncSize) : m_jit(_jit), m_mode(_mode)
+	JitBlockChain::JitBlockChain(Jit& _jit, const JitDspMode& _mode, const size_t _usedFuncSize) : m_jit(_jit), m_mode(_mode), m_activeMode(_mode)
 	{
 		m_logger.reset(new AsmJitLogger());
 		m_errorHandler.reset(new AsmJitErrorHandler());
@@ -25,7 +29,8 @@ namespace dsp56k
 		const auto& mem = _jit.dsp().memory();
 		const auto pSize = mem.sizeP();
 
-		m_jitFuncs.init(pSize, &funcCreate);
+		// the function table is read on every dispatch and is the only one that benefits from huge pages, the cache is mostly used while compiling
+		m_jitFuncs.init(pSize, &funcCreate, MmuArray<TJitFunc>::DefaultBlockSize, true);
 		m_jitFuncs.setResizedCallback([this]() { onFuncsResized(); });
 
 		m_jitCache.init(pSize, [](JitCacheEntry* _ptr, size_t _count)
@@ -40,6 +45,8 @@ namespace dsp56k
 
 	JitBlockChain::~JitBlockChain()
 	{
+		m_destructing = true;
+
 		for (size_t i = 0; i < m_jitCache.size(); ++i)
 		{
 			auto& e = m_jitCache[i];
@@ -83,11 +90,15 @@ namespace dsp56k
 			assert(m_jitCache[i].block == nullptr || m_jitCache[i].block == _block);
 			m_jitCache[i].block = _block;
 			if (i == first)
-				m_jitFuncs[i] = Jit::updateRunFunc(m_jitCache[i]);
+				m_jitFuncs[i] = m_jit.hasBreakpoint(first) ? &funcRunBreakpoint : Jit::updateRunFunc(m_jitCache[i]);
 			else
 				m_jitFuncs[i] = &funcRecreate;
 		}
 
+		++m_jit.getRuntimeData().m_funcsGeneration;
+
+		m_jit.getPMemGuard().protect(first, last - first);
+
 		m_jit.addLoop(_block->getInfo());
 	}
 
@@ -104,6 +115,8 @@ namespace dsp56k
 			m_jitFuncs[i] = &funcCreate;
 		}
 
+		++m_jit.getRuntimeData().m_funcsGeneration;
+
 		const auto& info = _block->getInfo();
 		m_jit.removeLoop(info);
 	}
@@ -161,6 +174,18 @@ namespace dsp56k
 			exec(_pc);
 	}
 
+	bool JitBlockChain::isCompatible(const JitDspMode& _mode) const
+	{
+		const auto relevantBits = m_jit.getConfig().shareChainsAcrossModes ? m_modeDependencies : ~0u;
+		return m_activeMode.isCompatible(_mode, relevantBits);
+	}
+
+	void JitBlockChain::activate(const JitDspMode& _mode)
+	{
+		assert(isCompatible(_mode));
+		m_activeMode = _mode;
+	}
+
 	void JitBlockChain::notifyPMemWrite(const TWord _addr, const bool _isCurrentChain)
 	{
 		destroy(_addr);
@@ -208,6 +233,12 @@ namespace dsp56k
 
 	void JitBlockChain::destroy(JitBlockRuntimeData* _block)
 	{
+		if(!m_destructing)
+		{
+			m_jit.getCompileStats().onBlockDestroyed();
+			m_destroyedPCs.insert(_block->getPCFirst());
+		}
+
 		destroyParents(_block);
 
 		unoccupyArea(_block);
@@ -289,6 +320,10 @@ namespace dsp56k
 		if (m_jit.isVolatileP(_pc))
 			return nullptr;
 
+		// blocks with a breakpoint are always entered via the function table, which traps them
+		if (m_jit.hasBreakpoint(_pc))
+			return nullptr;
+
 		if(!_allowCreate && _pc >= m_jitCache.size())
 			return nullptr;
 
@@ -361,9 +396,15 @@ namespace dsp56k
 
 		m_generatingBlocks.insert(std::make_pair(_pc, b));
 
+		// child blocks may be generated recursively while emitting, their time is subtracted
+		auto& compileStats = m_jit.getCompileStats();
+		const auto childNsBegin = compileStats.getTotals().getTotalNs();
+		const auto tBegin = JitCompileStats::now();
+
 		if(!emitter->block.emit(*b, this, _pc, m_jitCache, m_jit.getVolatileP(), m_jit.getLoops(), m_jit.getLoopEnds(), m_jit.getProfilingSupport()))
 		{
-			LOG("FATAL: code generation failed for PC " << HEX(_pc));
+			LOGL(ERROR, "FATAL: code generation failed for PC " << HEX(_pc));
+			compileStats.onBlockFailed();
 			m_jit.releaseBlockRuntimeData(b);
 			m_generatingBlocks.erase(_pc);
 			m_jit.releaseEmitter(emitter);
@@ -372,12 +413,20 @@ namespace dsp56k
 
 		m_generatingBlocks.erase(_pc);
 
+		const auto tEmitted = JitCompileStats::now();
+		const auto childNs = compileStats.getTotals().getTotalNs() - childNsBegin;
+
+		JitCompileStats::Block stats;
+
 		if(m_jit.getConfig().enableOptimizer)
 		{
-			JitOptimizer optimizer(emitter->emitter);
-			optimizer.optimize();
+			JitOptimizer optimizer(emitter->emitter, m_jit.getConfig().optimizeMemoryAccesses);
+			stats.optimizerChanges = optimizer.optimize();
+			m_memoryOptimizerStats += optimizer.getMemoryStats();
 		}
 
+		const auto tOptimized = JitCompileStats::now();
+
 		emitter->emitter.finalize();
 
 		TJitFunc func;
@@ -387,7 +436,8 @@ namespace dsp56k
 		if(err)
 		{
 			const auto* const errString = asmjit::DebugUtils::errorAsString(err);
-			LOG("JIT failed: " << err << " - " << errString << "PC " << HEX(_pc));
+			LOGL(ERROR, "JIT failed: " << err << " - " << errString << "PC " << HEX(_pc));
+			compileStats.onBlockFailed();
 			m_jit.releaseEmitter(emitter);
 			return nullptr;
 		}
@@ -395,12 +445,43 @@ namespace dsp56k
 		b->finalize(func, emitter->codeHolder);
 		m_codeSize += emitter->codeHolder.codeSize();
 
+		const auto tEnd = JitCompileStats::now();
+
+		stats.pc = _pc;
+		stats.pMemSize = b->getPMemSize();
+		stats.instructionCount = b->getInfo().instructionCount;
+		stats.codeBytes = emitter->codeHolder.codeSize();
+		stats.emitNs = tEmitted - tBegin > childNs ? tEmitted - tBegin - childNs : 0;
+		stats.optimizeNs = tOptimized - tEmitted;
+		stats.finalizeNs = tEnd - tOptimized;
+		stats.terminationReason = b->getInfo().terminationReason;
+
+		compileStats.addBlock(stats, m_destroyedPCs.erase(_pc) > 0);
+		m_modeDependencies |= b->getModeDependencies();
+
+		if(b->getChild() != g_invalidAddress && b->getChild() != g_dynamicAddress)
+		{
+			const auto spillsAvoided = std::bitset<64>(static_cast<uint64_t>(b->getResidentRegs())).count();
+
+			++m_residencyStats.linkedBlocks;
+
+			if(spillsAvoided)
+				++m_residencyStats.linkedEntries;
+
+			m_residencyStats.spillsAvoided += spillsAvoided;
+		}
+
 		m_jit.releaseEmitter(emitter);
 
 //		LOG("Total code size now " << (m_codeSize >> 10) << "kb");
 
 		occupyArea(b);
 
+		// needs to be done before the profiling support takes the instruction profiling info
+		auto* perfCounters = m_jit.getPerfCounters();
+		if (perfCounters)
+			perfCounters->addJitBlock(*b);
+
 		auto* profiling = m_jit.getProfilingSupport();
 		if (profiling)
 			profiling->addJitBlock(*b);
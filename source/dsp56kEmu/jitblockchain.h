@@ -1,10 +1,12 @@
 #pragma once
 
 #include <memory>
+#include <set>
 #include <vector>
 
 #include "jitcacheentry.h"
 #include "jitdspmode.h"
+#include "jitoptimizer.h"
 #include "jittypes.h"
 
 #include "dsp56kBase/mmuarray.h"
@@ -19,6 +21,14 @@ namespace dsp56k
 	class JitBlockChain final
 	{
 	public:
+		// accumulated per chain since its creation, blocks that are destroyed are not subtracted
+		struct ResidencyStats
+		{
+			uint64_t linkedBlocks = 0;		// blocks that jump to a child block directly
+			uint64_t linkedEntries = 0;		// of these, blocks that jump to the linked entry of their child, see JitBlockRuntimeData::getLinkedFunc()
+			uint64_t spillsAvoided = 0;		// DSP regs passed to a child block in host registers, each one saves a store/load pair at a block transition
+		};
+
 		JitBlockChain(Jit& _jit, const JitDspMode& _mode, size_t _usedFuncSize);
 		~JitBlockChain();
 
@@ -65,11 +75,32 @@ namespace dsp56k
 			_f(&getDspRegs(), _pc);
 		}
 
+		// mode that blocks are generated for
 		const JitDspMode& getMode() const
+		{
+			return m_activeMode;
+		}
+
+		const JitDspMode& getInitialMode() const
 		{
 			return m_mode;
 		}
 
+		// The generated code only depends on the mode bits that have been used while generating it. The chain can continue to be
+		// used if the DSP switches to a mode that differs in other bits only. Mode changes always return to the dispatcher
+		bool isCompatible(const JitDspMode& _mode) const;
+		void activate(const JitDspMode& _mode);
+
+		uint32_t getModeDependencies() const
+		{
+			return m_modeDependencies;
+		}
+
+		size_t getCodeSize() const
+		{
+			return m_codeSize;
+		}
+
 		void notifyPMemWrite(TWord _addr, bool _isCurrentChain);
 
 		size_t getFuncSize() const
@@ -89,6 +120,16 @@ namespace dsp56k
 
 		DspRegs& getDspRegs() const;
 
+		const ResidencyStats& getResidencyStats() const
+		{
+			return m_residencyStats;
+		}
+
+		const JitOptimizer::MemoryStats& getMemoryOptimizerStats() const
+		{
+			return m_memoryOptimizerStats;
+		}
+
 	private:
 
 		void destroyParents(JitBlockRuntimeData* _block);
@@ -109,15 +150,23 @@ namespace dsp56k
 
 		Jit& m_jit;
 		const JitDspMode m_mode;
+		JitDspMode m_activeMode;
+		uint32_t m_modeDependencies = 0;
 
 		MmuArray<JitCacheEntry> m_jitCache;
 		MmuArray<TJitFunc> m_jitFuncs;
 
 		std::map<TWord, JitBlockRuntimeData*> m_generatingBlocks;
 
+		// start addresses of destroyed blocks, to detect blocks that are generated again
+		std::set<TWord> m_destroyedPCs;
+		bool m_destructing = false;
+
 		std::unique_ptr<AsmJitLogger> m_logger;
 		std::unique_ptr<AsmJitErrorHandler> m_errorHandler;
 
 		size_t m_codeSize = 0;
+		ResidencyStats m_residencyStats;
+		JitOptimizer::MemoryStats m_memoryOptimizerStats;
 	};
 }
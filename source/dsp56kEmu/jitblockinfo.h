@@ -21,7 +21,8 @@ namespace dsp56k
 			LoopEnd,
 			InstructionLimit,
 			ModeChange,
-			WaitInstruction
+			WaitInstruction,
+			Breakpoint
 		};
 
 		enum class Flags
@@ -55,6 +56,7 @@ namespace dsp56k
 			writtenRegs = RegisterMask::None;
 			branchTarget = g_invalidAddress;
 			branchIsConditional = false;
+			branchIsSubroutineCall = false;
 			loopBegin = g_invalidAddress;
 			loopEnd = g_invalidAddress;
 		}
@@ -70,6 +72,7 @@ namespace dsp56k
 		RegisterMask writtenRegs = RegisterMask::None;
 		TWord branchTarget = g_invalidAddress;
 		bool branchIsConditional = false;
+		bool branchIsSubroutineCall = false;
 		TWord loopBegin = g_invalidAddress;
 		TWord loopEnd = g_invalidAddress;
 		uint32_t ccrRead = 0;
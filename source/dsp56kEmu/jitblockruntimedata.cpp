@@ -22,6 +22,11 @@ namespace dsp56k
 		m_func = _func;
 		m_codeSize = _codeHolder.codeSize();
 
+		if(m_entryRegCount)
+			m_linkedFunc = reinterpret_cast<TJitFunc>(reinterpret_cast<uintptr_t>(_func) + _codeHolder.labelOffset(m_linkedEntry));
+		else
+			m_linkedFunc = _func;
+
 		for (auto& pi : m_profilingInfo)
 		{
 			pi.codeOffset = _codeHolder.labelOffset(pi.labelBefore);
@@ -32,6 +37,8 @@ namespace dsp56k
 	void JitBlockRuntimeData::reset()
 	{
 		m_func = nullptr;
+		m_linkedFunc = nullptr;
+		m_linkedEntry.reset();
 
 		m_lastOpSize = 0;
 		m_singleOpWordA = 0;
@@ -45,6 +52,11 @@ namespace dsp56k
 		m_codeSize = 0;
 
 		m_info.reset();
+		m_residentRegs = RegisterMask::None;
+		m_entryRegs.fill(DspRegInvalid);
+		m_entryRegCount = 0;
+		m_modeDependencies = 0;
+		m_indirectBranchCache.fill({});
 
 		m_parents.clear();
 		m_generating = false;
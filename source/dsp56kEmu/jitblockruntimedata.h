@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <set>
 
 #include "interrupts.h"
@@ -17,6 +18,8 @@ namespace dsp56k
 		friend class JitBlock;
 
 		static constexpr TWord SingleOpCacheIgnoreWordB = 0xffffffff;
+		static constexpr uint32_t IndirectBranchCacheSize = 4;	// needs to be a power of two, entries are indexed by the lower bits of the target PC
+		static constexpr uint32_t MaxEntryRegs = 2;				// DSP registers that can be passed in host registers from a linked parent, see JitConfig::registerResidency
 
 		struct InstructionProfilingInfo
 		{
@@ -64,6 +67,12 @@ namespace dsp56k
 
 		const TJitFunc& getFunc() const { return m_func; }
 
+		// entry point for linked parent blocks, expects the entry registers in the carrier registers. Equal to getFunc() if there are no entry registers
+		const TJitFunc& getLinkedFunc() const { return m_linkedFunc; }
+
+		const std::array<PoolReg, MaxEntryRegs>& getEntryRegs() const { return m_entryRegs; }
+		uint32_t getEntryRegCount() const { return m_entryRegCount; }
+
 		TWord& getEncodedInstructionCount() { return m_encodedInstructionCount; }
 		TWord& getEncodedCycleCount() { return m_encodedCycles; }
 
@@ -72,12 +81,19 @@ namespace dsp56k
 
 		const JitBlockInfo& getInfo() const { return m_info; }
 
+		RegisterMask getResidentRegs() const { return m_residentRegs; }
+		uint32_t getModeDependencies() const { return m_modeDependencies; }
+
+		const std::array<JitIndirectTarget, IndirectBranchCacheSize>& getIndirectBranchCache() const { return m_indirectBranchCache; }
+
 		void reset();
 
 	private:
 		void addParent(TWord _pc);
 
 		TJitFunc m_func = nullptr;
+		TJitFunc m_linkedFunc = nullptr;
+		asmjit::Label m_linkedEntry;
 
 		TWord m_lastOpSize = 0;
 		TWord m_singleOpWordA = 0;
@@ -91,6 +107,11 @@ namespace dsp56k
 		size_t m_codeSize = 0;
 
 		JitBlockInfo m_info;
+		RegisterMask m_residentRegs = RegisterMask::None;	// DSP regs that this block passes to its linked child block in host registers
+		std::array<PoolReg, MaxEntryRegs> m_entryRegs{};	// DSP regs that this block receives in host registers when entered via m_linkedFunc
+		uint32_t m_entryRegCount = 0;
+		uint32_t m_modeDependencies = 0;					// JitDspMode bits that the generated code depends on
+		std::array<JitIndirectTarget, IndirectBranchCacheSize> m_indirectBranchCache;	// inline cache for the indirect branch at the end of the block, written by JIT code
 
 		std::set<TWord> m_parents;
 		bool m_generating = false;
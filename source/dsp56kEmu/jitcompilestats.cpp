@@ -0,0 +1,129 @@
+#include "jitcompilestats.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <vector>
+
+#include "dsp56kBase/logging.h"
+
+namespace dsp56k
+{
+	uint64_t JitCompileStats::now()
+	{
+		return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+	}
+
+	void JitCompileStats::addBlock(const Block& _block, const bool _recompiled)
+	{
+		++m_totals.blocks;
+		m_totals.instructions += _block.instructionCount;
+		m_totals.codeBytes += _block.codeBytes;
+		m_totals.optimizerChanges += _block.optimizerChanges;
+		m_totals.emitNs += _block.emitNs;
+		m_totals.optimizeNs += _block.optimizeNs;
+		m_totals.finalizeNs += _block.finalizeNs;
+
+		const auto reason = static_cast<size_t>(_block.terminationReason);
+		if(reason < TerminationReasonCount)
+			++m_totals.terminationReasons[reason];
+
+		auto& s = m_blocks[_block.pc];
+
+		s.last = _block;
+		++s.compileCount;
+		s.totalNs += _block.getTotalNs();
+
+		if(_recompiled)
+		{
+			++s.recompileCount;
+			++m_totals.recompiledBlocks;
+		}
+	}
+
+	void JitCompileStats::reset()
+	{
+		m_totals = {};
+		m_blocks.clear();
+	}
+
+	void JitCompileStats::writeReport(std::ostream& _out, const size_t _maxBlocks) const
+	{
+		const auto& t = m_totals;
+
+		auto ms = [](const uint64_t _ns) { return static_cast<double>(_ns) / 1000000.0; };
+
+		_out << std::fixed << std::setprecision(3);
+
+		_out << "JIT compile statistics" << std::endl;
+		_out << "Blocks " << std::dec << t.blocks << ", recompiled " << t.recompiledBlocks << ", destroyed " << t.destroyedBlocks
+			<< ", failed " << t.failedBlocks << ", all blocks destroyed " << t.destroyAllBlocks << " times" << std::endl;
+		_out << "DSP instructions " << t.instructions << ", code bytes " << t.codeBytes << ", optimizer changes " << t.optimizerChanges << std::endl;
+		_out << "Compile time " << ms(t.getTotalNs()) << " ms: emit " << ms(t.emitNs) << " ms, optimize " << ms(t.optimizeNs) << " ms, finalize " << ms(t.finalizeNs) << " ms";
+		if(t.blocks)
+			_out << ", " << (static_cast<double>(t.getTotalNs()) / static_cast<double>(t.blocks) / 1000.0) << " us per block";
+		_out << std::endl;
+
+		_out << "Block termination reasons:";
+		for(size_t i=0; i<TerminationReasonCount; ++i)
+		{
+			if(t.terminationReasons[i])
+				_out << ' ' << toString(static_cast<TerminationReason>(i)) << ' ' << t.terminationReasons[i];
+		}
+		_out << std::endl;
+
+		if(!_maxBlocks || m_blocks.empty())
+			return;
+
+		std::vector<std::pair<TWord, const PcStats*>> blocks;
+		blocks.reserve(m_blocks.size());
+
+		for (const auto& it : m_blocks)
+			blocks.emplace_back(it.first, &it.second);
+
+		std::sort(blocks.begin(), blocks.end(), [](const auto& _a, const auto& _b)
+		{
+			return _a.second->totalNs > _b.second->totalNs;
+		});
+
+		_out << std::endl;
+		_out << std::left << std::setw(10) << "block" << std::right
+			<< std::setw(8) << "words" << std::setw(8) << "instr" << std::setw(8) << "bytes" << std::setw(8) << "opt"
+			<< std::setw(10) << "compiles" << std::setw(10) << "recomp" << std::setw(12) << "total ms" << std::setw(12) << "last us"
+			<< "  termination" << std::endl;
+
+		for(size_t i=0; i<blocks.size() && i<_maxBlocks; ++i)
+		{
+			const auto& s = *blocks[i].second;
+			const auto& b = s.last;
+
+			_out << "P:" << HEXN(blocks[i].first, 6) << std::dec << std::setfill(' ') << "  "
+				<< std::setw(8) << b.pMemSize << std::setw(8) << b.instructionCount << std::setw(8) << b.codeBytes << std::setw(8) << b.optimizerChanges
+				<< std::setw(10) << s.compileCount << std::setw(10) << s.recompileCount
+				<< std::setw(12) << ms(s.totalNs) << std::setw(12) << (static_cast<double>(b.getTotalNs()) / 1000.0)
+				<< "  " << toString(b.terminationReason) << std::endl;
+		}
+	}
+
+	const char* JitCompileStats::toString(const TerminationReason _reason)
+	{
+		switch (_reason)
+		{
+		case TerminationReason::None:				return "None";
+		case TerminationReason::ExistingCode:		return "ExistingCode";
+		case TerminationReason::PcMax:				return "PcMax";
+		case TerminationReason::VolatileP:			return "VolatileP";
+		case TerminationReason::WriteLoopRegs:		return "WriteLoopRegs";
+		case TerminationReason::Branch:				return "Branch";
+		case TerminationReason::PopPC:				return "PopPC";
+		case TerminationReason::LoopBegin:			return "LoopBegin";
+		case TerminationReason::WritePMem:			return "WritePMem";
+		case TerminationReason::LoopEnd:			return "LoopEnd";
+		case TerminationReason::InstructionLimit:	return "InstructionLimit";
+		case TerminationReason::ModeChange:			return "ModeChange";
+		case TerminationReason::WaitInstruction:	return "WaitInstruction";
+		case TerminationReason::Breakpoint:			return "Breakpoint";
+		}
+		return "?";
+	}
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <ostream>
+
+#include "jitblockinfo.h"
+#include "types.h"
+
+namespace dsp56k
+{
+	// Cost of JIT code generation, per block start address and accumulated. Collected while blocks are generated, the overhead is
+	// a few clock reads per generated block. Survives Jit::destroyAllBlocks(), use reset() to start a new measurement
+	class JitCompileStats
+	{
+	public:
+		using TerminationReason = JitBlockInfo::TerminationReason;
+
+		static constexpr size_t TerminationReasonCount = static_cast<size_t>(TerminationReason::Breakpoint) + 1;
+
+		struct Block
+		{
+			TWord pc = 0;
+			TWord pMemSize = 0;
+			TWord instructionCount = 0;
+			size_t codeBytes = 0;
+			size_t optimizerChanges = 0;		// optimizations applied by the JitOptimizer
+			uint64_t emitNs = 0;				// without child blocks that have been generated recursively
+			uint64_t optimizeNs = 0;
+			uint64_t finalizeNs = 0;			// asmjit finalization + adding the code to the runtime
+			TerminationReason terminationReason = TerminationReason::None;
+
+			uint64_t getTotalNs() const { return emitNs + optimizeNs + finalizeNs; }
+		};
+
+		// most recent block generated at a PC plus values accumulated over all blocks generated at that PC
+		struct PcStats
+		{
+			Block last;
+			uint32_t compileCount = 0;			// includes blocks generated for different chains
+			uint32_t recompileCount = 0;		// blocks generated after a block at that PC was destroyed in the same chain
+			uint64_t totalNs = 0;
+		};
+
+		struct Totals
+		{
+			uint64_t blocks = 0;
+			uint64_t instructions = 0;
+			uint64_t codeBytes = 0;
+			uint64_t optimizerChanges = 0;
+			uint64_t emitNs = 0;
+			uint64_t optimizeNs = 0;
+			uint64_t finalizeNs = 0;
+			uint64_t recompiledBlocks = 0;
+			uint64_t destroyedBlocks = 0;		// without the ones that are destroyed because all blocks are destroyed at once
+			uint64_t failedBlocks = 0;
+			uint64_t destroyAllBlocks = 0;
+			std::array<uint64_t, TerminationReasonCount> terminationReasons{};
+
+			uint64_t getTotalNs() const { return emitNs + optimizeNs + finalizeNs; }
+		};
+
+		static uint64_t now();
+
+		void addBlock(const Block& _block, bool _recompiled);
+		void onBlockDestroyed()		{ ++m_totals.destroyedBlocks; }
+		void onBlockFailed()		{ ++m_totals.failedBlocks; }
+		void onDestroyAllBlocks()	{ ++m_totals.destroyAllBlocks; }
+
+		const Totals& getTotals() const { return m_totals; }
+		const std::map<TWord, PcStats>& getBlocks() const { return m_blocks; }
+
+		void reset();
+
+		// writes totals and the blocks with the highest accumulated compile time
+		void writeReport(std::ostream& _out, size_t _maxBlocks = 20) const;
+
+		static const char* toString(TerminationReason _reason);
+
+	private:
+		Totals m_totals;
+		std::map<TWord, PcStats> m_blocks;
+	};
+}
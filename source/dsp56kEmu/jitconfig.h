@@ -10,10 +10,33 @@ namespace dsp56k
 {
 	struct JitConfig
 	{
+		// only affects code that is compiled for an unknown addressing mode, bit-reverse updates are always emitted if the mode is known
 		bool aguSupportBitreverse = false;
 		bool aguSupportMultipleWrapModulo = true;
 		bool cacheSingleOpBlocks = true;
 		bool linkJitBlocks = true;
+
+		// indirect branches (rts, jmp (rn), ...) jump to their target block directly by using inline caches and a return address predictor instead of returning to the dispatcher
+		bool linkIndirectBranches = false;
+
+		// maximum number of indirect branches that are linked before the dispatcher is entered again, giving a time slice for interrupts/peripherals. Clamped to 1...4095
+		uint32_t maxLinkedIndirectBranches = 64;
+
+		// skip writebacks of DSP registers and CCR updates at the end of a block if the registers are overwritten on all paths before they are read
+		bool interBlockLiveness = false;
+
+		// blocks that are linked unconditionally pass up to two AGU registers (R/N) that the child block reads to the child in host registers
+		// instead of storing them to DspRegs and loading them again. Blocks get a second entry point for linked parents
+		bool registerResidency = false;
+
+		// detect writes to P memory that contains JIT code via host page protection instead of checking every P memory write in JIT code.
+		// Beneficial if P memory is only written while code is uploaded. Evaluated by Jit::setConfig() only, not per block
+		bool guardProgramMemory = false;
+
+		// continue to use the blocks of the current chain after a DSP mode change (M registers, SR scaling/rounding/...) if the
+		// generated code does not depend on the mode bits that changed instead of generating all code again for the new mode
+		bool shareChainsAcrossModes = false;
+
 		bool splitOpsByNops = false;
 		bool dynamicPeripheralAddressing = false;
 
@@ -35,6 +58,9 @@ namespace dsp56k
 		// enable JIT optimizer (dead code elimination + constant folding)
 		bool enableOptimizer = true;
 
+		// JIT optimizer: eliminate redundant loads/stores of DSP registers and memory within a block
+		bool optimizeMemoryAccesses = true;
+
 		// x86-64 only: Will issue int3() = breakpoint interrupt if a memory address is detected that points to peripherals but DPA is disabled
 		bool debugDynamicPeripheralAddressing = false;
 
@@ -28,17 +28,20 @@ namespace dsp56k
 
 	AddressingMode JitDspMode::getAddressingMode(const uint32_t _aguIndex) const
 	{
+		m_usedBits |= 0x3u << (_aguIndex << g_aguShift);
 		return static_cast<AddressingMode>((m_mode >> (_aguIndex << g_aguShift)) & 0x3);
 	}
 
 	uint32_t JitDspMode::getSR() const
 	{
+		m_usedBits |= SrModeChangeRelevantBits << 8;
 		return (m_mode >> 8) & 0xffff00;
 	}
 
 	uint32_t JitDspMode::testSR(const SRBit _bit) const
 	{
-		const auto sr = getSR();
+		m_usedBits |= (1u << _bit) << 8;
+		const auto sr = (m_mode >> 8) & 0xffff00;
 		return sr & (1<<_bit);
 	}
 
@@ -32,7 +32,15 @@ namespace dsp56k
 		uint32_t getSR() const;
 		uint32_t testSR(SRBit _bit) const;
 
+		// mode bits that have been queried via the getters above. Generated code only depends on these
+		uint32_t getUsedBits() const { return m_usedBits; }
+		void clearUsedBits() { m_usedBits = 0; }
+
+		// true if both modes are identical in all bits of _relevantBits
+		bool isCompatible(const JitDspMode& _m, const uint32_t _relevantBits) const { return ((m_mode ^ _m.m_mode) & _relevantBits) == 0; }
+
 	private:
 		uint32_t m_mode = Uninitialized;
+		mutable uint32_t m_usedBits = 0;
 	};
 }
@@ -321,6 +321,33 @@ namespace dsp56k
 		release(_reg);
 	}
 
+	uint32_t JitDspRegPool::discardDead(const RegisterMask _live)
+	{
+		// written DSP registers that are not read anymore do not need to be stored
+		constexpr PoolReg candidates[] =
+		{
+			DspR0, DspR1, DspR2, DspR3, DspR4, DspR5, DspR6, DspR7,
+			DspN0, DspN1, DspN2, DspN3, DspN4, DspN5, DspN6, DspN7,
+			DspA, DspB, DspX, DspY, DspX0, DspX1, DspY0, DspY1
+		};
+
+		uint32_t count = 0;
+
+		for (const auto reg : candidates)
+		{
+			if(!isWritten(reg) || isLocked(reg))
+				continue;
+
+			if((toRegisterMask(reg, false) & _live) != RegisterMask::None)
+				continue;
+
+			discard(reg);
+			++count;
+		}
+
+		return count;
+	}
+
 	void JitDspRegPool::debugStoreAll()
 	{
 		for(auto i=0; i<DspCount; ++i)
@@ -74,6 +74,7 @@ namespace dsp56k
 		void releaseByFlags(DspRegFlags _flags);
 
 		void discard(PoolReg _reg);
+		uint32_t discardDead(RegisterMask _live);
 
 		JitBlock& getBlock() { return m_block; }
 
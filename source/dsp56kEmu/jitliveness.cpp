@@ -0,0 +1,615 @@
+#include "jitliveness.h"
+
+#include <algorithm>
+
+#include "dsp.h"
+#include "interrupts.h"
+
+namespace dsp56k
+{
+	JitLiveness::JitLiveness(const DSP& _dsp) : m_dsp(_dsp)
+	{
+	}
+
+	JitLiveness::~JitLiveness()
+	{
+		m_abortScan = true;
+
+		if(m_scanThread)
+		{
+			m_scanThread->join();
+			m_scanThread.reset();
+		}
+	}
+
+	RegisterMask JitLiveness::getLiveOut(const TWord _pc, const TWord _memSize)
+	{
+		if(!update())
+			return AllLive;
+
+		// find the last instruction of the range, its successors are the successors of the range
+		TWord pc = _pc;
+
+		while(true)
+		{
+			const auto& node = getNode(pc);
+
+			if(pc + node.len >= _pc + _memSize)
+				break;
+
+			pc += node.len;
+		}
+
+		const auto& node = getNode(pc);
+
+		if(node.flags & NodeUnknownSuccessor)
+			return AllLive;
+
+		auto live = m_interruptLive;
+
+		forEachSuccessor(pc, node, [&](const TWord _succ)
+		{
+			live |= analyze(_succ);
+		});
+
+		return live;
+	}
+
+	RegisterMask JitLiveness::getLiveIn(const TWord _pc)
+	{
+		if(!update())
+			return AllLive;
+
+		return analyze(_pc);
+	}
+
+	void JitLiveness::registerBlock(const TWord _pc, const TWord _memSize, const RegisterMask _liveOut)
+	{
+		const auto key = std::make_pair(_pc, _memSize);
+
+		if(_liveOut == AllLive)
+			m_blocks.erase(key);
+		else
+			m_blocks[key] = _liveOut;
+	}
+
+	void JitLiveness::notifyProgramMemWrite(const TWord _addr, std::vector<TWord>& _invalidBlocks)
+	{
+		if(!m_scanned)
+		{
+			// the initial scan will see the new content if it has not been started yet
+			if(m_scanThread)
+				m_writesDuringScan.insert(_addr);
+			return;
+		}
+
+		// a write might modify the second word of a two-word instruction, too
+		auto changed = scan(_addr);
+
+		if(_addr > 0)
+			changed |= scan(_addr - 1);
+
+		if(changed)
+		{
+			// subroutine calls, loops and stack writes add successors to code anywhere in P memory, start from scratch
+			m_dirty = true;
+			recheckBlocks(true, _invalidBlocks);
+			return;
+		}
+
+		// analyzed instructions only matter if their registers, length or successors change. Patching an immediate does not invalidate anything
+		std::vector<TWord> changedNodes;
+
+		if(nodeChanged(_addr))
+			changedNodes.push_back(_addr);
+
+		if(_addr > 0 && nodeChanged(_addr - 1))
+			changedNodes.push_back(_addr - 1);
+
+		if(changedNodes.empty())
+			return;
+
+		// only the liveness of instructions that reach a modified instruction changes
+		collectAffected(changedNodes);
+
+		// the registers read by interrupt handlers are live everywhere
+		if(!m_affected.empty() && *m_affected.begin() < Vba_End)
+		{
+			m_dirty = true;
+			recheckBlocks(true, _invalidBlocks);
+			return;
+		}
+
+		for (const auto pc : m_affected)
+			m_liveIn.erase(pc);
+
+		for (const auto pc : changedNodes)
+			removeNode(pc);
+
+		recheckBlocks(false, _invalidBlocks);
+	}
+
+	void JitLiveness::removeNode(const TWord _pc)
+	{
+		const auto it = m_nodes.find(_pc);
+
+		if(it == m_nodes.end())
+			return;
+
+		forEachSuccessor(_pc, it->second, [&](const TWord _succ)
+		{
+			auto& preds = m_predecessors[_succ];
+			preds.erase(std::remove(preds.begin(), preds.end(), _pc), preds.end());
+		});
+
+		m_nodes.erase(it);
+	}
+
+	void JitLiveness::collectAffected(const std::vector<TWord>& _changedNodes)
+	{
+		m_affected.clear();
+		m_pending.assign(_changedNodes.begin(), _changedNodes.end());
+
+		while(!m_pending.empty())
+		{
+			const auto pc = m_pending.back();
+			m_pending.pop_back();
+
+			if(!m_affected.insert(pc).second)
+				continue;
+
+			const auto it = m_predecessors.find(pc);
+
+			if(it != m_predecessors.end())
+				m_pending.insert(m_pending.end(), it->second.begin(), it->second.end());
+		}
+	}
+
+	void JitLiveness::recheckBlocks(const bool _all, std::vector<TWord>& _invalidBlocks)
+	{
+		// blocks that discarded registers which are live now need to be recreated. Registers that became dead do not hurt
+		for(auto it = m_blocks.begin(); it != m_blocks.end();)
+		{
+			const auto pc = it->first.first;
+			const auto memSize = it->first.second;
+
+			if(!_all)
+			{
+				// the instructions of a block are nodes, the block is affected if any of them reaches a modified instruction
+				const auto itAffected = m_affected.lower_bound(pc);
+
+				if(itAffected == m_affected.end() || *itAffected >= pc + memSize)
+				{
+					++it;
+					continue;
+				}
+			}
+
+			++m_stats.recheckedBlocks;
+
+			const auto liveOut = getLiveOut(pc, memSize);
+
+			if(any(liveOut, ~it->second))
+			{
+				_invalidBlocks.push_back(pc);
+				++m_stats.invalidatedBlocks;
+				it = m_blocks.erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+	}
+
+	void JitLiveness::waitForScan()
+	{
+		if(m_scanned)
+			return;
+
+		if(!m_scanThread)
+			startScan();
+
+		finishScan();
+	}
+
+	bool JitLiveness::update()
+	{
+		if(!m_scanned)
+		{
+			if(!m_scanThread)
+				startScan();
+
+			if(!m_scanFinished)
+				return false;
+
+			finishScan();
+		}
+
+		if(!m_dirty)
+			return true;
+
+		m_dirty = false;
+
+		m_nodes.clear();
+		m_predecessors.clear();
+		m_liveIn.clear();
+
+		// Interrupts may occur between any two instructions, whatever an interrupt handler reads is live everywhere.
+		// An rti continues at the interrupted code, its liveness is already covered by the interrupted code itself
+		m_interruptLive = RegisterMask::None;
+
+		auto interruptLive = RegisterMask::None;
+
+		for(TWord vba = 0; vba < Vba_End; vba += 2)
+			interruptLive |= analyze(vba);
+
+		// results so far have been computed without nested interrupts
+		m_liveIn.clear();
+
+		m_interruptLive = interruptLive;
+
+		return true;
+	}
+
+	void JitLiveness::startScan()
+	{
+		// the scan only touches the containers that are filled by scan(), they are not accessed by the DSP thread before the scan has finished
+		m_scanThread.reset(new std::thread([this]()
+		{
+			const auto pSize = m_dsp.memory().sizeP();
+
+			for(TWord pc = 0; pc < pSize && !m_abortScan; ++pc)
+				scan(pc);
+
+			m_scanFinished = true;
+		}));
+	}
+
+	void JitLiveness::finishScan()
+	{
+		m_scanThread->join();
+		m_scanThread.reset();
+
+		m_scanned = true;
+
+		// the scan might have seen P memory before or after these writes
+		for (const auto addr : m_writesDuringScan)
+		{
+			scan(addr);
+			if(addr > 0)
+				scan(addr - 1);
+		}
+
+		m_writesDuringScan.clear();
+	}
+
+	bool JitLiveness::scan(const TWord _pc)
+	{
+		// determine what the instruction at _pc contributes, then update the containers if that differs from the previous scan
+		auto returnAddr = g_invalidAddress;
+		auto loop = std::make_pair(g_invalidAddress, g_invalidAddress);
+		bool stackWrite = false;
+
+		if(_pc < m_dsp.memory().sizeP())
+		{
+			TWord opA, opB;
+			m_dsp.memory().getOpcode(_pc, opA, opB);
+
+			Instruction instA, instB;
+			m_dsp.opcodes().getInstructionTypes(opA, instA, instB);
+
+			if(instA != Invalid || instB != Invalid)
+			{
+				const auto flags = Opcodes::getFlags(instA, instB);
+				const auto len = Opcodes::getOpcodeLength(opA, instA, instB);
+
+				if(flags & OpFlagPushPC)
+					returnAddr = _pc + len;
+
+				TWord loopEnd;
+
+				if(getLoopEndAddr(loopEnd, instA, _pc, opB))
+					loop = std::make_pair(loopEnd, _pc + len);
+
+				RegisterMask written, read;
+				Opcodes::getRegisters(written, read, opA, instA, instB);
+
+				stackWrite = any(written, RegisterMask::SSH | RegisterMask::SP) && !(flags & (OpFlagPushPC | OpFlagPopPC | OpFlagLoop | OpFlagRepImmediate | OpFlagRepDynamic));
+			}
+		}
+
+		bool changed = false;
+
+		{
+			const auto it = m_returnAddresses.find(_pc);
+			const auto prev = it != m_returnAddresses.end() ? it->second : g_invalidAddress;
+
+			if(prev != returnAddr)
+			{
+				if(it != m_returnAddresses.end())
+					m_returnAddresses.erase(it);
+				if(returnAddr != g_invalidAddress)
+					m_returnAddresses.insert(std::make_pair(_pc, returnAddr));
+				changed = true;
+			}
+		}
+
+		{
+			const auto it = m_loops.find(_pc);
+			const auto prev = it != m_loops.end() ? it->second : std::make_pair(g_invalidAddress, g_invalidAddress);
+
+			if(prev != loop)
+			{
+				if(it != m_loops.end())
+				{
+					const auto range = m_loopBackEdges.equal_range(prev.first);
+
+					for(auto itEdge = range.first; itEdge != range.second; ++itEdge)
+					{
+						if(itEdge->second == prev.second)
+						{
+							m_loopBackEdges.erase(itEdge);
+							break;
+						}
+					}
+
+					m_loops.erase(it);
+				}
+
+				if(loop.first != g_invalidAddress)
+				{
+					m_loops.insert(std::make_pair(_pc, loop));
+					m_loopBackEdges.insert(loop);
+				}
+				changed = true;
+			}
+		}
+
+		if(stackWrite != (m_stackWrites.find(_pc) != m_stackWrites.end()))
+		{
+			if(stackWrite)
+				m_stackWrites.insert(_pc);
+			else
+				m_stackWrites.erase(_pc);
+			changed = true;
+		}
+
+		return changed;
+	}
+
+	bool JitLiveness::nodeChanged(const TWord _pc) const
+	{
+		const auto it = m_nodes.find(_pc);
+
+		if(it == m_nodes.end())
+			return false;
+
+		return !(createNode(_pc) == it->second);
+	}
+
+	const JitLiveness::Node& JitLiveness::getNode(const TWord _pc)
+	{
+		const auto it = m_nodes.find(_pc);
+		if(it != m_nodes.end())
+			return it->second;
+
+		const auto& node = m_nodes.insert(std::make_pair(_pc, createNode(_pc))).first->second;
+
+		forEachSuccessor(_pc, node, [&](const TWord _succ)
+		{
+			m_predecessors[_succ].push_back(_pc);
+		});
+
+		return node;
+	}
+
+	JitLiveness::Node JitLiveness::createNode(const TWord _pc) const
+	{
+		Node node;
+
+		if(_pc >= m_dsp.memory().sizeP())
+		{
+			node.flags = NodeUnknownSuccessor;
+			return node;
+		}
+
+		TWord opA, opB;
+		m_dsp.memory().getOpcode(_pc, opA, opB);
+
+		Instruction instA, instB;
+		m_dsp.opcodes().getInstructionTypes(opA, instA, instB);
+
+		if(instA == Invalid && instB == Invalid)
+		{
+			node.flags = NodeUnknownSuccessor;
+			return node;
+		}
+
+		switch (instA)
+		{
+		case Debug:
+		case Debugcc:
+		case Illegal:
+		case Reset:
+		case Stop:
+		case Trap:
+		case Trapcc:
+			node.flags = NodeUnknownSuccessor;
+			return node;
+		default:;
+		}
+
+		const auto flags = Opcodes::getFlags(instA, instB);
+
+		node.len = std::max<TWord>(1, Opcodes::getOpcodeLength(opA, instA, instB));
+
+		RegisterMask written, read;
+		Opcodes::getRegisters(written, read, opA, instA, instB);
+
+		const auto isConditional = (flags & OpFlagCondition) || (instA != Invalid && (hasField(instA, Field_CCCC) || hasField(instA, Field_bbbbb)));
+
+		node.use = read;
+
+		// conditional writes might not happen, the previous value stays live
+		node.def = isConditional ? RegisterMask::None : written;
+
+		// CCR updates are partial and some instructions read the carry implicitly (adc, rol, div, ...)
+		if(flags & OpFlagCCR)
+			node.use |= RegisterMask::CCR;
+
+		// a subroutine call pushes the SR
+		if(flags & OpFlagPushPC)
+			node.use |= RegisterMask::SR;
+
+		if(flags & OpFlagPopPC)
+		{
+			// rti continues at the interrupted code
+			if(instA != Rti)
+				node.flags = m_stackWrites.empty() ? NodeReturn : NodeUnknownSuccessor;
+			return node;
+		}
+
+		if(flags & OpFlagBranch)
+		{
+			const auto target = getBranchTarget(instA, opA, opB, _pc);
+
+			if(target == g_dynamicAddress || target == g_invalidAddress)
+			{
+				node.flags = NodeUnknownSuccessor;
+				return node;
+			}
+
+			node.target = target;
+
+			// the code following a subroutine call is reached via rts
+			if(isConditional)
+				node.next = _pc + node.len;
+
+			return node;
+		}
+
+		node.next = _pc + node.len;
+
+		TWord loopEnd;
+
+		// a loop with a loop count of zero is skipped
+		if(getLoopEndAddr(loopEnd, instA, _pc, opB))
+			node.target = loopEnd;
+
+		return node;
+	}
+
+	template<typename TFunc> void JitLiveness::forEachSuccessor(const TWord _pc, const Node& _node, const TFunc& _func) const
+	{
+		if(_node.next != g_invalidAddress)
+			_func(_node.next);
+
+		if(_node.target != g_invalidAddress)
+			_func(_node.target);
+
+		if(_node.flags & NodeReturn)
+		{
+			for (const auto& it : m_returnAddresses)
+				_func(it.second);
+		}
+
+		// the last instruction of a loop continues at the beginning of the loop body
+		const auto range = m_loopBackEdges.equal_range(_pc + _node.len);
+
+		for(auto it = range.first; it != range.second; ++it)
+			_func(it->second);
+	}
+
+	RegisterMask JitLiveness::analyze(const TWord _pc)
+	{
+		{
+			const auto it = m_liveIn.find(_pc);
+			if(it != m_liveIn.end())
+				return it->second;
+		}
+
+		++m_stats.analyses;
+
+		// collect all instructions reachable from _pc that have not been analyzed yet
+		m_pending.clear();
+		m_order.clear();
+		m_local.clear();
+
+		m_pending.push_back(_pc);
+
+		while(!m_pending.empty())
+		{
+			const auto pc = m_pending.back();
+			m_pending.pop_back();
+
+			if(m_liveIn.find(pc) != m_liveIn.end() || !m_local.insert(std::make_pair(pc, RegisterMask::None)).second)
+				continue;
+
+			m_order.push_back(pc);
+
+			if(m_order.size() > MaxInstructions)
+			{
+				++m_stats.exceededLimit;
+				m_liveIn.insert(std::make_pair(_pc, AllLive));
+				return AllLive;
+			}
+
+			const auto& node = getNode(pc);
+
+			if(node.flags & NodeUnknownSuccessor)
+				continue;
+
+			forEachSuccessor(pc, node, [&](const TWord _succ)
+			{
+				m_pending.push_back(_succ);
+			});
+		}
+
+		m_stats.analyzedInstructions += m_order.size();
+
+		// backward data flow until nothing changes anymore. live in = use | (live out & ~def)
+		bool changed = true;
+
+		while(changed)
+		{
+			changed = false;
+
+			for(auto it = m_order.rbegin(); it != m_order.rend(); ++it)
+			{
+				const auto pc = *it;
+				const auto& node = getNode(pc);
+
+				auto liveOut = m_interruptLive;
+
+				if(node.flags & NodeUnknownSuccessor)
+				{
+					liveOut = AllLive;
+				}
+				else
+				{
+					forEachSuccessor(pc, node, [&](const TWord _succ)
+					{
+						const auto itLocal = m_local.find(_succ);
+						liveOut |= itLocal != m_local.end() ? itLocal->second : m_liveIn[_succ];
+					});
+				}
+
+				const auto liveIn = node.use | (liveOut & ~node.def);
+
+				auto& current = m_local[pc];
+
+				if(liveIn != current)
+				{
+					current = liveIn;
+					changed = true;
+				}
+			}
+		}
+
+		for (const auto& it : m_local)
+			m_liveIn.insert(it);
+
+		return m_local[_pc];
+	}
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <set>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "opcodeanalysis.h"
+#include "types.h"
+
+namespace dsp56k
+{
+	class DSP;
+
+	// Register liveness across JIT blocks. The control flow graph over P memory is built on demand, starting at the successors of a block.
+	// A register that is overwritten on all paths before it is read again is dead, a block does not need to write it back.
+	// An rts may return to any address that follows a subroutine call, interrupts may occur everywhere and add the registers read by the interrupt handlers.
+	// Subroutine calls, loops and stack writes are collected by a scan of the whole P memory that runs on a background thread, all registers are live until it has finished
+	class JitLiveness
+	{
+	public:
+		struct Stats
+		{
+			uint64_t analyses = 0;
+			uint64_t analyzedInstructions = 0;
+			uint64_t exceededLimit = 0;			// too much reachable code, all registers have been assumed to be live
+			uint64_t discardedWritebacks = 0;	// DSP register writebacks omitted by JIT blocks
+			uint64_t skippedCCRUpdates = 0;		// CCR updates omitted by JIT blocks
+			uint64_t invalidatedBlocks = 0;		// JIT blocks that omitted writebacks of registers that became live after a P memory write
+			uint64_t recheckedBlocks = 0;		// JIT blocks whose live out has been recomputed after a P memory write
+		};
+
+		static constexpr RegisterMask AllLive = static_cast<RegisterMask>(~0ull);
+
+		// maximum number of instructions that are analyzed at once
+		static constexpr size_t MaxInstructions = 0x10000;
+
+		explicit JitLiveness(const DSP& _dsp);
+		~JitLiveness();
+
+		JitLiveness(const JitLiveness&) = delete;
+		JitLiveness& operator = (const JitLiveness&) = delete;
+
+		// registers that might be read after the code in the range [_pc, _pc + _memSize) has been executed. AllLive while P memory is being scanned
+		RegisterMask getLiveOut(TWord _pc, TWord _memSize);
+		RegisterMask getLiveIn(TWord _pc);
+
+		// a JIT block [_pc, _pc + _memSize) that omits writebacks of registers that are not in _liveOut. AllLive removes the block
+		void registerBlock(TWord _pc, TWord _memSize, RegisterMask _liveOut);
+
+		// adds the start addresses of registered blocks to _invalidBlocks if the write makes registers live that they did not write back.
+		// Only blocks that reach the written instruction are checked, unless the write adds or removes a subroutine call, loop or stack write
+		void notifyProgramMemWrite(TWord _addr, std::vector<TWord>& _invalidBlocks);
+
+		bool isScanFinished() const { return m_scanned; }
+
+		// blocks until the scan of P memory has finished, starts it if needed
+		void waitForScan();
+
+		Stats& getStats() { return m_stats; }
+		const Stats& getStats() const { return m_stats; }
+
+	private:
+		enum NodeFlags : uint32_t
+		{
+			NodeUnknownSuccessor	= 0x01,		// dynamic branch target, trap, illegal instruction, ...
+			NodeReturn				= 0x02,		// rts, continues at any return address
+		};
+
+		struct Node
+		{
+			RegisterMask use = RegisterMask::None;	// read before written
+			RegisterMask def = RegisterMask::None;	// always written
+			TWord len = 1;
+			TWord next = g_invalidAddress;
+			TWord target = g_invalidAddress;
+			uint32_t flags = 0;
+
+			bool operator == (const Node& _n) const
+			{
+				return use == _n.use && def == _n.def && len == _n.len && next == _n.next && target == _n.target && flags == _n.flags;
+			}
+		};
+
+		bool update();
+		void startScan();
+		void finishScan();
+		bool scan(TWord _pc);
+		bool nodeChanged(TWord _pc) const;
+		void removeNode(TWord _pc);
+		void collectAffected(const std::vector<TWord>& _changedNodes);
+		void recheckBlocks(bool _all, std::vector<TWord>& _invalidBlocks);
+
+		const Node& getNode(TWord _pc);
+		Node createNode(TWord _pc) const;
+
+		template<typename TFunc> void forEachSuccessor(TWord _pc, const Node& _node, const TFunc& _func) const;
+
+		RegisterMask analyze(TWord _pc);
+
+		const DSP& m_dsp;
+
+		std::unique_ptr<std::thread> m_scanThread;
+		std::atomic<bool> m_scanFinished{false};
+		std::atomic<bool> m_abortScan{false};
+		std::set<TWord> m_writesDuringScan;
+
+		bool m_scanned = false;
+		bool m_dirty = true;
+
+		// results of the linear scan of P memory, keyed by the address of the instruction
+		std::map<TWord, TWord> m_returnAddresses;			// subroutine call => return address
+		std::map<TWord, std::pair<TWord, TWord>> m_loops;	// do => first address after the loop, first address of the loop body
+		std::multimap<TWord, TWord> m_loopBackEdges;		// first address after the loop => first address of the loop body
+		std::set<TWord> m_stackWrites;						// instructions that write to SSH or SP, return addresses become unpredictable
+
+		std::map<std::pair<TWord, TWord>, RegisterMask> m_blocks;	// [pc, memSize) => live out of registered blocks
+
+		std::unordered_map<TWord, Node> m_nodes;
+		std::unordered_map<TWord, std::vector<TWord>> m_predecessors;	// successor => nodes that have been created with it as a successor
+		std::set<TWord> m_affected;										// nodes that reach an instruction modified by a P memory write
+		std::unordered_map<TWord, RegisterMask> m_liveIn;
+
+		RegisterMask m_interruptLive = RegisterMask::None;
+
+		std::vector<TWord> m_pending;
+		std::vector<TWord> m_order;
+		std::unordered_map<TWord, RegisterMask> m_local;
+
+		Stats m_stats;
+	};
+}
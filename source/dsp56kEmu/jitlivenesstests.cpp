@@ -0,0 +1,361 @@
+#include "jitlivenesstests.h"
+
+#include <sstream>
+
+#include "dsp.h"
+#include "interrupts.h"
+#include "jitliveness.h"
+#include "memory.h"
+#include "peripherals.h"
+#include "unittests.h"
+
+namespace dsp56k
+{
+	namespace
+	{
+		constexpr TWord MemSize = 0x4000;
+
+		struct Instance
+		{
+			Instance() : mem(validator, MemSize), dsp(mem, &periphX, &periphY)
+			{
+			}
+
+			DefaultMemoryValidator validator;
+			Memory mem;
+			Peripherals56362 periphX;
+			Peripherals56367 periphY;
+			DSP dsp;
+		};
+
+		std::string hex(const TWord _value)
+		{
+			std::stringstream ss;
+			ss << '$' << std::hex << _value;
+			return ss.str();
+		}
+
+		bool isLive(const RegisterMask _live, const RegisterMask _reg)
+		{
+			return any(_live, _reg);
+		}
+	}
+
+	JitLivenessTests::JitLivenessTests()
+	{
+		LOG("Running JIT Liveness Tests...");
+
+		testCallReturn();
+		testInterrupts();
+		testProgramWrite();
+		testAffectedBlocks();
+		testBlockInvalidation();
+
+		LOG("JIT Liveness Tests finished.");
+	}
+
+	void JitLivenessTests::testCallReturn()
+	{
+		Instance inst;
+		auto& dsp = inst.dsp;
+
+		emitVectors(dsp);
+
+		// main: a is read after the call, b is overwritten by the subroutine and again after the call
+		auto pc = emitToMemory(dsp, "move #1,a", 0x100);
+		const auto jsrEnd = emitToMemory(dsp, "jsr $200", pc);
+		pc = emitToMemory(dsp, "move a,x:$10", jsrEnd);
+		pc = emitToMemory(dsp, "move #3,b", pc);
+		emitToMemory(dsp, "jmp " + hex(pc), pc);
+
+		// subroutine
+		pc = emitToMemory(dsp, "move #2,b", 0x200);
+		const auto subEnd = emitToMemory(dsp, "rts", pc);
+
+		JitLiveness liveness(dsp);
+		liveness.waitForScan();
+		verify(liveness.isScanFinished());
+
+		// [$100, jsr] continues at the subroutine, which overwrites b before returning
+		const auto callOut = liveness.getLiveOut(0x100, jsrEnd - 0x100);
+		verify(callOut != JitLiveness::AllLive);
+		verify(isLive(callOut, RegisterMask::A));
+		verify(!isLive(callOut, RegisterMask::B));
+		verify(!isLive(callOut, RegisterMask::X0));
+
+		// the rts returns behind the jsr where a is read and b is overwritten
+		const auto returnOut = liveness.getLiveOut(0x200, subEnd - 0x200);
+		verify(isLive(returnOut, RegisterMask::A));
+		verify(!isLive(returnOut, RegisterMask::B));
+
+		verify(!isLive(liveness.getLiveIn(0x200), RegisterMask::B));
+		verify(isLive(liveness.getLiveIn(jsrEnd), RegisterMask::A));
+		verify(!isLive(liveness.getLiveIn(0x100), RegisterMask::A));
+	}
+
+	void JitLivenessTests::testInterrupts()
+	{
+		Instance inst;
+		auto& dsp = inst.dsp;
+
+		emitVectors(dsp);
+
+		auto pc = emitToMemory(dsp, "move #1,x0", 0x100);
+		pc = emitToMemory(dsp, "move #2,y0", pc);
+		const auto blockEnd = pc;
+		emitToMemory(dsp, "jmp $100", pc);
+
+		{
+			JitLiveness liveness(dsp);
+			liveness.waitForScan();
+
+			// the program overwrites x0 and y0 before reading them
+			const auto live = liveness.getLiveOut(0x100, blockEnd - 0x100);
+			verify(!isLive(live, RegisterMask::X0));
+			verify(!isLive(live, RegisterMask::Y0));
+		}
+
+		// a handler that reads x0 makes it live everywhere. y0 is written before it is read
+		emitToMemory(dsp, "jsr $300", Vba_IRQA);
+		pc = emitToMemory(dsp, "move x0,x:$10", 0x300);
+		pc = emitToMemory(dsp, "move #3,y0", pc);
+		pc = emitToMemory(dsp, "move y0,x:$11", pc);
+		emitToMemory(dsp, "rti", pc);
+
+		JitLiveness liveness(dsp);
+		liveness.waitForScan();
+
+		const auto live = liveness.getLiveOut(0x100, blockEnd - 0x100);
+		verify(isLive(live, RegisterMask::X0));
+		verify(!isLive(live, RegisterMask::Y0));
+
+		// interrupts are taken after an instruction, the one at $100 overwrites x0 itself
+		verify(isLive(liveness.getLiveIn(blockEnd), RegisterMask::X0));
+		verify(!isLive(liveness.getLiveIn(0x100), RegisterMask::X0));
+	}
+
+	void JitLivenessTests::testProgramWrite()
+	{
+		Instance inst;
+		auto& dsp = inst.dsp;
+
+		emitVectors(dsp);
+
+		auto pc = emitToMemory(dsp, "move #1,a", 0x100);
+		const auto jsrEnd = emitToMemory(dsp, "jsr $200", pc);
+		pc = emitToMemory(dsp, "move a,x:$10", jsrEnd);
+		pc = emitToMemory(dsp, "move #3,b", pc);
+		emitToMemory(dsp, "jmp " + hex(pc), pc);
+
+		pc = emitToMemory(dsp, "move #2,b", 0x200);
+		const auto subEnd = emitToMemory(dsp, "rts", pc);
+
+		JitLiveness liveness(dsp);
+		liveness.waitForScan();
+
+		const auto callOut = liveness.getLiveOut(0x100, jsrEnd - 0x100);
+		const auto returnOut = liveness.getLiveOut(0x200, subEnd - 0x200);
+		verify(!isLive(returnOut, RegisterMask::B));
+
+		liveness.registerBlock(0x100, jsrEnd - 0x100, callOut);
+		liveness.registerBlock(0x200, subEnd - 0x200, returnOut);
+
+		std::vector<TWord> invalid;
+
+		auto write = [&](const std::string& _text, const TWord _pc)
+		{
+			const auto next = emitToMemory(dsp, _text, _pc);
+			for(TWord i=_pc; i<next; ++i)
+				liveness.notifyProgramMemWrite(i, invalid);
+			return next;
+		};
+
+		// patching an immediate does not change the registers of the instruction
+		write("move #5,a", 0x100);
+		verify(invalid.empty());
+
+		// neither does unreachable code
+		const auto callerLen = getWordCount("jsr $200");
+		pc = write("move b,x:$11", 0x180 + callerLen);
+		write("jmp " + hex(pc), pc);
+		verify(invalid.empty());
+
+		// a second call site reads b after the rts, the subroutine block needs to write it back now.
+		// The liveness of the first caller does not change, the subroutine still overwrites b
+		write("jsr $200", 0x180);
+		verify(invalid.size() == 1);
+		verify(invalid.front() == 0x200);
+		verify(liveness.getStats().invalidatedBlocks == 1);
+
+		verify(isLive(liveness.getLiveOut(0x200, subEnd - 0x200), RegisterMask::B));
+		verify(liveness.getLiveOut(0x100, jsrEnd - 0x100) == callOut);
+
+		// an invalidated block is forgotten until it is registered again
+		invalid.clear();
+		write("move #2,y0", 0x180 + callerLen);
+		verify(invalid.empty());
+	}
+
+	void JitLivenessTests::testAffectedBlocks()
+	{
+		Instance inst;
+		auto& dsp = inst.dsp;
+
+		emitVectors(dsp);
+
+		// independent pieces of code, each one has a block that does not write back x0 as it is overwritten by its successor
+		constexpr TWord Count = 32;
+		constexpr TWord Stride = 0x10;
+		constexpr TWord Base = 0x100;
+
+		for(TWord i=0; i<Count; ++i)
+		{
+			const auto base = Base + i * Stride;
+
+			auto pc = emitToMemory(dsp, "move #1,x0", base);
+			emitToMemory(dsp, "jmp " + hex(base + 4), pc);
+			pc = emitToMemory(dsp, "move #2,x0", base + 4);
+			pc = emitToMemory(dsp, "move x0,x:$10", pc);
+			emitToMemory(dsp, "jmp " + hex(pc), pc);
+		}
+
+		JitLiveness liveness(dsp);
+		liveness.waitForScan();
+
+		for(TWord i=0; i<Count; ++i)
+		{
+			const auto base = Base + i * Stride;
+			const auto live = liveness.getLiveOut(base, 2);
+			verify(!isLive(live, RegisterMask::X0));
+			liveness.registerBlock(base, 2, live);
+		}
+
+		std::vector<TWord> invalid;
+
+		auto write = [&](const std::string& _text, const TWord _pc)
+		{
+			const auto next = emitToMemory(dsp, _text, _pc);
+			for(TWord i=_pc; i<next; ++i)
+				liveness.notifyProgramMemWrite(i, invalid);
+		};
+
+		// x0 is read after the first block of one piece of code now. Only that block reaches the modified instruction and is checked again
+		constexpr TWord Modified = 5;
+
+		const auto analyzedBefore = liveness.getStats().analyzedInstructions;
+
+		write("move x0,x:$11", Base + Modified * Stride + 4);
+
+		verify(invalid.size() == 1);
+		verify(invalid.front() == Base + Modified * Stride);
+		verify(liveness.getStats().recheckedBlocks == 1);
+		verify(liveness.getStats().invalidatedBlocks == 1);
+
+		// the liveness of the others is still known, only the code around the write has been analyzed again
+		verify(liveness.getStats().analyzedInstructions - analyzedBefore < 2 * Stride);
+
+		for(TWord i=0; i<Count; ++i)
+		{
+			const auto live = liveness.getLiveOut(Base + i * Stride, 2);
+			verify(isLive(live, RegisterMask::X0) == (i == Modified));
+		}
+
+		// instructions that are not reached by any registered block do not recheck any
+		invalid.clear();
+		write("move #3,y0", Base + Modified * Stride + 8);
+		verify(invalid.empty());
+		verify(liveness.getStats().recheckedBlocks == 1);
+
+		// a new subroutine call adds successors everywhere, all blocks are checked again
+		write("jsr " + hex(Base + 2 * Stride), Base + Count * Stride);
+		verify(invalid.empty());
+		verify(liveness.getStats().recheckedBlocks == Count);
+	}
+
+	void JitLivenessTests::testBlockInvalidation()
+	{
+		if(!g_useJIT)
+			return;
+
+		Instance inst;
+		auto& dsp = inst.dsp;
+
+		emitVectors(dsp);
+
+		auto& jit = dsp.getJit();
+
+		auto config = jit.getConfig();
+		config.interBlockLiveness = true;
+		jit.setConfig(config);
+
+		// x0 is overwritten before it is read, the first block does not need to write it back
+		emitToMemory(dsp, "move #>$111111,x0", 0x100);
+		emitToMemory(dsp, "jmp $110", 0x102);
+		emitToMemory(dsp, "move #>$222222,x0", 0x110);
+		emitToMemory(dsp, "jmp $120", 0x112);
+		emitToMemory(dsp, "move x0,x:$10", 0x120);
+		const auto endAddr = emitToMemory(dsp, "move x0,x:$11", 0x121);
+		emitToMemory(dsp, "jmp " + hex(endAddr), endAddr);
+
+		auto& liveness = jit.getLiveness();
+		liveness.waitForScan();
+
+		auto run = [&]()
+		{
+			dsp.setPC(0x100);
+
+			for(uint32_t i=0; i<100 && dsp.getPC().toWord() != endAddr; ++i)
+				dsp.execJit();
+
+			verify(dsp.getPC().toWord() == endAddr);
+		};
+
+		run();
+
+		verify(dsp.memory().get(MemArea_X, 0x10) == 0x222222);
+		verify(liveness.getStats().discardedWritebacks > 0);
+
+		// now x0 is read after the first block, it needs to be recompiled to write back x0
+		const auto invalidatedBefore = liveness.getStats().invalidatedBlocks;
+
+		dsp.memWriteP(0x110, m_assembler.assemble("move x0,x:$11").word[0]);
+		dsp.memWriteP(0x111, 0);	// nop, replaces the immediate
+
+		verify(liveness.getStats().invalidatedBlocks > invalidatedBefore);
+
+		dsp.memory().set(MemArea_X, 0x11, 0);
+
+		run();
+
+		verify(dsp.memory().get(MemArea_X, 0x11) == 0x111111);
+		verify(dsp.memory().get(MemArea_X, 0x10) == 0x111111);
+	}
+
+	void JitLivenessTests::emitVectors(DSP& _dsp)
+	{
+		for(TWord vba = 0; vba < Vba_End; vba += 2)
+		{
+			emitToMemory(_dsp, "rti", vba);
+			emitToMemory(_dsp, "nop", vba + 1);
+		}
+	}
+
+	TWord JitLivenessTests::emitToMemory(DSP& _dsp, const std::string& _text, const TWord _pc)
+	{
+		const auto result = m_assembler.assemble(_text.c_str());
+		if(!result.success())
+			throw std::string("Assembly failed for: ") + _text;
+
+		auto& mem = _dsp.memory();
+
+		for(uint32_t i=0; i<result.wordCount; ++i)
+			mem.set(MemArea_P, _pc + i, result.word[i]);
+
+		return _pc + result.wordCount;
+	}
+
+	uint32_t JitLivenessTests::getWordCount(const std::string& _text)
+	{
+		return m_assembler.assemble(_text.c_str()).wordCount;
+	}
+}
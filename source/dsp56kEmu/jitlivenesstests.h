@@ -0,0 +1,33 @@
+#pragma once
+
+#include <string>
+
+#include "assembler.h"
+#include "types.h"
+
+namespace dsp56k
+{
+	class DSP;
+
+	// Tests for JitLiveness: registers that are live after blocks that call or return from subroutines, registers read by interrupt handlers
+	// and the invalidation of JIT blocks if a write to P memory makes registers live that they did not write back
+	class JitLivenessTests
+	{
+	public:
+		JitLivenessTests();
+
+	private:
+		void testCallReturn();
+		void testInterrupts();
+		void testProgramWrite();
+		void testAffectedBlocks();
+		void testBlockInvalidation();
+
+		// fills the interrupt vector table with rti, unused vectors do not read any registers
+		void emitVectors(DSP& _dsp);
+		TWord emitToMemory(DSP& _dsp, const std::string& _text, TWord _pc);
+		uint32_t getWordCount(const std::string& _text);
+
+		Assembler m_assembler;
+	};
+}
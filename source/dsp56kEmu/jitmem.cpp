@@ -305,6 +305,8 @@ namespace dsp56k
 
 	Jitmem::MemoryRef Jitmem::readDspMemory(DspValue& _dst, const EMemArea _area, const JitRegGP& _offset, MemoryRef&& _ref) const
 	{
+		sampleAccess(_area, _offset, false);
+
 		const SkipLabel skip(m_block.asm_());
 
 		if (!_dst.isRegValid())
@@ -340,6 +342,9 @@ namespace dsp56k
 
 	void Jitmem::readDspMemory(DspValue& _dstX, DspValue& _dstY, const JitRegGP& _offset) const
 	{
+		sampleAccess(MemArea_X, _offset, false);
+		sampleAccess(MemArea_Y, _offset, false);
+
 		if (!_dstX.isRegValid())
 			_dstX.temp(DspValue::Memory);
 		if (!_dstY.isRegValid())
@@ -375,6 +380,9 @@ namespace dsp56k
 		if (_offset >= m_block.dsp().memory().sizeXY())
 			return noRef();
 
+		sampleAccess(MemArea_X, _offset, false);
+		sampleAccess(MemArea_Y, _offset, false);
+
 		if (!_dstX.isRegValid())
 			_dstX.temp(DspValue::Memory);
 		if (!_dstY.isRegValid())
@@ -395,6 +403,8 @@ namespace dsp56k
 
 	Jitmem::MemoryRef Jitmem::readDspMemory(DspValue& _dst, EMemArea _area, TWord _offset, MemoryRef&& _ref) const
 	{
+		sampleAccess(_area, _offset, false);
+
 		const auto& mem = m_block.dsp().memory();
 		mem.memTranslateAddress(_area, _offset);
 
@@ -460,67 +470,120 @@ namespace dsp56k
 		_dsp->memory().dspWrite(a, o, _value);
 	}
 
-	Jitmem::MemoryRef Jitmem::writeDspMemory(const EMemArea _area, const JitRegGP& _offset, const DspValue& _src, MemoryRef&& _ref) const
+	void Jitmem::callDspMemWrite(const EMemArea _area, const JitRegGP& _offset, const DspValue& _src) const
 	{
-		if(m_block.getConfig().memoryWritesCallCpp || g_debugMemoryWrites)
-		{
-			const FuncArg r0(m_block, 0);
-			const FuncArg r1(m_block, 1);
-			const FuncArg r2(m_block, 2);
-			const FuncArg r3(m_block, 3);
+		const FuncArg r0(m_block, 0);
+		const FuncArg r1(m_block, 1);
+		const FuncArg r2(m_block, 2);
+		const FuncArg r3(m_block, 3);
 
-			if(_src.isImm24())
+		if(_src.isImm24())
+		{
+			m_block.asm_().mov(r32(r2), r32(_offset));
+			makeDspPtr(r0);
+			m_block.asm_().mov(r32(r1), asmjit::Imm(_area));
+			m_block.asm_().mov(r32(r3), asmjit::Imm(_src.imm24()));
+		}
+		else
+		{
+			if(m_block.stack().isUsedFuncArg(_offset) && m_block.stack().isUsedFuncArg(_src.get()))
+			{
+				const RegScratch t(m_block);
+				m_block.asm_().mov(r32(t), r32(_src.get()));
+				m_block.asm_().mov(r32(r2), r32(_offset));
+				m_block.asm_().mov(r32(r3), r32(t));
+			}
+			else if(m_block.stack().isUsedFuncArg(_src.get()))
 			{
+				m_block.asm_().mov(r32(r3), r32(_src.get()));
 				m_block.asm_().mov(r32(r2), r32(_offset));
-				makeDspPtr(r0);
-				m_block.asm_().mov(r32(r1), asmjit::Imm(_area));
-				m_block.asm_().mov(r32(r3), asmjit::Imm(_src.imm24()));
 			}
 			else
 			{
-				if(m_block.stack().isUsedFuncArg(_offset) && m_block.stack().isUsedFuncArg(_src.get()))
-				{
-					const RegScratch t(m_block);
-					m_block.asm_().mov(r32(t), r32(_src.get()));
-					m_block.asm_().mov(r32(r2), r32(_offset));
-					m_block.asm_().mov(r32(r3), r32(t));
-				}
-				else if(m_block.stack().isUsedFuncArg(_src.get()))
-				{
-					m_block.asm_().mov(r32(r3), r32(_src.get()));
-					m_block.asm_().mov(r32(r2), r32(_offset));
-				}
-				else
-				{
-					m_block.asm_().mov(r32(r2), r32(_offset));
-					m_block.asm_().mov(r32(r3), r32(_src.get()));
-				}
-
-				makeDspPtr(r0);
-				m_block.asm_().mov(r32(r1), asmjit::Imm(_area));
+				m_block.asm_().mov(r32(r2), r32(_offset));
+				m_block.asm_().mov(r32(r3), r32(_src.get()));
 			}
 
-			m_block.stack().call(asmjit::func_as_ptr(&callDSPMemWrite));
+			makeDspPtr(r0);
+			m_block.asm_().mov(r32(r1), asmjit::Imm(_area));
+		}
+
+		m_block.stack().call(asmjit::func_as_ptr(&callDSPMemWrite));
+	}
 
+	Jitmem::MemoryRef Jitmem::writeDspMemory(const EMemArea _area, const JitRegGP& _offset, const DspValue& _src, MemoryRef&& _ref) const
+	{
+		if(writesCallCpp())
+		{
+			callDspMemWrite(_area, _offset, _src);
 			return std::move(_ref);
 		}
-		else
+
+		if(hasWatchpoints(_area))
+			return writeDspMemoryGuarded(_area, _offset, _src, std::move(_ref));
+
+		sampleAccess(_area, _offset, true);
+
+		DspValue tempXY(m_block);
+		auto p = getMemAreaPtr(tempXY, _area, _offset, std::move(_ref));
+
+		const SkipLabel skip(m_block.asm_());
+
+		if(!hasMmuSupport())
 		{
-			DspValue tempXY(m_block);
-			auto p = getMemAreaPtr(tempXY, _area, _offset, std::move(_ref));
+			m_block.asm_().cmp(r32(_offset), asmjit::Imm(m_block.dsp().memory().size(_area)));
+			m_block.asm_().jge(skip.get());
+		}
 
-			const SkipLabel skip(m_block.asm_());
+		writeDspMemory(p, _src);
+		markPageDirty(_area, _offset);
 
-			if(!hasMmuSupport())
-			{
-				m_block.asm_().cmp(r32(_offset), asmjit::Imm(m_block.dsp().memory().size(_area)));
-				m_block.asm_().jge(skip.get());
-			}
+		return p;
+	}
 
-			writeDspMemory(p, _src);
+	Jitmem::MemoryRef Jitmem::writeDspMemoryGuarded(const EMemArea _area, const JitRegGP& _offset, const DspValue& _src, MemoryRef&& _ref) const
+	{
+		// the address is not known at compile time. Writes that may hit a watchpoint are done via C++ to notify the debugger,
+		// all others take the fast path. The range check is done signed, DSP addresses are 24 bits only
+		const auto& jit = m_block.dsp().getJit();
 
-			return p;
+		const SkipLabel skip(m_block.asm_());
+		const auto fastPath = m_block.asm_().newLabel();
+
+		{
+			const RegGP limit(m_block);
+
+			m_block.asm_().mov(r32(limit), asmjit::Imm(jit.getWatchpointMin(_area)));
+			m_block.asm_().cmp(r32(limit), r32(_offset));
+			m_block.asm_().jg(fastPath);
+
+			m_block.asm_().mov(r32(limit), asmjit::Imm(jit.getWatchpointMax(_area)));
+			m_block.asm_().cmp(r32(_offset), r32(limit));
+			m_block.asm_().jg(fastPath);
+		}
+
+		callDspMemWrite(_area, _offset, _src);
+		m_block.asm_().jmp(skip.get());
+
+		m_block.asm_().bind(fastPath);
+
+		// writes via C++ are sampled by Memory::dspWrite()
+		sampleAccess(_area, _offset, true);
+
+		// the memory ref is only valid on the fast path, do not hand it to the caller
+		DspValue tempXY(m_block);
+		const auto p = getMemAreaPtr(tempXY, _area, _offset, noRef());
+
+		if(!hasMmuSupport())
+		{
+			m_block.asm_().cmp(r32(_offset), asmjit::Imm(m_block.dsp().memory().size(_area)));
+			m_block.asm_().jge(skip.get());
 		}
+
+		writeDspMemory(p, _src);
+		markPageDirty(_area, _offset);
+
+		return std::move(_ref);
 	}
 
 	Jitmem::MemoryRef Jitmem::writeDspMemory(EMemArea _area, const JitRegGP& _offset, const DspValue& _src) const
@@ -537,6 +600,16 @@ namespace dsp56k
 
 	void Jitmem::writeDspMemory(const JitRegGP& _offset, const DspValue& _srcX, const DspValue& _srcY) const
 	{
+		if(writesCallCpp() || hasWatchpoints(MemArea_X) || hasWatchpoints(MemArea_Y))
+		{
+			writeDspMemory(MemArea_X, _offset, _srcX, noRef());
+			writeDspMemory(MemArea_Y, _offset, _srcY, noRef());
+			return;
+		}
+
+		sampleAccess(MemArea_X, _offset, true);
+		sampleAccess(MemArea_Y, _offset, true);
+
 		const SkipLabel skip(m_block.asm_());
 
 		if(!hasMmuSupport())
@@ -551,6 +624,9 @@ namespace dsp56k
 
 		auto py = getMemAreaPtr(tempXY, MemArea_Y, _offset, std::move(px));
 		writeDspMemory(py, _srcY);
+
+		markPageDirty(MemArea_X, _offset);
+		markPageDirty(MemArea_Y, _offset);
 	}
 
 	Jitmem::MemoryRef Jitmem::writeDspMemory(const TWord& _offset, const DspValue& _srcX, const DspValue& _srcY) const
@@ -558,8 +634,19 @@ namespace dsp56k
 		if (_offset >= m_block.dsp().memory().sizeXY())
 			return noRef();
 
+		if(writesCallCpp() || isWatched(MemArea_X, _offset) || isWatched(MemArea_Y, _offset))
+		{
+			writeDspMemory(MemArea_X, _offset, _srcX);
+			writeDspMemory(MemArea_Y, _offset, _srcY);
+			return noRef();
+		}
+
+		sampleAccess(MemArea_X, _offset, true);
+		sampleAccess(MemArea_Y, _offset, true);
+
 		auto p = getMemAreaPtr(MemArea_X, _offset, noRef(), false);
 		writeDspMemory(p, _srcX);
+		markPageDirty(MemArea_X, _offset);
 
 		// it makes no sense to write two values to the same memory address, which is the case for bridged memory. Skip second write in this case
 		if(_offset >= m_block.dsp().memory().getBridgedMemoryAddress())
@@ -567,6 +654,7 @@ namespace dsp56k
 
 		p = getMemAreaPtr(MemArea_Y, _offset, std::move(p), false);
 		writeDspMemory(p, _srcY);
+		markPageDirty(MemArea_Y, _offset);
 		return p;
 	}
 
@@ -577,13 +665,16 @@ namespace dsp56k
 
 	Jitmem::MemoryRef Jitmem::writeDspMemory(EMemArea _area, TWord _offset, const DspValue& _src, MemoryRef&& _ref) const
 	{
-		if(m_block.getConfig().memoryWritesCallCpp || g_debugMemoryWrites)
+		if(writesCallCpp() || isWatched(_area, _offset))
 		{
 			const RegGP r(m_block);
 			m_block.asm_().mov(r, asmjit::Imm(_offset));
 			return writeDspMemory(_area, r.get(), _src, std::move(_ref));
 		}
 
+		// the heat map records addresses before bridging
+		sampleAccess(_area, _offset, true);
+
 		const auto& mem = m_block.dsp().memory();
 		mem.memTranslateAddress(_area, _offset);
 
@@ -594,6 +685,7 @@ namespace dsp56k
 
 		auto p = getMemAreaPtr(_area, _offset, std::move(_ref), false);
 		writeDspMemory(p, _src);
+		markPageDirty(_area, _offset);
 		return p;
 	}
 
@@ -637,14 +729,210 @@ namespace dsp56k
 			writeDspMemory(_offset.get(), _srcX, _srcY);
 	}
 
+	void Jitmem::markPageDirty(const EMemArea _area, const JitRegGP& _offset) const
+	{
+		auto& mem = m_block.dsp().memory();
+
+		if(!mem.isDirtyPageTrackingEnabled())
+			return;
+
+		const SkipLabel skip(m_block.asm_());
+
+		const auto bridged = mem.getBridgedMemoryAddress();
+
+		if(_area == MemArea_P || !bridged)
+		{
+			markPageDirty(_area, _offset, skip.get());
+			return;
+		}
+
+		// writes to bridged memory are tracked as P memory writes
+		const auto isBridged = m_block.asm_().newLabel();
+
+		m_block.asm_().cmp(r32(_offset), asmjit::Imm(bridged));
+		m_block.asm_().jge(isBridged);
+
+		markPageDirty(_area, _offset, skip.get());
+		m_block.asm_().jmp(skip.get());
+
+		m_block.asm_().bind(isBridged);
+		markPageDirty(MemArea_P, _offset, skip.get());
+	}
+
+	void Jitmem::markPageDirty(const EMemArea _area, const JitRegGP& _offset, const asmjit::Label& _skip) const
+	{
+		auto& mem = m_block.dsp().memory();
+
+		const RegGP page(m_block);
+
+		m_block.asm_().mov(r32(page), r32(_offset));
+		m_block.asm_().shr(r32(page), asmjit::Imm(Memory::DirtyPageShift));
+		m_block.asm_().cmp(r32(page), asmjit::Imm(mem.getDirtyPageCount(_area)));
+		m_block.asm_().jge(_skip);
+
+		// The DSP thread is the only one that sets bits, others only clear them. A non-atomic read-modify-write may
+		// set bits again that have been fetched concurrently, which causes a page to be reported twice but never loses a write
+		const RegScratch base(m_block);
+		makeBasePtr(r64(base), mem.getDirtyPageBits(_area));
+
+#ifdef HAVE_ARM64
+		const RegGP bit(m_block);
+
+		// 64 bit shifts use the shift amount modulo 64
+		m_block.asm_().mov(r32(bit), asmjit::Imm(1));
+		m_block.asm_().shl(r64(bit), r64(page));
+		m_block.asm_().shr(r32(page), asmjit::Imm(6));
+
+		m_block.asm_().add(r64(base), r64(base), r64(page), asmjit::arm::Shift(asmjit::arm::ShiftOp::kLSL, 3));
+
+		// other threads may fetch the page as soon as its bit is set, the data store has to be visible before
+		m_block.asm_().dmb(asmjit::Imm(asmjit::a64::Predicate::DB::kISHST));
+
+		m_block.asm_().ldr(r64(page), makePtr(base, sizeof(uint64_t)));
+		m_block.asm_().orr(r64(page), r64(page), r64(bit));
+		m_block.asm_().str(r64(page), makePtr(base, sizeof(uint64_t)));
+#else
+		// with a memory operand, bts addresses the whole bitmap: it sets bit page % 64 of the qword at page / 64
+		m_block.asm_().bts(makePtr(r64(base), sizeof(uint64_t)), r64(page));
+#endif
+	}
+
+	void Jitmem::markPageDirty(EMemArea _area, const TWord _offset) const
+	{
+		auto& mem = m_block.dsp().memory();
+
+		if(!mem.isDirtyPageTrackingEnabled())
+			return;
+
+		const auto bridged = mem.getBridgedMemoryAddress();
+
+		if(bridged && _offset >= bridged)
+			_area = MemArea_P;
+
+		const auto page = _offset >> Memory::DirtyPageShift;
+
+		if(page >= mem.getDirtyPageCount(_area))
+			return;
+
+		// the page is known at compile time, modify the byte that contains its bit. Both architectures are little endian
+		auto* bits = reinterpret_cast<uint8_t*>(mem.getDirtyPageBits(_area) + (page >> 6)) + ((page & 63) >> 3);
+
+		const RegGP temp(m_block);
+
+#ifdef HAVE_ARM64
+		// see above, the data store has to be visible before the bit is set
+		m_block.asm_().dmb(asmjit::Imm(asmjit::a64::Predicate::DB::kISHST));
+#endif
+		mov(temp.get(), *bits);
+		m_block.asm_().or_(r32(temp), asmjit::Imm(1 << (page & 7)));
+		mov<sizeof(uint8_t)>(bits, temp.get());
+	}
+
+	void callDSPMemHeatMapSampleRead(DSP* const _dsp, const TWord _area, const TWord _offset)
+	{
+		if(auto* heatMap = _dsp->memory().getHeatMap())
+			heatMap->sample(static_cast<EMemArea>(_area), _offset, false);
+	}
+
+	void callDSPMemHeatMapSampleWrite(DSP* const _dsp, const TWord _area, const TWord _offset)
+	{
+		if(auto* heatMap = _dsp->memory().getHeatMap())
+			heatMap->sample(static_cast<EMemArea>(_area), _offset, true);
+	}
+
+	bool Jitmem::writesCallCpp() const
+	{
+		return m_block.getConfig().memoryWritesCallCpp || g_debugMemoryWrites;
+	}
+
+	bool Jitmem::hasWatchpoints(const EMemArea _area) const
+	{
+		return m_block.dsp().getJit().hasWatchpoints(_area);
+	}
+
+	bool Jitmem::isWatched(const EMemArea _area, const TWord _offset) const
+	{
+		return m_block.dsp().getJit().hasWatchpoint(_area, _offset);
+	}
+
+	void Jitmem::sampleAccess(const EMemArea _area, const JitRegGP& _offset, const bool _write) const
+	{
+		auto* heatMap = m_block.dsp().memory().getHeatMap();
+		if(!heatMap)
+			return;
+
+		const SkipLabel skip(m_block.asm_());
+
+		skipUnlessSampled(heatMap, skip.get());
+
+		const FuncArg r0(m_block, 0);
+		const FuncArg r1(m_block, 1);
+		const FuncArg r2(m_block, 2);
+
+		// offset first, it might be located in one of the other argument registers
+		m_block.asm_().mov(r32(r2), r32(_offset));
+		makeDspPtr(r0);
+		m_block.asm_().mov(r32(r1), asmjit::Imm(_area));
+
+		m_block.stack().call(asmjit::func_as_ptr(_write ? &callDSPMemHeatMapSampleWrite : &callDSPMemHeatMapSampleRead));
+	}
+
+	void Jitmem::sampleAccess(const EMemArea _area, const TWord _offset, const bool _write) const
+	{
+		auto* heatMap = m_block.dsp().memory().getHeatMap();
+		if(!heatMap)
+			return;
+
+		const SkipLabel skip(m_block.asm_());
+
+		skipUnlessSampled(heatMap, skip.get());
+
+		const FuncArg r0(m_block, 0);
+		const FuncArg r1(m_block, 1);
+		const FuncArg r2(m_block, 2);
+
+		makeDspPtr(r0);
+		m_block.asm_().mov(r32(r1), asmjit::Imm(_area));
+		m_block.asm_().mov(r32(r2), asmjit::Imm(_offset));
+
+		m_block.stack().call(asmjit::func_as_ptr(_write ? &callDSPMemHeatMapSampleWrite : &callDSPMemHeatMapSampleRead));
+	}
+
+	void Jitmem::skipUnlessSampled(MemoryHeatMap* _heatMap, const asmjit::Label& _skip) const
+	{
+		// same as MemoryHeatMap::onRead(), the countdown is restarted by sample()
+		auto* countdown = _heatMap->getCountdownPtr();
+
+		const RegGP temp(m_block);
+
+		mov(temp.get(), *countdown);
+		m_block.asm_().dec(r32(temp));
+		mov<sizeof(uint32_t)>(countdown, temp.get());
+		m_block.asm_().test_(r32(temp));
+		m_block.asm_().jnz(_skip);
+	}
+
+	// C++ accesses take the same route as the interpreter, DSP::memReadPeriph()/memWritePeriph() do the bookkeeping for them
+
 	TWord callDSPMemReadPeriph(DSP* const _dsp, const TWord _area, const TWord _offset, Instruction _inst)
 	{
-		return _dsp->getPeriph(_area)->read(_offset | 0xff0000, _inst);
+		return _dsp->memReadPeriph(_area ? MemArea_Y : MemArea_X, _offset, _inst);
 	}
 
 	void callDSPMemWritePeriph(DSP* const _dsp, const TWord _area, const TWord _offset, const TWord _value)
 	{
-		_dsp->getPeriph(_area)->write(_offset | 0xff0000, _value);
+		_dsp->memWritePeriph(_area ? MemArea_Y : MemArea_X, _offset, _value);
+	}
+
+	void Jitmem::countPeriphAccess(const EMemArea _area, const bool _write) const
+	{
+		// inline accesses that do not call C++ need to do the bookkeeping of DSP::memReadPeriph()/memWritePeriph() themselves
+		auto& counter = m_block.dsp().getMetrics().getStorage(DspMetrics::periphAccess(_area, _write));
+
+		const RegGP temp(m_block);
+		mov(temp.get(), counter);
+		m_block.asm_().add(r64(temp), asmjit::Imm(1));
+		mov(counter, temp.get());
 	}
 
 	void Jitmem::readPeriph(DspValue& _dst, const EMemArea _area, TWord _offset, const Instruction _inst) const
@@ -657,6 +945,8 @@ namespace dsp56k
 
 		if(memPtr)
 		{
+			countPeriphAccess(_area, false);
+
 			if (!_dst.isRegValid())
 				_dst.temp(DspValue::Memory);
 
@@ -664,6 +954,51 @@ namespace dsp56k
 			return;
 		}
 
+		const auto access = periph->readAccess(_offset, _inst);
+
+		if(access.type == PeriphAccess::Type::Slot)
+		{
+			readPeriphSlot(_dst, _area, _offset, _inst, access);
+			return;
+		}
+
+		callReadPeriph(_dst, _area, _offset, _inst);
+	}
+
+	void Jitmem::readPeriphSlot(DspValue& _dst, const EMemArea _area, const TWord _offset, const Instruction _inst, const PeriphAccess& _access) const
+	{
+		// read() only needs to run if the slot is disabled or if this is the last pending slot, it clears the receive flags in that case
+		if (!_dst.isRegValid())
+			_dst.temp(DspValue::Memory);
+
+		const SkipLabel skip(m_block.asm_());
+		const auto callCpp = m_block.asm_().newLabel();
+
+		{
+			const RegGP temp(m_block);
+
+			mov(temp.get(), *_access.enabled);
+			m_block.asm_().test_(r32(temp), asmjit::Imm(_access.enabledMask));
+			m_block.asm_().jz(callCpp);
+
+			mov(temp.get(), *_access.pending);
+			m_block.asm_().and_(r32(temp), asmjit::Imm(~_access.pendingBit));
+			m_block.asm_().test_(r32(temp));
+			m_block.asm_().jz(callCpp);
+
+			mov<sizeof(uint32_t)>(_access.pending, temp.get());
+		}
+
+		mov(_dst.get(), *_access.value);
+		countPeriphAccess(_area, false);
+		m_block.asm_().jmp(skip.get());
+
+		m_block.asm_().bind(callCpp);
+		callReadPeriph(_dst, _area, _offset, _inst);
+	}
+
+	void Jitmem::callReadPeriph(DspValue& _dst, const EMemArea _area, const TWord _offset, const Instruction _inst) const
+	{
 		{
 			const FuncArg r0(m_block, 0);
 			const FuncArg r1(m_block, 1);
@@ -767,6 +1102,104 @@ namespace dsp56k
 	}
 
 	void Jitmem::writePeriph(const EMemArea _area, const TWord& _offset, const DspValue& _value) const
+	{
+		const auto access = m_block.dsp().getPeriph(_area)->writeAccess(_offset | 0xff0000);
+
+		switch (access.type)
+		{
+		case PeriphAccess::Type::Plain:
+			countPeriphAccess(_area, true);
+			mov(*access.value, _value);
+			return;
+		case PeriphAccess::Type::Flags:
+			writePeriphFlags(_area, _offset, _value, access);
+			return;
+		case PeriphAccess::Type::Slot:
+			writePeriphSlot(_area, _offset, _value, access);
+			return;
+		default:
+			callWritePeriph(_area, _offset, _value);
+		}
+	}
+
+	void Jitmem::writePeriphFlags(const EMemArea _area, const TWord _offset, const DspValue& _value, const PeriphAccess& _access) const
+	{
+		// a write that sets a write-one-to-clear flag always needs C++, do not emit the check at all
+		if (_value.isImmediate() && (_value.imm() & _access.stickyMask))
+		{
+			callWritePeriph(_area, _offset, _value);
+			return;
+		}
+
+		const SkipLabel skip(m_block.asm_());
+		const auto callCpp = m_block.asm_().newLabel();
+
+		{
+			// C++ is needed if ((old ^ new) & edgeMask) | ((old | new) & stickyMask) != 0
+			const RegGP old(m_block);
+			const RegGP edge(m_block);
+
+			mov(old.get(), *_access.value);
+
+			if (_value.isImmediate())
+			{
+				m_block.asm_().mov(r32(edge), asmjit::Imm(_value.imm()));
+				m_block.asm_().xor_(r32(edge), r32(old));
+				m_block.asm_().and_(r32(edge), asmjit::Imm(_access.edgeMask));
+			}
+			else
+			{
+				m_block.asm_().mov(r32(edge), r32(_value.get()));
+				m_block.asm_().xor_(r32(edge), r32(old));
+				m_block.asm_().and_(r32(edge), asmjit::Imm(_access.edgeMask));
+				m_block.asm_().or_(r32(old), r32(_value.get()));
+			}
+
+			m_block.asm_().and_(r32(old), asmjit::Imm(_access.stickyMask));
+			m_block.asm_().or_(r32(edge), r32(old));
+			m_block.asm_().test_(r32(edge));
+			m_block.asm_().jnz(callCpp);
+		}
+
+		mov(*_access.value, _value);
+		countPeriphAccess(_area, true);
+		m_block.asm_().jmp(skip.get());
+
+		m_block.asm_().bind(callCpp);
+		callWritePeriph(_area, _offset, _value);
+	}
+
+	void Jitmem::writePeriphSlot(const EMemArea _area, const TWord _offset, const DspValue& _value, const PeriphAccess& _access) const
+	{
+		// write() only needs to run once all enabled slots have been written, it clears the transmit flags. It is idempotent, it may store the
+		// value and set the pending bit a second time
+		mov(*_access.value, _value);
+
+		const SkipLabel skip(m_block.asm_());
+		const auto callCpp = m_block.asm_().newLabel();
+
+		{
+			const RegGP pending(m_block);
+			const RegGP enabled(m_block);
+
+			mov(pending.get(), *_access.pending);
+			m_block.asm_().or_(r32(pending), asmjit::Imm(_access.pendingBit));
+			mov<sizeof(uint32_t)>(_access.pending, pending.get());
+
+			mov(enabled.get(), *_access.enabled);
+			m_block.asm_().and_(r32(enabled), asmjit::Imm(_access.enabledMask));
+			m_block.asm_().cmp(r32(pending), r32(enabled));
+			m_block.asm_().jz(callCpp);
+		}
+
+		countPeriphAccess(_area, true);
+		m_block.asm_().jmp(skip.get());
+
+		m_block.asm_().bind(callCpp);
+		callWritePeriph(_area, _offset, _value);
+	}
+
+	void Jitmem::callWritePeriph(const EMemArea _area, const TWord _offset, const DspValue& _value) const
 	{
 		const FuncArg r0(m_block, 0);
 		const FuncArg r1(m_block, 1);
@@ -833,6 +1266,11 @@ namespace dsp56k
 		}
 	}
 
+	TWord Jitmem::addressShift(const EMemArea _area) const
+	{
+		return m_block.dsp().memory().getAddressShift(_area);
+	}
+
 	Jitmem::MemoryRef Jitmem::noRef() const
 	{
 		return MemoryRef(m_block);
@@ -915,7 +1353,7 @@ namespace dsp56k
 
 	Jitmem::MemoryRef Jitmem::getMemAreaPtr(const EMemArea _area, const TWord _offset, MemoryRef&& _ref, bool _supportIndexedAddressing) const
 	{
-		auto* hostPtr = getMemAreaHostPtr(_area) + _offset;
+		auto* hostPtr = getMemAreaHostPtr(_area) + (_offset << addressShift(_area));
 
 		// nothing to do if _ref is already pointing to it
 		if(hostPtr == _ref.baseAddr)
@@ -955,10 +1393,11 @@ namespace dsp56k
 
 	Jitmem::MemoryRef Jitmem::getMemAreaPtr(DspValue& _tempXY, EMemArea _area, const JitRegGP& _offset,	MemoryRef&& _ref) const
 	{
-		if(_area == MemArea_P || hasMmuSupport())
+		if(_area == MemArea_P || hasMmuSupport() || addressShift(_area))
 		{
+			// interleaved X/Y memory is never bridged
 			auto m = getMemAreaPtr(_area, 0, std::move(_ref), true);
-			m.ptr.setIndex(_offset, 2);
+			m.ptr.setIndex(_offset, 2 + addressShift(_area));
 			return m;
 		}
 
@@ -1022,7 +1461,8 @@ namespace dsp56k
 	{
 		const auto& mem = m_block.dsp().memory();
 
-		const TWord* ptr = getMemAreaHostPtr(_offset >= mem.getBridgedMemoryAddress() ? MemArea_P :_area) + _offset;
+		const auto area = _offset >= mem.getBridgedMemoryAddress() ? MemArea_P :_area;
+		const TWord* ptr = getMemAreaHostPtr(area) + (_offset << addressShift(area));
 
 		if(ptr == _ref.baseAddr)
 		{
@@ -1080,7 +1520,7 @@ namespace dsp56k
 		copyHostAddressToReg(m.value, _area, _offset, _ref);
 
 		m.reg = r64(m.value);
-		m.baseAddr = getMemAreaHostPtr(_area) + _offset;
+		m.baseAddr = getMemAreaHostPtr(_area) + (_offset << addressShift(_area));
 		m.ptr = makePtr(m.reg, sizeof(TWord));
 
 		return m;
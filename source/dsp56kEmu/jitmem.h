@@ -3,12 +3,14 @@
 #include "jitdspvalue.h"
 #include "jitregtracker.h"
 #include "opcodetypes.h"
+#include "periphaccess.h"
 #include "types.h"
 
 namespace dsp56k
 {
 	class DspValue;
 	class JitBlock;
+	class MemoryHeatMap;
 
 	class Jitmem
 	{
@@ -147,17 +149,50 @@ namespace dsp56k
 		MemoryRef writeDspMemory(EMemArea _area, const JitRegGP& _offset, const DspValue& _src) const;
 		MemoryRef writeDspMemory(const JitRegGP& _offsetX, const JitRegGP& _offsetY, const DspValue& _srcX, const DspValue& _srcY) const;
 		void writeDspMemory(const JitRegGP& _offset, const DspValue& _srcX, const DspValue& _srcY) const;
+		MemoryRef writeDspMemoryGuarded(EMemArea _area, const JitRegGP& _offset, const DspValue& _src, MemoryRef&& _ref) const;
+		void callDspMemWrite(EMemArea _area, const JitRegGP& _offset, const DspValue& _src) const;
 
 		void readPeriph(DspValue& _dst, EMemArea _area, const JitReg32& _offset, Instruction _inst) const;
 
 		void writePeriph(EMemArea _area, const JitReg32& _offset, const DspValue& _value) const;
 
+		// counts a peripheral register access in the DSP metrics, inline accesses are counted as well
+		void countPeriphAccess(EMemArea _area, bool _write) const;
+
+		// peripheral registers that are described by a PeriphAccess are accessed inline, C++ is only called on the flag edge
+		void readPeriphSlot(DspValue& _dst, EMemArea _area, TWord _offset, Instruction _inst, const PeriphAccess& _access) const;
+		void writePeriphFlags(EMemArea _area, TWord _offset, const DspValue& _value, const PeriphAccess& _access) const;
+		void writePeriphSlot(EMemArea _area, TWord _offset, const DspValue& _value, const PeriphAccess& _access) const;
+
+		void callReadPeriph(DspValue& _dst, EMemArea _area, TWord _offset, Instruction _inst) const;
+		void callWritePeriph(EMemArea _area, TWord _offset, const DspValue& _value) const;
+
 		const TWord* getMemAreaHostPtr(EMemArea _area) const;
+		TWord addressShift(EMemArea _area) const;
 
 		MemoryRef noRef() const;
 
 		bool hasMmuSupport() const;
 
+		// writes call the C++ implementation if requested, for debugging purposes or if memory accesses are sampled
+		bool writesCallCpp() const;
+
+		// writes to addresses watched by the debugger call the C++ implementation
+		bool hasWatchpoints(EMemArea _area) const;
+		bool isWatched(EMemArea _area, TWord _offset) const;
+
+		// marks the page written to as dirty if dirty page tracking is enabled, see Memory::markPageDirty()
+		void markPageDirty(EMemArea _area, const JitRegGP& _offset) const;
+		void markPageDirty(EMemArea _area, TWord _offset) const;
+		void markPageDirty(EMemArea _area, const JitRegGP& _offset, const asmjit::Label& _skip) const;
+
+		// reports a memory read or write to the memory heat map, if there is one
+		void sampleAccess(EMemArea _area, const JitRegGP& _offset, bool _write) const;
+		void sampleAccess(EMemArea _area, TWord _offset, bool _write) const;
+
+		// counts the sample period of the heat map down and jumps to _skip unless this access is sampled
+		void skipUnlessSampled(MemoryHeatMap* _heatMap, const asmjit::Label& _skip) const;
+
 		static void assignFuncArgs(const std::vector<JitRegGP>& _target, const std::vector<JitRegGP>& _source, const std::function<void(uint32_t, JitRegGP, JitRegGP)>&& _assignFunc);
 
 		JitBlock& m_block;
@@ -17,6 +17,8 @@ namespace dsp56k
 			else		m_asm.sub(_r, _n);
 			break;
 		case AddressingMode::Modulo:
+			// not specialized for constant M/N: blocks are compiled for the addressing mode only, M and N are runtime register contents.
+			// Guarding specialized code against changed values would cost about as much as the generic update
 			{
 				const DspValue moduloMask = makeDspValueAguReg(m_block, PoolReg::DspM0mask, _rrr);
 				const DspValue m = makeDspValueAguReg(m_block, PoolReg::DspM0, _rrr, true, false);
@@ -230,42 +232,14 @@ namespace dsp56k
 #endif
 	}
 
-	void JitOps::updateAddressRegisterSubBitreverse(const JitReg32& _r, const JitReg32& _n, bool _addN)
-	{
-		if (!m_block.getConfig().aguSupportBitreverse)
-			return;
-
-		bitreverse24(_r);
-		bitreverse24(_n);
-		if (_addN)
-			m_asm.add(_r, _n);
-		else
-			m_asm.sub(_r, _n);
-		bitreverse24(_r);
-	}
-
 	void JitOps::updateAddressRegisterSubBitreverseN1(const JitReg32& _r, const bool _addN)
 	{
-		if (!m_block.getConfig().aguSupportBitreverse)
-			return;
-
-		bitreverse24(_r);
-		constexpr auto n = dsp56k::bitreverse24(static_cast<TWord>(1));
+		// reverse-carry +/- 1 adds/subtracts the MSB of the reversed value, the carry/borrow leaves the 24 bit range immediately.
+		// Either way, only bit 0 toggles
 #ifdef HAVE_ARM64
-		{
-			static_assert((n & 0xfff) == 0, "invalid immediate");
-			static_assert(n <= 0xfff000, "invalid immediate");
-			if (_addN)
-				m_asm.add(_r, r32(_r), asmjit::Imm(n));
-			else
-				m_asm.sub(_r, r32(_r), asmjit::Imm(n));
-		}
+		m_asm.eor(_r, _r, asmjit::Imm(1));
 #else
-		if (_addN)
-			m_asm.add(_r, asmjit::Imm(n));
-		else
-			m_asm.sub(_r, asmjit::Imm(n));
+		m_asm.xor_(_r, asmjit::Imm(1));
 #endif
-		bitreverse24(_r);
 	}
 }
@@ -69,7 +69,8 @@ namespace dsp56k
 
 		// bitreverse:
 		m_asm.bind(bitreverse);
-		updateAddressRegisterSubBitreverse(_r, _n, _addN);
+		if(m_block.getConfig().aguSupportBitreverse)
+			updateAddressRegisterSubBitreverse(_r, _n, _addN);
 
 		m_asm.bind(end);
 		m_dspRegs.maskSC1624(_r);
@@ -141,6 +142,17 @@ namespace dsp56k
 		m_dspRegs.maskSC1624(_r);
 	}
 
+	void JitOps::updateAddressRegisterSubBitreverse(const JitReg32& _r, const JitReg32& _n, const bool _addN)
+	{
+		bitreverse24(_r);
+		bitreverse24(_n);
+		if (_addN)
+			m_asm.add(_r, _n);
+		else
+			m_asm.sub(_r, _n);
+		bitreverse24(_r);
+	}
+
 	void JitOps::updateAddressRegisterSubModuloN1(const JitReg32& _r, const JitReg32& _m, const JitReg32& _mMask, bool _addN) const
 	{
 		const RegScratch scratch(m_block);
@@ -61,7 +61,8 @@ namespace dsp56k
 
 		// bitreverse:
 		m_asm.bind(bitreverse);
-		updateAddressRegisterSubBitreverse(_r, _n, _addN);
+		if(m_block.getConfig().aguSupportBitreverse)
+			updateAddressRegisterSubBitreverse(_r, _n, _addN);
 
 		m_asm.bind(end);
 		m_dspRegs.maskSC1624(_r);
@@ -125,6 +126,62 @@ namespace dsp56k
 		m_dspRegs.maskSC1624(_r);
 	}
 
+	void JitOps::updateAddressRegisterSubBitreverse(const JitReg32& _r, const JitReg32& _n, const bool _addN)
+	{
+		const auto generic = m_asm.newLabel();
+		const auto flip = m_asm.newLabel();
+		const auto end = m_asm.newLabel();
+
+		// FFTs use a power of two for N. Reverse-carry arithmetic with a single bit j only modifies bits j..0: an add flips
+		// all bits from j down to the highest zero bit, a subtract flips all bits from j down to the highest one bit
+		{
+			const RegScratch scratch(m_block);
+			const RegGP lowBits(m_block);
+
+			const auto t = r32(scratch);
+			const auto low = r32(lowBits);
+
+			m_asm.test(_n, _n);
+			m_asm.jz(end);
+
+			m_asm.lea(t, ptr(_n, -1));
+			m_asm.test(t, _n);
+			m_asm.jnz(generic);
+
+			m_asm.lea(_n, ptr(_n, _n, 0, -1));	// bits j..0
+
+			m_asm.mov(t, _r);
+			if(_addN)
+				m_asm.not_(t);
+			m_asm.and_(t, _n);
+
+			// all bits carry/borrow through if there is no stop bit
+			m_asm.bsr(t, t);
+			m_asm.jz(flip);
+
+			m_asm.xor_(low, low);
+			m_asm.bts(low, t);
+			m_asm.dec(low);
+			m_asm.xor_(_n, low);
+
+			m_asm.bind(flip);
+			m_asm.xor_(_r, _n);
+			m_asm.jmp(end);
+		}
+
+		m_asm.bind(generic);
+
+		bitreverse24(_r);
+		bitreverse24(_n);
+		if (_addN)
+			m_asm.add(_r, _n);
+		else
+			m_asm.sub(_r, _n);
+		bitreverse24(_r);
+
+		m_asm.bind(end);
+	}
+
 	void JitOps::updateAddressRegisterSubModuloN1(const JitReg32& _r, const JitReg32& _m, const JitReg32& _mMask, bool _addN) const
 	{
 		const RegScratch scratch(m_block);
@@ -463,20 +463,17 @@ namespace dsp56k
 				{
 					m_asm.lea(d, asmjit::x86::ptr(d, r64(_s1), 1));
 				}
-				else
+				else if(_accumulate/* && _negate*/)
 				{
 					// fractional multiplication requires one post-shift to be correct
 					m_asm.add(r64(_s1), r64(_s1));	// add r,r is faster than shl r,1 on Haswell, can run on more ports and has a TP of 0.25 vs 0.5
-
-					if(_accumulate && _negate)
-					{
-						m_asm.sub(d, r64(_s1));
-					}
-					else/* if(_negate)*/
-					{
-						m_asm.neg(r64(_s1));
-						m_asm.mov(d, r64(_s1));
-					}
+					m_asm.sub(d, r64(_s1));
+				}
+				else/* if(_negate)*/
+				{
+					// fold the post-shift into the move to the destination
+					m_asm.neg(r64(_s1));
+					m_asm.lea(r64(d.get()), asmjit::x86::ptr(r64(_s1.get()), r64(_s1.get())));
 				}
 			}
 		}
@@ -676,18 +673,29 @@ namespace dsp56k
 #else
 		m_asm.imul(r64(s1), r64(s2));
 #endif
-		// fractional multiplication requires one post-shift to be correct
-		m_asm.sal(r64(s1), asmjit::Imm(1));
-
-		if (negate)
-			m_asm.neg(r64(s1));
 
 		AluRef d(m_block, ab);
 
 		signextend56to64(d);
 		m_asm.sar(d, asmjit::Imm(24));
 
-		m_asm.add(d, r64(s1));
+		// fractional multiplication requires one post-shift to be correct, fold it into the accumulation
+#ifdef HAVE_ARM64
+		if (negate)
+			m_asm.sub(d, d, r64(s1), asmjit::arm::lsl(1));
+		else
+			m_asm.add(d, d, r64(s1), asmjit::arm::lsl(1));
+#else
+		if (negate)
+		{
+			m_asm.add(r64(s1), r64(s1));
+			m_asm.sub(d, r64(s1));
+		}
+		else
+		{
+			m_asm.lea(d, asmjit::x86::ptr(d, r64(s1), 1));
+		}
+#endif
 		s1.release();
 
 		const auto& dOld = r64(s2);
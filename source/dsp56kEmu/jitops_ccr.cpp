@@ -24,6 +24,7 @@ namespace dsp56k
 
 			if(!m_disableCCRUpdates)
 			{
+				assert(!m_block.isEntryRegCarrierReserved(regLastModAlu) && "last modified ALU carries an entry register");
 				m_block.stack().setUsed(regLastModAlu);
 				m_asm.movq(regLastModAlu, _alu);
 			}
@@ -44,12 +44,30 @@ namespace dsp56k
 		skipToFrameSync(_dsp, p->getEssiClock().getRemainingInstructionsForReceiveFrameSync<ExpectedValue>(EssiIndex));
 	}
 
+	HDI08& getHostInterface(Peripherals56362& _p) { return _p.getHDI08(); }
+	HDI08& getHostInterface(Peripherals56303& _p) { return _p.getHI08(); }
+
+	template<typename TPeripherals>
+	void callDspHostReceiveSpinloop(DSP* _dsp)
+	{
+		auto* p = static_cast<TPeripherals*>(_dsp->getPeriph(0));  // NOLINT(cppcoreguidelines-pro-type-static-cast-downcast)
+
+		if(!getHostInterface(*p).hasRXData())
+			_dsp->fastForwardToPeripheralsDeadline();
+	}
+
+	void callDspPeripheralSpinloop(DSP* _dsp, const TWord* _reg, const TWord _mask, const TWord _spinValue)
+	{
+		if((*_reg & _mask) == _spinValue)
+			_dsp->fastForwardToPeripheralsDeadline();
+	}
+
 	// If the DSP is spinlooping while waiting for the ESAI frame sync to flip, we fast-forward the DSP instructions to make it happen ASAP
 
-	template<Instruction Inst, ExpectedBitValue BitValue> void JitOps::esaiFrameSyncSpinloopBra(const TWord op) const
+	template<Instruction Inst, ExpectedBitValue BitValue> bool JitOps::esaiFrameSyncSpinloopBra(const TWord op) const
 	{
 		if(!dynamic_cast<Peripherals56362*>(getBlock().dsp().getPeriph(0)))
-			return;
+			return false;
 
 		// If the DSP is spinlooping while waiting for the ESAI frame sync to flip, we fast-forward the DSP instructions to make it happen ASAP
 		const auto bit = getBit<Inst>(op);
@@ -61,10 +79,13 @@ namespace dsp56k
 			const FuncArg r0(m_block, 0);
 			m_block.mem().makeDspPtr(r0);
 			m_block.stack().call(asmjit::func_as_ptr(&callDspRemainingInstructionsForTransmitFrameSync<BitValue == BitClear>));
+			return true;
 		}
+
+		return false;
 	}
 
-	template<Instruction Inst, ExpectedBitValue BitValue> void JitOps::esaiFrameSyncSpinloopJmp(const TWord op) const
+	template<Instruction Inst, ExpectedBitValue BitValue> bool JitOps::esaiFrameSyncSpinloopJmp(const TWord op) const
 	{
 		if(dynamic_cast<Peripherals56362*>(getBlock().dsp().getPeriph(0)))
 		{
@@ -79,6 +100,7 @@ namespace dsp56k
 					const FuncArg r0(m_block, 0);
 					m_block.mem().makeDspPtr(r0);
 					m_block.stack().call(asmjit::func_as_ptr(&callDspRemainingInstructionsForTransmitFrameSync<BitValue == BitClear>));
+					return true;
 				}
 				else if(bit == Esai::M_RFS)
 				{
@@ -86,6 +108,7 @@ namespace dsp56k
 					const FuncArg r0(m_block, 0);
 					m_block.mem().makeDspPtr(r0);
 					m_block.stack().call(asmjit::func_as_ptr(&callDspRemainingInstructionsForReceiveFrameSync<BitValue == BitClear>));
+					return true;
 				}
 			}
 		}
@@ -95,7 +118,7 @@ namespace dsp56k
 			const auto addr = getFieldValue<Inst, Field_qqqqqq>(op) + 0xffff80;
 
 			if (m_opWordB != m_pcCurrentOp)
-				return;
+				return false;
 
 			if(addr == Essi::ESSI0_SSISR)
 			{
@@ -105,13 +128,15 @@ namespace dsp56k
 					const FuncArg r0(m_block, 0);
 					m_block.mem().makeDspPtr(r0);
 					m_block.stack().call(asmjit::func_as_ptr(&callDspRemainingInstructionsForEssiTransmitFrameSync<BitValue == BitClear, 0>));
+					return true;
 				}
-				if(bit == Essi::SSISR_RFS)
+				else if(bit == Essi::SSISR_RFS)
 				{
 					// op word B = jump to self, addr = ESSI0 status register, bit test for bit Receive Frame Sync
 					const FuncArg r0(m_block, 0);
 					m_block.mem().makeDspPtr(r0);
 					m_block.stack().call(asmjit::func_as_ptr(&callDspRemainingInstructionsForEssiReceiveFrameSync<BitValue == BitClear, 0>));
+					return true;
 				}
 			}
 
@@ -123,25 +148,109 @@ namespace dsp56k
 					const FuncArg r0(m_block, 0);
 					m_block.mem().makeDspPtr(r0);
 					m_block.stack().call(asmjit::func_as_ptr(&callDspRemainingInstructionsForEssiTransmitFrameSync<BitValue == BitClear, 1>));
+					return true;
 				}
-				if(bit == Essi::SSISR_RFS)
+				else if(bit == Essi::SSISR_RFS)
 				{
 					// op word B = jump to self, addr = ESSI1 status register, bit test for bit Receive Frame Sync
 					const FuncArg r0(m_block, 0);
 					m_block.mem().makeDspPtr(r0);
 					m_block.stack().call(asmjit::func_as_ptr(&callDspRemainingInstructionsForEssiReceiveFrameSync<BitValue == BitClear, 1>));
+					return true;
 				}
 			}
 		}
+
+		return false;
+	}
+
+	// If the DSP is spinlooping while waiting for host data (jclr #HRDF,x:HSR,*), nothing can happen before the next peripheral
+	// deadline unless the host sends data, so we skip the idle time instead of executing the loop over and over again
+
+	template<Instruction Inst, bool Relative> bool JitOps::hostReceiveSpinloop(const TWord op) const
+	{
+		if(m_opWordB != (Relative ? 0 : m_pcCurrentOp))
+			return false;
+
+		if(getFieldValue<Inst, Field_S>(op))
+			return false;
+
+		const auto bit = getBit<Inst>(op);
+		const auto addr = getFieldValue<Inst, Field_pppppp>(op) + 0xffffc0;
+
+		if(addr != HDI08::HSR || bit != HDI08::HSR_HRDF)
+			return false;
+
+		auto* periph = getBlock().dsp().getPeriph(0);
+
+		const FuncArg r0(m_block, 0);
+
+		if(dynamic_cast<Peripherals56362*>(periph))
+		{
+			m_block.mem().makeDspPtr(r0);
+			m_block.stack().call(asmjit::func_as_ptr(&callDspHostReceiveSpinloop<Peripherals56362>));
+			return true;
+		}
+
+		if(dynamic_cast<Peripherals56303*>(periph))
+		{
+			m_block.mem().makeDspPtr(r0);
+			m_block.stack().call(asmjit::func_as_ptr(&callDspHostReceiveSpinloop<Peripherals56303>));
+			return true;
+		}
+
+		return false;
+	}
+
+	// Any other peripheral register that JIT code reads from memory only changes when the peripherals are processed. If the DSP is
+	// spinlooping on one of its bits (jclr #TDE,x:SAISR,* for example), the loop cannot exit before the next peripheral deadline
+
+	template<Instruction Inst, ExpectedBitValue BitValue, bool Relative> void JitOps::peripheralSpinloop(const TWord op) const
+	{
+		if(m_opWordB != (Relative ? 0 : m_pcCurrentOp))
+			return;
+
+		const auto area = getFieldValue<Inst, Field_S>(op) ? MemArea_Y : MemArea_X;
+		const auto bit = getBit<Inst>(op);
+
+		TWord addr;
+		if constexpr (hasFieldT<Inst, Field_qqqqqq>())
+			addr = getFieldValue<Inst, Field_qqqqqq>(op) + 0xffff80;
+		else
+			addr = getFieldValue<Inst, Field_pppppp>(op) + 0xffffc0;
+
+		const auto* reg = getBlock().dsp().getPeriph(area)->readAsPtr(addr, Inst);
+
+		if(!reg)
+			return;
+
+		const TWord mask = 1 << bit;
+
+		const FuncArg r0(m_block, 0);
+		const FuncArg r1(m_block, 1);
+		const FuncArg r2(m_block, 2);
+		const FuncArg r3(m_block, 3);
+
+		m_block.mem().makeDspPtr(r0);
+		m_block.asm_().mov(r1.get(), asmjit::Imm(reinterpret_cast<uint64_t>(reg)));
+		m_block.asm_().mov(r32(r2.get()), asmjit::Imm(mask));
+		m_block.asm_().mov(r32(r3.get()), asmjit::Imm(BitValue == BitClear ? 0 : mask));
+		m_block.stack().call(asmjit::func_as_ptr(&callDspPeripheralSpinloop));
 	}
 
 	// Brclr
 	void JitOps::op_Brclr_ea(const TWord op) { braIfBitTestMem<Brclr_ea, Bra, BitClear>(op); }
 	void JitOps::op_Brclr_aa(const TWord op) { braIfBitTestMem<Brclr_aa, Bra, BitClear>(op); }
-	void JitOps::op_Brclr_pp(const TWord op) { braIfBitTestMem<Brclr_pp, Bra, BitClear>(op); }
+	void JitOps::op_Brclr_pp(const TWord op)
+	{
+		if(!hostReceiveSpinloop<Brclr_pp, true>(op))
+			peripheralSpinloop<Brclr_pp, BitClear, true>(op);
+		braIfBitTestMem<Brclr_pp, Bra, BitClear>(op);
+	}
 	void JitOps::op_Brclr_qq(const TWord op)
 	{
-		esaiFrameSyncSpinloopBra<Brclr_qq, BitClear>(op);
+		if(!esaiFrameSyncSpinloopBra<Brclr_qq, BitClear>(op))
+			peripheralSpinloop<Brclr_qq, BitClear, true>(op);
 		braIfBitTestMem<Brclr_qq, Bra, BitClear>(op);
 	}
 	void JitOps::op_Brclr_S(const TWord op) { braIfBitTestDDDDDD<Brclr_S, Bra, BitClear>(op); }
@@ -149,10 +258,15 @@ namespace dsp56k
 	// Brset
 	void JitOps::op_Brset_ea(const TWord op) { braIfBitTestMem<Brset_ea, Bra, BitSet>(op); }
 	void JitOps::op_Brset_aa(const TWord op) { braIfBitTestMem<Brset_aa, Bra, BitSet>(op); }
-	void JitOps::op_Brset_pp(const TWord op) { braIfBitTestMem<Brset_pp, Bra, BitSet>(op); }
+	void JitOps::op_Brset_pp(const TWord op)
+	{
+		peripheralSpinloop<Brset_pp, BitSet, true>(op);
+		braIfBitTestMem<Brset_pp, Bra, BitSet>(op);
+	}
 	void JitOps::op_Brset_qq(const TWord op)
 	{
-		esaiFrameSyncSpinloopBra<Brset_qq, BitSet>(op);
+		if(!esaiFrameSyncSpinloopBra<Brset_qq, BitSet>(op))
+			peripheralSpinloop<Brset_qq, BitSet, true>(op);
 		braIfBitTestMem<Brset_qq, Bra, BitSet>(op);
 	}
 	void JitOps::op_Brset_S(const TWord op) { braIfBitTestDDDDDD<Brset_S, Bra, BitSet>(op); }
@@ -265,10 +379,16 @@ namespace dsp56k
 
 	void JitOps::op_Jclr_ea(const TWord op) { jumpIfBitTestMem<Jclr_ea, Jump, BitClear>(op); }
 	void JitOps::op_Jclr_aa(const TWord op) { jumpIfBitTestMem<Jclr_aa, Jump, BitClear>(op); }
-	void JitOps::op_Jclr_pp(const TWord op) { jumpIfBitTestMem<Jclr_pp, Jump, BitClear>(op); }
+	void JitOps::op_Jclr_pp(const TWord op)
+	{
+		if(!hostReceiveSpinloop<Jclr_pp, false>(op))
+			peripheralSpinloop<Jclr_pp, BitClear, false>(op);
+		jumpIfBitTestMem<Jclr_pp, Jump, BitClear>(op);
+	}
 	void JitOps::op_Jclr_qq(const TWord op)
 	{
-		esaiFrameSyncSpinloopJmp<Jclr_qq, BitClear>(op);
+		if(!esaiFrameSyncSpinloopJmp<Jclr_qq, BitClear>(op))
+			peripheralSpinloop<Jclr_qq, BitClear, false>(op);
 		jumpIfBitTestMem<Jclr_qq, Jump, BitClear>(op);
 	}
 	void JitOps::op_Jclr_S(const TWord op) { jumpIfBitTestDDDDDD<Jclr_S, Jump, BitClear>(op); }
@@ -280,10 +400,15 @@ namespace dsp56k
 	void JitOps::op_Jsclr_S(const TWord op) { jumpIfBitTestDDDDDD<Jsclr_S, JSR, BitClear>(op); }
 	void JitOps::op_Jset_ea(const TWord op) { jumpIfBitTestMem<Jset_ea, Jump, BitSet>(op); }
 	void JitOps::op_Jset_aa(const TWord op) { jumpIfBitTestMem<Jset_aa, Jump, BitSet>(op); }
-	void JitOps::op_Jset_pp(const TWord op) { jumpIfBitTestMem<Jset_pp, Jump, BitSet>(op); }
+	void JitOps::op_Jset_pp(const TWord op)
+	{
+		peripheralSpinloop<Jset_pp, BitSet, false>(op);
+		jumpIfBitTestMem<Jset_pp, Jump, BitSet>(op);
+	}
 	void JitOps::op_Jset_qq(const TWord op)
 	{
-		esaiFrameSyncSpinloopJmp<Jclr_qq, BitSet>(op);
+		if(!esaiFrameSyncSpinloopJmp<Jclr_qq, BitSet>(op))
+			peripheralSpinloop<Jset_qq, BitSet, false>(op);
 		jumpIfBitTestMem<Jset_qq, Jump, BitSet>(op);
 	}
 	void JitOps::op_Jset_S(const TWord op) { jumpIfBitTestDDDDDD<Jset_S, Jump, BitSet>(op); }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "dsp.h"
 #include "jitblock.h"
 #include "jitops.h"
 #include "opcodes.h"
@@ -140,6 +141,15 @@ namespace dsp56k
 	{
 		auto ea = effectiveAddress<Inst>(_op);
 
+		m_resultFlags |= WritePMem;
+
+		// writes to P memory that contains code are detected by page protection
+		if(m_block.dsp().getJit().getPMemGuard().isActive())
+		{
+			m_block.mem().writeDspMemory(MemArea_P, ea, _src);
+			return;
+		}
+
 		DspValue compare(m_block, UsePooledTemp);
 
 		auto memRef = m_block.mem().readDspMemory(compare, MemArea_P, ea);
@@ -154,7 +164,5 @@ namespace dsp56k
 		m_block.mem().mov(m_block.pMemWriteValue(), _src);
 
 		m_asm.bind(skip);
-
-		m_resultFlags |= WritePMem;
 	}
 }
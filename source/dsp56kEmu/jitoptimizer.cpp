@@ -18,7 +18,12 @@ namespace dsp56k
 	namespace Inst = asmjit::x86::Inst;
 #endif
 
-	JitOptimizer::JitOptimizer(JitEmitter& _emitter) : m_asm(_emitter)
+	static bool isGpReg(const asmjit::Operand& _op)
+	{
+		return _op.isReg() && _op.as<asmjit::BaseReg>().isGp();
+	}
+
+	JitOptimizer::JitOptimizer(JitEmitter& _emitter, const bool _optimizeMemoryAccesses) : m_asm(_emitter), m_optimizeMemoryAccesses(_optimizeMemoryAccesses)
 	{
 	}
 
@@ -56,9 +61,11 @@ namespace dsp56k
 		// Constant folding creates dead code (e.g. mov reg,reg replaced with
 		// mov reg,imm makes the source's mov dead).  DCE may expose further
 		// folding opportunities.  Iterate until stable.
+		// Memory optimization turns loads into register moves, which are
+		// subject to both constant folding and DCE.
 		for(;;)
 		{
-			const size_t changed = constantFolding() + deadCodeElimination();
+			const size_t changed = constantFolding() + (m_optimizeMemoryAccesses ? memoryOptimization() : 0) + deadCodeElimination();
 			total += changed;
 			if(changed == 0)
 				break;
@@ -751,6 +758,362 @@ namespace dsp56k
 		return folded;
 	}
 
+	// Redundant load/store elimination within basic blocks.
+	// DSP registers are addressed relative to regDspPtr, DSP memory via a base register plus an
+	// optional index register (the DSP address). Two accesses that use the same base/index registers
+	// are disambiguated by their offsets, everything else is assumed to alias.
+	// - store-to-load forwarding:	mov [m],r1 ... mov r2,[m]	->	mov r2,r1
+	// - redundant load elimination:	mov r1,[m] ... mov r2,[m]	->	mov r2,r1
+	// - dead store elimination:		mov [m],r1 ... mov [m],r2	->	first store removed if [m] is not read in between
+	size_t JitOptimizer::memoryOptimization()
+	{
+		const auto arch = asmjit::Environment::host().arch();
+		size_t changed = 0;
+
+		MemTracker tracker;
+
+		for(auto* node = m_asm.firstNode(); node;)
+		{
+			auto* next = node->next();
+
+			// block boundaries, calls may access anything
+			if(node->isLabel() || isControlFlow(node))
+			{
+				tracker.clear();
+				node = next;
+				continue;
+			}
+
+			if(!node->isInst())
+			{
+				node = next;
+				continue;
+			}
+
+			auto* inst = node->as<asmjit::InstNode>();
+			const auto instId = inst->id();
+			const auto opCount = inst->opCount();
+
+			asmjit::InstRWInfo rwInfo{};
+			if(asmjit::InstAPI::queryRWInfo(arch, inst->baseInst(), inst->operands(), opCount, &rwInfo) != asmjit::kErrorOk || hasImplicitRegWrites(inst))
+			{
+				tracker.clear();
+				node = next;
+				continue;
+			}
+
+			JitMemPtr mem;
+
+			// loads: mov r32/r64, [mem]
+#ifdef HAVE_ARM64
+			const bool isLoad = instId == Inst::kIdLdr && opCount == 2 && isGpReg(inst->op(0)) && getMemOperand(inst->op(1), mem);
+#else
+			const bool isLoad = instId == Inst::kIdMov && opCount == 2 && isGpReg(inst->op(0)) && getMemOperand(inst->op(1), mem);
+#endif
+			if(isLoad)
+			{
+				const auto& dst = inst->op(0).as<JitRegGP>();
+				const auto size = dst.size();
+				bool dstValid;
+				const auto dstIdx = regIndex(dst, dstValid);
+
+				if(dstValid && (size == 4 || size == 8) && (!mem.size() || mem.size() == size))
+				{
+					const auto* e = tracker.find(mem, size);
+
+					const bool canReplace = e && ((e->value.isReg() && e->value.as<JitRegGP>().size() == size)
+#ifndef HAVE_ARM64
+						|| e->value.isImm()
+#endif
+						);
+
+					if(canReplace)
+					{
+						if(e->valueFromLoad)
+							++m_memoryStats.redundantLoads;
+						else
+							++m_memoryStats.forwardedStores;
+						++changed;
+
+						bool srcValid = false;
+						const auto srcIdx = e->value.isReg() ? regIndex(e->value, srcValid) : 0;
+
+						// a 32 bit register move clears the upper half, which is only guaranteed to be clear already if the register has been loaded
+						if(srcValid && srcIdx == dstIdx && (size == 8 || e->valueFromLoad))
+						{
+							m_asm.removeNode(node);
+							node = next;
+							continue;
+						}
+
+						inst->setId(Inst::kIdMov);
+						inst->setOp(1, e->value);
+
+						if(!srcValid || srcIdx != dstIdx)
+							tracker.onRegWrite(dstIdx);
+					}
+					else
+					{
+						tracker.onRead(mem, size);
+						tracker.onRegWrite(dstIdx);
+
+						if(!usesReg(mem, dstIdx))
+						{
+							auto& n = tracker.add(mem, size);
+							n.value = dst;
+							n.valueFromLoad = true;
+						}
+					}
+
+					node = next;
+					continue;
+				}
+			}
+
+			// stores: mov [mem], r32/r64/imm
+#ifdef HAVE_ARM64
+			const bool isStore = instId == Inst::kIdStr && opCount == 2 && isGpReg(inst->op(0)) && getMemOperand(inst->op(1), mem);
+			const auto& storeSrc = inst->op(0);
+#else
+			const bool isStore = instId == Inst::kIdMov && opCount == 2 && (isGpReg(inst->op(1)) || inst->op(1).isImm()) && getMemOperand(inst->op(0), mem);
+			const auto& storeSrc = inst->op(1);
+#endif
+			if(isStore)
+			{
+				const auto size = storeSrc.isReg() ? storeSrc.as<JitRegGP>().size() : mem.size();
+
+				if((size == 4 || size == 8) && (!mem.size() || mem.size() == size))
+				{
+					if(auto* e = tracker.find(mem, size))
+					{
+						if(e->pendingStore)
+						{
+							m_asm.removeNode(e->pendingStore);
+							++m_memoryStats.deadStores;
+							++changed;
+						}
+					}
+
+					tracker.onWrite(mem, size);
+
+					auto& n = tracker.add(mem, size);
+					n.pendingStore = inst;
+
+					bool srcValid = true;
+					if(storeSrc.isReg())
+						regIndex(storeSrc, srcValid);
+#ifdef HAVE_ARM64
+					// regIndex() does not distinguish between zr and sp
+					if(srcValid && storeSrc.as<JitRegGP>().id() != asmjit::a64::Gp::kIdZr)
+#else
+					if(srcValid)
+#endif
+						n.value = storeSrc;
+
+					node = next;
+					continue;
+				}
+			}
+
+			// any other instruction: memory operands first, they are evaluated before registers are written
+			for(uint32_t i = 0; i < opCount; ++i)
+			{
+				const auto& op = inst->op(i);
+
+				if(!op.isMem())
+					continue;
+
+#ifndef HAVE_ARM64
+				if(instId == Inst::kIdLea)
+					continue;
+#endif
+				if(!getMemOperand(op, mem))
+				{
+					tracker.clear();
+					break;
+				}
+
+				const auto size = mem.size() ? mem.size() : kUnknownAccessSize;
+
+				const bool read = i >= rwInfo.opCount() || rwInfo.operand(i).isRead();
+				const bool write = i >= rwInfo.opCount() || rwInfo.operand(i).isWrite();
+
+				if(read)
+					tracker.onRead(mem, size);
+				if(write)
+					tracker.onWrite(mem, size);
+			}
+
+			for(uint32_t i = 0; i < opCount; ++i)
+			{
+				bool valid;
+				const auto idx = regIndex(inst->op(i), valid);
+				if(!valid)
+					continue;
+
+				if(i >= rwInfo.opCount() || rwInfo.operand(i).isWrite())
+					tracker.onRegWrite(idx);
+			}
+
+			node = next;
+		}
+
+		return changed;
+	}
+
+	JitOptimizer::MemEntry* JitOptimizer::MemTracker::find(const JitMemPtr& _mem, const uint32_t _size)
+	{
+		for(uint32_t i = 0; i < count; ++i)
+		{
+			auto& e = entries[i];
+			if(e.size == _size && e.mem.offset() == _mem.offset() && sameAddressRegs(e.mem, _mem))
+				return &e;
+		}
+		return nullptr;
+	}
+
+	JitOptimizer::MemEntry& JitOptimizer::MemTracker::add(const JitMemPtr& _mem, const uint32_t _size)
+	{
+		// full: forget the oldest entry, it is just not optimized
+		if(count == kMaxMemEntries)
+			remove(0);
+
+		auto& e = entries[count++];
+		e = MemEntry();
+		e.mem = _mem;
+		e.size = _size;
+		return e;
+	}
+
+	void JitOptimizer::MemTracker::remove(const uint32_t _index)
+	{
+		for(uint32_t i = _index + 1; i < count; ++i)
+			entries[i - 1] = entries[i];
+		--count;
+	}
+
+	void JitOptimizer::MemTracker::onRead(const JitMemPtr& _mem, const uint32_t _size)
+	{
+		for(uint32_t i = 0; i < count; ++i)
+		{
+			if(mayAlias(entries[i].mem, entries[i].size, _mem, _size))
+				entries[i].pendingStore = nullptr;
+		}
+	}
+
+	void JitOptimizer::MemTracker::onWrite(const JitMemPtr& _mem, const uint32_t _size)
+	{
+		for(uint32_t i = 0; i < count;)
+		{
+			if(mayAlias(entries[i].mem, entries[i].size, _mem, _size))
+				remove(i);
+			else
+				++i;
+		}
+	}
+
+	void JitOptimizer::MemTracker::onRegWrite(const uint32_t _regIdx)
+	{
+		for(uint32_t i = 0; i < count;)
+		{
+			auto& e = entries[i];
+
+			if(usesReg(e.mem, _regIdx))
+			{
+				remove(i);
+				continue;
+			}
+
+			bool valid;
+			if(e.value.isReg() && regIndex(e.value, valid) == _regIdx && valid)
+			{
+				e.value.reset();
+				e.valueFromLoad = false;
+			}
+
+			++i;
+		}
+	}
+
+	bool JitOptimizer::getMemOperand(const asmjit::Operand& _op, JitMemPtr& _mem)
+	{
+		if(!_op.isMem())
+			return false;
+
+		_mem = _op.as<JitMemPtr>();
+
+		if(_mem.hasBaseLabel())
+			return false;
+
+#ifdef HAVE_ARM64
+		// pre/post indexing modifies the base register
+		if(_mem.isPreOrPost())
+			return false;
+
+		constexpr uint32_t stackRegId = asmjit::a64::Gp::kIdSp;
+#else
+		if(_mem.hasSegment())
+			return false;
+
+		constexpr uint32_t stackRegId = asmjit::x86::Gp::kIdSp;
+#endif
+		// push/pop access the stack implicitly
+		if(_mem.hasBaseReg() && _mem.baseId() == stackRegId)
+			return false;
+
+		return true;
+	}
+
+	bool JitOptimizer::sameAddressRegs(JitMemPtr _a, JitMemPtr _b)
+	{
+		_a.setOffset(0);
+		_b.setOffset(0);
+		_a.setSize(0);
+		_b.setSize(0);
+		return _a == _b;
+	}
+
+	bool JitOptimizer::mayAlias(const JitMemPtr& _a, const uint32_t _sizeA, const JitMemPtr& _b, const uint32_t _sizeB)
+	{
+		if(!sameAddressRegs(_a, _b))
+			return true;
+
+		const auto offA = _a.offset();
+		const auto offB = _b.offset();
+
+		return offA < offB + _sizeB && offB < offA + _sizeA;
+	}
+
+	bool JitOptimizer::usesReg(const JitMemPtr& _mem, const uint32_t _regIdx)
+	{
+		constexpr auto gp = static_cast<uint32_t>(asmjit::RegGroup::kGp);
+
+		if(_mem.hasBaseReg() && regIndex(gp, _mem.baseId()) == _regIdx)
+			return true;
+		if(_mem.hasIndexReg() && regIndex(gp, _mem.indexId()) == _regIdx)
+			return true;
+		return false;
+	}
+
+	bool JitOptimizer::hasImplicitRegWrites(const asmjit::InstNode* _inst)
+	{
+#ifdef HAVE_ARM64
+		(void)_inst;
+		return false;
+#else
+		// one operand forms write rdx:rax
+		const auto instId = _inst->id();
+
+		if(instId == Inst::kIdMul || instId == Inst::kIdDiv || instId == Inst::kIdIdiv)
+			return true;
+		if(instId == Inst::kIdImul && _inst->opCount() == 1)
+			return true;
+		if(instId == Inst::kIdCdq || instId == Inst::kIdCqo)
+			return true;
+		return false;
+#endif
+	}
+
 	bool JitOptimizer::isSideEffectFree(const asmjit::InstNode* _inst, const asmjit::InstRWInfo& _rwInfo) const
 	{
 		const auto instId = _inst->id();
@@ -22,10 +22,29 @@ namespace dsp56k
 	class JitOptimizer
 	{
 	public:
-		JitOptimizer(JitEmitter& _emitter);
+		struct MemoryStats
+		{
+			uint64_t forwardedStores = 0;	// loads replaced by the register that has been stored to the same location
+			uint64_t redundantLoads = 0;	// loads replaced by the register that has been loaded from the same location
+			uint64_t deadStores = 0;		// stores removed because the location is overwritten before being read
+
+			uint64_t total() const { return forwardedStores + redundantLoads + deadStores; }
+
+			MemoryStats& operator += (const MemoryStats& _s)
+			{
+				forwardedStores += _s.forwardedStores;
+				redundantLoads += _s.redundantLoads;
+				deadStores += _s.deadStores;
+				return *this;
+			}
+		};
+
+		JitOptimizer(JitEmitter& _emitter, bool _optimizeMemoryAccesses = true);
 
 		size_t optimize();
 
+		const MemoryStats& getMemoryStats() const { return m_memoryStats; }
+
 	private:
 		// Register key: compact index into a flat array.
 		// GP registers: 0-31, Vec registers: 32-63, CPU flags: 64
@@ -117,10 +136,47 @@ namespace dsp56k
 			}
 		};
 
+		// Memory locations with known content / not yet read stores, used by memoryOptimization().
+		// Locations are identified by their address operand, an entry is dropped as soon as a register of its address is modified
+		static constexpr uint32_t kMaxMemEntries = 32;
+		static constexpr uint32_t kUnknownAccessSize = 64;
+
+		struct MemEntry
+		{
+			JitMemPtr mem;
+			uint32_t size = 0;
+			asmjit::Operand value;						// register or immediate that holds the content of the location, none if unknown
+			bool valueFromLoad = false;
+			asmjit::InstNode* pendingStore = nullptr;	// last store to the location that has not been read yet
+		};
+
+		struct MemTracker
+		{
+			MemEntry entries[kMaxMemEntries];
+			uint32_t count = 0;
+
+			void clear()											{ count = 0; }
+
+			MemEntry* find(const JitMemPtr& _mem, uint32_t _size);
+			MemEntry& add(const JitMemPtr& _mem, uint32_t _size);
+			void remove(uint32_t _index);
+
+			void onRead(const JitMemPtr& _mem, uint32_t _size);		// stores to the location are no longer dead
+			void onWrite(const JitMemPtr& _mem, uint32_t _size);	// drops all entries that may alias with the location
+			void onRegWrite(uint32_t _regIdx);						// drops entries addressed by the register, forgets values held by it
+		};
+
 		static int64_t maskToRegSize(const asmjit::Operand& _reg, int64_t _value);
 
 		size_t deadCodeElimination() const;
 		size_t constantFolding();
+		size_t memoryOptimization();
+
+		static bool getMemOperand(const asmjit::Operand& _op, JitMemPtr& _mem);
+		static bool sameAddressRegs(JitMemPtr _a, JitMemPtr _b);
+		static bool mayAlias(const JitMemPtr& _a, uint32_t _sizeA, const JitMemPtr& _b, uint32_t _sizeB);
+		static bool usesReg(const JitMemPtr& _mem, uint32_t _regIdx);
+		static bool hasImplicitRegWrites(const asmjit::InstNode* _inst);
 
 		bool isSideEffectFree(const asmjit::InstNode* _inst, const asmjit::InstRWInfo& _rwInfo) const;
 		bool isControlFlow(const asmjit::BaseNode* _node) const;
@@ -129,5 +185,7 @@ namespace dsp56k
 		static bool readsFlags(const asmjit::InstNode* _inst, const asmjit::InstRWInfo& _rwInfo);
 
 		JitEmitter& m_asm;
+		const bool m_optimizeMemoryAccesses;
+		MemoryStats m_memoryStats;
 	};
 }
@@ -30,13 +30,15 @@ namespace dsp56k
 		testMoveImmAdd();
 		testFullBlockPipeline();
 		testAGUOperations();
+		testMemoryAccesses();
 
 		LOG("JIT Optimizer Tests finished.");
 	}
 
-	void JitOptimizerTests::runOptimizedTest(const std::string& _name,
+	bool JitOptimizerTests::runOptimizedTest(const std::string& _name,
 		const std::function<void()>& _setupDsp,
-		const std::function<void(JitBlock&, JitOps&)>& _build)
+		const std::function<void(JitBlock&, JitOps&)>& _build,
+		JitOptimizer::MemoryStats* _memoryStats/* = nullptr*/)
 	{
 		DspState withoutOpt{}, withOpt{};
 
@@ -49,7 +51,7 @@ namespace dsp56k
 		if(foreignArch)
 		{
 			LOG("Skipping optimizer test '" << _name << "' on foreign arch");
-			return;
+			return false;
 		}
 
 		// Run WITHOUT optimizer
@@ -142,9 +144,13 @@ namespace dsp56k
 			{
 				JitOptimizer optimizer(emitter);
 				optimized = optimizer.optimize();
+
+				if(_memoryStats)
+					*_memoryStats = optimizer.getMemoryStats();
 			}
 
-			if(optimized == 0)
+			// callers that collect memory stats verify the exact number of changes themselves
+			if(optimized == 0 && !_memoryStats)
 				throw std::string("Optimizer test '") + _name + "' FAILED: optimizer made 0 changes (expected > 0)";
 
 			emitter.finalize();
@@ -163,6 +169,7 @@ namespace dsp56k
 		}
 
 		compareDspState(_name, withoutOpt, withOpt);
+		return true;
 	}
 
 	void JitOptimizerTests::emitOp(JitBlock& _block, JitOps& _ops, TWord _opA, TWord _opB)
@@ -612,6 +619,102 @@ namespace dsp56k
 		});
 	}
 
+	// Repeated loads and overwritten stores of the same DSP memory locations. Every case is compared against a control block
+	// that accesses different addresses and therefore cannot be optimized. Host accesses to the DSP register file are identical
+	// in both, the difference of the memory stats is the number of optimizations done for the DSP memory accesses
+	void JitOptimizerTests::testMemoryAccesses()
+	{
+		runMemoryTest("RedundantLoadX",
+			{"move x:$21,x0", "move x:$21,x1"},
+			{"move x:$21,x0", "move x:$22,x1"},
+			0, 1, 0);
+
+		runMemoryTest("RedundantLoadY",
+			{"move y:$18,y0", "move y:$18,y1"},
+			{"move y:$18,y0", "move y:$19,y1"},
+			0, 1, 0);
+
+		runMemoryTest("StoreForwarding",
+			{"move x0,x:$21", "move x:$21,y0"},
+			{"move x0,x:$21", "move x:$22,y0"},
+			1, 0, 0);
+
+		runMemoryTest("DeadStore",
+			{"move x0,y:$18", "move x1,y:$18"},
+			{"move x0,y:$18", "move x1,y:$19"},
+			0, 0, 1);
+
+		// the store replaces the value that has been loaded before, the second load is forwarded from the store, not from the first load
+		runMemoryTest("StoreBetweenLoads",
+			{"move x:$21,x0", "move y0,x:$21", "move x:$21,x1"},
+			{"move x:$21,x0", "move y0,x:$22", "move x:$23,x1"},
+			1, 0, 0);
+
+		// the load in between is forwarded, memory is not read anymore and the first store becomes dead
+		runMemoryTest("LoadBetweenStores",
+			{"move x0,x:$21", "move x:$21,y0", "move x1,x:$21"},
+			{"move x0,x:$21", "move x:$22,y0", "move x1,x:$23"},
+			1, 0, 1);
+
+		// X and Y memory do not alias
+		runMemoryTest("SeparateAreas",
+			{"move x0,x:$21", "move y:$21,y0", "move x1,x:$21"},
+			{"move x0,x:$21", "move y:$22,y0", "move x1,x:$23"},
+			0, 0, 1);
+	}
+
+	void JitOptimizerTests::runMemoryTest(const std::string& _name, const std::vector<const char*>& _ops, const std::vector<const char*>& _controlOps,
+		const uint64_t _forwardedStores, const uint64_t _redundantLoads, const uint64_t _deadStores)
+	{
+		auto setup = [&]()
+		{
+			dsp.resetHW();
+
+			mem.set(MemArea_X, 0x21, 0x123456);
+			mem.set(MemArea_X, 0x22, 0x234567);
+			mem.set(MemArea_X, 0x23, 0x345678);
+			mem.set(MemArea_Y, 0x18, 0x222222);
+			mem.set(MemArea_Y, 0x19, 0x333333);
+			mem.set(MemArea_Y, 0x21, 0x444444);
+			mem.set(MemArea_Y, 0x22, 0x555555);
+
+			dsp.x0(0x111111);
+			dsp.x1(0x700000);
+			dsp.y0(0x654321);
+			dsp.y1(0);
+		};
+
+		auto build = [&](const std::vector<const char*>& _text)
+		{
+			return [this, _text](JitBlock& _block, JitOps& _jitOps)
+			{
+				for (const auto* t : _text)
+					emitAsm(_block, _jitOps, t);
+			};
+		};
+
+		JitOptimizer::MemoryStats stats, control;
+
+		if(!runOptimizedTest(_name, setup, build(_ops), &stats))
+			return;
+		runOptimizedTest(_name + "Control", setup, build(_controlOps), &control);
+
+		auto check = [&](const char* _counter, const uint64_t _value, const uint64_t _controlValue, const uint64_t _expected)
+		{
+			if(_value == _controlValue + _expected)
+				return;
+
+			std::stringstream ss;
+			ss << "Optimizer test '" << _name << "' FAILED: expected " << _expected << ' ' << _counter
+				<< ", got " << _value << " with " << _controlValue << " in the control block";
+			throw ss.str();
+		};
+
+		check("forwarded stores", stats.forwardedStores, control.forwardedStores, _forwardedStores);
+		check("redundant loads", stats.redundantLoads, control.redundantLoads, _redundantLoads);
+		check("dead stores", stats.deadStores, control.deadStores, _deadStores);
+	}
+
 	// Test using the FULL JitBlock::emit pipeline — writes DSP opcodes into
 	// P memory and compiles with the real block infrastructure + optimizer.
 	// This matches exactly what happens in the actual DSP emulation.
@@ -733,9 +836,13 @@ namespace dsp56k
 			{
 				JitOptimizer optimizer(emitter);
 				optimized = optimizer.optimize();
+
+				if(_memoryStats)
+					*_memoryStats = optimizer.getMemoryStats();
 			}
 
-			if(optimized == 0)
+			// callers that collect memory stats verify the exact number of changes themselves
+			if(optimized == 0 && !_memoryStats)
 				throw std::string("Optimizer test '") + name + "' FAILED: optimizer made 0 changes (expected > 0)";
 
 			emitter.finalize();
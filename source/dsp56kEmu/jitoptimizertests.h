@@ -4,8 +4,10 @@
 
 #include <functional>
 #include <string>
+#include <vector>
 
 #include "assembler.h"
+#include "jitoptimizer.h"
 #include "unittests.h"
 
 namespace dsp56k
@@ -27,10 +29,16 @@ namespace dsp56k
 			TWord sr;
 		};
 
-		// Run a DSP program both with and without the optimizer, verify results match
-		void runOptimizedTest(const std::string& _name,
+		// Run a DSP program both with and without the optimizer, verify results match. Optionally returns the memory stats of the optimizer.
+		// Returns false if the test has been skipped
+		bool runOptimizedTest(const std::string& _name,
 			const std::function<void()>& _setupDsp,
-			const std::function<void(JitBlock&, JitOps&)>& _build);
+			const std::function<void(JitBlock&, JitOps&)>& _build,
+			JitOptimizer::MemoryStats* _memoryStats = nullptr);
+
+		// Run a memory access test and a control block without optimizable accesses, verify the difference of the memory stats
+		void runMemoryTest(const std::string& _name, const std::vector<const char*>& _ops, const std::vector<const char*>& _controlOps,
+			uint64_t _forwardedStores, uint64_t _redundantLoads, uint64_t _deadStores);
 
 		// Emit a single DSP opcode
 		void emitOp(JitBlock& _block, JitOps& _ops, TWord _opA, TWord _opB = 0);
@@ -54,6 +62,7 @@ namespace dsp56k
 		void testMoveImmAdd();
 		void testFullBlockPipeline();
 		void testAGUOperations();
+		void testMemoryAccesses();
 
 		Peripherals56362 peripheralsX;
 		Peripherals56367 peripheralsY;
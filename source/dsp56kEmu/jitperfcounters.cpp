@@ -0,0 +1,447 @@
+#include "jitperfcounters.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+
+#include "jitblockruntimedata.h"
+
+#include "dsp56kBase/hugepages.h"
+#include "dsp56kBase/logging.h"
+#include "dsp56kBase/threadtools.h"
+
+#ifdef DSP56K_USE_PERF_JIT_PROFILING
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace dsp56k
+{
+	namespace
+	{
+		constexpr const char* g_eventNames[JitPerfCounters::EventCount] = {"cycles", "instructions", "branch-misses", "L1D-misses", "dTLB-misses"};
+
+#ifdef DSP56K_USE_PERF_JIT_PROFILING
+		constexpr size_t g_ringPageCount = 64;	// data pages per event, must be a power of two
+
+		void initAttr(perf_event_attr& _attr, const JitPerfCounters::Event _event)
+		{
+			switch (_event)
+			{
+			case JitPerfCounters::Event::Cycles:
+				_attr.type = PERF_TYPE_HARDWARE;
+				_attr.config = PERF_COUNT_HW_CPU_CYCLES;
+				break;
+			case JitPerfCounters::Event::Instructions:
+				_attr.type = PERF_TYPE_HARDWARE;
+				_attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+				break;
+			case JitPerfCounters::Event::BranchMisses:
+				_attr.type = PERF_TYPE_HARDWARE;
+				_attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+				break;
+			case JitPerfCounters::Event::L1DMisses:
+				_attr.type = PERF_TYPE_HW_CACHE;
+				_attr.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+				break;
+			case JitPerfCounters::Event::DTLBMisses:
+				_attr.type = PERF_TYPE_HW_CACHE;
+				_attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+				break;
+			default:
+				break;
+			}
+		}
+
+		// opens a counter for the calling thread on any cpu. The counter samples if _samplePeriod is not zero, it is created disabled
+		int openEvent(const JitPerfCounters::Event _event, const uint64_t _samplePeriod)
+		{
+			perf_event_attr attr;
+			memset(&attr, 0, sizeof(attr));
+			attr.size = sizeof(attr);
+			initAttr(attr, _event);
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+			attr.disabled = 1;
+
+			if(_samplePeriod)
+			{
+				attr.sample_period = _samplePeriod;
+				attr.sample_type = PERF_SAMPLE_IP;
+			}
+
+			return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+		}
+#endif
+	}
+
+	JitPerfCounters::EventCounter::EventCounter(const Event _event)
+	{
+#ifdef DSP56K_USE_PERF_JIT_PROFILING
+		m_fd = openEvent(_event, 0);
+#else
+		(void)_event;
+#endif
+	}
+
+	JitPerfCounters::EventCounter::~EventCounter()
+	{
+#ifdef DSP56K_USE_PERF_JIT_PROFILING
+		if(m_fd >= 0)
+			close(m_fd);
+#endif
+	}
+
+	void JitPerfCounters::EventCounter::start() const
+	{
+#ifdef DSP56K_USE_PERF_JIT_PROFILING
+		if(m_fd < 0)
+			return;
+		ioctl(m_fd, PERF_EVENT_IOC_RESET, 0);
+		ioctl(m_fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+	}
+
+	uint64_t JitPerfCounters::EventCounter::stop() const
+	{
+#ifdef DSP56K_USE_PERF_JIT_PROFILING
+		if(m_fd < 0)
+			return 0;
+		ioctl(m_fd, PERF_EVENT_IOC_DISABLE, 0);
+		uint64_t count = 0;
+		if(read(m_fd, &count, sizeof(count)) != sizeof(count))
+			return 0;
+		return count;
+#else
+		return 0;
+#endif
+	}
+
+	JitPerfCounters::JitPerfCounters(const uint64_t _samplePeriod) : m_samplePeriod(_samplePeriod)
+	{
+#ifdef DSP56K_USE_PERF_JIT_PROFILING
+		const auto pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+
+		for(size_t i=0; i<EventCount; ++i)
+		{
+			const auto e = static_cast<Event>(i);
+
+			auto& b = m_buffers[i];
+
+			b.fd = openEvent(e, _samplePeriod);
+
+			if(b.fd < 0)
+			{
+				// not all hosts support all events (VMs usually do not expose cache events), skip these
+				LOGL(WARNING, "Failed to open perf event " << g_eventNames[i] << ", error " << errno);
+				continue;
+			}
+
+			b.memSize = (g_ringPageCount + 1) * pageSize;
+			b.mem = mmap(nullptr, b.memSize, PROT_READ | PROT_WRITE, MAP_SHARED, b.fd, 0);
+
+			if(b.mem == MAP_FAILED)
+			{
+				LOGL(WARNING, "Failed to map perf event buffer for " << g_eventNames[i] << ", error " << errno);
+				close(b.fd);
+				b = EventBuffer();
+				continue;
+			}
+
+			m_valid = true;
+		}
+
+		if(!m_valid)
+		{
+			LOG("No perf events available, check /proc/sys/kernel/perf_event_paranoid");
+			return;
+		}
+
+		for (const auto& b : m_buffers)
+		{
+			if(b.fd >= 0)
+				ioctl(b.fd, PERF_EVENT_IOC_ENABLE, 0);
+		}
+
+		m_thread.reset(new std::thread([this]()
+		{
+			ThreadTools::setCurrentThreadName("jitPerfCounters");
+			threadFunc();
+		}));
+#else
+		LOGL(WARNING, "Hardware performance counters are not supported on this platform");
+#endif
+	}
+
+	JitPerfCounters::~JitPerfCounters()
+	{
+		m_exit = true;
+
+		if(m_thread)
+		{
+			m_thread->join();
+			m_thread.reset();
+		}
+
+#ifdef DSP56K_USE_PERF_JIT_PROFILING
+		for (auto& b : m_buffers)
+		{
+			if(b.fd < 0)
+				continue;
+			ioctl(b.fd, PERF_EVENT_IOC_DISABLE, 0);
+			munmap(b.mem, b.memSize);
+			close(b.fd);
+			b = EventBuffer();
+		}
+#endif
+	}
+
+	void JitPerfCounters::addJitBlock(const JitBlockRuntimeData& _block)
+	{
+		CodeRange r;
+		r.size = _block.getCodeSize();
+		r.pcFirst = _block.getPCFirst();
+		r.pcLast = _block.getPCNext() - 1;
+
+		// only available if profiling support is active, otherwise samples are attributed to blocks only
+		auto& pis = const_cast<JitBlockRuntimeData&>(_block).getProfilingInfo();
+
+		r.pcByCodeOffset.reserve(pis.size());
+
+		for (const auto& pi : pis)
+			r.pcByCodeOffset.emplace_back(pi.codeOffset, pi.pc);
+
+		std::sort(r.pcByCodeOffset.begin(), r.pcByCodeOffset.end());
+
+		const auto start = reinterpret_cast<uint64_t>(_block.getFunc());
+
+		std::lock_guard lock(m_mutex);
+
+		// code memory of destroyed blocks is reused, remove all ranges that overlap the new one
+		auto it = m_codeRanges.lower_bound(start);
+		if(it != m_codeRanges.begin())
+		{
+			auto prev = std::prev(it);
+			if(prev->first + prev->second.size > start)
+				it = prev;
+		}
+
+		while(it != m_codeRanges.end() && it->first < start + r.size)
+			it = m_codeRanges.erase(it);
+
+		m_codeRanges.insert(std::make_pair(start, std::move(r)));
+	}
+
+	void JitPerfCounters::writeReport(std::ostream& _out, const size_t _maxBlocks)
+	{
+		readSamples();
+
+		std::vector<std::pair<std::pair<TWord, TWord>, Counters>> blocks;
+		Counters total;
+		Counters nonJit;
+		uint64_t lost;
+
+		{
+			std::lock_guard lock(m_mutex);
+
+			blocks.assign(m_blocks.begin(), m_blocks.end());
+			nonJit = m_nonJitCode;
+			lost = m_lostSamples;
+		}
+
+		for (const auto& b : blocks)
+		{
+			for(size_t i=0; i<EventCount; ++i)
+				total.samples[i] += b.second.samples[i];
+		}
+
+		for(size_t i=0; i<EventCount; ++i)
+			total.samples[i] += nonJit.samples[i];
+
+		std::sort(blocks.begin(), blocks.end(), [](const auto& _a, const auto& _b)
+		{
+			return _a.second[Event::Cycles] > _b.second[Event::Cycles];
+		});
+
+		const auto period = static_cast<double>(m_samplePeriod);
+
+		auto writeLine = [&](const std::string& _name, const Counters& _c)
+		{
+			const auto cycles = static_cast<double>(_c[Event::Cycles]);
+			const auto instructions = static_cast<double>(_c[Event::Instructions]);
+			const auto share = total[Event::Cycles] ? 100.0 * cycles / static_cast<double>(total[Event::Cycles]) : 0.0;
+
+			_out << std::left << std::setw(20) << _name << std::right
+				<< std::fixed << std::setprecision(2) << std::setw(8) << share << '%'
+				<< std::setw(16) << static_cast<uint64_t>(cycles * period)
+				<< std::setw(16) << static_cast<uint64_t>(instructions * period)
+				<< std::setw(8) << (cycles > 0 ? instructions / cycles : 0.0)
+				<< std::setw(14) << static_cast<uint64_t>(static_cast<double>(_c[Event::BranchMisses]) * period)
+				<< std::setw(14) << static_cast<uint64_t>(static_cast<double>(_c[Event::L1DMisses]) * period)
+				<< std::setw(14) << static_cast<uint64_t>(static_cast<double>(_c[Event::DTLBMisses]) * period)
+				<< std::endl;
+		};
+
+		_out << "Host performance counters of JIT blocks, estimated from samples, period " << m_samplePeriod << ", lost " << lost << std::endl;
+		_out << "Huge pages " << (HugePages::isEnabled() ? "enabled" : "disabled") << ", " << (HugePages::getProcessHugePageBytes() >> 10) << " kB of the process are backed by huge pages" << std::endl;
+		_out << std::left << std::setw(20) << "block" << std::right
+			<< std::setw(9) << "cycles%" << std::setw(16) << "cycles" << std::setw(16) << "instructions" << std::setw(8) << "IPC"
+			<< std::setw(14) << "br-misses" << std::setw(14) << "L1D-misses" << std::setw(14) << "dTLB-misses" << std::endl;
+
+		for(size_t i=0; i<blocks.size() && i<_maxBlocks; ++i)
+		{
+			const auto& b = blocks[i];
+
+			std::stringstream ss;
+			ss << "P:" << HEX(b.first.first) << '-' << HEX(b.first.second);
+			writeLine(ss.str(), b.second);
+		}
+
+		writeLine("[non-JIT code]", nonJit);
+		writeLine("[total]", total);
+	}
+
+	void JitPerfCounters::writeFoldedStacks(std::ostream& _out)
+	{
+		readSamples();
+
+		std::lock_guard lock(m_mutex);
+
+		// folded stacks format as consumed by flamegraph.pl: one line per stack, frames separated by ';', followed by the sample count
+		for (const auto& it : m_blocks)
+		{
+			const auto samples = it.second[Event::Cycles];
+			if(!samples)
+				continue;
+
+			const auto& range = it.first;
+
+			uint64_t attributed = 0;
+
+			for(auto itI = m_instructions.lower_bound(range.first); itI != m_instructions.end() && itI->first <= range.second; ++itI)
+			{
+				const auto count = std::min(itI->second[Event::Cycles], samples - attributed);
+				if(!count)
+					continue;
+				_out << "dsp56k;P:" << HEX(range.first) << '-' << HEX(range.second) << ";P:" << HEX(itI->first) << ' ' << std::dec << count << std::endl;
+				attributed += count;
+			}
+
+			if(attributed < samples)
+				_out << "dsp56k;P:" << HEX(range.first) << '-' << HEX(range.second) << ' ' << std::dec << (samples - attributed) << std::endl;
+		}
+
+		if(m_nonJitCode[Event::Cycles])
+			_out << "host " << std::dec << m_nonJitCode[Event::Cycles] << std::endl;
+	}
+
+	void JitPerfCounters::threadFunc()
+	{
+		while(!m_exit)
+		{
+			readSamples();
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+	}
+
+	void JitPerfCounters::readSamples()
+	{
+		for(size_t i=0; i<EventCount; ++i)
+		{
+			if(m_buffers[i].fd >= 0)
+				readSamples(static_cast<Event>(i), m_buffers[i]);
+		}
+	}
+
+	void JitPerfCounters::readSamples(const Event _event, EventBuffer& _buffer)
+	{
+#ifdef DSP56K_USE_PERF_JIT_PROFILING
+		auto* header = static_cast<perf_event_mmap_page*>(_buffer.mem);
+		auto* data = static_cast<const uint8_t*>(_buffer.mem) + header->data_offset;
+		const auto dataSize = header->data_size;
+
+		std::lock_guard lock(m_mutex);	// serializes readers, too
+
+		const auto head = __atomic_load_n(&header->data_head, __ATOMIC_ACQUIRE);
+		auto tail = header->data_tail;
+
+		std::vector<uint8_t> record;
+
+		while(tail < head)
+		{
+			// records may wrap around the end of the ring buffer, copy them into a linear buffer before parsing
+			perf_event_header eh;
+			for(size_t i=0; i<sizeof(eh); ++i)
+				reinterpret_cast<uint8_t*>(&eh)[i] = data[(tail + i) % dataSize];
+
+			if(eh.size < sizeof(eh))
+				break;
+
+			record.resize(eh.size);
+			for(size_t i=0; i<eh.size; ++i)
+				record[i] = data[(tail + i) % dataSize];
+
+			if(eh.type == PERF_RECORD_SAMPLE && eh.size >= sizeof(eh) + sizeof(uint64_t))
+			{
+				uint64_t ip;
+				memcpy(&ip, &record[sizeof(eh)], sizeof(ip));
+				addSample(_event, ip);
+			}
+			else if(eh.type == PERF_RECORD_LOST && eh.size >= sizeof(eh) + 2 * sizeof(uint64_t))
+			{
+				uint64_t lost;
+				memcpy(&lost, &record[sizeof(eh) + sizeof(uint64_t)], sizeof(lost));	// id, lost
+				m_lostSamples += lost;
+			}
+
+			tail += eh.size;
+		}
+
+		__atomic_store_n(&header->data_tail, tail, __ATOMIC_RELEASE);
+#else
+		(void)_event;
+		(void)_buffer;
+#endif
+	}
+
+	void JitPerfCounters::addSample(const Event _event, const uint64_t _ip)
+	{
+		auto it = m_codeRanges.upper_bound(_ip);
+
+		if(it == m_codeRanges.begin())
+		{
+			++m_nonJitCode[_event];
+			return;
+		}
+
+		--it;
+
+		const auto& r = it->second;
+		const auto offset = _ip - it->first;
+
+		if(offset >= r.size)
+		{
+			++m_nonJitCode[_event];
+			return;
+		}
+
+		++m_blocks[std::make_pair(r.pcFirst, r.pcLast)][_event];
+
+		if(r.pcByCodeOffset.empty())
+			return;
+
+		// last instruction that starts at or before the sampled offset, samples in the block prologue go to the first one
+		auto itPc = std::upper_bound(r.pcByCodeOffset.begin(), r.pcByCodeOffset.end(), std::make_pair(offset, static_cast<TWord>(0xffffffff)));
+		if(itPc != r.pcByCodeOffset.begin())
+			--itPc;
+
+		++m_instructions[itPc->second][_event];
+	}
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+#include "types.h"
+
+namespace dsp56k
+{
+	class JitBlockRuntimeData;
+
+	// Samples hardware performance counters of the DSP thread via Linux perf_event_open and attributes the samples to the
+	// JIT blocks they hit. If JIT profiling support is active, samples are attributed to individual DSP instructions, too.
+	// On other platforms, isValid() returns false
+	class JitPerfCounters
+	{
+	public:
+		enum class Event
+		{
+			Cycles,
+			Instructions,
+			BranchMisses,
+			L1DMisses,
+			DTLBMisses,
+
+			Count
+		};
+
+		static constexpr size_t EventCount = static_cast<size_t>(Event::Count);
+
+		struct Counters
+		{
+			std::array<uint64_t, EventCount> samples{};
+
+			uint64_t& operator[](Event _e)				{ return samples[static_cast<size_t>(_e)]; }
+			uint64_t operator[](Event _e) const			{ return samples[static_cast<size_t>(_e)]; }
+		};
+
+		// counts a single event of the calling thread between start() and stop(). Counts are 0 if the event is not available
+		class EventCounter
+		{
+		public:
+			explicit EventCounter(Event _event);
+			~EventCounter();
+
+			EventCounter(const EventCounter&) = delete;
+			EventCounter& operator=(const EventCounter&) = delete;
+
+			bool isValid() const { return m_fd >= 0; }
+
+			void start() const;
+			uint64_t stop() const;
+
+		private:
+			int m_fd = -1;
+		};
+
+		// needs to be created on the DSP thread, the calling thread is the one that is being measured
+		explicit JitPerfCounters(uint64_t _samplePeriod = 100000);
+		~JitPerfCounters();
+
+		bool isValid() const { return m_valid; }
+
+		void addJitBlock(const JitBlockRuntimeData& _block);
+
+		void writeReport(std::ostream& _out, size_t _maxBlocks = 50);
+		void writeFoldedStacks(std::ostream& _out);
+
+		uint64_t getLostSamples() const { return m_lostSamples; }
+
+	private:
+		struct CodeRange
+		{
+			uint64_t size = 0;
+			TWord pcFirst = 0;
+			TWord pcLast = 0;
+			std::vector<std::pair<uint64_t, TWord>> pcByCodeOffset;	// sorted by code offset
+		};
+
+		struct EventBuffer
+		{
+			int fd = -1;
+			void* mem = nullptr;
+			size_t memSize = 0;
+		};
+
+		void threadFunc();
+		void readSamples();
+		void readSamples(Event _event, EventBuffer& _buffer);
+		void addSample(Event _event, uint64_t _ip);
+
+		const uint64_t m_samplePeriod;
+		bool m_valid = false;
+
+		std::array<EventBuffer, EventCount> m_buffers;
+
+		std::mutex m_mutex;
+		std::map<uint64_t, CodeRange> m_codeRanges;				// by host code address
+		std::map<std::pair<TWord, TWord>, Counters> m_blocks;		// by DSP address range
+		std::map<TWord, Counters> m_instructions;					// by DSP address
+		Counters m_nonJitCode;
+		uint64_t m_lostSamples = 0;
+
+		std::unique_ptr<std::thread> m_thread;
+		std::atomic<bool> m_exit{false};
+	};
+}
@@ -0,0 +1,172 @@
+#include "jitpmemguard.h"
+
+#include <algorithm>
+
+#include "dsp.h"
+
+namespace dsp56k
+{
+	JitPMemGuard::JitPMemGuard(DSP& _dsp) : m_dsp(_dsp)
+	{
+	}
+
+	JitPMemGuard::~JitPMemGuard()
+	{
+		deactivate();
+	}
+
+	bool JitPMemGuard::activate()
+	{
+		if(m_guard)
+			return true;
+
+		auto& mem = m_dsp.memory();
+
+		const auto pageSize = PageGuard::getPageSize();
+		const auto pageWords = static_cast<TWord>(pageSize / sizeof(TWord));
+
+		// a partially covered page at the end would either be unprotected or contain data that is written frequently
+		if(!mem.sizeP() || (mem.sizeP() & (pageWords - 1)))
+		{
+			LOGL(WARNING, "P memory size " << HEX(mem.sizeP()) << " is not a multiple of the host page size, P memory cannot be guarded");
+			return false;
+		}
+
+		m_guard.reset(new PageGuard(mem.getMemAreaPtr(MemArea_P), mem.sizeP() * sizeof(TWord), &onFault, this));
+
+		if(!m_guard->isValid())
+		{
+			LOGL(WARNING, "Failed to guard P memory, falling back to explicit P memory write checks");
+			m_guard.reset();
+			return false;
+		}
+
+		m_pageShift = 0;
+		while((1u << m_pageShift) < pageWords)
+			++m_pageShift;
+
+		m_pageCount = static_cast<TWord>(m_guard->getPageCount());
+
+		m_protectedPages.assign(m_pageCount, 0);
+
+		m_modifiedPages.reset(new std::atomic<uint8_t>[m_pageCount]);
+		for(TWord i=0; i<m_pageCount; ++i)
+			m_modifiedPages[i] = 0;
+
+		m_hasModifiedPages = false;
+
+		m_copy.assign(mem.sizeP(), 0);
+
+		return true;
+	}
+
+	void JitPMemGuard::deactivate()
+	{
+		// unprotects all pages
+		m_guard.reset();
+
+		m_pageCount = 0;
+		m_protectedPages.clear();
+		m_modifiedPages.reset();
+		m_hasModifiedPages = false;
+		m_copy.clear();
+	}
+
+	void JitPMemGuard::protect(const TWord _first, const TWord _count)
+	{
+		if(!m_guard || !_count)
+			return;
+
+		const auto* p = m_dsp.memory().getHostPtr(MemArea_P, 0);
+
+		const auto lastPage = std::min((_first + _count - 1) >> m_pageShift, m_pageCount - 1);
+
+		for(auto page = _first >> m_pageShift; page <= lastPage; ++page)
+		{
+			// modified pages are protected again once they have been processed
+			if(m_protectedPages[page] || m_modifiedPages[page].load(std::memory_order_relaxed))
+				continue;
+
+			const auto first = page << m_pageShift;
+			std::copy_n(p + first, 1u << m_pageShift, m_copy.begin() + first);
+
+			if(m_guard->protect(page))
+				m_protectedPages[page] = 1;
+		}
+	}
+
+	void JitPMemGuard::onWrite(const TWord _addr)
+	{
+		if(_addr < m_copy.size())
+			m_copy[_addr] = *m_dsp.memory().getHostPtr(MemArea_P, _addr);
+	}
+
+	const std::vector<TWord>& JitPMemGuard::processModifiedPages()
+	{
+		m_modifiedAddresses.clear();
+
+		if(!m_hasModifiedPages.exchange(false, std::memory_order_acquire))
+			return m_modifiedAddresses;
+
+		const auto* p = m_dsp.memory().getHostPtr(MemArea_P, 0);
+
+		for(TWord page=0; page<m_pageCount; ++page)
+		{
+			if(!m_modifiedPages[page].exchange(0, std::memory_order_relaxed))
+				continue;
+
+			++m_stats.processedPages;
+
+			const auto first = page << m_pageShift;
+			const auto last = first + (1u << m_pageShift);
+
+			for(auto a = first; a < last; ++a)
+			{
+				if(p[a] == m_copy[a])
+					continue;
+
+				m_copy[a] = p[a];
+				m_modifiedAddresses.push_back(a);
+			}
+
+			// our copy is up to date now, protect it again
+			m_protectedPages[page] = m_guard->protect(page) ? 1 : 0;
+		}
+
+		m_stats.modifiedWords += m_modifiedAddresses.size();
+
+		return m_modifiedAddresses;
+	}
+
+	void JitPMemGuard::reset()
+	{
+		if(!m_guard)
+			return;
+
+		m_guard->unprotectAll();
+
+		std::fill(m_protectedPages.begin(), m_protectedPages.end(), 0);
+
+		for(TWord i=0; i<m_pageCount; ++i)
+			m_modifiedPages[i] = 0;
+
+		m_hasModifiedPages = false;
+	}
+
+	JitPMemGuard::Stats JitPMemGuard::getStats() const
+	{
+		auto stats = m_stats;
+		stats.faults = m_faults.load(std::memory_order_relaxed);
+		return stats;
+	}
+
+	void JitPMemGuard::onFault(void* _user, const size_t _page)
+	{
+		// runs inside of the fault handler
+		auto* guard = static_cast<JitPMemGuard*>(_user);
+
+		guard->m_modifiedPages[_page].store(1, std::memory_order_relaxed);
+		guard->m_hasModifiedPages.store(true, std::memory_order_release);
+		guard->m_faults.fetch_add(1, std::memory_order_relaxed);
+	}
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "types.h"
+
+#include "dsp56kBase/pageguard.h"
+
+namespace dsp56k
+{
+	class DSP;
+
+	// Optional self-modifying code detection for P memory. Pages of P memory that contain JIT code are write protected. The first write
+	// to such a page faults, the page becomes writable and is marked as modified. Modified pages are compared against a copy of their
+	// previous content to find the P addresses whose JIT blocks need to be invalidated, afterwards the page is protected again.
+	// JIT code writes to P memory without any additional checks, the block that writes still terminates to process the modified pages.
+	// Writes to bridged external memory via X or Y addresses are not detected, they use a different mapping of the same memory
+	class JitPMemGuard
+	{
+	public:
+		struct Stats
+		{
+			uint64_t faults = 0;			// writes to protected pages
+			uint64_t processedPages = 0;	// modified pages that have been compared
+			uint64_t modifiedWords = 0;		// P addresses that have been invalidated
+		};
+
+		explicit JitPMemGuard(DSP& _dsp);
+		~JitPMemGuard();
+
+		JitPMemGuard(const JitPMemGuard&) = delete;
+		JitPMemGuard& operator=(const JitPMemGuard&) = delete;
+
+		// fails if P memory is not page aligned or if the host does not support it
+		bool activate();
+		void deactivate();
+		bool isActive() const { return m_guard != nullptr; }
+
+		// write protects all pages that cover the given P memory range
+		void protect(TWord _first, TWord _count);
+
+		// needs to be called for P memory writes that are reported to the JIT explicitly to keep our copy up to date
+		void onWrite(TWord _addr);
+
+		bool hasModifiedPages() const { return m_hasModifiedPages.load(std::memory_order_relaxed); }
+
+		// returns the P addresses that have been modified since the last call
+		const std::vector<TWord>& processModifiedPages();
+
+		// removes the protection of all pages
+		void reset();
+
+		Stats getStats() const;
+
+	private:
+		static void onFault(void* _user, size_t _page);
+
+		DSP& m_dsp;
+
+		std::unique_ptr<PageGuard> m_guard;
+
+		TWord m_pageShift = 0;
+		TWord m_pageCount = 0;
+
+		std::vector<uint8_t> m_protectedPages;
+		std::unique_ptr<std::atomic<uint8_t>[]> m_modifiedPages;
+		std::atomic<bool> m_hasModifiedPages{false};
+
+		std::vector<TWord> m_copy;
+		std::vector<TWord> m_modifiedAddresses;
+
+		std::atomic<uint64_t> m_faults{0};
+		Stats m_stats;
+	};
+}
@@ -1,13 +1,51 @@
 #pragma once
 
+#include <array>
+
+#include "jittypes.h"
 #include "types.h"
 
 namespace dsp56k
 {
 	constexpr TWord g_pcInvalid = 0xffffffff;
 
+	// target of an indirect branch (rts, jmp (rn), ...). The key combines the generation of the function table with the target PC,
+	// func is the function table entry for that PC at that time. As long as the generation is unchanged, func is still valid
+	struct JitIndirectTarget
+	{
+		static constexpr uint64_t InvalidKey = ~0ull;
+
+		static constexpr uint64_t makeKey(const uint32_t _generation, const TWord _pc)
+		{
+			return (static_cast<uint64_t>(_generation) << 32) | _pc;
+		}
+
+		uint64_t key = InvalidKey;
+		TJitFunc func = nullptr;
+	};
+
+	static_assert(sizeof(JitIndirectTarget) == 16, "JIT code indexes indirect targets via shift by 4");
+
+	struct JitIndirectBranchStats
+	{
+		uint64_t cacheHits = 0;			// inline cache at the branch site contained the target
+		uint64_t cacheMisses = 0;		// target has been looked up in the function table
+		uint64_t returnHits = 0;		// rts target matched the return address pushed by the subroutine call
+		uint64_t returnMisses = 0;
+		uint64_t timeSliceExits = 0;	// returned to the dispatcher to give interrupts and peripherals a time slice
+	};
+
 	struct JitRuntimeData
 	{
+		static constexpr uint32_t ReturnStackSize = 16;	// needs to be a power of two
+
+		std::array<JitIndirectTarget, ReturnStackSize> m_returnStack;
+		JitIndirectBranchStats m_indirectBranchStats;
+
+		uint32_t m_returnStackIndex = 0;
+		uint32_t m_linkedIndirectBranches = 0;	// reset by the dispatcher
+		uint32_t m_funcsGeneration = 0;		// incremented whenever the function table changes, invalidates all indirect targets
+
 		TWord m_pMemWriteAddress = g_pcInvalid;
 		TWord m_pMemWriteValue = 0;
 	};
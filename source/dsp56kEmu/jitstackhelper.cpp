@@ -341,6 +341,16 @@ namespace dsp56k
 		return false;
 	}
 
+	bool JitStackHelper::isPushed(const JitReg& _reg) const
+	{
+		for (const auto& r : m_pushedRegs)
+		{
+			if(r.reg.equals(_reg))
+				return true;
+		}
+		return false;
+	}
+
 	uint32_t JitStackHelper::pushSize(const JitReg& _reg)
 	{
 #ifdef HAVE_ARM64
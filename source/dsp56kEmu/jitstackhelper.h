@@ -55,6 +55,7 @@ namespace dsp56k
 		const auto& getUsedRegs() const { return m_usedRegs; }
 
 		bool isUsed(const JitReg& _reg) const;
+		bool isPushed(const JitReg& _reg) const;
 
 		uint32_t pushSize(const JitReg& _reg);
 
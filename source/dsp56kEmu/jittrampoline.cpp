@@ -91,10 +91,15 @@ namespace dsp56k
 
 		for(uint32_t i=0; i<UnrollSize; ++i)
 		{
-			// 1) call interrupt func: (DSP*)
-			// 2) call JIT func:       (DspRegs*, PC)
+			// 1) start a new time slice for linked indirect branches
+			// 2) call interrupt func: (DSP*)
+			// 3) call JIT func:       (DspRegs*, PC)
+
+			m_asm.lea_(r64(g_funcArgGPs[0]), r64(g_ptrDSP), &m_dsp.getJit().getRuntimeData().m_linkedIndirectBranches, &m_dsp);
 
 #ifdef HAVE_ARM64
+			m_asm.str(asmjit::a64::regs::wzr, Jitmem::makePtr(r64(g_funcArgGPs[0]), 4));
+
 			m_asm.ldr(g_funcToCall, Jitmem::makePtr(g_ptrInterruptFunc, 8));
 			m_asm.mov(g_funcArgGPs[0], g_ptrDSP);
 			m_asm.blr(g_funcToCall);
@@ -105,6 +110,8 @@ namespace dsp56k
 			m_asm.mov(r64(g_funcArgGPs[0]), regDspPtr);
 			m_asm.blr(g_funcToCall);
 #else
+			m_asm.mov(Jitmem::makePtr(r64(g_funcArgGPs[0]), 4), asmjit::Imm(0));
+
 			m_asm.mov(g_funcToCall, Jitmem::makePtr(g_ptrInterruptFunc, 8));
 			m_asm.mov(g_funcArgGPs[0], g_ptrDSP);
 			m_asm.call(g_funcToCall);
@@ -1,16 +1,54 @@
 #include "jitunittests.h"
 
+#include <chrono>
+
+#include "debuggerinterface.h"
+#include "esai.h"
 #include "jitasmjithelpers.h"
 #include "jitblock.h"
 #include "jitblockruntimedata.h"
 #include "jitemitter.h"
 #include "jithelper.h"
 #include "jitops.h"
+#include "statestream.h"
+#include "timers.h"
 
 namespace dsp56k
 {
 	static constexpr bool g_useDspMode = true;
 
+	namespace
+	{
+		class TestDebugger final : public DebuggerInterface
+		{
+		public:
+			explicit TestDebugger(DSP& _dsp) : DebuggerInterface(_dsp) {}
+
+			void onExec(const TWord _addr) override
+			{
+				execs.push_back(_addr);
+				if(onExecFunc)
+					onExecFunc(_addr);
+			}
+
+			void onMemoryWrite(const EMemArea _area, const TWord _addr, const TWord _value) override
+			{
+				writes.push_back({_area, _addr, _value});
+			}
+
+			struct Write
+			{
+				EMemArea area;
+				TWord addr;
+				TWord value;
+			};
+
+			std::vector<TWord> execs;
+			std::vector<Write> writes;
+			std::function<void(TWord)> onExecFunc;
+		};
+	}
+
 	JitUnittests::JitUnittests(bool _logging/* = true*/)
 	: m_checks({})
 	, m_logging(_logging)
@@ -52,6 +90,25 @@ namespace dsp56k
 		rep_div();
 
 		parallelMoveXY();
+		aguBitreverse();
+
+		registerResidency();
+		registerResidencyLoop();
+		registerResidencyCall();
+		registerResidencyModeChange();
+		indirectBranchReturnStack();
+		indirectBranchCache();
+		indirectBranchTimeSlice();
+		programMemoryWrite();
+		modeSharing();
+		executionTrace();
+		memoryHeatMap();
+		peripheralMetrics();
+		peripheralInlineAccess();
+		peripheralSpinloops();
+		copyState();
+
+		breakpoints();
 	}
 
 	JitUnittests::~JitUnittests()
@@ -1125,6 +1182,1235 @@ namespace dsp56k
 		});
 	}
 
+	void JitUnittests::aguBitreverse()
+	{
+		// bit-reversed address updates for N = 0, 1, powers of two as used by FFTs and other values, compared to the interpreter.
+		// Updates are done in place (move) and into a temp (lua)
+		constexpr TWord outputAddr = 0x100;
+		constexpr uint32_t iterations = 6;
+
+		TWord pc = 0x600;
+		for(const char* m : {"move #0,m0", "move #0,m1", "move #0,m2", "move #0,m3"})
+			pc = emitToMemory(m, pc);
+
+		for(uint32_t i=0; i<iterations; ++i)
+		{
+			pc = emitToMemory("move (r0)+n0", pc);
+			pc = emitToMemory("lua (r1)-n1,r1", pc);
+			pc = emitToMemory("move (r2)+", pc);
+			pc = emitToMemory("lua (r3)+n3,r3", pc);
+
+			for(const char* store : {"move r0,y:(r4)+", "move r1,y:(r4)+", "move r2,y:(r4)+", "move r3,y:(r4)+"})
+				pc = emitToMemory(store, pc);
+		}
+
+		const auto end = pc;
+		std::stringstream jmp;
+		jmp << "jmp $" << std::hex << end;
+		emitToMemory(jmp.str().c_str(), end);
+
+		DefaultMemoryValidator validator;
+		Memory refMem(validator, 0x080000, 0x800000, 0x200000);
+		Peripherals56362 refPeriphX;
+		Peripherals56367 refPeriphY;
+		DSP ref(refMem, &refPeriphX, &refPeriphY);
+
+		for(TWord i=0x600; i<=end; ++i)
+			refMem.set(MemArea_P, i, mem.get(MemArea_P, i));
+
+		auto setup = [](DSP& _dsp, const TWord _n)
+		{
+			_dsp.resetHW();
+
+			for(uint32_t i=0; i<4; ++i)
+			{
+				_dsp.regs().r[i].var = 0x2345 + i * 0x1111;
+				_dsp.regs().n[i].var = _n;
+			}
+
+			_dsp.regs().r[4].var = outputAddr;
+			_dsp.setPC(0x600);
+		};
+
+		for (const TWord n : {0x0u, 0x1u, 0x2u, 0x10u, 0x400u, 0x800000u, 0x3u, 0x123u, 0x7ffu})
+		{
+			setup(dsp, n);
+			setup(ref, n);
+
+			execUntil(end);
+
+			for(uint32_t i=0; i<10000 && ref.getPC().toWord() != end; ++i)
+				ref.execInterpreter();
+
+			verify(ref.getPC().toWord() == end);
+
+			for(uint32_t i=0; i<4; ++i)
+				verify(dsp.regs().r[i].var == ref.regs().r[i].var);
+
+			for(TWord i=0; i<iterations * 4; ++i)
+				verify(mem.get(MemArea_Y, outputAddr + i) == refMem.get(MemArea_Y, outputAddr + i));
+		}
+
+		dsp.resetHW();
+	}
+
+	void JitUnittests::registerResidency()
+	{
+		auto& jit = dsp.getJit();
+		const auto oldConfig = jit.getConfig();
+
+		auto config = oldConfig;
+		config.linkJitBlocks = true;
+		config.registerResidency = true;
+		jit.setConfig(config);
+		jit.destroyAllBlocks();
+
+		// three blocks that are linked unconditionally, r0 and n0 are passed in host registers from $400 to $410 and from $410 to $420
+		TWord pc = 0x400;
+		pc = emitToMemory("lua (r0)+n0,r0", pc);
+		emitToMemory("jmp $410", pc);
+
+		pc = 0x410;
+		pc = emitToMemory("lua (r0)+n0,r0", pc);
+		pc = emitToMemory("lua (r0)+n0,r0", pc);
+		emitToMemory("jmp $420", pc);
+
+		pc = 0x420;
+		pc = emitToMemory("lua (r0)+n0,r1", pc);
+		emitToMemory("jmp $430", pc);
+
+		emitToMemory("jmp $430", 0x430);
+
+		dsp.resetHW();
+		dsp.regs().r[0].var = 0x10;
+		dsp.regs().n[0].var = 3;
+		dsp.regs().r[1].var = 0;
+
+		dsp.setPC(0x400);
+		execUntil(0x430);
+
+		verify(dsp.regs().r[0].var == 0x19);
+		verify(dsp.regs().r[1].var == 0x1c);
+		verify(dsp.regs().n[0].var == 3);
+
+		verify(jit.getCurrentChain()->getResidencyStats().spillsAvoided > 0);
+
+		// blocks entered from C++ load their entry registers themselves
+		dsp.regs().r[0].var = 0x100;
+		dsp.regs().n[0].var = 1;
+
+		dsp.setPC(0x410);
+		execUntil(0x430);
+
+		verify(dsp.regs().r[0].var == 0x102);
+		verify(dsp.regs().r[1].var == 0x103);
+
+		jit.setConfig(oldConfig);
+		jit.destroyAllBlocks();
+	}
+
+	void JitUnittests::registerResidencyLoop()
+	{
+		auto& jit = dsp.getJit();
+		const auto oldConfig = jit.getConfig();
+
+		auto config = oldConfig;
+		config.linkJitBlocks = true;
+		config.registerResidency = true;
+		jit.setConfig(config);
+		jit.destroyAllBlocks();
+
+		// $780 passes r0 and n0 to the block with the do instruction. The loop body jumps back to its beginning and is entered with
+		// the DSP registers in memory, the block after the loop is entered from the loop body
+		TWord pc = 0x780;
+		pc = emitToMemory("lua (r0)+n0,r0", pc);
+		emitToMemory("jmp $782", pc);
+
+		pc = 0x782;
+		pc = emitToMemory("lua (r0)+n0,r0", pc);
+		pc = emitToMemory("do #4,>$787", pc);
+		pc = emitToMemory("lua (r0)+n0,r0", pc);
+		pc = emitToMemory("move r0,x:(r1)+", pc);
+		pc = emitToMemory("lua (r0)+n0,r2", pc);
+		emitToMemory("jmp $790", pc);
+
+		emitToMemory("jmp $790", 0x790);
+
+		auto run = [&](const TWord _r0, const TWord _n0)
+		{
+			dsp.regs().r[0].var = _r0;
+			dsp.regs().n[0].var = _n0;
+			dsp.regs().r[1].var = 0x20;
+
+			dsp.setPC(0x780);
+			execUntil(0x790);
+
+			verify(dsp.regs().r[0].var == _r0 + 6 * _n0);
+			verify(dsp.regs().r[1].var == 0x24);
+			verify(dsp.regs().r[2].var == _r0 + 7 * _n0);
+			verify(!dsp.sr_test(SR_LF));
+
+			for(TWord i=0; i<4; ++i)
+				verify(mem.get(MemArea_X, 0x20 + i) == _r0 + (3 + i) * _n0);
+		};
+
+		dsp.resetHW();
+
+		// the second run executes the blocks that have been linked by the first one
+		run(0x10, 3);
+		run(0x100, 1);
+
+		const auto* chain = jit.getCurrentChain();
+
+		verify(chain->getBlock(0x782)->getEntryRegCount() > 0);
+		verify(chain->getBlock(0x785)->getEntryRegCount() == 0);
+		verify(chain->getResidencyStats().spillsAvoided > 0);
+
+		jit.setConfig(oldConfig);
+		jit.destroyAllBlocks();
+	}
+
+	void JitUnittests::registerResidencyCall()
+	{
+		auto& jit = dsp.getJit();
+		const auto oldConfig = jit.getConfig();
+
+		auto config = oldConfig;
+		config.linkJitBlocks = true;
+		config.registerResidency = true;
+		config.linkIndirectBranches = true;
+		jit.setConfig(config);
+		jit.destroyAllBlocks();
+
+		// the jsr passes r0 and n0 to the subroutine and pushes the return address in between. The rts returns via the return stack
+		TWord pc = 0x7a0;
+		pc = emitToMemory("lua (r0)+n0,r0", pc);
+		pc = emitToMemory("jsr $7b0", pc);
+		pc = emitToMemory("lua (r0)+n0,r1", pc);
+		emitToMemory("jmp $7a8", pc);
+
+		emitToMemory("jmp $7a8", 0x7a8);
+
+		pc = 0x7b0;
+		pc = emitToMemory("lua (r0)+n0,r0", pc);
+		emitToMemory("rts", pc);
+
+		auto run = [&](const TWord _r0, const TWord _n0)
+		{
+			dsp.regs().r[0].var = _r0;
+			dsp.regs().n[0].var = _n0;
+			dsp.regs().r[1].var = 0;
+
+			const auto sp = dsp.regs().sp.var;
+
+			dsp.setPC(0x7a0);
+			execUntil(0x7a8);
+
+			verify(dsp.regs().r[0].var == _r0 + 2 * _n0);
+			verify(dsp.regs().r[1].var == _r0 + 3 * _n0);
+			verify(dsp.regs().n[0].var == _n0);
+			verify(dsp.regs().sp.var == sp);
+		};
+
+		dsp.resetHW();
+
+		run(0x10, 3);
+		run(0x100, 1);
+		run(0x200, 5);
+
+		const auto& stats = jit.getCurrentChain()->getResidencyStats();
+
+		verify(jit.getCurrentChain()->getBlock(0x7b0)->getEntryRegCount() > 0);
+		verify(stats.linkedEntries > 0);
+		verify(stats.spillsAvoided >= 2);
+
+		jit.setConfig(oldConfig);
+		jit.destroyAllBlocks();
+	}
+
+	void JitUnittests::registerResidencyModeChange()
+	{
+		auto& jit = dsp.getJit();
+		const auto oldConfig = jit.getConfig();
+
+		auto config = oldConfig;
+		config.linkJitBlocks = true;
+		config.registerResidency = true;
+		config.shareChainsAcrossModes = false;
+		jit.setConfig(config);
+		jit.destroyAllBlocks();
+
+		// a block that changes the addressing mode of r1 is not linked, the code after it runs in a different chain and links its
+		// blocks with their own counters
+		TWord pc = 0x7c0;
+		pc = emitToMemory("lua (r0)+n0,r0", pc);
+		pc = emitToMemory("move #$f,m1", pc);
+		emitToMemory("jmp $7d0", pc);
+
+		pc = 0x7d0;
+		pc = emitToMemory("lua (r0)+n0,r0", pc);
+		emitToMemory("jmp $7d4", pc);
+
+		pc = 0x7d4;
+		pc = emitToMemory("lua (r0)+n0,r2", pc);
+		emitToMemory("jmp $7d8", pc);
+
+		emitToMemory("jmp $7d8", 0x7d8);
+
+		auto run = [&](const TWord _r0, const TWord _n0)
+		{
+			dsp.set_m(1, 0xffffff);
+			jit.checkModeChange();
+
+			dsp.regs().r[0].var = _r0;
+			dsp.regs().n[0].var = _n0;
+
+			dsp.setPC(0x7c0);
+			execUntil(0x7d8);
+
+			verify(dsp.regs().r[0].var == _r0 + 2 * _n0);
+			verify(dsp.regs().r[2].var == _r0 + 3 * _n0);
+			verify(dsp.regs().m[1].var == 0xf);
+		};
+
+		dsp.resetHW();
+
+		run(0x10, 3);
+		run(0x100, 1);
+
+		const JitBlockChain* linear = nullptr;
+		const JitBlockChain* modulo = nullptr;
+
+		for(size_t i=0; i<jit.getChainCount(); ++i)
+		{
+			const auto& chain = jit.getChain(i);
+
+			if(chain.getBlock(0x7c0))
+				linear = &chain;
+			if(chain.getBlock(0x7d0))
+				modulo = &chain;
+		}
+
+		verify(linear && modulo && linear != modulo);
+		verify(jit.getCurrentChain() == modulo);
+
+		// the mode change is not linked, only the blocks of the second chain pass registers
+		verify(linear->getResidencyStats().linkedBlocks == 0);
+		verify(linear->getResidencyStats().spillsAvoided == 0);
+		verify(modulo->getResidencyStats().linkedEntries > 0);
+		verify(modulo->getResidencyStats().spillsAvoided > 0);
+
+		dsp.set_m(1, 0xffffff);
+
+		jit.setConfig(oldConfig);
+		jit.destroyAllBlocks();
+	}
+
+	void JitUnittests::indirectBranchReturnStack()
+	{
+		auto& jit = dsp.getJit();
+		const auto oldConfig = jit.getConfig();
+
+		auto config = oldConfig;
+		config.linkIndirectBranches = true;
+		jit.setConfig(config);
+		jit.destroyAllBlocks();
+
+		const auto& stats = jit.getIndirectBranchStats();
+
+		// an unconditional subroutine call pushes its return address, the rts of the subroutine finds it on the return stack
+		TWord pc = 0x4e0;
+		pc = emitToMemory("jsr $4f0", pc);
+		emitToMemory("jmp $4e0", pc);
+
+		pc = 0x4f0;
+		pc = emitToMemory("lua (r3)+,r3", pc);
+		emitToMemory("rts", pc);
+
+		dsp.resetHW();
+		dsp.regs().r[3].var = 0;
+		dsp.setPC(0x4e0);
+
+		// the first iterations compile the blocks, which invalidates the pushed return addresses
+		for(size_t i=0; i<10; ++i)
+			execStep();
+
+		auto before = stats;
+		auto r3 = dsp.regs().r[3].var;
+
+		for(size_t i=0; i<10; ++i)
+			execStep();
+
+		verify(stats.returnHits > before.returnHits);
+		verify(stats.returnMisses == before.returnMisses);
+		// every rts either hits or returns to the dispatcher at the end of a time slice
+		verify(static_cast<uint64_t>(dsp.regs().r[3].var - r3) == stats.returnHits - before.returnHits + stats.timeSliceExits - before.timeSliceExits);
+
+		// a conditional subroutine call does not push its return address, the rts misses the return stack and uses the inline cache of its block
+		pc = 0x500;
+		pc = emitToMemory("andi #$fe,ccr", pc);
+		pc = emitToMemory("jscc $510", pc);
+		emitToMemory("jmp $500", pc);
+
+		pc = 0x510;
+		pc = emitToMemory("lua (r3)+,r3", pc);
+		emitToMemory("rts", pc);
+
+		dsp.setPC(0x500);
+
+		for(size_t i=0; i<10; ++i)
+			execStep();
+
+		before = stats;
+		r3 = dsp.regs().r[3].var;
+
+		for(size_t i=0; i<10; ++i)
+			execStep();
+
+		verify(stats.returnMisses > before.returnMisses);
+		verify(stats.returnHits == before.returnHits);
+		verify(stats.cacheHits - before.cacheHits == stats.returnMisses - before.returnMisses);
+		verify(stats.cacheMisses == before.cacheMisses);
+		verify(static_cast<uint64_t>(dsp.regs().r[3].var - r3) == stats.returnMisses - before.returnMisses + stats.timeSliceExits - before.timeSliceExits);
+
+		jit.setConfig(oldConfig);
+		jit.destroyAllBlocks();
+	}
+
+	void JitUnittests::indirectBranchCache()
+	{
+		auto& jit = dsp.getJit();
+		const auto oldConfig = jit.getConfig();
+
+		auto config = oldConfig;
+		config.linkIndirectBranches = true;
+		jit.setConfig(config);
+		jit.destroyAllBlocks();
+
+		const auto& stats = jit.getIndirectBranchStats();
+
+		TWord pc = 0x520;
+		pc = emitToMemory("lua (r3)+,r3", pc);
+		emitToMemory("jmp (r0)", pc);
+
+		pc = 0x530;
+		pc = emitToMemory("move #$1,r2", pc);
+		emitToMemory("jmp $520", pc);
+
+		dsp.resetHW();
+		dsp.regs().r[0].var = 0x530;
+		dsp.regs().r[2].var = 0;
+		dsp.regs().r[3].var = 0;
+		dsp.setPC(0x520);
+
+		for(size_t i=0; i<10; ++i)
+			execStep();
+
+		verify(dsp.regs().r[2].var == 1);
+
+		// all blocks exist, the indirect branch always finds its target in the inline cache
+		auto before = stats;
+		const auto r3 = dsp.regs().r[3].var;
+
+		for(size_t i=0; i<10; ++i)
+			execStep();
+
+		verify(stats.cacheHits > before.cacheHits);
+		verify(stats.cacheMisses == before.cacheMisses);
+		verify(static_cast<uint64_t>(dsp.regs().r[3].var - r3) == stats.cacheHits - before.cacheHits + stats.timeSliceExits - before.timeSliceExits);
+
+		// a write to P memory destroys the target block and increases the generation of the function table, the cached target is no longer used
+		const auto generation = jit.getRuntimeData().m_funcsGeneration;
+
+		emitToMemory("move #$2,r2", 0x530);
+		jit.notifyProgramMemWrite(0x530);
+
+		verify(jit.getRuntimeData().m_funcsGeneration != generation);
+
+		before = stats;
+
+		for(size_t i=0; i<10; ++i)
+			execStep();
+
+		verify(stats.cacheMisses > before.cacheMisses);
+		verify(dsp.regs().r[2].var == 2);
+
+		jit.setConfig(oldConfig);
+		jit.destroyAllBlocks();
+	}
+
+	void JitUnittests::indirectBranchTimeSlice()
+	{
+		auto& jit = dsp.getJit();
+		const auto oldConfig = jit.getConfig();
+
+		constexpr uint32_t maxLinked = 8;
+
+		auto config = oldConfig;
+		config.linkIndirectBranches = true;
+		config.maxLinkedIndirectBranches = maxLinked;
+		jit.setConfig(config);
+		jit.destroyAllBlocks();
+
+		const auto& stats = jit.getIndirectBranchStats();
+
+		// endless loop that never returns to the dispatcher on its own
+		emitToMemory("jmp (r0)", 0x540);
+
+		dsp.resetHW();
+		dsp.regs().r[0].var = 0x540;
+		dsp.setPC(0x540);
+
+		execStep();
+
+		// every dispatcher call starts a new time slice
+		for(size_t i=0; i<3; ++i)
+		{
+			const auto instructions = dsp.getInstructionCounter();
+			const auto exits = stats.timeSliceExits;
+
+			execStep();
+
+			verify(dsp.getInstructionCounter() - instructions == maxLinked);
+			verify(stats.timeSliceExits == exits + 1);
+		}
+
+		// an interrupt is serviced by the next dispatcher call
+		bool serviced = false;
+		const auto vba = dsp.registerInterruptFunc([&serviced] { serviced = true; });
+		dsp.injectInterrupt(vba);
+
+		execStep();
+
+		verify(serviced);
+		verify(dsp.getPC().toWord() == 0x540);
+
+		jit.setConfig(oldConfig);
+		jit.destroyAllBlocks();
+	}
+
+	void JitUnittests::programMemoryWrite()
+	{
+		auto& jit = dsp.getJit();
+		const auto oldConfig = jit.getConfig();
+
+		// JIT code patches the immediate of a block that has already been compiled. Without the guard, the writing block reports the address,
+		// with the guard, the write faults and the modified page is compared against its copy
+		for(const auto guard : {false, true})
+		{
+			auto config = oldConfig;
+			config.guardProgramMemory = guard;
+			jit.setConfig(config);
+			jit.destroyAllBlocks();
+
+			TWord pc = 0x700;
+			pc = emitToMemory("move #>$000001,a", pc);
+			emitToMemory("jmp $710", pc);
+
+			pc = emitToMemory("move x0,p:(r0)", 0x710);
+			emitToMemory("jmp $720", pc);
+
+			emitToMemory("jmp $720", 0x720);
+
+			const auto faults = jit.getPMemGuard().getStats().faults;
+
+			dsp.resetHW();
+			dsp.regs().r[0].var = 0x701;
+			dsp.x0(0x000005);
+			dsp.setPC(0x700);
+
+			execUntil(0x720);
+
+			verify(dsp.regs().a.var == 0x00000001000000);
+			verify(dsp.memory().get(MemArea_P, 0x701) == 0x000005);
+
+			// the block at $700 needs to be recompiled with the new immediate
+			dsp.setPC(0x700);
+
+			execUntil(0x720);
+
+			verify(dsp.regs().a.var == 0x00000005000000);
+
+			if(guard && jit.getPMemGuard().isActive())
+				verify(jit.getPMemGuard().getStats().faults > faults);
+		}
+
+		jit.setConfig(oldConfig);
+		jit.destroyAllBlocks();
+	}
+
+	void JitUnittests::modeSharing()
+	{
+		auto& jit = dsp.getJit();
+		const auto oldConfig = jit.getConfig();
+
+		auto config = oldConfig;
+		config.shareChainsAcrossModes = true;
+		jit.setConfig(config);
+		jit.destroyAllBlocks();
+
+		// only the addressing mode of r0 is used
+		emitToMemory("move (r0)+n0", 0x740);
+		emitToMemory("jmp $750", 0x741);
+		emitToMemory("jmp $750", 0x750);
+
+		auto run = [&](const TWord _m0, const TWord _m1)
+		{
+			dsp.set_m(0, _m0);
+			dsp.set_m(1, _m1);
+			jit.checkModeChange();
+
+			dsp.regs().r[0].var = 0x18;
+			dsp.regs().n[0].var = 0xc;
+			dsp.setPC(0x740);
+
+			execUntil(0x750);
+
+			return dsp.regs().r[0].var;
+		};
+
+		verify(run(0xffffff, 0xffffff) == 0x24);
+
+		const auto& totals = jit.getCompileStats().getTotals();
+
+		const auto chains = jit.getChainStats();
+		const auto blocks = totals.blocks;
+
+		// switching the addressing mode of r1 continues with the same chain, the blocks are reused
+		verify(run(0xffffff, 0x00000f) == 0x24);
+
+		auto stats = jit.getChainStats();
+		verify(stats.createdChains == chains.createdChains);
+		verify(stats.sharedModeChanges > chains.sharedModeChanges);
+		verify(totals.blocks == blocks);
+
+		// a different addressing mode of r0 needs a new chain, modulo 16 wraps r0 to the lower bound
+		verify(run(0x00000f, 0x00000f) == 0x14);
+
+		stats = jit.getChainStats();
+		verify(stats.createdChains == chains.createdChains + 1);
+		verify(totals.blocks > blocks);
+
+		// switching back finds the first chain again
+		const auto blocksModulo = totals.blocks;
+
+		verify(run(0xffffff, 0xffffff) == 0x24);
+
+		verify(jit.getChainStats().createdChains == stats.createdChains);
+		verify(totals.blocks == blocksModulo);
+
+		dsp.set_m(0, 0xffffff);
+		dsp.set_m(1, 0xffffff);
+
+		jit.setConfig(oldConfig);
+		jit.destroyAllBlocks();
+	}
+
+	void JitUnittests::executionTrace()
+	{
+		dsp.enableExecutionTrace(64, true);
+
+		TWord pc = 0x440;
+		pc = emitToMemory("move #$12,r2", pc);
+		emitToMemory("jmp $450", pc);
+
+		pc = 0x450;
+		pc = emitToMemory("move #$34,r3", pc);
+		emitToMemory("jmp $460", pc);
+
+		emitToMemory("jmp $460", 0x460);
+
+		dsp.resetHW();
+		dsp.setPC(0x440);
+		execUntil(0x460);
+
+		// block entries are written by JIT code, register deltas by C++
+		const auto entries = dsp.getExecutionTrace()->getEntries();
+
+		const ExecutionTrace::Entry* blockA = nullptr;
+		const ExecutionTrace::Entry* blockB = nullptr;
+		const ExecutionTrace::Entry* r2 = nullptr;
+
+		for (const auto& e : entries)
+		{
+			if(e.type == ExecutionTrace::EntryType::Block)
+			{
+				if(e.pc == 0x440 && !blockA)
+					blockA = &e;
+				else if(e.pc == 0x450 && blockA && !blockB)
+					blockB = &e;
+			}
+			else if(e.reg == Reg_R2 && blockB && !r2)
+			{
+				r2 = &e;
+			}
+		}
+
+		verify(blockA && blockB);
+		verify(blockA->length == 2 && blockB->length == 2);
+		verify(blockB->instructions > blockA->instructions);
+		verify(blockB->value > blockA->value);
+		verify(r2 && r2->pc == 0x450 && r2->value == 0x12);
+
+		dsp.disableExecutionTrace();
+	}
+
+	void JitUnittests::memoryHeatMap()
+	{
+		TWord pc = 0x470;
+		pc = emitToMemory("move #$20,r0", pc);
+		for(size_t i=0; i<12; ++i)
+			pc = emitToMemory("move x:(r0)+,a", pc);
+		emitToMemory("jmp $47d", pc);
+
+		// JIT code counts the sample period down inline and calls C++ for every third read only
+		dsp.enableMemoryHeatMap(3, 0);
+
+		dsp.resetHW();
+		dsp.setPC(0x470);
+		execUntil(0x47d);
+
+		const auto* heatMap = dsp.getMemoryHeatMap();
+
+		const auto samples = heatMap->getSamples(MemArea_X);
+		verify(samples.size() == 4);
+
+		for (const TWord addr : {0x22u, 0x25u, 0x28u, 0x2bu})
+		{
+			const auto it = samples.find(addr);
+			verify(it != samples.end() && it->second.reads == 1 && it->second.writes == 0);
+		}
+
+		// the countdown continues across block executions, twelve reads hit the same addresses again
+		dsp.setPC(0x470);
+		execUntil(0x47d);
+
+		for (const auto& [addr, counters] : heatMap->getSamples(MemArea_X))
+			verify(counters.reads == 2);
+
+		// writes are sampled inline as well and do not need to be routed through C++
+		pc = 0x4a0;
+		pc = emitToMemory("move #$100,r1", pc);
+		for(size_t i=0; i<6; ++i)
+			pc = emitToMemory("move a,y:(r1)+", pc);
+		const auto writesEnd = pc;
+		std::stringstream jmp;
+		jmp << "jmp $" << std::hex << writesEnd;
+		emitToMemory(jmp.str().c_str(), pc);
+
+		heatMap->clear();
+
+		dsp.setPC(0x4a0);
+		execUntil(writesEnd);
+
+		const auto writes = heatMap->getSamples(MemArea_Y);
+		verify(writes.size() == 2);
+
+		for (const TWord addr : {0x102u, 0x105u})
+		{
+			const auto it = writes.find(addr);
+			verify(it != writes.end() && it->second.writes == 1 && it->second.reads == 0);
+		}
+
+		dsp.disableMemoryHeatMap();
+	}
+
+	void JitUnittests::peripheralMetrics()
+	{
+		TWord pc = 0x4b0;
+		pc = emitToMemory("movep x:<<$ffffb3,x0", pc);		// SAISR, read via pointer
+		pc = emitToMemory("movep x0,x:<<$ffff8d", pc);		// TCPR0, plain store
+		pc = emitToMemory("movep x0,x:<<$ffffa0", pc);		// TX0, slot store that does not reach the flag edge
+		pc = emitToMemory("movep x:<<$ffff8c,x1", pc);		// TCR0, read via pointer
+		const auto end = pc;
+
+		std::stringstream jmp;
+		jmp << "jmp $" << std::hex << end;
+		emitToMemory(jmp.str().c_str(), pc);
+
+		using Metric = DspMetrics::Metric;
+
+		auto& metrics = dsp.getMetrics();
+
+		const auto reads = metrics.get(Metric::PeriphXReads);
+		const auto writes = metrics.get(Metric::PeriphXWrites);
+		const auto readsY = metrics.get(Metric::PeriphYReads);
+
+		// accesses that JIT code performs inline are counted at runtime, not when compiling
+		for(uint64_t i=1; i<=2; ++i)
+		{
+			dsp.setPC(0x4b0);
+			execUntil(end);
+
+			verify(metrics.get(Metric::PeriphXReads) == reads + i * 2);
+			verify(metrics.get(Metric::PeriphXWrites) == writes + i * 2);
+			verify(metrics.get(Metric::PeriphYReads) == readsY);
+		}
+	}
+
+	void JitUnittests::peripheralInlineAccess()
+	{
+		// registers that JIT code accesses inline need to behave exactly like the virtual read()/write() functions of the peripherals.
+		// Every access sequence runs as JIT code first, then the initial state is restored and the same accesses are made via the DSP.
+		// Read values, peripheral state and metrics need to match
+		struct Access
+		{
+			bool write;
+			TWord address;
+			TWord value;
+		};
+
+		auto saveState = [](const IPeripherals& _periph)
+		{
+			std::vector<uint8_t> state;
+			StateWriter w(state);
+			_periph.saveState(w);
+			return state;
+		};
+
+		auto& metrics = dsp.getMetrics();
+
+		auto compare = [&](IPeripherals& _periph, const EMemArea _area, const std::vector<Access>& _accesses, const bool _registerValues)
+		{
+			verify(_accesses.size() <= m_checks.size());
+
+			const auto readMetric = DspMetrics::periphAccess(_area, false);
+			const auto writeMetric = DspMetrics::periphAccess(_area, true);
+
+			const auto initialState = saveState(_periph);
+			const auto reads = metrics.get(readMetric);
+			const auto writes = metrics.get(writeMetric);
+
+			runTest([&]
+			{
+				for(size_t i=0; i<_accesses.size(); ++i)
+				{
+					const auto& a = _accesses[i];
+
+					if(!a.write)
+					{
+						DspValue v(*block);
+						block->mem().readPeriph(v, _area, a.address, Movep_ppea);
+						block->mem().mov(m_checks[i], v.get());
+					}
+					else if(_registerValues)
+					{
+						DspValue v(*block, UsePooledTemp);
+						v.temp(DspValue::Temp24);
+						block->asm_().mov(r32(v.get()), asmjit::Imm(a.value));
+						block->mem().writePeriph(_area, a.address, v);
+					}
+					else
+					{
+						block->mem().writePeriph(_area, a.address, DspValue(*block, a.value));
+					}
+				}
+			}, [&]
+			{
+				const auto jitState = saveState(_periph);
+				const auto jitReads = metrics.get(readMetric) - reads;
+				const auto jitWrites = metrics.get(writeMetric) - writes;
+
+				StateReader r(initialState);
+				_periph.loadState(r);
+				verify(r.ok());
+
+				for(size_t i=0; i<_accesses.size(); ++i)
+				{
+					const auto& a = _accesses[i];
+
+					if(a.write)
+						dsp.memWritePeriph(_area, a.address, a.value);
+					else
+						verify(dsp.memReadPeriph(_area, a.address, Movep_ppea) == static_cast<TWord>(m_checks[i]));
+				}
+
+				verify(saveState(_periph) == jitState);
+				verify(metrics.get(readMetric) - reads - jitReads == jitReads);
+				verify(metrics.get(writeMetric) - writes - jitWrites == jitWrites);
+			});
+		};
+
+		auto compareAll = [&](IPeripherals& _periph, const EMemArea _area, const std::function<void()>& _setup, const std::vector<Access>& _accesses)
+		{
+			for(const auto registerValues : {false, true})
+			{
+				_setup();
+				compare(_periph, _area, _accesses, registerValues);
+			}
+		};
+
+		auto collect = [](IPeripherals& _periph, const PeriphAccess::Type _type, const bool _write)
+		{
+			std::vector<TWord> addresses;
+			for(TWord a = 0xffff80; a <= 0xffffff; ++a)
+			{
+				const auto access = _write ? _periph.writeAccess(a) : _periph.readAccess(a, Movep_ppea);
+				if(access.type == _type)
+					addresses.push_back(a);
+			}
+			return addresses;
+		};
+
+		auto noSetup = []{};
+
+		// plain registers: timer compare registers and DMA address/count registers
+		{
+			std::vector<Access> accesses;
+			for(const auto a : collect(peripheralsX, PeriphAccess::Type::Plain, true))
+				accesses.push_back({true, a, 0x100000 + static_cast<TWord>(accesses.size())});
+
+			verify(accesses.size() == 3 + 6 * 3);
+			compareAll(peripheralsX, MemArea_X, noSetup, accesses);
+		}
+
+		// timer status registers: TE edges call C++, as well as writes that involve TOF/TCF
+		{
+			constexpr TWord te = 1 << Timer::M_TE;
+			constexpr TWord trm = 1 << Timer::M_TRM;
+			constexpr TWord tof = 1 << Timer::M_TOF;
+			constexpr TWord tcf = 1 << Timer::M_TCF;
+
+			const auto tcsrs = collect(peripheralsX, PeriphAccess::Type::Flags, true);
+			verify(tcsrs.size() == 3);
+
+			for(const auto tcsr : tcsrs)
+			{
+				compareAll(peripheralsX, MemArea_X, noSetup, {{true, tcsr, te}, {true, tcsr, te | trm}, {true, tcsr, te | trm | tof}, {true, tcsr, te | tcf}, {true, tcsr, 0}});
+
+				// a flag that is set in the register always needs C++
+				compareAll(peripheralsX, MemArea_X, [&]
+				{
+					*peripheralsX.writeAccess(tcsr).value |= tof;
+				}, {{true, tcsr, trm}, {true, tcsr, 0}});
+			}
+		}
+
+		// audio interface slots: C++ is called only by the access that completes a frame
+		auto compareEsai = [&](IPeripherals& _periph, const EMemArea _area, Esai& _esai, const TWord _tcr, const TWord _rcr)
+		{
+			const auto txs = collect(_periph, PeriphAccess::Type::Slot, true);
+			const auto rxs = collect(_periph, PeriphAccess::Type::Slot, false);
+
+			verify(txs.size() == 6);
+			verify(rxs.size() == 4);
+
+			auto setup = [&](const TWord _enabledTX, const TWord _enabledRX)
+			{
+				return [&, _enabledTX, _enabledRX]
+				{
+					dsp.memWritePeriph(_area, _tcr, _enabledTX);
+					dsp.memWritePeriph(_area, _rcr, _enabledRX);
+
+					for(size_t i=0; i<rxs.size(); ++i)
+					{
+						const auto access = _periph.readAccess(rxs[i], Movep_ppea);
+						*access.value = 0x200000 + static_cast<TWord>(i);
+						*access.pending = _enabledRX;
+					}
+
+					_esai.writestatusRegister((1<<Esai::M_TDE) | (1<<Esai::M_TUE) | (1<<Esai::M_RDF) | (1<<Esai::M_ROE));
+				};
+			};
+
+			std::vector<Access> accesses;
+
+			// all slots enabled, the last write/read clears the flags
+			for(const auto a : txs)
+				accesses.push_back({true, a, 0x300000 + static_cast<TWord>(accesses.size())});
+			for(const auto a : rxs)
+				accesses.push_back({false, a, 0});
+
+			compareAll(_periph, _area, setup(Esai::M_TEM, Esai::M_REM), accesses);
+
+			// disabled slots are accessed, too. A disabled receiver returns zero
+			accesses = {{true, txs[1], 0x400001}, {true, txs[0], 0x400000}, {true, txs[2], 0x400002}, {false, rxs[1], 0}, {false, rxs[0], 0}, {false, rxs[2], 0}};
+
+			compareAll(_periph, _area, setup(0x5, 0x5), accesses);
+
+			// the flag edge is reached repeatedly if a slot is written or read again
+			accesses = {{true, txs[0], 0x500000}, {true, txs[0], 0x500001}, {false, rxs[0], 0}, {false, rxs[0], 0}};
+
+			compareAll(_periph, _area, setup(0x1, 0x1), accesses);
+
+			dsp.memWritePeriph(_area, _tcr, 0);
+			dsp.memWritePeriph(_area, _rcr, 0);
+		};
+
+		compareEsai(peripheralsX, MemArea_X, peripheralsX.getEsai(), Esai::M_TCR, Esai::M_RCR);
+		compareEsai(peripheralsY, MemArea_Y, peripheralsY.getEsai(), Esai::M_TCR_1, Esai::M_RCR_1);
+	}
+
+	void JitUnittests::peripheralSpinloops()
+	{
+		auto& hdi08 = peripheralsX.getHDI08();
+		auto& esai = peripheralsX.getEsai();
+
+		hdi08.clearRX();
+		esai.writestatusRegister(0);
+
+		// every polling loop is followed by a jump to self that the DSP reaches once the loop exits
+		TWord pc = 0x490;
+
+		auto emitLoop = [&](const char* _op, const bool _relative)
+		{
+			const auto loop = pc;
+
+			std::stringstream ss;
+			if(_relative)
+				ss << _op << ">$0";
+			else
+				ss << _op << '$' << std::hex << loop;
+			pc = emitToMemory(ss.str().c_str(), pc);
+
+			const auto next = pc;
+
+			std::stringstream jmp;
+			jmp << "jmp $" << std::hex << next;
+			pc = emitToMemory(jmp.str().c_str(), pc);
+
+			return std::make_pair(loop, next);
+		};
+
+		const auto hostReceive = emitLoop("jclr #$0,x:<<$ffffc3,", false);		// wait for HRDF
+		const auto esaiTDE = emitLoop("brclr #$f,x:<<$ffffb3,", true);			// wait for TDE, relative
+		const auto esaiNotTDE = emitLoop("jset #$f,x:<<$ffffb3,", false);		// wait for TDE to be cleared
+
+		// each iteration skips to the next peripheral deadline, the skipped cycles are counted as idle time
+		auto spin = [&](const TWord _loop)
+		{
+			dsp.setPC(_loop);
+
+			for(size_t i=0; i<4; ++i)
+			{
+				const auto instructions = dsp.getInstructionCounter();
+				const auto cycles = dsp.getCycles();
+				const auto idle = dsp.getIdleCycles();
+
+				execStep();
+
+				verify(dsp.getPC().var == _loop);
+
+				const auto skipped = dsp.getIdleCycles() - idle;
+
+				verify(skipped > 0);
+				verify(dsp.getInstructionCounter() - instructions > skipped);
+				verify(dsp.getCycles() - cycles > skipped);
+				verify(dsp.getInstructionCounter() >= peripheralsX.getTargetClock());
+			}
+		};
+
+		// the loop exits as soon as the bit flips, without skipping any time
+		auto wake = [&](const TWord _next)
+		{
+			const auto idle = dsp.getIdleCycles();
+			execUntil(_next);
+			verify(dsp.getIdleCycles() == idle);
+		};
+
+		spin(hostReceive.first);
+		hdi08.writeRX(std::vector<TWord>{0x123456});
+		wake(hostReceive.second);
+		hdi08.clearRX();
+
+		spin(esaiTDE.first);
+		esai.writestatusRegister(1 << Esai::M_TDE);
+		wake(esaiTDE.second);
+
+		spin(esaiNotTDE.first);
+		esai.writestatusRegister(0);
+		wake(esaiNotTDE.second);
+	}
+
+	void JitUnittests::copyState()
+	{
+		TWord pc = 0x4c0;
+		pc = emitToMemory("move #$10,x0", pc);
+		pc = emitToMemory("move #$300,r0", pc);
+		pc = emitToMemory("clr a", pc);
+
+		// the clone continues inside of the loop body, it does not execute the do instruction before it compiles the body
+		const auto loop = pc;
+		const auto loopEnd = loop + 4;
+
+		std::stringstream doLoop;
+		doLoop << "do #$5,>$" << std::hex << loopEnd;
+		pc = emitToMemory(doLoop.str().c_str(), pc);
+		pc = emitToMemory("add x0,a", pc);
+		pc = emitToMemory("move a,x:(r0)+", pc);
+
+		std::stringstream jmp;
+		jmp << "jmp $" << std::hex << loop;
+		emitToMemory(jmp.str().c_str(), pc);
+
+		dsp.resetHW();
+		dsp.setPC(0x4c0);
+
+		for(size_t i=0; i<20; ++i)
+			execStep();
+
+		for(size_t i=0; i<20 && !dsp.sr_test(SR_LF); ++i)
+			execStep();
+
+		verify(dsp.sr_test(SR_LF));
+
+		DefaultMemoryValidator validator;
+		Memory cloneMem(validator, 0x080000, 0x800000, 0x200000);
+		Peripherals56362 clonePeriphX;
+		Peripherals56367 clonePeriphY;
+		DSP clone(cloneMem, &clonePeriphX, &clonePeriphY);
+
+		const auto& cloneStats = clone.getJit().getCompileStats().getTotals();
+
+		const auto t = std::chrono::steady_clock::now();
+		verify(clone.copyStateFrom(dsp));
+		const auto cloneNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t).count();
+
+		// nothing is compiled while copying, blocks are compiled on first entry
+		verify(cloneStats.blocks == 0);
+		verify(clone.getJit().getChainStats().codeBytes == 0);
+
+		LOG("Copying the DSP state took " << cloneNs << "ns, compiling the blocks of the source took " << dsp.getJit().getCompileStats().getTotals().getTotalNs() << "ns");
+
+		for(size_t i=0; i<200; ++i)
+		{
+			dsp.execJit();
+			clone.execJit();
+		}
+
+		verify(cloneStats.blocks > 0);
+
+		const auto& a = dsp.readRegs();
+		const auto& b = clone.readRegs();
+
+		verify(a.pc == b.pc);
+		verify(a.a == b.a);
+		verify(a.r[0] == b.r[0]);
+		verify(a.sr == b.sr);
+		verify(a.lc == b.lc);
+		verify(dsp.getInstructionCounter() == clone.getInstructionCounter());
+
+		for(TWord i=0x300; i<a.r[0].var; ++i)
+			verify(mem.get(MemArea_X, i) == cloneMem.get(MemArea_X, i));
+	}
+
+	void JitUnittests::breakpoints()
+	{
+		auto& jit = dsp.getJit();
+		jit.destroyAllBlocks();
+
+		TWord pc = 0x480;
+		pc = emitToMemory("move #$1,r2", pc);
+		pc = emitToMemory("move #$2,r3", pc);
+		pc = emitToMemory("move r3,x:$10", pc);
+		pc = emitToMemory("move #$3,r4", pc);
+		emitToMemory("jmp $485", pc);
+
+		emitToMemory("jmp $485", 0x485);
+
+		auto run = [&]()
+		{
+			dsp.regs().r[2].var = dsp.regs().r[3].var = dsp.regs().r[4].var = 0;
+			dsp.memory().set(MemArea_X, 0x10, 0);
+
+			dsp.setPC(0x480);
+			execUntil(0x485);
+		};
+
+		dsp.resetHW();
+
+		// one block at $480, one at $485
+		run();
+		execStep();
+
+		TestDebugger debugger(dsp);
+		dsp.setDebugger(&debugger);
+
+		const auto& stats = jit.getCompileStats().getTotals();
+
+		// the vector table is compiled as fast interrupts, which cannot trap
+		verify(!jit.setBreakpoint(0x10, true));
+		verify(!Jit::supportsBreakpoint(Vba_End - 1));
+
+		// only the block covering the breakpoint is destroyed
+		auto destroyed = stats.destroyedBlocks;
+		auto created = stats.blocks;
+
+		verify(jit.setBreakpoint(0x482, true));
+		verify(stats.destroyedBlocks == destroyed + 1);
+
+		// the block is split in two, the second one traps on entry. The debugger may modify the DSP state before the block is executed
+		debugger.onExecFunc = [&](const TWord _addr)
+		{
+			if(_addr == 0x482)
+				dsp.regs().r[3].var = 0x5;
+		};
+
+		run();
+
+		verify(stats.blocks == created + 2);
+		verify(dsp.regs().r[2].var == 1);
+		verify(dsp.regs().r[4].var == 3);
+
+#if DSP56300_DEBUGGER
+		verify(debugger.execs.size() == 1 && debugger.execs.front() == 0x482);
+		verify(dsp.memory().get(MemArea_X, 0x10) == 5);
+#else
+		verify(dsp.memory().get(MemArea_X, 0x10) == 2);
+#endif
+
+		// existing blocks trap, too
+		debugger.execs.clear();
+		debugger.onExecFunc = nullptr;
+		created = stats.blocks;
+
+		run();
+
+		verify(stats.blocks == created);
+		verify(dsp.memory().get(MemArea_X, 0x10) == 2);
+#if DSP56300_DEBUGGER
+		verify(debugger.execs.size() == 1 && debugger.execs.front() == 0x482);
+#endif
+
+		// resume without the breakpoint
+		debugger.execs.clear();
+		destroyed = stats.destroyedBlocks;
+
+		verify(jit.setBreakpoint(0x482, false));
+		verify(stats.destroyedBlocks == destroyed + 1);
+
+		run();
+
+		verify(debugger.execs.empty());
+		verify(dsp.memory().get(MemArea_X, 0x10) == 2);
+
+		// watchpoints report stores to watched addresses only
+		jit.setWatchpoint(MemArea_X, 0x10, true);
+		debugger.writes.clear();
+
+		run();
+
+		verify(dsp.memory().get(MemArea_X, 0x10) == 2);
+#if DSP56300_DEBUGGER
+		verify(debugger.writes.size() == 1);
+		verify(debugger.writes.front().area == MemArea_X && debugger.writes.front().addr == 0x10 && debugger.writes.front().value == 2);
+#endif
+
+		jit.setWatchpoint(MemArea_X, 0x10, false);
+		jit.setWatchpoint(MemArea_X, 0x11, true);
+		debugger.writes.clear();
+
+		run();
+
+		verify(debugger.writes.empty());
+		verify(dsp.memory().get(MemArea_X, 0x10) == 2);
+
+		jit.setWatchpoint(MemArea_X, 0x11, false);
+
+		dsp.setDebugger(nullptr);
+		jit.destroyAllBlocks();
+	}
+
 	void JitUnittests::emit(const TWord _opA, TWord _opB, TWord _pc)
 	{
 		JitDspMode mode;
@@ -74,6 +74,27 @@ namespace dsp56k
 
 		// host register pressure test
 		void parallelMoveXY();
+		void aguBitreverse();
+
+		// linked blocks passing registers in host registers
+		void registerResidency();
+		void registerResidencyLoop();
+		void registerResidencyCall();
+		void registerResidencyModeChange();
+		void indirectBranchReturnStack();
+		void indirectBranchCache();
+		void indirectBranchTimeSlice();
+		void programMemoryWrite();
+		void modeSharing();
+		void executionTrace();
+		void memoryHeatMap();
+		void peripheralMetrics();
+		void peripheralInlineAccess();
+		void peripheralSpinloops();
+		void copyState();
+
+		// debugger support
+		void breakpoints();
 
 		void emit(TWord _opA, TWord _opB = 0, TWord _pc = 0) override;
 		void execStep() override { dsp.execJit(); }
@@ -1,19 +1,44 @@
 #include "memory.h"
 
 
+#include <algorithm>
 #include <fstream>
 #include <iomanip>
 
 #include "disasm.h"
 #include "dsp.h"
 #include "error.h"
+#include "memoryheatmap.h"
 #include "omfloader.h"
 
+#include "dsp56kBase/buildconfig.h"
+#include "dsp56kBase/hugepages.h"
+#include "dsp56kBase/pageguard.h"
+
+#ifdef _MSC_VER
+#	include <intrin.h>
+#endif
+
 namespace dsp56k
 {
 	constexpr bool g_useInitPattern	= false;
 	constexpr TWord g_initPattern	= 0xabcabcab;
 
+	namespace
+	{
+		// _v must not be zero
+		TWord countTrailingZeros(const uint64_t _v)
+		{
+#ifdef _MSC_VER
+			unsigned long index;
+			_BitScanForward64(&index, _v);
+			return static_cast<TWord>(index);
+#else
+			return static_cast<TWord>(__builtin_ctzll(_v));
+#endif
+		}
+	}
+
 	// _____________________________________________________________________________
 	// Memory
 	//
@@ -28,8 +53,7 @@ namespace dsp56k
 
 		if(!address)
 		{
-			m_buffer.resize(static_cast<size_t>(_memSize) * MemArea_COUNT, 0);
-			address = &m_buffer[0];
+			address = allocateBuffer(static_cast<size_t>(_memSize) * MemArea_COUNT);
 		}
 
 		p = address;	address += sizeP();
@@ -40,16 +64,13 @@ namespace dsp56k
 		m_mem[MemArea_Y] = y;
 		m_mem[MemArea_P] = p;
 
-#if MEMORY_HEAT_MAP
-		for(size_t i=0; i<MemArea_COUNT; ++i)
-			m_heatMap[i].resize(size());
-#endif
+		initBuffer(_memSize);
 
 		if(g_useInitPattern)
 			fillWithInitPattern();
 	}
 
-	Memory::Memory(const IMemoryValidator& _memoryMap, TWord _memSizeP, TWord _memSizeXY, TWord _brigedMemoryAddress/* = 0*/, TWord* _externalBuffer/* = nullptr*/)
+	Memory::Memory(const IMemoryValidator& _memoryMap, TWord _memSizeP, TWord _memSizeXY, TWord _brigedMemoryAddress/* = 0*/, TWord* _externalBuffer/* = nullptr*/, const MemoryLayout _layout/* = MemoryLayout::Planar*/)
 		: m_memoryMap(_memoryMap)
 		, m_size({_memSizeP, _memSizeXY, _memSizeXY})
 		, m_mem({nullptr})
@@ -75,10 +96,21 @@ namespace dsp56k
 
 			if(!address)
 			{
-				m_buffer.resize(calcMemSize(_memSizeP, _memSizeXY, _brigedMemoryAddress), 0);
-				address = &m_buffer[0];
+				address = allocateBuffer(calcMemSize(_memSizeP, _memSizeXY, _brigedMemoryAddress));
 			}
 
+#ifndef HAVE_ARM64	// JIT code would need an additional instruction per access to scale the index register
+			if(_layout == MemoryLayout::InterleavedXY && _brigedMemoryAddress >= _memSizeXY)
+			{
+				// X at even, Y at odd host addresses
+				p = address;	address += pSize;
+				x = address;
+				y = address + 1;
+
+				m_addressShift[MemArea_X] = m_addressShift[MemArea_Y] = 1;
+			}
+			else
+#endif
 			// try to keep internal XY and P addresses as close together as possible
 			if(xySize < pSize)
 			{
@@ -94,9 +126,45 @@ namespace dsp56k
 			}
 		}
 
+		if(_layout == MemoryLayout::InterleavedXY && getLayout() != _layout)
+			LOGL(WARNING, "Interleaved X/Y memory layout is not supported with bridged external memory or on this architecture, using planar layout");
+
 		m_mem[MemArea_X] = x;
 		m_mem[MemArea_Y] = y;
 		m_mem[MemArea_P] = p;
+
+		if(!m_mmuBuffer)
+			initBuffer(xySize);
+	}
+
+	TWord* Memory::allocateBuffer(const size_t _wordCount)
+	{
+		// the buffer starts at a page boundary to be able to write protect P memory, see JitPMemGuard
+		const auto pageWords = PageGuard::getPageSize() / sizeof(TWord);
+
+		// the memory is not touched before initBuffer() has requested huge pages
+		m_buffer.reserve(_wordCount + pageWords);
+
+		const auto pageMask = PageGuard::getPageSize() - 1;
+		const auto misalignment = reinterpret_cast<uintptr_t>(m_buffer.data()) & pageMask;
+
+		return m_buffer.data() + (misalignment ? (PageGuard::getPageSize() - misalignment) / sizeof(TWord) : 0);
+	}
+
+	void Memory::initBuffer(const TWord _xySize)
+	{
+		// nothing to do for external buffers
+		if(!m_buffer.capacity())
+			return;
+
+		// X and Y are adjacent in all layouts. P memory is excluded as JitPMemGuard write protects it with regular page granularity,
+		// which would split the huge pages
+		auto* xyBegin = std::min(x, y);
+		auto* xyEnd = std::max(x + (static_cast<size_t>(_xySize) << m_addressShift[MemArea_X]), y + (static_cast<size_t>(_xySize) << m_addressShift[MemArea_Y]));
+
+		HugePages::advise(xyBegin, (xyEnd - xyBegin) * sizeof(TWord));
+
+		m_buffer.resize(m_buffer.capacity(), 0);
 	}
 
 	// _____________________________________________________________________________
@@ -104,9 +172,8 @@ namespace dsp56k
 	//
 	bool Memory::dspWrite( EMemArea& _area, TWord& _offset, TWord _value )
 	{
-#if MEMORY_HEAT_MAP
-		++m_heatMap[_area][_offset];
-#endif
+		if(m_heatMap)
+			m_heatMap->onWrite(_area, _offset);
 
 #if DSP56300_DEBUGGER
 		if(m_dsp->getDebugger())
@@ -146,7 +213,10 @@ namespace dsp56k
 		}
 */
 		if (_offset < size(_area))		// Fix the amazing "write to wrong address" bug
-			m_mem[_area][_offset] = _value & 0x00ffffff;
+			*getHostPtr(_area, _offset) = _value & 0x00ffffff;
+
+		if(m_trackDirtyPages)
+			markPageDirty(_area, _offset);
 
 		return true;
 	}
@@ -156,9 +226,8 @@ namespace dsp56k
 	//
 	TWord Memory::get( EMemArea _area, TWord _offset ) const
 	{
-#if MEMORY_HEAT_MAP
-		++m_heatMap[_area][_offset];
-#endif
+		if(m_heatMap)
+			m_heatMap->onRead(_area, _offset);
 
 #if DSP56300_DEBUGGER
 		if(m_dsp->getDebugger())
@@ -178,7 +247,7 @@ namespace dsp56k
 			return 0;
 		}
 
-		const auto res = m_mem[_area][_offset];
+		const auto res = *getHostPtr(_area, _offset);
 
 #ifdef _DEBUG
 		if( res == g_initPattern)
@@ -190,10 +259,6 @@ namespace dsp56k
 
 	void Memory::getOpcode(TWord _offset, TWord& _wordA, TWord& _wordB) const
 	{
-#if MEMORY_HEAT_MAP
-		++m_heatMap[MemArea_P][_offset];
-#endif
-
 #ifdef _DEBUG
 		assert(_offset < XIO_Reserved_High_First);
 		if(!m_memoryMap.memValidateAccess(MemArea_P, _offset, true))
@@ -367,6 +432,111 @@ namespace dsp56k
 		return *it2->second.names.begin();
 	}
 
+	bool Memory::copyFrom(const Memory& _source)
+	{
+		if(m_size != _source.m_size || m_bridgedMemoryAddress != _source.m_bridgedMemoryAddress || m_addressShift != _source.m_addressShift)
+		{
+			LOG("Unable to copy memory, layout mismatch");
+			return false;
+		}
+
+		for(size_t a=0; a<MemArea_COUNT; ++a)
+		{
+			const auto area = static_cast<EMemArea>(a);
+
+			// interleaved Y is copied as part of X
+			if(area == MemArea_Y && m_addressShift[a])
+				continue;
+
+			std::copy_n(_source.m_mem[a], static_cast<size_t>(getBufferSize(area)) << m_addressShift[a], m_mem[a]);
+		}
+
+		return true;
+	}
+
+	TWord Memory::getBufferSize(const EMemArea _area) const
+	{
+		const auto bridged = m_bridgedMemoryAddress && m_bridgedMemoryAddress < sizeXY() ? m_bridgedMemoryAddress : 0;
+
+		if(_area == MemArea_P)
+			return calcPMemSize(sizeP(), sizeXY(), bridged);
+		return calcXYMemSize(sizeXY(), bridged);
+	}
+
+	void Memory::enableDirtyPageTracking(const bool _enable)
+	{
+		if(_enable == m_trackDirtyPages)
+			return;
+
+		m_trackDirtyPages = false;
+
+		for(size_t a=0; a<MemArea_COUNT; ++a)
+		{
+			if(_enable)
+			{
+				const auto pageCount = (getBufferSize(static_cast<EMemArea>(a)) + DirtyPageSize - 1) >> DirtyPageShift;
+				const auto wordCount = (pageCount + 63) >> 6;
+
+				// the previous content is unknown to anyone who fetches dirty pages, all pages start dirty
+				m_dirtyPages[a].reset(new std::atomic<uint64_t>[wordCount]);
+				for(size_t i=0; i<wordCount; ++i)
+				{
+					const auto remaining = pageCount - (i << 6);
+					m_dirtyPages[a][i].store(remaining >= 64 ? ~0ull : (1ull << remaining) - 1, std::memory_order_relaxed);
+				}
+
+				m_dirtyPageCount[a] = pageCount;
+			}
+			else
+			{
+				m_dirtyPageCount[a] = 0;
+				m_dirtyPages[a].reset();
+			}
+		}
+
+		m_trackDirtyPages = _enable;
+	}
+
+	bool Memory::isPageDirty(const EMemArea _area, const TWord _page) const
+	{
+		if(_page >= m_dirtyPageCount[_area])
+			return false;
+
+		return (m_dirtyPages[_area][_page >> 6].load(std::memory_order_relaxed) & (1ull << (_page & 63))) != 0;
+	}
+
+	void Memory::fetchDirtyPages(const EMemArea _area, std::vector<TWord>& _pages)
+	{
+		const auto wordCount = (m_dirtyPageCount[_area] + 63) >> 6;
+
+		for(size_t w=0; w<wordCount; ++w)
+		{
+			auto& word = m_dirtyPages[_area][w];
+
+			if(!word.load(std::memory_order_relaxed))
+				continue;
+
+			auto bits = word.exchange(0, std::memory_order_acquire);
+
+			while(bits)
+			{
+				const auto bit = countTrailingZeros(bits);
+				_pages.push_back(static_cast<TWord>(w << 6) + bit);
+				bits &= bits - 1;
+			}
+		}
+	}
+
+	void Memory::clearDirtyPages()
+	{
+		for(size_t a=0; a<MemArea_COUNT; ++a)
+		{
+			const auto wordCount = (m_dirtyPageCount[a] + 63) >> 6;
+			for(size_t w=0; w<wordCount; ++w)
+				m_dirtyPages[a][w].store(0, std::memory_order_relaxed);
+		}
+	}
+
 	// _____________________________________________________________________________
 	// fillWithInitPattern
 	//
@@ -374,14 +544,14 @@ namespace dsp56k
 	{
 		for(size_t a=0; a<m_mem.size(); ++a)
 		{
-			for(size_t i=0; i<size(static_cast<EMemArea>(a)); ++i)
-				m_mem[a][i] = g_initPattern;
+			for(TWord i=0; i<size(static_cast<EMemArea>(a)); ++i)
+				*getHostPtr(static_cast<EMemArea>(a), i) = g_initPattern;
 		}
 	}
 
 	void Memory::memTranslateAddress(EMemArea& _area, const TWord& _addr) const
 	{
-		if(m_mmuBuffer->isValid())
+		if(hasMmuSupport())
 			return;
 
 //		if(_addr >= m_bridgedMemoryAddress)
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <map>
+#include <memory>
 #include <set>
 #include <vector>
 
@@ -27,6 +30,7 @@ namespace dsp56k
 	#define MemArea_X_IOInternal_End			0xFFFFFF
 
 	class DSP;
+	class MemoryHeatMap;
 
 	class Jitmem;
 
@@ -43,6 +47,12 @@ namespace dsp56k
 		bool memValidateAccess(EMemArea _area, TWord _addr, bool _write) const override	{ return true; }
 	};
 
+	enum class MemoryLayout
+	{
+		Planar,			// X, Y and P are stored in separate buffers
+		InterleavedXY	// X and Y words of the same address are stored next to each other. Not available with bridged external memory
+	};
+
 	class Memory final
 	{
 		friend class Jitmem;
@@ -63,6 +73,7 @@ namespace dsp56k
 		TWord*												p;
 
 		TWord												m_bridgedMemoryAddress;
+		std::array<TWord, MemArea_COUNT>					m_addressShift{};
 		
 		struct STransaction
 		{
@@ -90,7 +101,7 @@ namespace dsp56k
 		//
 	public:
 		explicit Memory(const IMemoryValidator& _memoryMap, TWord _memSize = 0xc00000, TWord* _externalBuffer = nullptr);
-		explicit Memory(const IMemoryValidator& _memoryMap, TWord _memSizeP, TWord _memSizeXY, TWord _brigedMemoryAddress, TWord* _externalBuffer = nullptr);
+		explicit Memory(const IMemoryValidator& _memoryMap, TWord _memSizeP, TWord _memSizeXY, TWord _brigedMemoryAddress, TWord* _externalBuffer = nullptr, MemoryLayout _layout = MemoryLayout::Planar);
 		Memory(const Memory&) = delete;
 		Memory& operator = (const Memory&) = delete;
 
@@ -124,6 +135,7 @@ namespace dsp56k
 
 		const TWord&		getBridgedMemoryAddress() const { return m_bridgedMemoryAddress; }
 
+		// base address of a memory area. Use getHostPtr() to access individual words, X and Y may be interleaved
 		TWord*				getMemAreaPtr		(EMemArea _area)
 		{
 			switch (_area)
@@ -135,6 +147,13 @@ namespace dsp56k
 			}
 		}
 
+		TWord*				getHostPtr			(const EMemArea _area, const TWord _offset)	{ return m_mem[_area] + (static_cast<size_t>(_offset) << m_addressShift[_area]); }
+		const TWord*		getHostPtr			(const EMemArea _area, const TWord _offset) const	{ return m_mem[_area] + (static_cast<size_t>(_offset) << m_addressShift[_area]); }
+
+		// distance of two consecutive words of an area as log2, i.e. 1 for X/Y if they are interleaved
+		TWord				getAddressShift		(const EMemArea _area) const	{ return m_addressShift[_area]; }
+		MemoryLayout		getLayout			() const						{ return m_addressShift[MemArea_X] ? MemoryLayout::InterleavedXY : MemoryLayout::Planar; }
+
 		// As XY is bridged to P for all addresses >= _brigedMemoryAddress, we need to allocate more for P but less for XY if a bridged address is specified
 		static constexpr TWord calcXYMemSize(TWord _memSizeXY, TWord _bridgedMemoryAddress)
 		{
@@ -158,10 +177,64 @@ namespace dsp56k
 
 		bool hasMmuSupport() const { return m_mmuBuffer != nullptr; }
 
+		// copies the contents of all memory areas from another memory with identical layout
+		bool				copyFrom			(const Memory& _source);
+
+		// number of words that are backed by the buffer of the given area, X/Y addresses above the bridged address are stored in P
+		TWord				getBufferSize		(EMemArea _area) const;
+
+		// JIT code only reports memory accesses if the heat map has been set before a block is created, see DSP::enableMemoryHeatMap()
+		void				setHeatMap			(MemoryHeatMap* _heatMap)	{ m_heatMap = _heatMap; }
+		MemoryHeatMap*		getHeatMap			() const					{ return m_heatMap; }
+
+		// Optional tracking of modified memory pages. Writes to bridged memory are tracked as P memory writes. All pages are dirty
+		// after enabling. Pages are marked on the DSP thread and may be queried and cleared from any thread. A page is marked after
+		// the data has been written, with release semantics, fetching a page with acquire semantics sees the data that has been written
+		static constexpr TWord DirtyPageShift = 8;
+		static constexpr TWord DirtyPageSize = 1 << DirtyPageShift;
+
+		void				enableDirtyPageTracking	(bool _enable);
+		bool				isDirtyPageTrackingEnabled() const		{ return m_trackDirtyPages; }
+
+		TWord				getDirtyPageCount	(EMemArea _area) const	{ return static_cast<TWord>(m_dirtyPageCount[_area]); }
+		bool				isPageDirty			(EMemArea _area, TWord _page) const;
+
+		// appends the indices of all dirty pages of an area to _pages and clears their dirty state
+		void				fetchDirtyPages		(EMemArea _area, std::vector<TWord>& _pages);
+		void				clearDirtyPages		();
+
+		// JIT code marks pages inline, bit n of word w represents page w * 64 + n
+		std::atomic<uint64_t>* getDirtyPageBits	(EMemArea _area)		{ return m_dirtyPages[_area].get(); }
+
+		void				markPageDirty		(EMemArea _area, const TWord _offset)
+		{
+			if(m_bridgedMemoryAddress && _offset >= m_bridgedMemoryAddress)
+				_area = MemArea_P;
+
+			const auto page = _offset >> DirtyPageShift;
+			if(page >= m_dirtyPageCount[_area])
+				return;
+
+			auto& word = m_dirtyPages[_area][page >> 6];
+			const auto bit = 1ull << (page & 63);
+
+			// Same as the JIT code: a non-atomic read-modify-write that is never skipped. Skipping it if the bit is already set
+			// loses the write if another thread fetches the page concurrently. The release store makes the data visible first
+			word.store(word.load(std::memory_order_relaxed) | bit, std::memory_order_release);
+		}
+
 	private:
 		void				fillWithInitPattern	();
 		void				memTranslateAddress	(EMemArea& _area, const TWord& _addr) const;
+		TWord*				allocateBuffer		(size_t _wordCount);
+		void				initBuffer			(TWord _xySize);
 
 		std::unique_ptr<MemoryBuffer> m_mmuBuffer;
+
+		MemoryHeatMap* m_heatMap = nullptr;
+
+		bool m_trackDirtyPages = false;
+		std::array<std::unique_ptr<std::atomic<uint64_t>[]>, MemArea_COUNT> m_dirtyPages;
+		std::array<size_t, MemArea_COUNT> m_dirtyPageCount{};
 	};
 }
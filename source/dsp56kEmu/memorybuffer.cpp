@@ -75,7 +75,7 @@ namespace dsp56k
 		// we add a block above the external memory that every invalid DSP address will point into
 		constexpr auto totalAddressRange = 3 * totalDspAreaByteSize;
 
-		auto* basePtr = reinterpret_cast<TWord*>(m_mmu.reserveAddressRange(totalAddressRange * sizeof(TWord)));
+		auto* basePtr = reinterpret_cast<TWord*>(m_mmu.reserveAddressRange(totalAddressRange * sizeof(TWord), true));
 
 		if(!basePtr)
 			return;
@@ -94,8 +94,9 @@ namespace dsp56k
 		size_t backingByteOffset = 0;
 
 		// map memory for internal X, Y and P memory. They point to unique memory and are separated
-		m_x = static_cast<TWord*>(m_mmu.mapRegion(backingByteOffset, _externalMemAddress * sizeof(TWord), hostPtrX));	backingByteOffset += _externalMemAddress * sizeof(TWord);
-		m_y = static_cast<TWord*>(m_mmu.mapRegion(backingByteOffset, _externalMemAddress * sizeof(TWord), hostPtrY));	backingByteOffset += _externalMemAddress * sizeof(TWord);
+		// P memory does not use huge pages as JitPMemGuard write protects it with regular page granularity
+		m_x = static_cast<TWord*>(m_mmu.mapRegion(backingByteOffset, _externalMemAddress * sizeof(TWord), hostPtrX, true));	backingByteOffset += _externalMemAddress * sizeof(TWord);
+		m_y = static_cast<TWord*>(m_mmu.mapRegion(backingByteOffset, _externalMemAddress * sizeof(TWord), hostPtrY, true));	backingByteOffset += _externalMemAddress * sizeof(TWord);
 		m_p = static_cast<TWord*>(m_mmu.mapRegion(backingByteOffset, _externalMemAddress * sizeof(TWord), hostPtrP));	backingByteOffset += _externalMemAddress * sizeof(TWord);
 
 		if(!m_x || !m_y || !m_p)
@@ -108,8 +109,8 @@ namespace dsp56k
 		// now map memory pointers for X, Y and P that are in external SRAM and are shared
 		// The host sees them as separate memory addresses that are next to the next to internal XYP pointers
 		// but in reality they point to the same portion of physical memory
-		auto xShared = m_mmu.mapRegion(backingByteOffset, externalAreaSize * sizeof(TWord), hostPtrX);
-		auto yShared = m_mmu.mapRegion(backingByteOffset, externalAreaSize * sizeof(TWord), hostPtrY);
+		auto xShared = m_mmu.mapRegion(backingByteOffset, externalAreaSize * sizeof(TWord), hostPtrX, true);
+		auto yShared = m_mmu.mapRegion(backingByteOffset, externalAreaSize * sizeof(TWord), hostPtrY, true);
 		auto pShared = m_mmu.mapRegion(backingByteOffset, externalAreaSize * sizeof(TWord), hostPtrP);
 
 		if(!xShared || !yShared || !pShared)
@@ -0,0 +1,158 @@
+#include "memoryheatmap.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "memory.h"
+
+#include "dsp56kBase/logging.h"
+
+namespace dsp56k
+{
+	namespace
+	{
+		template<typename TKey> std::vector<std::pair<TKey, MemoryHeatMap::Counters>> sortByTotal(const std::map<TKey, MemoryHeatMap::Counters>& _src)
+		{
+			std::vector<std::pair<TKey, MemoryHeatMap::Counters>> sorted(_src.begin(), _src.end());
+
+			std::stable_sort(sorted.begin(), sorted.end(), [](const auto& _a, const auto& _b)
+			{
+				return _a.second.total() > _b.second.total();
+			});
+
+			return sorted;
+		}
+	}
+
+	MemoryHeatMap::MemoryHeatMap(const uint32_t _samplePeriod, const TWord _addressCount, const TWord _granularityShift)
+		: m_samplePeriod(std::max(_samplePeriod, 1u))
+		, m_granularityShift(_granularityShift)
+		, m_counterCount((_addressCount + (1 << _granularityShift) - 1) >> _granularityShift)
+		, m_countdown(m_samplePeriod)
+	{
+		for (auto& c : m_counters)
+			c.reset(new Counter[m_counterCount]);
+	}
+
+	std::unordered_map<TWord, MemoryHeatMap::Counters> MemoryHeatMap::getSamples(const EMemArea _area) const
+	{
+		std::unordered_map<TWord, Counters> samples;
+
+		const auto& counters = m_counters[_area];
+
+		for(TWord i=0; i<m_counterCount; ++i)
+		{
+			Counters c;
+			c.reads = counters[i].reads.load(std::memory_order_relaxed);
+			c.writes = counters[i].writes.load(std::memory_order_relaxed);
+
+			if(c.total())
+				samples.insert({i << m_granularityShift, c});
+		}
+
+		return samples;
+	}
+
+	void MemoryHeatMap::clear()
+	{
+		for (const auto& counters : m_counters)
+		{
+			for(TWord i=0; i<m_counterCount; ++i)
+			{
+				counters[i].reads.store(0, std::memory_order_relaxed);
+				counters[i].writes.store(0, std::memory_order_relaxed);
+			}
+		}
+	}
+
+	void MemoryHeatMap::writeReport(std::ostream& _out, const Memory& _memory, TWord _pageSize, const size_t _maxEntries) const
+	{
+		// pages cannot be smaller than the blocks that samples are counted for
+		_pageSize = std::max(_pageSize, getGranularity());
+
+		const auto& symbols = _memory.getSymbols();
+		const auto period = static_cast<uint64_t>(m_samplePeriod);
+
+		_out << "Memory access heat map, sample period " << m_samplePeriod << ", page size " << _pageSize << " words" << std::endl;
+
+		for(size_t a=0; a<MemArea_COUNT; ++a)
+		{
+			const auto area = static_cast<EMemArea>(a);
+			const auto areaName = g_memAreaNames[a];
+
+			const auto samples = getSamples(area);
+
+			if(samples.empty())
+				continue;
+
+			std::map<TWord, Counters> pages;
+			std::map<std::string, Counters> bySymbol;
+			Counters total;
+
+			const auto itSymbols = symbols.find(areaName);
+
+			for (const auto& [addr, counters] : samples)
+			{
+				pages[addr / _pageSize] += counters;
+				total += counters;
+
+				// attribute accesses to the closest symbol at or below the address
+				std::string name = "<unnamed>";
+
+				if(itSymbols != symbols.end())
+				{
+					auto it = itSymbols->second.upper_bound(addr);
+
+					if(it != itSymbols->second.begin())
+					{
+						--it;
+						if(!it->second.names.empty())
+							name = *it->second.names.begin();
+					}
+				}
+
+				bySymbol[name] += counters;
+			}
+
+			_out << std::endl << areaName << " memory: ~" << std::dec << total.reads * period << " reads, ~" << total.writes * period << " writes" << std::endl;
+
+			auto percent = [&](const Counters& _c)
+			{
+				return static_cast<double>(_c.total()) * 100.0 / static_cast<double>(total.total());
+			};
+
+			auto writeLine = [&](const std::string& _name, const Counters& _c)
+			{
+				_out << "  " << std::left << std::setfill(' ') << std::setw(32) << _name << std::right
+					<< std::setw(14) << _c.reads * period
+					<< std::setw(14) << _c.writes * period
+					<< std::setw(8) << std::fixed << std::setprecision(2) << percent(_c) << '%' << std::endl;
+			};
+
+			_out << "  " << std::left << std::setfill(' ') << std::setw(32) << "Page" << std::right << std::setw(14) << "Reads" << std::setw(14) << "Writes" << std::setw(9) << "Share" << std::endl;
+
+			const auto sortedPages = sortByTotal(pages);
+
+			for(size_t i=0; i<std::min(_maxEntries, sortedPages.size()); ++i)
+			{
+				const auto first = sortedPages[i].first * _pageSize;
+
+				std::stringstream ss;
+				ss << areaName << ':' << HEX(first) << '-' << HEX(first + _pageSize - 1);
+
+				writeLine(ss.str(), sortedPages[i].second);
+			}
+
+			_out << "  " << std::left << std::setw(32) << "Symbol" << std::right << std::setw(14) << "Reads" << std::setw(14) << "Writes" << std::setw(9) << "Share" << std::endl;
+
+			const auto sortedSymbols = sortByTotal(bySymbol);
+
+			for(size_t i=0; i<std::min(_maxEntries, sortedSymbols.size()); ++i)
+				writeLine(sortedSymbols[i].first, sortedSymbols[i].second);
+		}
+	}
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <unordered_map>
+
+#include "types.h"
+
+namespace dsp56k
+{
+	class Memory;
+
+	// Sampling profiler for X/Y/P memory reads and writes. Every n-th access is recorded with the address as seen by the DSP,
+	// i.e. before external memory bridging is applied. Samples are counted per block of 2^granularityShift words in counters
+	// that are allocated upfront, recording a sample does neither lock nor allocate. The report aggregates the samples per page
+	// and per symbol, a block is attributed to the symbol at or below its first address
+	class MemoryHeatMap
+	{
+	public:
+		struct Counters
+		{
+			uint64_t reads = 0;
+			uint64_t writes = 0;
+
+			uint64_t total() const { return reads + writes; }
+
+			Counters& operator += (const Counters& _c)
+			{
+				reads += _c.reads;
+				writes += _c.writes;
+				return *this;
+			}
+		};
+
+		// accesses to addresses at or above _addressCount are not recorded
+		explicit MemoryHeatMap(uint32_t _samplePeriod = 64, TWord _addressCount = 0x10000, TWord _granularityShift = 4);
+
+		void onRead(const EMemArea _area, const TWord _offset)
+		{
+			if(--m_countdown)
+				return;
+			sample(_area, _offset, false);
+		}
+
+		void onWrite(const EMemArea _area, const TWord _offset)
+		{
+			if(--m_countdown)
+				return;
+			sample(_area, _offset, true);
+		}
+
+		uint32_t getSamplePeriod() const { return m_samplePeriod; }
+		TWord getGranularity() const { return 1 << m_granularityShift; }
+
+		// JIT code decrements the countdown inline and only calls sample() once it reaches zero
+		uint32_t* getCountdownPtr() { return &m_countdown; }
+
+		// only to be called by the DSP thread, the counters have a single writer
+		void sample(const EMemArea _area, const TWord _offset, const bool _write)
+		{
+			m_countdown = m_samplePeriod;
+
+			const auto index = _offset >> m_granularityShift;
+
+			if(index >= m_counterCount)
+				return;
+
+			auto& c = _write ? m_counters[_area][index].writes : m_counters[_area][index].reads;
+			c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		}
+
+		// number of samples per block, keyed by the first DSP address of a block. May be called from any thread
+		std::unordered_map<TWord, Counters> getSamples(EMemArea _area) const;
+
+		// May be called from any thread. Samples that are recorded concurrently may survive
+		void clear();
+
+		// Access counts are estimated by multiplying sample counts with the sample period. May be called from any thread
+		void writeReport(std::ostream& _out, const Memory& _memory, TWord _pageSize = 256, size_t _maxEntries = 30) const;
+
+	private:
+		struct Counter
+		{
+			std::atomic<uint64_t> reads{0};
+			std::atomic<uint64_t> writes{0};
+		};
+
+		const uint32_t m_samplePeriod;
+		const TWord m_granularityShift;
+		const TWord m_counterCount;
+
+		uint32_t m_countdown;
+
+		std::array<std::unique_ptr<Counter[]>, MemArea_COUNT> m_counters;
+	};
+}
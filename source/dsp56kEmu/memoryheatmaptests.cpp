@@ -0,0 +1,235 @@
+#include "memoryheatmaptests.h"
+
+#include <memory>
+#include <sstream>
+
+#include "dsp.h"
+#include "memory.h"
+#include "memoryheatmap.h"
+#include "peripherals.h"
+#include "unittests.h"
+
+namespace dsp56k
+{
+	namespace
+	{
+		MemoryHeatMap::Counters getCounters(const MemoryHeatMap& _heatMap, const EMemArea _area, const TWord _offset)
+		{
+			const auto samples = _heatMap.getSamples(_area);
+			const auto it = samples.find(_offset);
+			return it != samples.end() ? it->second : MemoryHeatMap::Counters();
+		}
+
+		bool contains(const std::string& _s, const char* _text)
+		{
+			return _s.find(_text) != std::string::npos;
+		}
+	}
+
+	MemoryHeatMapTests::MemoryHeatMapTests()
+	{
+		LOG("Running Memory Heat Map Tests...");
+
+		testSampling();
+		testClear();
+		testGranularity();
+		testReport();
+		testInterpreter();
+
+		LOG("Memory Heat Map Tests finished.");
+	}
+
+	void MemoryHeatMapTests::testSampling()
+	{
+		MemoryHeatMap heatMap(4, 0x1000, 0);
+		verify(heatMap.getSamplePeriod() == 4);
+		verify(heatMap.getGranularity() == 1);
+
+		// every fourth access is sampled
+		for(TWord i=0; i<10; ++i)
+			heatMap.onRead(MemArea_X, 0x10);
+
+		verify(getCounters(heatMap, MemArea_X, 0x10).reads == 2);
+		verify(getCounters(heatMap, MemArea_X, 0x10).writes == 0);
+
+		// reads and writes share the countdown, the twelfth access is a write
+		heatMap.onWrite(MemArea_Y, 0x20);
+		verify(heatMap.getSamples(MemArea_Y).empty());
+		heatMap.onWrite(MemArea_Y, 0x20);
+		verify(getCounters(heatMap, MemArea_Y, 0x20).writes == 1);
+		verify(getCounters(heatMap, MemArea_Y, 0x20).reads == 0);
+
+		// the area is part of the key
+		verify(heatMap.getSamples(MemArea_P).empty());
+		verify(heatMap.getSamples(MemArea_X).size() == 1);
+
+		// sample() records immediately and restarts the countdown, as done by JIT code
+		heatMap.sample(MemArea_P, 0x30, false);
+		verify(getCounters(heatMap, MemArea_P, 0x30).reads == 1);
+		verify(*heatMap.getCountdownPtr() == 4);
+
+		// a period of zero samples every access
+		MemoryHeatMap everyAccess(0, 0x1000, 0);
+		verify(everyAccess.getSamplePeriod() == 1);
+
+		everyAccess.onRead(MemArea_X, 1);
+		everyAccess.onRead(MemArea_X, 2);
+		everyAccess.onWrite(MemArea_X, 2);
+
+		verify(getCounters(everyAccess, MemArea_X, 1).reads == 1);
+		verify(getCounters(everyAccess, MemArea_X, 2).reads == 1);
+		verify(getCounters(everyAccess, MemArea_X, 2).writes == 1);
+	}
+
+	void MemoryHeatMapTests::testClear()
+	{
+		MemoryHeatMap heatMap(1, 0x1000, 0);
+
+		heatMap.onRead(MemArea_X, 1);
+		heatMap.onWrite(MemArea_Y, 2);
+		heatMap.onRead(MemArea_P, 3);
+
+		heatMap.clear();
+
+		for(size_t a=0; a<MemArea_COUNT; ++a)
+			verify(heatMap.getSamples(static_cast<EMemArea>(a)).empty());
+
+		heatMap.onRead(MemArea_X, 1);
+		verify(getCounters(heatMap, MemArea_X, 1).reads == 1);
+	}
+
+	void MemoryHeatMapTests::testGranularity()
+	{
+		MemoryHeatMap heatMap(1, 0x100, 4);
+		verify(heatMap.getGranularity() == 16);
+
+		// samples are counted per block of 16 words, keyed by the first address of the block
+		heatMap.onRead(MemArea_X, 0x10);
+		heatMap.onRead(MemArea_X, 0x1f);
+		heatMap.onWrite(MemArea_X, 0x20);
+
+		const auto samples = heatMap.getSamples(MemArea_X);
+		verify(samples.size() == 2);
+		verify(getCounters(heatMap, MemArea_X, 0x10).reads == 2);
+		verify(getCounters(heatMap, MemArea_X, 0x20).writes == 1);
+
+		// addresses outside of the preallocated range are not recorded
+		heatMap.onRead(MemArea_X, 0x100);
+		heatMap.onWrite(MemArea_Y, 0xffffff);
+		verify(heatMap.getSamples(MemArea_X).size() == 2);
+		verify(heatMap.getSamples(MemArea_Y).empty());
+
+		// the report does not use pages smaller than a block
+		DefaultMemoryValidator validator;
+		Memory mem(validator, 0x1000);
+
+		std::stringstream ss;
+		heatMap.writeReport(ss, mem, 4);
+		verify(contains(ss.str(), "page size 16 words"));
+		verify(contains(ss.str(), "X:000010-00001f"));
+	}
+
+	void MemoryHeatMapTests::testReport()
+	{
+		DefaultMemoryValidator validator;
+		Memory mem(validator, 0x1000);
+
+		mem.setSymbol('X', 0x100, "coeffs");
+		mem.setSymbol('X', 0x200, "buffer");
+
+		MemoryHeatMap heatMap(2);
+
+		// 8 samples attributed to coeffs, 1 below the first symbol, 2 write samples attributed to buffer
+		for(TWord i=0; i<16; ++i)
+			heatMap.onRead(MemArea_X, 0x100 + i);
+		for(TWord i=0; i<2; ++i)
+			heatMap.onRead(MemArea_X, 0x10);
+		for(TWord i=0; i<4; ++i)
+			heatMap.onWrite(MemArea_X, 0x210);
+
+		std::stringstream ss;
+		heatMap.writeReport(ss, mem, 0x100);
+		const auto report = ss.str();
+
+		// counts are estimated by multiplying samples with the sample period
+		verify(contains(report, "sample period 2, page size 256 words"));
+		verify(contains(report, "X memory: ~18 reads, ~4 writes"));
+
+		// only areas with samples are reported
+		verify(!contains(report, "Y memory"));
+		verify(!contains(report, "P memory"));
+
+		// pages are sorted by their share
+		const auto pageCoeffs = report.find("X:000100-0001ff");
+		const auto pageBuffer = report.find("X:000200-0002ff");
+		const auto pageLow = report.find("X:000000-0000ff");
+
+		verify(pageCoeffs != std::string::npos && pageBuffer != std::string::npos && pageLow != std::string::npos);
+		verify(pageCoeffs < pageBuffer && pageBuffer < pageLow);
+
+		const auto symCoeffs = report.find("coeffs");
+		const auto symBuffer = report.find("buffer");
+		const auto symUnnamed = report.find("<unnamed>");
+
+		verify(symCoeffs != std::string::npos && symBuffer != std::string::npos && symUnnamed != std::string::npos);
+		verify(symCoeffs < symBuffer && symBuffer < symUnnamed);
+
+		// the number of entries per table is limited
+		std::stringstream limited;
+		heatMap.writeReport(limited, mem, 0x100, 1);
+		verify(!contains(limited.str(), "X:000200-0002ff"));
+		verify(!contains(limited.str(), "buffer"));
+	}
+
+	void MemoryHeatMapTests::testInterpreter()
+	{
+		DefaultMemoryValidator validator;
+		Memory mem(validator, 0x1000);
+		Peripherals56362 periphX;
+		Peripherals56367 periphY;
+		DSP dsp(mem, &periphX, &periphY);
+
+		// instruction fetches are not sampled, only the reads of the program are
+		TWord pc = 0x100;
+		pc = emitToMemory(dsp, "move #$20,r0", pc);
+		for(size_t i=0; i<12; ++i)
+			pc = emitToMemory(dsp, "move x:(r0)+,a", pc);
+
+		dsp.enableMemoryHeatMap(3, 0);
+
+		dsp.setPC(0x100);
+		while(dsp.getPC().toWord() != pc)
+			dsp.execInterpreter();
+
+		const auto* heatMap = dsp.getMemoryHeatMap();
+		verify(heatMap != nullptr);
+		verify(mem.getHeatMap() == heatMap);
+
+		const auto samples = heatMap->getSamples(MemArea_X);
+		verify(samples.size() == 4);
+
+		for(const TWord addr : {0x22u, 0x25u, 0x28u, 0x2bu})
+			verify(getCounters(*heatMap, MemArea_X, addr).reads == 1);
+
+		verify(heatMap->getSamples(MemArea_P).empty());
+
+		dsp.disableMemoryHeatMap();
+		verify(dsp.getMemoryHeatMap() == nullptr);
+		verify(mem.getHeatMap() == nullptr);
+	}
+
+	TWord MemoryHeatMapTests::emitToMemory(DSP& _dsp, const char* _text, const TWord _pc)
+	{
+		const auto result = m_assembler.assemble(_text);
+		if(!result.success())
+			throw std::string("Assembly failed for: ") + _text;
+
+		auto& mem = _dsp.memory();
+
+		mem.set(MemArea_P, _pc, result.word[0]);
+		if(result.wordCount > 1)
+			mem.set(MemArea_P, _pc + 1, result.word[1]);
+
+		return _pc + result.wordCount;
+	}
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "assembler.h"
+#include "types.h"
+
+namespace dsp56k
+{
+	class DSP;
+
+	// Tests for MemoryHeatMap: sampling of every n-th access, counting per block, aggregation per page and symbol and sampling of interpreted code. JIT generated sampling is tested in JitUnittests
+	class MemoryHeatMapTests
+	{
+	public:
+		MemoryHeatMapTests();
+
+	private:
+		void testSampling();
+		void testClear();
+		void testGranularity();
+		void testReport();
+		void testInterpreter();
+
+		TWord emitToMemory(DSP& _dsp, const char* _text, TWord _pc);
+
+		Assembler m_assembler;
+	};
+}
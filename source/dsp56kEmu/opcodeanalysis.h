@@ -147,6 +147,11 @@ namespace dsp56k
 		return static_cast<RegisterMask>(static_cast<uint64_t>(_a) & static_cast<uint64_t>(_b));
 	}
 
+	constexpr RegisterMask operator ~ (RegisterMask _a)
+	{
+		return static_cast<RegisterMask>(~static_cast<uint64_t>(_a));
+	}
+
 	constexpr RegisterMask& operator |= (RegisterMask& _a, const RegisterMask _b)
 	{
 		return _a = _a | _b;
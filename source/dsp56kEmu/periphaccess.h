@@ -0,0 +1,69 @@
+#pragma once
+
+#include "types.h"
+
+namespace dsp56k
+{
+	// Describes how JIT code accesses a peripheral register without calling IPeripherals::read()/write() for every access
+	struct PeriphAccess
+	{
+		enum class Type : uint8_t
+		{
+			// read()/write() is called for every access
+			None,
+
+			// load/store of value, the access has no side effects
+			Plain,
+
+			// write: store to value. write() is called instead if a bit of edgeMask changes or if a bit of stickyMask is set in the stored
+			// or in the written value (write one to clear flags)
+			Flags,
+
+			// Audio interface slot registers, the accessed slots are tracked via pendingBit in pending. C++ is called on the flag edge only
+			// write: store to value and set pendingBit. write() is called afterwards if pending equals enabled & enabledMask
+			// read: clear pendingBit and load from value. read() is called instead if enabled & enabledMask is zero or if no other bit remains set in pending
+			Slot
+		};
+
+		Type type = Type::None;
+		TWord* value = nullptr;
+
+		TWord edgeMask = 0;
+		TWord stickyMask = 0;
+
+		uint32_t* pending = nullptr;
+		uint32_t pendingBit = 0;
+		const uint32_t* enabled = nullptr;
+		uint32_t enabledMask = 0;
+
+		static PeriphAccess plain(TWord& _value)
+		{
+			PeriphAccess a;
+			a.type = Type::Plain;
+			a.value = &_value;
+			return a;
+		}
+
+		static PeriphAccess flags(TWord& _value, const TWord _edgeMask, const TWord _stickyMask)
+		{
+			PeriphAccess a;
+			a.type = Type::Flags;
+			a.value = &_value;
+			a.edgeMask = _edgeMask;
+			a.stickyMask = _stickyMask;
+			return a;
+		}
+
+		static PeriphAccess slot(TWord& _value, uint32_t& _pending, const uint32_t _pendingBit, const uint32_t& _enabled, const uint32_t _enabledMask)
+		{
+			PeriphAccess a;
+			a.type = Type::Slot;
+			a.value = &_value;
+			a.pending = &_pending;
+			a.pendingBit = _pendingBit;
+			a.enabled = &_enabled;
+			a.enabledMask = _enabledMask;
+			return a;
+		}
+	};
+}
@@ -3,7 +3,9 @@
 #include "aar.h"
 #include "disasm.h"
 #include "dsp.h"
+#include "dspmetrics.h"
 #include "interrupts.h"
+#include "statestream.h"
 
 namespace dsp56k
 {
@@ -108,6 +110,68 @@ namespace dsp56k
 				}
 			}
 		}
+
+		// Timer compare registers and DMA address/count registers are plain storage, writing them has no side effects.
+		// Writing the timer status registers has side effects only if TE changes or if TOF/TCF are involved
+		PeriphAccess writeAccessTimersDma(Timers& _timers, Dma& _dma, const TWord _addr)
+		{
+			switch (_addr)
+			{
+			case Timers::M_TCSR0:	return _timers.getTCSRAccess(0);
+			case Timers::M_TCSR1:	return _timers.getTCSRAccess(1);
+			case Timers::M_TCSR2:	return _timers.getTCSRAccess(2);
+			case Timers::M_TCPR0:	return PeriphAccess::plain(_timers.getTCPR(0));
+			case Timers::M_TCPR1:	return PeriphAccess::plain(_timers.getTCPR(1));
+			case Timers::M_TCPR2:	return PeriphAccess::plain(_timers.getTCPR(2));
+			case XIO_DCO5:			return PeriphAccess::plain(_dma.getDCO(5));
+			case XIO_DDR5:			return PeriphAccess::plain(_dma.getDDR(5));
+			case XIO_DSR5:			return PeriphAccess::plain(_dma.getDSR(5));
+			case XIO_DCO4:			return PeriphAccess::plain(_dma.getDCO(4));
+			case XIO_DDR4:			return PeriphAccess::plain(_dma.getDDR(4));
+			case XIO_DSR4:			return PeriphAccess::plain(_dma.getDSR(4));
+			case XIO_DCO3:			return PeriphAccess::plain(_dma.getDCO(3));
+			case XIO_DDR3:			return PeriphAccess::plain(_dma.getDDR(3));
+			case XIO_DSR3:			return PeriphAccess::plain(_dma.getDSR(3));
+			case XIO_DCO2:			return PeriphAccess::plain(_dma.getDCO(2));
+			case XIO_DDR2:			return PeriphAccess::plain(_dma.getDDR(2));
+			case XIO_DSR2:			return PeriphAccess::plain(_dma.getDSR(2));
+			case XIO_DCO1:			return PeriphAccess::plain(_dma.getDCO(1));
+			case XIO_DDR1:			return PeriphAccess::plain(_dma.getDDR(1));
+			case XIO_DSR1:			return PeriphAccess::plain(_dma.getDSR(1));
+			case XIO_DCO0:			return PeriphAccess::plain(_dma.getDCO(0));
+			case XIO_DDR0:			return PeriphAccess::plain(_dma.getDDR(0));
+			case XIO_DSR0:			return PeriphAccess::plain(_dma.getDSR(0));
+			default:				return {};
+			}
+		}
+
+		void updateAudioMetrics(DspMetrics& _metrics, const Audio& _audio)
+		{
+			using Metric = DspMetrics::Metric;
+
+			_metrics.set(Metric::AudioInputLevel, _audio.getAudioInputs().size());
+			_metrics.set(Metric::AudioOutputLevel, _audio.getAudioOutputs().size());
+			_metrics.set(Metric::AudioInputCapacity, _audio.getAudioInputs().capacity());
+			_metrics.set(Metric::AudioOutputCapacity, _audio.getAudioOutputs().capacity());
+		}
+
+		// the DSP thread blocks if there is no input or if the output is full
+		uint64_t getAudioBlockedNs(const Audio& _audio)
+		{
+			return _audio.getAudioInputs().getReadWaitNs() + _audio.getAudioOutputs().getWriteWaitNs();
+		}
+
+		void updateHdi08Metrics(DspMetrics& _metrics, const HDI08& _hdi08)
+		{
+			using Metric = DspMetrics::Metric;
+
+			_metrics.set(Metric::Hdi08RxWords, _hdi08.getRxWords());
+			_metrics.set(Metric::Hdi08RxEmptyReads, _hdi08.getRxEmptyReads());
+			_metrics.set(Metric::Hdi08TxWords, _hdi08.getTxWords());
+			_metrics.set(Metric::Hdi08TxOverwrites, _hdi08.getTxOverwrites());
+			_metrics.set(Metric::Hdi08RxLevel, _hdi08.rxData().size());
+			_metrics.set(Metric::Hdi08TxLevel, _hdi08.txData().size());
+		}
 	}
 
 	void IPeripherals::setDelayCycles(const uint32_t _delayCycles) noexcept
@@ -116,6 +180,18 @@ namespace dsp56k
 		m_targetClock = m_dsp->getInstructionCounter() + m_delayCycles;
 	}
 
+	void IPeripherals::saveState(StateWriter& _w) const
+	{
+		_w.write(m_delayCycles);
+		_w.write(m_targetClock);
+	}
+
+	void IPeripherals::loadState(StateReader& _r)
+	{
+		_r.read(m_delayCycles);
+		_r.read(m_targetClock);
+	}
+
 	// _____________________________________________________________________________
 	// Peripherals
 	//
@@ -244,6 +320,20 @@ namespace dsp56k
 		}
 	}
 
+	PeriphAccess Peripherals56303::writeAccess(const TWord _addr)
+	{
+		switch (_addr)
+		{
+		case Essi::ESSI0_TX0:		return m_essi0.getTXAccess(0);
+		case Essi::ESSI0_TX1:		return m_essi0.getTXAccess(1);
+		case Essi::ESSI0_TX2:		return m_essi0.getTXAccess(2);
+		case Essi::ESSI1_TX0:		return m_essi1.getTXAccess(0);
+		case Essi::ESSI1_TX1:		return m_essi1.getTXAccess(1);
+		case Essi::ESSI1_TX2:		return m_essi1.getTXAccess(2);
+		default:					return writeAccessTimersDma(m_timers, m_dma, _addr);
+		}
+	}
+
 	void Peripherals56303::write(TWord _addr, TWord _val)
 	{
 		switch (_addr)
@@ -375,6 +465,40 @@ namespace dsp56k
 		m_essi1.terminate();
 	}
 
+	void Peripherals56303::saveState(StateWriter& _w) const
+	{
+		IPeripherals::saveState(_w);
+
+		_w.write(m_mem);
+		m_dma.saveState(_w);
+		m_essiClock.saveState(_w);
+		m_essi0.saveState(_w);
+		m_essi1.saveState(_w);
+		m_hi08.saveState(_w);
+		m_timers.saveState(_w);
+	}
+
+	void Peripherals56303::loadState(StateReader& _r)
+	{
+		IPeripherals::loadState(_r);
+
+		_r.read(m_mem);
+		m_dma.loadState(_r);
+		m_essiClock.loadState(_r);
+		m_essi0.loadState(_r);
+		m_essi1.loadState(_r);
+		m_hi08.loadState(_r);
+		m_timers.loadState(_r);
+	}
+
+	void Peripherals56303::updateMetrics(DspMetrics& _metrics) const
+	{
+		updateAudioMetrics(_metrics, m_essi0);
+		updateHdi08Metrics(_metrics, m_hi08);
+
+		_metrics.set(DspMetrics::Metric::ThreadBlockedNs, getAudioBlockedNs(m_essi0) + m_hi08.txData().getWriteWaitNs());
+	}
+
 	Peripherals56362::Peripherals56362(Peripherals56367* _peripherals56367/* = nullptr*/)
 	: IPeripherals(PeripheralType::Peripherals56362)
 	, m_mem{}
@@ -560,6 +684,32 @@ namespace dsp56k
 		return nullptr;
 	}
 
+	PeriphAccess Peripherals56362::writeAccess(const TWord _addr)
+	{
+		switch (_addr)
+		{
+		case Esai::M_TX0:
+		case Esai::M_TX1:
+		case Esai::M_TX2:
+		case Esai::M_TX3:
+		case Esai::M_TX4:
+		case Esai::M_TX5:			return m_esai.getTXAccess(_addr - Esai::M_TX0);
+		default:					return writeAccessTimersDma(m_timers, m_dma, _addr);
+		}
+	}
+
+	PeriphAccess Peripherals56362::readAccess(const TWord _addr, Instruction _inst)
+	{
+		switch (_addr)
+		{
+		case Esai::M_RX0:
+		case Esai::M_RX1:
+		case Esai::M_RX2:
+		case Esai::M_RX3:			return m_esai.getRXAccess(_addr - Esai::M_RX0);
+		default:					return {};
+		}
+	}
+
 	void Peripherals56362::write(const TWord _addr, const TWord _val)
 	{
 		switch (_addr)
@@ -733,6 +883,47 @@ namespace dsp56k
 		m_esai.terminate();
 	}
 
+	void Peripherals56362::saveState(StateWriter& _w) const
+	{
+		IPeripherals::saveState(_w);
+
+		_w.write(m_mem);
+		m_dma.saveState(_w);
+		m_esaiClock.saveState(_w);
+		m_esai.saveState(_w);
+		m_hdi08.saveState(_w);
+		m_timers.saveState(_w);
+		m_portC.saveState(_w);
+	}
+
+	void Peripherals56362::loadState(StateReader& _r)
+	{
+		IPeripherals::loadState(_r);
+
+		_r.read(m_mem);
+		m_dma.loadState(_r);
+		m_esaiClock.loadState(_r);
+		m_esai.loadState(_r);
+		m_hdi08.loadState(_r);
+		m_timers.loadState(_r);
+		m_portC.loadState(_r);
+	}
+
+	void Peripherals56362::updateMetrics(DspMetrics& _metrics) const
+	{
+		using Metric = DspMetrics::Metric;
+
+		_metrics.set(Metric::EsaiTxFrames, m_esai.getTxFrameCounter());
+		_metrics.set(Metric::EsaiRxFrames, m_esai.getRxFrameCounter());
+		_metrics.set(Metric::EsaiTxUnderruns, m_esai.getTxUnderruns());
+		_metrics.set(Metric::EsaiRxOverruns, m_esai.getRxOverruns());
+
+		updateAudioMetrics(_metrics, m_esai);
+		updateHdi08Metrics(_metrics, m_hdi08);
+
+		_metrics.set(Metric::ThreadBlockedNs, getAudioBlockedNs(m_esai) + m_hdi08.txData().getWriteWaitNs());
+	}
+
 	void Peripherals56362::setDSP(DSP* _dsp)
 	{
 		IPeripherals::setDSP(_dsp);
@@ -799,6 +990,32 @@ namespace dsp56k
 		m_mem[_addr - XIO_Reserved_High_First] = _val;
 	}
 
+	PeriphAccess Peripherals56367::writeAccess(const TWord _addr)
+	{
+		switch (_addr)
+		{
+		case Esai::M_TX0_1:
+		case Esai::M_TX1_1:
+		case Esai::M_TX2_1:
+		case Esai::M_TX3_1:
+		case Esai::M_TX4_1:
+		case Esai::M_TX5_1:		return m_esai.getTXAccess(_addr - Esai::M_TX0_1);
+		default:				return {};
+		}
+	}
+
+	PeriphAccess Peripherals56367::readAccess(const TWord _addr, Instruction _inst)
+	{
+		switch (_addr)
+		{
+		case Esai::M_RX0_1:
+		case Esai::M_RX1_1:
+		case Esai::M_RX2_1:
+		case Esai::M_RX3_1:		return m_esai.getRXAccess(_addr - Esai::M_RX0_1);
+		default:				return {};
+		}
+	}
+
 	void Peripherals56367::reset()
 	{
 		m_esai.reset();
@@ -813,4 +1030,20 @@ namespace dsp56k
 	{
 		m_esai.terminate();
 	}
+
+	void Peripherals56367::saveState(StateWriter& _w) const
+	{
+		IPeripherals::saveState(_w);
+
+		_w.write(m_mem);
+		m_esai.saveState(_w);
+	}
+
+	void Peripherals56367::loadState(StateReader& _r)
+	{
+		IPeripherals::loadState(_r);
+
+		_r.read(m_mem);
+		m_esai.loadState(_r);
+	}
 }
@@ -7,6 +7,7 @@
 #include "gpio.h"
 #include "hdi08.h"
 #include "opcodetypes.h"
+#include "periphaccess.h"
 #include "timers.h"
 #include "types.h"
 #include <array>
@@ -14,6 +15,7 @@
 namespace dsp56k
 {
 	class Disassembler;
+	class DspMetrics;
 
 	enum class PeripheralType
 	{
@@ -106,10 +108,20 @@ namespace dsp56k
 		virtual TWord read(TWord _addr, Instruction _inst) = 0;
 		virtual const TWord* readAsPtr(TWord _addr, Instruction _inst) = 0;
 		virtual void write(TWord _addr, TWord _value) = 0;
+		// describe registers that the JIT can access without calling read()/write() for every access, see PeriphAccess
+		virtual PeriphAccess writeAccess(TWord _addr) { return {}; }
+		virtual PeriphAccess readAccess(TWord _addr, Instruction _inst) { return {}; }
 		virtual void reset() = 0;
 		virtual void setSymbols(Disassembler& _disasm) const = 0;
 		virtual void terminate() = 0;
 
+		// publishes peripheral state, called on the DSP thread
+		virtual void updateMetrics(DspMetrics& _metrics) const {}
+
+		// peripheral registers and timing, see SaveState. Data that has been queued by the host (audio, HDI08) is not part of the state
+		virtual void saveState(StateWriter& _w) const;
+		virtual void loadState(StateReader& _r);
+
 		void setDelayCycles(uint32_t _delayCycles) noexcept;
 
 		void resetDelayCycles(const uint64_t _instructionCount, const uint32_t _delayCycles) noexcept
@@ -161,6 +173,7 @@ namespace dsp56k
 		TWord read(TWord _addr, Instruction _inst) override;
 		const TWord* readAsPtr(TWord _addr, Instruction _inst) override;
 		void write(TWord _addr, TWord _val) override;
+		PeriphAccess writeAccess(TWord _addr) override;
 
 		uint32_t exec() noexcept;
 		void reset() override;
@@ -186,6 +199,11 @@ namespace dsp56k
 
 		void terminate() override;
 
+		void updateMetrics(DspMetrics& _metrics) const override;
+
+		void saveState(StateWriter& _w) const override;
+		void loadState(StateReader& _r) override;
+
 	private:
 		Dma m_dma;
 		EssiClock m_essiClock;
@@ -213,6 +231,8 @@ namespace dsp56k
 		TWord read(TWord _addr, Instruction _inst) override;
 		const TWord* readAsPtr(TWord _addr, Instruction _inst) override;
 		void write(TWord _addr, TWord _val) override;
+		PeriphAccess writeAccess(TWord _addr) override;
+		PeriphAccess readAccess(TWord _addr, Instruction _inst) override;
 
 		uint32_t exec() noexcept;
 		void reset() override;
@@ -228,6 +248,8 @@ namespace dsp56k
 
 		void terminate() override;
 
+		void updateMetrics(DspMetrics& _metrics) const override;
+
 		void disableTimers(const bool _disable)
 		{
 			m_disableTimers = _disable;
@@ -235,6 +257,9 @@ namespace dsp56k
 
 		void setDSP(DSP* _dsp) override;
 
+		void saveState(StateWriter& _w) const override;
+		void loadState(StateReader& _r) override;
+
 	private:
 		Dma m_dma;
 		EsaiClock m_esaiClock;
@@ -253,6 +278,8 @@ namespace dsp56k
 		TWord read(TWord _addr, Instruction _inst) override;
 		const TWord* readAsPtr(TWord _addr, Instruction _inst) override { return nullptr; }
 		void write(TWord _addr, TWord _val) override;
+		PeriphAccess writeAccess(TWord _addr) override;
+		PeriphAccess readAccess(TWord _addr, Instruction _inst) override;
 
 		uint32_t exec() noexcept { return MaxDelayCycles; }
 
@@ -270,6 +297,9 @@ namespace dsp56k
 			m_esai.setDSP(_dsp);
 		}
 
+		void saveState(StateWriter& _w) const override;
+		void loadState(StateReader& _r) override;
+
 	private:
 		std::array<TWord, XIO_Reserved_High_Last - XIO_Reserved_High_First + 1> m_mem;
 		Esai m_esai;
@@ -0,0 +1,531 @@
+#include "savestate.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#include "dsp.h"
+#include "memory.h"
+#include "peripherals.h"
+#include "statestream.h"
+
+#include "dsp56kBase/logging.h"
+
+namespace dsp56k
+{
+	static_assert(SaveState::PageSize == Memory::DirtyPageSize, "save state pages need to match dirty pages");
+
+	namespace
+	{
+		struct FileHeader
+		{
+			char magic[4] = {'D', 'S', 'P', 'S'};
+			uint32_t version = SaveState::Version;
+			uint32_t coreSize = 0;
+			std::array<uint32_t, 2> peripheralTypes{};
+			std::array<uint32_t, 2> peripheralSizes{};
+			std::array<uint32_t, MemArea_COUNT> memSize{};
+		};
+
+		void writeReg(StateWriter& _w, const TReg24& _r)	{ _w.write(_r.var); }
+		void writeReg(StateWriter& _w, const TReg48& _r)	{ _w.write(_r.var); }
+		void writeReg(StateWriter& _w, const TReg56& _r)	{ _w.write(_r.var); }
+		void writeReg(StateWriter& _w, const TReg5& _r)		{ _w.write(_r.var); }
+
+		void readReg(StateReader& _r, TReg24& _reg)			{ _r.read(_reg.var); }
+		void readReg(StateReader& _r, TReg48& _reg)			{ _r.read(_reg.var); }
+		void readReg(StateReader& _r, TReg56& _reg)			{ _r.read(_reg.var); }
+		void readReg(StateReader& _r, TReg5& _reg)			{ _r.read(_reg.var); }
+
+		template<typename TRing> void writeRing(StateWriter& _w, const TRing& _ring)
+		{
+			_w.write(static_cast<uint32_t>(_ring.size()));
+			for(size_t i=0; i<_ring.size(); ++i)
+				_w.write(_ring[i]);
+		}
+
+		bool readRing(StateReader& _r, std::vector<TWord>& _dst, const size_t _capacity)
+		{
+			const auto count = _r.read<uint32_t>();
+			if(!_r.ok() || count > _capacity)
+				return false;
+			_dst.resize(count);
+			return _r.read(_dst.data(), count);
+		}
+	}
+
+	// the state of the core in the order of serialization, M registers are applied via DSP::set_m() to update the modulo masks
+	struct SaveState::Core
+	{
+		DspRegs regs;
+		uint64_t instructions = 0;
+		uint64_t cycles = 0;
+		uint32_t processingMode = 0;
+		TWord pcCurrentInstruction = 0;
+		uint32_t interruptFunc = 0;
+
+		std::vector<TWord> pendingInterrupts;
+		std::vector<TWord> pendingExternalInterrupts;
+	};
+
+	void SaveState::writeCore(StateWriter& _w, const DSP& _dsp)
+	{
+		const auto& r = _dsp.reg;
+
+		writeReg(_w, r.x);
+		writeReg(_w, r.y);
+		writeReg(_w, r.a);
+		writeReg(_w, r.b);
+
+		for(size_t i=0; i<r.r.size(); ++i)
+		{
+			writeReg(_w, r.r[i]);
+			writeReg(_w, r.n[i]);
+			writeReg(_w, r.m[i]);
+		}
+
+		writeReg(_w, r.sr);
+		writeReg(_w, r.omr);
+		writeReg(_w, r.pc);
+		writeReg(_w, r.la);
+		writeReg(_w, r.lc);
+		writeReg(_w, r.sp);
+		writeReg(_w, r.sc);
+
+		for (const auto& ss : r.ss)
+			writeReg(_w, ss);
+
+		writeReg(_w, r.sz);
+		writeReg(_w, r.vba);
+		writeReg(_w, r.ep);
+
+		_w.write(_dsp.m_instructions);
+		_w.write(_dsp.m_cycles);
+		_w.write(static_cast<uint32_t>(_dsp.m_processingMode));
+		_w.write(_dsp.pcCurrentInstruction);
+		_w.write(_dsp.getInterruptFuncIndex());
+
+		writeRing(_w, _dsp.m_pendingInterrupts);
+		writeRing(_w, _dsp.m_pendingExternalInterrupts);
+	}
+
+	bool SaveState::readCore(StateReader& _r, Core& _core)
+	{
+		auto& r = _core.regs;
+
+		readReg(_r, r.x);
+		readReg(_r, r.y);
+		readReg(_r, r.a);
+		readReg(_r, r.b);
+
+		for(size_t i=0; i<r.r.size(); ++i)
+		{
+			readReg(_r, r.r[i]);
+			readReg(_r, r.n[i]);
+			readReg(_r, r.m[i]);
+		}
+
+		readReg(_r, r.sr);
+		readReg(_r, r.omr);
+		readReg(_r, r.pc);
+		readReg(_r, r.la);
+		readReg(_r, r.lc);
+		readReg(_r, r.sp);
+		readReg(_r, r.sc);
+
+		for (auto& ss : r.ss)
+			readReg(_r, ss);
+
+		readReg(_r, r.sz);
+		readReg(_r, r.vba);
+		readReg(_r, r.ep);
+
+		_r.read(_core.instructions);
+		_r.read(_core.cycles);
+		_r.read(_core.processingMode);
+		_r.read(_core.pcCurrentInstruction);
+		_r.read(_core.interruptFunc);
+
+		if(!readRing(_r, _core.pendingInterrupts, decltype(DSP::m_pendingInterrupts)::capacity()) ||
+			!readRing(_r, _core.pendingExternalInterrupts, decltype(DSP::m_pendingExternalInterrupts)::capacity()))
+			return false;
+
+		return _r.ok() && !_r.getRemaining() && _core.processingMode <= DSP::LongInterrupt;
+	}
+
+	size_t SaveState::capture(DSP& _dsp)
+	{
+		m_core.clear();
+		StateWriter coreWriter(m_core);
+		writeCore(coreWriter, _dsp);
+
+		for(size_t i=0; i<m_peripherals.size(); ++i)
+		{
+			const auto* p = _dsp.getPeriph(i);
+
+			m_peripheralTypes[i] = p->getType();
+			m_peripherals[i].clear();
+
+			StateWriter w(m_peripherals[i]);
+			p->saveState(w);
+		}
+
+		auto& mem = _dsp.memory();
+
+		const bool useDirtyPages = mem.isDirtyPageTrackingEnabled() && m_dirtySource == &mem;
+
+		size_t copiedPages = 0;
+
+		std::vector<TWord> dirtyPages;
+
+		for(size_t a=0; a<MemArea_COUNT; ++a)
+		{
+			const auto area = static_cast<EMemArea>(a);
+			const auto size = mem.getBufferSize(area);
+			const auto shift = mem.getAddressShift(area);
+			const auto* src = mem.getHostPtr(area, 0);
+
+			auto& dst = m_memory[a];
+
+			// consume the dirty state in any case, it describes the changes relative to this capture afterwards
+			dirtyPages.clear();
+			if(mem.isDirtyPageTrackingEnabled())
+				mem.fetchDirtyPages(area, dirtyPages);
+
+			if(dst.size() != size)
+			{
+				dst.resize(size);
+				copyPage(dst.data(), 0, src, shift, size);
+				copiedPages += (size + PageSize - 1) / PageSize;
+				continue;
+			}
+
+			if(useDirtyPages)
+			{
+				for (const auto page : dirtyPages)
+				{
+					const auto i = page * PageSize;
+					copyPage(&dst[i], 0, src + (i << shift), shift, std::min(PageSize, size - i));
+				}
+				copiedPages += dirtyPages.size();
+				continue;
+			}
+
+			// incremental capture, comparing is a lot cheaper than copying as the snapshot is mostly read
+			for(TWord i=0; i<size; i += PageSize)
+			{
+				const auto count = std::min(PageSize, size - i);
+
+				if(comparePage(&dst[i], 0, src + (i << shift), shift, count))
+					continue;
+
+				copyPage(&dst[i], 0, src + (i << shift), shift, count);
+				++copiedPages;
+			}
+		}
+
+		m_dirtySource = mem.isDirtyPageTrackingEnabled() ? &mem : nullptr;
+		m_valid = true;
+
+		return copiedPages;
+	}
+
+	bool SaveState::restore(DSP& _dsp) const
+	{
+		if(!m_valid)
+			return false;
+
+		auto& mem = _dsp.memory();
+
+		for(size_t a=0; a<MemArea_COUNT; ++a)
+		{
+			if(m_memory[a].size() != mem.getBufferSize(static_cast<EMemArea>(a)))
+			{
+				LOGL(ERROR, "Unable to restore state, memory layout mismatch");
+				return false;
+			}
+		}
+
+		for(size_t i=0; i<m_peripherals.size(); ++i)
+		{
+			if(_dsp.getPeriph(i)->getType() != m_peripheralTypes[i])
+			{
+				LOGL(ERROR, "Unable to restore state, peripherals mismatch");
+				return false;
+			}
+		}
+
+		Core core;
+		StateReader coreReader(m_core);
+		if(!readCore(coreReader, core))
+		{
+			LOGL(ERROR, "Unable to restore state, invalid core state");
+			return false;
+		}
+
+		// peripheral data can only be validated by loading it. Nothing else has been modified at this point, keep the current state of
+		// all peripherals to revert them if any section turns out to be invalid
+		std::array<std::vector<uint8_t>, 2> previousPeripherals;
+
+		for(size_t i=0; i<previousPeripherals.size(); ++i)
+		{
+			StateWriter w(previousPeripherals[i]);
+			_dsp.getPeriph(i)->saveState(w);
+		}
+
+		for(size_t i=0; i<m_peripherals.size(); ++i)
+		{
+			StateReader r(m_peripherals[i]);
+			_dsp.getPeriph(i)->loadState(r);
+
+			if(r.ok() && !r.getRemaining())
+				continue;
+
+			for(size_t p=0; p<=i; ++p)
+			{
+				StateReader prev(previousPeripherals[p]);
+				_dsp.getPeriph(p)->loadState(prev);
+			}
+
+			LOGL(ERROR, "Unable to restore state, invalid peripheral state");
+			return false;
+		}
+
+		bool pMemChanged = false;
+
+		for(size_t a=0; a<MemArea_COUNT; ++a)
+		{
+			const auto area = static_cast<EMemArea>(a);
+			const auto& src = m_memory[a];
+			const auto shift = mem.getAddressShift(area);
+			auto* dst = mem.getHostPtr(area, 0);
+
+			for(TWord i=0; i<src.size(); i += PageSize)
+			{
+				const auto count = std::min(PageSize, static_cast<TWord>(src.size()) - i);
+
+				if(comparePage(dst + (i << shift), shift, &src[i], 0, count))
+					continue;
+
+				copyPage(dst + (i << shift), shift, &src[i], 0, count);
+
+				// other consumers of the dirty state need to see the restored pages
+				if(mem.isDirtyPageTrackingEnabled())
+					mem.markPageDirty(area, i);
+
+				if(area == MemArea_P)
+					pMemChanged = true;
+			}
+		}
+
+		_dsp.reg = core.regs;
+
+		for(int i=0; i<static_cast<int>(core.regs.m.size()); ++i)
+			_dsp.set_m(i, core.regs.m[i].var);
+
+		_dsp.m_instructions = core.instructions;
+		_dsp.m_cycles = core.cycles;
+		_dsp.m_processingMode = static_cast<DSP::ProcessingMode>(core.processingMode);
+		_dsp.pcCurrentInstruction = core.pcCurrentInstruction;
+
+		_dsp.m_pendingInterrupts.clear();
+		for (const auto vba : core.pendingInterrupts)
+			_dsp.m_pendingInterrupts.push_back(vba);
+
+		_dsp.m_pendingExternalInterrupts.clear();
+		for (const auto vba : core.pendingExternalInterrupts)
+			_dsp.m_pendingExternalInterrupts.push_back(vba);
+
+		_dsp.setInterruptFuncIndex(core.interruptFunc);
+
+		_dsp.resetCCRCache();
+
+		if(pMemChanged)
+		{
+			_dsp.clearOpcodeCache();
+
+			if constexpr(g_useJIT)
+				_dsp.m_jit.destroyAllBlocks();
+		}
+		else if constexpr(g_useJIT)
+		{
+			// P memory is unchanged, existing JIT blocks stay valid, but SR/OMR may require a different block chain
+			_dsp.m_jit.checkModeChange();
+		}
+
+		return true;
+	}
+
+	void SaveState::write(std::vector<uint8_t>& _dst) const
+	{
+		FileHeader header;
+		header.coreSize = static_cast<uint32_t>(m_core.size());
+
+		for(size_t i=0; i<m_peripherals.size(); ++i)
+		{
+			header.peripheralTypes[i] = static_cast<uint32_t>(m_peripheralTypes[i]);
+			header.peripheralSizes[i] = static_cast<uint32_t>(m_peripherals[i].size());
+		}
+
+		for(size_t a=0; a<MemArea_COUNT; ++a)
+			header.memSize[a] = static_cast<uint32_t>(m_memory[a].size());
+
+		_dst.clear();
+
+		StateWriter w(_dst);
+
+		w.write(header);
+		w.write(m_core.data(), m_core.size());
+
+		for (const auto& p : m_peripherals)
+			w.write(p.data(), p.size());
+
+		for (const auto& m : m_memory)
+			w.write(m.data(), m.size());
+	}
+
+	bool SaveState::read(const std::vector<uint8_t>& _src, const DSP& _target)
+	{
+		m_valid = false;
+		m_dirtySource = nullptr;
+
+		StateReader r(_src);
+
+		FileHeader header;
+		const FileHeader expected;
+
+		if(!r.read(header) || !std::equal(std::begin(header.magic), std::end(header.magic), std::begin(expected.magic)))
+		{
+			LOGL(ERROR, "Data is not a DSP save state");
+			return false;
+		}
+
+		if(header.version != Version)
+		{
+			LOGL(ERROR, "Unsupported save state version " << header.version);
+			return false;
+		}
+
+		// validate against the target before allocating anything, sizes in the data cannot be trusted
+		const auto& mem = _target.memory();
+
+		for(size_t a=0; a<MemArea_COUNT; ++a)
+		{
+			if(header.memSize[a] != mem.getBufferSize(static_cast<EMemArea>(a)))
+			{
+				LOGL(ERROR, "Save state memory layout does not match, area " << a << " has " << HEX(header.memSize[a]) << " words, expected " << HEX(mem.getBufferSize(static_cast<EMemArea>(a))));
+				return false;
+			}
+		}
+
+		for(size_t i=0; i<m_peripherals.size(); ++i)
+		{
+			if(header.peripheralTypes[i] != static_cast<uint32_t>(_target.getPeriph(i)->getType()))
+			{
+				LOGL(ERROR, "Save state peripherals do not match");
+				return false;
+			}
+		}
+
+		size_t totalSize = header.coreSize;
+		for (const auto s : header.peripheralSizes)
+			totalSize += s;
+		for (const auto s : header.memSize)
+			totalSize += static_cast<size_t>(s) * sizeof(TWord);
+
+		if(totalSize != r.getRemaining())
+		{
+			LOGL(ERROR, "Save state size mismatch, expected " << totalSize << " bytes, got " << r.getRemaining());
+			return false;
+		}
+
+		m_core.resize(header.coreSize);
+		r.read(m_core.data(), m_core.size());
+
+		for(size_t i=0; i<m_peripherals.size(); ++i)
+		{
+			m_peripheralTypes[i] = static_cast<PeripheralType>(header.peripheralTypes[i]);
+			m_peripherals[i].resize(header.peripheralSizes[i]);
+			r.read(m_peripherals[i].data(), m_peripherals[i].size());
+		}
+
+		for(size_t a=0; a<MemArea_COUNT; ++a)
+		{
+			m_memory[a].resize(header.memSize[a]);
+			r.read(m_memory[a].data(), m_memory[a].size());
+		}
+
+		Core core;
+		StateReader coreReader(m_core);
+
+		if(!r.ok() || !readCore(coreReader, core))
+		{
+			LOGL(ERROR, "Save state contains an invalid core state");
+			return false;
+		}
+
+		m_valid = true;
+		return true;
+	}
+
+	bool SaveState::writeToFile(const std::string& _filename) const
+	{
+		std::vector<uint8_t> data;
+		write(data);
+
+		std::ofstream file(_filename, std::ios::out | std::ios::binary);
+
+		if(!file.is_open())
+		{
+			LOGL(ERROR, "Failed to create save state file " << _filename);
+			return false;
+		}
+
+		file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+		return file.good();
+	}
+
+	bool SaveState::readFromFile(const std::string& _filename, const DSP& _target)
+	{
+		std::ifstream file(_filename, std::ios::in | std::ios::binary | std::ios::ate);
+
+		if(!file.is_open())
+			return false;
+
+		const auto size = file.tellg();
+		file.seekg(0, std::ios::beg);
+
+		std::vector<uint8_t> data(static_cast<size_t>(size));
+		file.read(reinterpret_cast<char*>(data.data()), size);
+
+		if(!file.good())
+			return false;
+
+		return read(data, _target);
+	}
+
+	bool SaveState::comparePage(const TWord* _a, const TWord _shiftA, const TWord* _b, const TWord _shiftB, const TWord _count)
+	{
+		if(!_shiftA && !_shiftB)
+			return ::memcmp(_a, _b, _count * sizeof(TWord)) == 0;
+
+		for(TWord i=0; i<_count; ++i)
+		{
+			if(_a[i << _shiftA] != _b[i << _shiftB])
+				return false;
+		}
+		return true;
+	}
+
+	void SaveState::copyPage(TWord* _dst, const TWord _shiftDst, const TWord* _src, const TWord _shiftSrc, const TWord _count)
+	{
+		if(!_shiftDst && !_shiftSrc)
+		{
+			std::copy_n(_src, _count, _dst);
+			return;
+		}
+
+		for(TWord i=0; i<_count; ++i)
+			_dst[i << _shiftDst] = _src[i << _shiftSrc];
+	}
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "types.h"
+
+namespace dsp56k
+{
+	class DSP;
+	class Memory;
+	class StateReader;
+	class StateWriter;
+	enum class PeripheralType;
+
+	// Binary snapshot of the DSP state: registers, counters, pending interrupts, X/Y/P memory and the registers of the peripherals.
+	// Memory is stored in pages, capturing into an existing snapshot only copies pages that have changed since the previous capture.
+	// Data that has been queued by the host (audio, HDI08) is not part of the snapshot
+	class SaveState
+	{
+	public:
+		static constexpr uint32_t Version = 2;
+		static constexpr TWord PageSize = 256;	// in words, equals Memory::DirtyPageSize
+
+		// Returns the number of memory pages that have been copied. If dirty page tracking is enabled (see DSP::enableDirtyPageTracking()),
+		// only the pages that are reported as dirty are copied, the dirty state of the memory is consumed
+		size_t capture(DSP& _dsp);
+
+		// JIT blocks are only recreated if P memory differs from the current memory of the DSP. Do not call while the DSP executes code.
+		// All sections are validated before the DSP is modified, the DSP is left unchanged if restoring fails
+		bool restore(DSP& _dsp) const;
+
+		bool isValid() const { return m_valid; }
+
+		void write(std::vector<uint8_t>& _dst) const;
+
+		// fails if the memory layout or the peripherals of the data do not match the target DSP
+		bool read(const std::vector<uint8_t>& _src, const DSP& _target);
+
+		bool writeToFile(const std::string& _filename) const;
+		bool readFromFile(const std::string& _filename, const DSP& _target);
+
+	private:
+		struct Core;
+
+		static void writeCore(StateWriter& _w, const DSP& _dsp);
+		static bool readCore(StateReader& _r, Core& _core);
+
+		// X and Y memory words may be interleaved, shift is the distance of two consecutive words as log2
+		static bool comparePage(const TWord* _a, TWord _shiftA, const TWord* _b, TWord _shiftB, TWord _count);
+		static void copyPage(TWord* _dst, TWord _shiftDst, const TWord* _src, TWord _shiftSrc, TWord _count);
+
+		bool m_valid = false;
+
+		std::vector<uint8_t> m_core;
+
+		std::array<PeripheralType, 2> m_peripheralTypes{};
+		std::array<std::vector<uint8_t>, 2> m_peripherals;
+
+		std::array<std::vector<TWord>, MemArea_COUNT> m_memory;
+
+		// memory whose dirty pages describe the changes since the previous capture
+		const Memory* m_dirtySource = nullptr;
+	};
+}
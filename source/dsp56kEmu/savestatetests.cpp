@@ -0,0 +1,389 @@
+#include "savestatetests.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+
+#include "dsp.h"
+#include "esai.h"
+#include "memory.h"
+#include "peripherals.h"
+#include "savestate.h"
+#include "timers.h"
+#include "unittests.h"
+
+namespace dsp56k
+{
+	namespace
+	{
+		constexpr TWord MemSize = 0x4000;
+		constexpr TWord ProgramStart = 0x100;
+
+		struct Instance
+		{
+			explicit Instance(const TWord _memSize = MemSize, const bool _peripherals56303 = false) : mem(validator, _memSize)
+			{
+				if(_peripherals56303)
+					periphX.reset(new Peripherals56303());
+				else
+					periphX.reset(new Peripherals56362());
+
+				periphY.reset(new Peripherals56367());
+
+				dsp.reset(new DSP(mem, periphX.get(), periphY.get()));
+			}
+
+			DefaultMemoryValidator validator;
+			Memory mem;
+			std::unique_ptr<IPeripherals> periphX;
+			std::unique_ptr<IPeripherals> periphY;
+			std::unique_ptr<DSP> dsp;
+		};
+
+		std::string getTempFile(const char* _name)
+		{
+			return (std::filesystem::temp_directory_path() / _name).string();
+		}
+
+		void patch(std::vector<uint8_t>& _data, const size_t _offset, const uint32_t _value)
+		{
+			std::memcpy(&_data[_offset], &_value, sizeof(_value));
+		}
+	}
+
+	SaveStateTests::SaveStateTests()
+	{
+		LOG("Running Save State Tests...");
+
+		testRoundTrip();
+		testRestoreContinues();
+		testDirtyPages();
+		testValidation();
+		testRestoreInvalid();
+		testFile();
+		testCopyState();
+
+		LOG("Save State Tests finished.");
+	}
+
+	void SaveStateTests::testRoundTrip()
+	{
+		Instance src;
+		auto& dsp = *src.dsp;
+
+		emitProgram(dsp);
+
+		// peripheral registers that are not modified by the program
+		dsp.getPeriph(0)->write(Timers::M_TLR0, 0x123456);
+		dsp.getPeriph(0)->write(Timers::M_TCPR0, 0x654321);
+		dsp.getPeriph(0)->write(Esai::M_TSMA, 0x3);
+
+		run(dsp, 100);
+
+		SaveState state;
+		verify(state.capture(dsp) > 0);
+		verify(state.isValid());
+
+		std::vector<uint8_t> data;
+		state.write(data);
+
+		Instance dst;
+
+		SaveState loaded;
+		verify(loaded.read(data, *dst.dsp));
+		verify(loaded.restore(*dst.dsp));
+
+		const auto& a = dsp.readRegs();
+		const auto& b = dst.dsp->readRegs();
+
+		verify(a.pc == b.pc);
+		verify(a.a == b.a);
+		verify(a.r[0] == b.r[0]);
+		verify(a.sr == b.sr);
+		verify(dsp.getInstructionCounter() == dst.dsp->getInstructionCounter());
+
+		for(TWord i=0; i<MemSize; ++i)
+		{
+			verify(src.mem.get(MemArea_X, i) == dst.mem.get(MemArea_X, i));
+			verify(src.mem.get(MemArea_Y, i) == dst.mem.get(MemArea_Y, i));
+			verify(src.mem.get(MemArea_P, i) == dst.mem.get(MemArea_P, i));
+		}
+
+		verify(dst.dsp->getPeriph(0)->read(Timers::M_TLR0, Movep_ppea) == 0x123456);
+		verify(dst.dsp->getPeriph(0)->read(Timers::M_TCPR0, Movep_ppea) == 0x654321);
+		verify(dst.dsp->getPeriph(0)->read(Esai::M_TSMA, Movep_ppea) == 0x3);
+
+		// a capture of the restored DSP serializes to the same data
+		verify(toBytes(*dst.dsp) == data);
+	}
+
+	void SaveStateTests::testRestoreContinues()
+	{
+		Instance src;
+		emitProgram(*src.dsp);
+		run(*src.dsp, 50);
+
+		SaveState state;
+		state.capture(*src.dsp);
+
+		// a clone continues exactly like its source
+		Instance clone;
+		verify(state.restore(*clone.dsp));
+
+		run(*src.dsp, 500);
+		run(*clone.dsp, 500);
+
+		const auto expected = toBytes(*src.dsp);
+		verify(toBytes(*clone.dsp) == expected);
+
+		// restoring into the source itself rewinds it
+		verify(state.restore(*src.dsp));
+		run(*src.dsp, 500);
+		verify(toBytes(*src.dsp) == expected);
+	}
+
+	void SaveStateTests::testDirtyPages()
+	{
+		Instance src;
+		auto& dsp = *src.dsp;
+
+		emitProgram(dsp);
+
+		dsp.enableDirtyPageTracking(true);
+
+		constexpr auto pagesPerArea = MemSize / SaveState::PageSize;
+
+		// the first capture copies everything, afterwards nothing has changed
+		SaveState state;
+		verify(state.capture(dsp) == pagesPerArea * MemArea_COUNT);
+		verify(state.capture(dsp) == 0);
+
+		src.mem.set(MemArea_X, 0x1234, 0x42);
+		verify(state.capture(dsp) == 1);
+		verify(state.capture(dsp) == 0);
+
+		// the program writes to one page of X and Y memory
+		run(dsp, 30);
+		verify(state.capture(dsp) == 2);
+
+		// the incremental snapshot is complete
+		Instance dst;
+		verify(state.restore(*dst.dsp));
+		verify(toBytes(*dst.dsp) == toBytes(dsp));
+		verify(dst.mem.get(MemArea_X, 0x1234) == 0x42);
+
+		// restoring marks the restored pages dirty, a capture copies them again
+		dst.dsp->enableDirtyPageTracking(true);
+		SaveState dstState;
+		dstState.capture(*dst.dsp);
+		verify(dstState.capture(*dst.dsp) == 0);
+		dst.mem.set(MemArea_Y, 0x3000, 0x1);
+		verify(state.restore(*dst.dsp));
+		verify(dstState.capture(*dst.dsp) == 1);
+
+		// without dirty page tracking, pages are compared
+		dsp.enableDirtyPageTracking(false);
+		SaveState compared;
+		verify(compared.capture(dsp) == pagesPerArea * MemArea_COUNT);
+		verify(compared.capture(dsp) == 0);
+		src.mem.set(MemArea_P, 0x2000, 0x1);
+		verify(compared.capture(dsp) == 1);
+	}
+
+	void SaveStateTests::testValidation()
+	{
+		Instance src;
+		emitProgram(*src.dsp);
+		run(*src.dsp, 10);
+
+		const auto data = toBytes(*src.dsp);
+
+		Instance target;
+		SaveState state;
+		verify(state.read(data, *target.dsp));
+
+		// the memory sizes of the target need to match
+		Instance smaller(MemSize / 2);
+		verify(!state.read(data, *smaller.dsp));
+		verify(!state.isValid());
+		verify(!state.restore(*smaller.dsp));
+
+		// as well as the peripherals
+		Instance otherPeripherals(MemSize, true);
+		verify(!state.read(data, *otherPeripherals.dsp));
+
+		verify(state.read(data, *target.dsp));
+		verify(!state.restore(*otherPeripherals.dsp));
+		verify(!state.restore(*smaller.dsp));
+
+		// header: magic, version, core size, peripheral types, peripheral sizes, memory sizes
+		auto corrupt = [&](const size_t _offset, const uint32_t _value)
+		{
+			auto d = data;
+			patch(d, _offset, _value);
+			return state.read(d, *target.dsp);
+		};
+
+		verify(!corrupt(0, 0x12345678));
+		verify(!corrupt(4, SaveState::Version + 1));
+		verify(!corrupt(8, 4));
+		verify(!corrupt(12, static_cast<uint32_t>(PeripheralType::Peripherals56303)));
+		verify(!corrupt(20, 0x7fffffff));
+		verify(!corrupt(28, 0x7fffffff));
+
+		// truncated and oversized data
+		auto truncated = data;
+		truncated.pop_back();
+		verify(!state.read(truncated, *target.dsp));
+
+		auto oversized = data;
+		oversized.push_back(0);
+		verify(!state.read(oversized, *target.dsp));
+
+		verify(!state.read({}, *target.dsp));
+	}
+
+	void SaveStateTests::testRestoreInvalid()
+	{
+		Instance src;
+		emitProgram(*src.dsp);
+		run(*src.dsp, 10);
+
+		auto data = toBytes(*src.dsp);
+
+		Instance target;
+		emitProgram(*target.dsp);
+		run(*target.dsp, 3);
+
+		const auto before = toBytes(*target.dsp);
+
+		// move four bytes from the first peripheral section to the second one. The total size is unchanged, the first section is
+		// truncated and can only be detected by loading it
+		uint32_t size0, size1;
+		std::memcpy(&size0, &data[20], sizeof(size0));
+		std::memcpy(&size1, &data[24], sizeof(size1));
+		patch(data, 20, size0 - 4);
+		patch(data, 24, size1 + 4);
+
+		SaveState state;
+		verify(state.read(data, *target.dsp));
+		verify(!state.restore(*target.dsp));
+
+		// nothing has been applied, neither core, memory nor any of the peripherals
+		verify(toBytes(*target.dsp) == before);
+
+		// the reverted peripherals keep working
+		run(*target.dsp, 5);
+	}
+
+	void SaveStateTests::testFile()
+	{
+		Instance src;
+		emitProgram(*src.dsp);
+		run(*src.dsp, 20);
+
+		SaveState state;
+		state.capture(*src.dsp);
+
+		const auto filename = getTempFile("dsp56k_savestate_test.bin");
+
+		verify(state.writeToFile(filename));
+
+		Instance dst;
+		SaveState loaded;
+		verify(loaded.readFromFile(filename, *dst.dsp));
+		std::remove(filename.c_str());
+
+		verify(loaded.restore(*dst.dsp));
+		verify(toBytes(*dst.dsp) == toBytes(*src.dsp));
+
+		verify(!loaded.readFromFile(getTempFile("dsp56k_savestate_missing.bin"), *dst.dsp));
+	}
+
+	void SaveStateTests::testCopyState()
+	{
+		Instance src;
+		auto& dsp = *src.dsp;
+
+		emitProgram(dsp);
+		run(dsp, 50);
+
+		dsp.getPeriph(0)->write(Timers::M_TLR0, 0x123456);
+		dsp.getPeriph(0)->write(Esai::M_TSMA, 0x3);
+		dsp.injectExternalInterrupt(Vba_IRQA);
+
+		Instance clone;
+		verify(clone.dsp->copyStateFrom(dsp));
+
+		// registers, memory, pending interrupts and peripherals are identical
+		verify(clone.dsp->hasPendingExternalInterrupts());
+		verify(clone.dsp->getPeriph(0)->read(Timers::M_TLR0, Movep_ppea) == 0x123456);
+		verify(clone.dsp->getPeriph(0)->read(Esai::M_TSMA, Movep_ppea) == 0x3);
+		verify(toBytes(*clone.dsp) == toBytes(dsp));
+
+		// the clone continues exactly like its source
+		run(dsp, 500);
+		run(*clone.dsp, 500);
+
+		verify(toBytes(*clone.dsp) == toBytes(dsp));
+
+		// copying into a DSP with different peripherals or memory size is refused
+		Instance otherPeripherals(MemSize, true);
+		verify(!otherPeripherals.dsp->copyStateFrom(dsp));
+
+		Instance smaller(MemSize / 2);
+		verify(!smaller.dsp->copyStateFrom(dsp));
+	}
+
+	void SaveStateTests::emitProgram(DSP& _dsp)
+	{
+		TWord pc = ProgramStart;
+
+		pc = emitToMemory(_dsp, "move #$200,r0", pc);
+		pc = emitToMemory(_dsp, "move #$12345,a", pc);
+
+		const auto loop = pc;
+
+		pc = emitToMemory(_dsp, "inc a", pc);
+		pc = emitToMemory(_dsp, "move a,x:(r0)+", pc);
+		pc = emitToMemory(_dsp, "move a,y:(r0)", pc);
+
+		char jmp[32];
+		snprintf(jmp, sizeof(jmp), "jmp $%x", loop);
+		emitToMemory(_dsp, jmp, pc);
+
+		_dsp.setPC(ProgramStart);
+	}
+
+	TWord SaveStateTests::emitToMemory(DSP& _dsp, const char* _text, const TWord _pc)
+	{
+		const auto result = m_assembler.assemble(_text);
+		if(!result.success())
+			throw std::string("Assembly failed for: ") + _text;
+
+		auto& mem = _dsp.memory();
+
+		mem.set(MemArea_P, _pc, result.word[0]);
+		if(result.wordCount > 1)
+			mem.set(MemArea_P, _pc + 1, result.word[1]);
+
+		return _pc + result.wordCount;
+	}
+
+	void SaveStateTests::run(DSP& _dsp, const size_t _count)
+	{
+		for(size_t i=0; i<_count; ++i)
+			_dsp.execInterpreter();
+	}
+
+	std::vector<uint8_t> SaveStateTests::toBytes(DSP& _dsp)
+	{
+		SaveState state;
+		state.capture(_dsp);
+
+		std::vector<uint8_t> data;
+		state.write(data);
+		return data;
+	}
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "assembler.h"
+#include "types.h"
+
+namespace dsp56k
+{
+	class DSP;
+
+	// Tests for SaveState: serialization round trips, incremental capture via dirty pages and validation of the data against the target DSP.
+	// DSP::copyStateFrom() is verified against a capture of the source DSP
+	class SaveStateTests
+	{
+	public:
+		SaveStateTests();
+
+	private:
+		void testRoundTrip();
+		void testRestoreContinues();
+		void testDirtyPages();
+		void testValidation();
+		void testRestoreInvalid();
+		void testFile();
+		void testCopyState();
+
+		void emitProgram(DSP& _dsp);
+		TWord emitToMemory(DSP& _dsp, const char* _text, TWord _pc);
+
+		static void run(DSP& _dsp, size_t _count);
+		static std::vector<uint8_t> toBytes(DSP& _dsp);
+
+		Assembler m_assembler;
+	};
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace dsp56k
+{
+	// Sequential binary serialization of emulator state, see SaveState. Values are stored field by field with their native size,
+	// the layout of a stream is defined by the order of the write() calls and needs to be versioned by the owner of the stream
+	class StateWriter
+	{
+	public:
+		explicit StateWriter(std::vector<uint8_t>& _dst) : m_dst(_dst) {}
+
+		template<typename T> void write(const T& _value)
+		{
+			static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable types can be written");
+
+			const auto* src = reinterpret_cast<const uint8_t*>(&_value);
+			m_dst.insert(m_dst.end(), src, src + sizeof(T));
+		}
+
+		template<typename T> void write(const T* _values, const size_t _count)
+		{
+			static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable types can be written");
+
+			const auto* src = reinterpret_cast<const uint8_t*>(_values);
+			m_dst.insert(m_dst.end(), src, src + _count * sizeof(T));
+		}
+
+	private:
+		std::vector<uint8_t>& m_dst;
+	};
+
+	// Reads data written by StateWriter. Reading past the end fails the reader and leaves the target unmodified
+	class StateReader
+	{
+	public:
+		explicit StateReader(const std::vector<uint8_t>& _src, const size_t _offset = 0) : m_src(_src), m_offset(_offset) {}
+
+		template<typename T> bool read(T& _value)
+		{
+			return read(&_value, 1);
+		}
+
+		template<typename T> bool read(T* _values, const size_t _count)
+		{
+			static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable types can be read");
+
+			const auto byteCount = _count * sizeof(T);
+
+			if(m_failed || byteCount > m_src.size() - m_offset)
+			{
+				m_failed = true;
+				return false;
+			}
+
+			if(byteCount)
+				std::memcpy(_values, &m_src[m_offset], byteCount);
+
+			m_offset += byteCount;
+			return true;
+		}
+
+		template<typename T> T read()
+		{
+			T value{};
+			read(value);
+			return value;
+		}
+
+		void fail()						{ m_failed = true; }
+		bool ok() const					{ return !m_failed; }
+
+		size_t getOffset() const		{ return m_offset; }
+		size_t getRemaining() const		{ return m_src.size() - m_offset; }
+
+	private:
+		const std::vector<uint8_t>& m_src;
+		size_t m_offset;
+		bool m_failed = false;
+	};
+}
@@ -3,6 +3,7 @@
 #include "dsp.h"
 
 #include "timers.h"
+#include "statestream.h"
 
 namespace dsp56k
 {
@@ -150,6 +151,36 @@ namespace dsp56k
 		m_timerupdateInterval = _instructions;
 	}
 
+	void Timers::saveState(StateWriter& _w) const
+	{
+		_w.write(m_tplr);
+		_w.write(m_tpcr);
+		_w.write(m_lastClock);
+
+		for (const auto& t : m_timers)
+		{
+			_w.write(t.m_tlr);
+			_w.write(t.m_tcpr);
+			_w.write(t.m_tcr);
+			_w.write<TWord>(t.m_tcsr);
+		}
+	}
+
+	void Timers::loadState(StateReader& _r)
+	{
+		_r.read(m_tplr);
+		_r.read(m_tpcr);
+		_r.read(m_lastClock);
+
+		for (auto& t : m_timers)
+		{
+			_r.read(t.m_tlr);
+			_r.read(t.m_tcpr);
+			_r.read(t.m_tcr);
+			_r.read(t.m_tcsr.value());
+		}
+	}
+
 	void Timers::setSymbols(Disassembler& _disasm) const
 	{
 		constexpr std::pair<int,const char*> symbols[] =
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "periphaccess.h"
 #include "types.h"
 
 #include "dsp56kBase/bitfield.h"
@@ -8,6 +9,8 @@ namespace dsp56k
 {
 	class Timers;
 	class IPeripherals;
+	class StateReader;
+	class StateWriter;
 
 	class Timer
 	{
@@ -127,10 +130,21 @@ namespace dsp56k
 		const TWord& readTPLR() const					{ return m_tplr; }
 		const TWord& readTPCR() const					{ return m_tpcr; }
 
+		TWord& getTCPR(int _index)						{ return m_timers[_index].m_tcpr; }
+
+		// writeTCSR() only needs to run if TE changes or if TOF/TCF are involved
+		PeriphAccess getTCSRAccess(int _index)
+		{
+			return PeriphAccess::flags(m_timers[_index].m_tcsr.value(), 1 << Timer::M_TE, (1 << Timer::M_TOF) | (1 << Timer::M_TCF));
+		}
+
 		void setDSP(const DSP* _dsp);
 
 		void setTimerUpdateInterval(const TWord _instructions);
 
+		void saveState(StateWriter& _w) const;
+		void loadState(StateReader& _r);
+
 		void setSymbols(Disassembler& _disasm) const;
 
 	private:
@@ -1,5 +1,7 @@
 #include "unittests.h"
 
+#include <algorithm>
+
 namespace dsp56k
 {
 	static DefaultMemoryValidator g_defaultMemoryValidator;
@@ -1389,6 +1391,38 @@ namespace dsp56k
 		{
 			verify(dsp.regs().a.var == 0x000000000d2233);
 		});
+
+		// negative products, with and without negate, the doubled product is added to or subtracted from the shifted accumulator
+		runTest([&]()
+		{
+			dsp.regs().a.var = 0x00000001000000;
+			dsp.regs().b.var = 0x00000001000000;
+			dsp.x1(0xffffe0);
+			dsp.y1(0x000020);
+			emit("dmac ss x1,y1,a");
+			emit("dmac ss -x1,y1,b");
+		}, [&]()
+		{
+			verify(dsp.regs().a.var == 0xfffffffffff801);
+			verify(dsp.regs().b.var == 0x00000000000801);
+			verify(!dsp.sr_test(CCR_V));
+		});
+
+		// negative accumulator, unsigned operands that result in a product that uses all 48 bits
+		runTest([&]()
+		{
+			dsp.regs().a.var = 0xff800000000000;
+			dsp.regs().b.var = 0xff800000000000;
+			dsp.x1(0x800000);
+			dsp.y1(0x800000);
+			emit("dmac uu x1,y1,a");
+			emit("dmac uu -x1,y1,b");
+		}, [&]()
+		{
+			verify(dsp.regs().a.var == 0x007fffff800000);
+			verify(dsp.regs().b.var == 0xff7fffff800000);
+			verify(!dsp.sr_test(CCR_V));
+		});
 	}
 
 	// 48x48-bit multi-precision multiply using mpyuu/dmac/macsu sequence.
@@ -2079,6 +2113,50 @@ namespace dsp56k
 			verify(dsp.reg.a.var == 0x8000);
 			verify(dsp.reg.b.var == 0x80000);
 		});
+
+		// negated multiply and multiply-accumulate
+
+		runTest([&]()
+		{
+			dsp.x0(0x000200);
+			dsp.y0(0x000100);
+			dsp.reg.a.var = 0x12abcdefabdef;
+			dsp.reg.b.var = 0x00000001000000;
+
+			emit(0x2000d4);	// mpy -y0,x0,a
+			emit(0x2000de);	// mac -y0,x0,b
+		}, [&]()
+		{
+			verify(dsp.reg.a.var == 0xfffffffffc0000);
+			verify(dsp.reg.b.var == 0x00000000fc0000);
+		});
+
+		runTest([&]()
+		{
+			dsp.x0(0xffffff);
+			dsp.y0(0x800000);
+
+			emit(0x2000d4);	// mpy -y0,x0,a
+		}, [&]()
+		{
+			verify(dsp.reg.a.var == 0xffffffff000000);
+		});
+
+		// negative accumulator and negative product, negated and not negated
+		runTest([&]()
+		{
+			dsp.x0(0xffff00);
+			dsp.y0(0x000200);
+			dsp.reg.a.var = 0xfff00000000000;
+			dsp.reg.b.var = 0xfff00000000000;
+
+			emit("mac -x0,y0,a");
+			emit("mac x0,y0,b");
+		}, [&]()
+		{
+			verify(dsp.reg.a.var == 0xfff00000040000);
+			verify(dsp.reg.b.var == 0xffeffffffc0000);
+		});
 	}
 
 	void UnitTests::mpyr()
@@ -4504,6 +4582,7 @@ namespace dsp56k
 		rep_multi();
 		do_multi();
 		jsr_rts();
+		dirtyPages();
 	}
 
 	void UnitTests::rep_multi()
@@ -4644,4 +4723,71 @@ namespace dsp56k
 
 		verify(dsp.regs().a.var == 0x00000003000000);	// 3 adds total
 	}
+
+	void UnitTests::dirtyPages()
+	{
+		dsp.resetHW();
+
+		// immediate address, address register, parallel X/Y and L memory writes
+		TWord pc = 0x100;
+		pc = emitToMemory("move #$345,r0", pc);
+		pc = emitToMemory("move #$567,r4", pc);
+		pc = emitToMemory("move #$4567,r3", pc);
+		pc = emitToMemory("move #$12,x0", pc);
+		pc = emitToMemory("move x0,x:>$1234", pc);
+		pc = emitToMemory("move x0,y:(r0)", pc);
+		pc = emitToMemory("move x0,x:(r0) y0,y:(r4)", pc);
+		pc = emitToMemory("move a,l:(r3)", pc);
+		const auto end = pc;
+		emitToMemory("nop", pc);
+
+		std::vector<TWord> pages;
+
+		auto fetch = [&](const EMemArea _area)
+		{
+			pages.clear();
+			mem.fetchDirtyPages(_area, pages);
+			std::sort(pages.begin(), pages.end());
+			return pages;
+		};
+
+		dsp.enableDirtyPageTracking(true);
+
+		// all pages are dirty after enabling, fetching clears them
+		for(const auto area : {MemArea_X, MemArea_Y, MemArea_P})
+		{
+			const auto count = mem.getDirtyPageCount(area);
+			verify(count > 0);
+			verify(mem.isPageDirty(area, count - 1));
+			verify(fetch(area).size() == count);
+			verify(!mem.isPageDirty(area, 0));
+			verify(fetch(area).empty());
+		}
+
+		dsp.setPC(0x100);
+		execUntil(end);
+
+		verify(mem.isPageDirty(MemArea_X, 0x12));
+		verify(!mem.isPageDirty(MemArea_X, 0x13));
+
+		verify(fetch(MemArea_X) == std::vector<TWord>({0x3, 0x12, 0x45}));
+		verify(fetch(MemArea_Y) == std::vector<TWord>({0x3, 0x5, 0x45}));
+		verify(fetch(MemArea_P).empty());
+
+		verify(fetch(MemArea_X).empty());
+		verify(fetch(MemArea_Y).empty());
+
+		// writing again marks the pages again, clearing discards them
+		dsp.setPC(0x100);
+		execUntil(end);
+
+		verify(mem.isPageDirty(MemArea_Y, 0x5));
+		mem.clearDirtyPages();
+		verify(!mem.isPageDirty(MemArea_Y, 0x5));
+		verify(fetch(MemArea_Y).empty());
+
+		dsp.enableDirtyPageTracking(false);
+		verify(mem.getDirtyPageCount(MemArea_X) == 0);
+		verify(!mem.isPageDirty(MemArea_X, 0x12));
+	}
 }
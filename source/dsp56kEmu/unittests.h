@@ -161,6 +161,7 @@ namespace  dsp56k
 		void rep_multi();
 		void do_multi();
 		void jsr_rts();
+		void dirtyPages();
 
 		Peripherals56362 peripheralsX;
 		Peripherals56367 peripheralsY;
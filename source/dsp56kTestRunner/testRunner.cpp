@@ -2,9 +2,14 @@
 
 #include "dsp56kEmu/dspconfig.h"
 #include "dsp56kEmu/assemblertest.h"
+#include "dsp56kEmu/benchmarkkerneltests.h"
+#include "dsp56kEmu/executiontracetests.h"
+#include "dsp56kEmu/jitlivenesstests.h"
 #include "dsp56kEmu/jitunittests.h"
 #include "dsp56kEmu/jitoptimizertests.h"
 #include "dsp56kEmu/interpreterunittests.h"
+#include "dsp56kEmu/memoryheatmaptests.h"
+#include "dsp56kEmu/savestatetests.h"
 
 int main(int _argc, char* _argv[])
 {
@@ -46,6 +51,42 @@ int main(int _argc, char* _argv[])
 	}
 	std::cout << "Interpreter Unit Tests finished." << std::endl;
 
+	std::cout << "Running Execution Trace Tests..." << std::endl;
+	try
+	{
+		dsp56k::ExecutionTraceTests executionTraceTests;
+	}
+	catch(const std::string& _err)
+	{
+		std::cout << "Execution trace test failed: " << _err << std::endl;
+		return -1;
+	}
+	std::cout << "Execution Trace Tests finished." << std::endl;
+
+	std::cout << "Running Memory Heat Map Tests..." << std::endl;
+	try
+	{
+		dsp56k::MemoryHeatMapTests memoryHeatMapTests;
+	}
+	catch(const std::string& _err)
+	{
+		std::cout << "Memory heat map test failed: " << _err << std::endl;
+		return -1;
+	}
+	std::cout << "Memory Heat Map Tests finished." << std::endl;
+
+	std::cout << "Running Save State Tests..." << std::endl;
+	try
+	{
+		dsp56k::SaveStateTests saveStateTests;
+	}
+	catch(const std::string& _err)
+	{
+		std::cout << "Save state test failed: " << _err << std::endl;
+		return -1;
+	}
+	std::cout << "Save State Tests finished." << std::endl;
+
 	if (dsp56k::g_jitSupported)
 	{
 		std::cout << "Running JIT Optimizer Tests..." << std::endl;
@@ -59,7 +100,31 @@ int main(int _argc, char* _argv[])
 			return -1;
 		}
 		std::cout << "JIT Optimizer Tests finished." << std::endl;
+
+		std::cout << "Running JIT Liveness Tests..." << std::endl;
+		try
+		{
+			dsp56k::JitLivenessTests livenessTests;
+		}
+		catch(const std::string& _err)
+		{
+			std::cout << "JIT Liveness test failed: " << _err << std::endl;
+			return -1;
+		}
+		std::cout << "JIT Liveness Tests finished." << std::endl;
+	}
+
+	std::cout << "Running Benchmark Kernel Tests..." << std::endl;
+	try
+	{
+		dsp56k::BenchmarkKernelTests benchmarkKernelTests;
+	}
+	catch(const std::string& _err)
+	{
+		std::cout << "Benchmark kernel test failed: " << _err << std::endl;
+		return -1;
 	}
+	std::cout << "Benchmark Kernel Tests finished." << std::endl;
 
 	return 0;
 }
@@ -0,0 +1,92 @@
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <memory>
+
+#include "commandline.h"
+
+#include "dsp56kEmu/disasm.h"
+#include "dsp56kEmu/executiontrace.h"
+#include "dsp56kEmu/peripherals.h"
+
+using namespace dsp56k;
+
+int main(int _argc, char* _argv[])
+{
+	try
+	{
+		const CommandLine cmd(_argc, _argv);
+
+		if (!cmd.contains("in"))
+		{
+			std::cout << "DSP 56300 Execution Trace Decoder" << std::endl;
+			std::cout << std::endl;
+			std::cout << "Usage:" << std::endl;
+			std::cout << std::endl;
+			std::cout << "traceDecoder -in tracefile [-out outputfile] [-last count] [noasm]" << std::endl;
+			std::cout << std::endl;
+			std::cout << "Options:" << std::endl;
+			std::cout << "-in filename     Execution trace file, as written by ExecutionTrace::writeToFile(), required." << std::endl;
+			std::cout << "-out filename    Write output to a text file. May be omitted, in which case output is written to standard output." << std::endl;
+			std::cout << "-last count      Only decode the last count entries of the trace." << std::endl;
+			std::cout << "noasm            Do not disassemble the executed blocks, only print addresses and counters." << std::endl;
+			std::cout << std::endl;
+			std::cout << "Output format:" << std::endl;
+			std::cout << "[instruction counter] [cycle counter] P:[block address] ([block length] words)" << std::endl;
+			return -1;
+		}
+
+		const auto inFile = cmd.get("in");
+		const auto outFile = cmd.contains("out") ? cmd.get("out") : std::string();
+		const bool disassemble = !cmd.contains("noasm");
+
+		std::vector<ExecutionTrace::Entry> entries;
+		std::vector<ExecutionTrace::BlockCode> code;
+
+		if(!ExecutionTrace::readFromFile(inFile, entries, code))
+		{
+			std::cout << "Failed to load execution trace " << inFile << std::endl;
+			return -1;
+		}
+
+		std::unique_ptr<std::ofstream> outf;
+
+		if(!outFile.empty())
+		{
+			outf.reset(new std::ofstream(outFile, std::ios::out));
+
+			if(!outf->is_open())
+			{
+				std::cout << "Failed to create output file " << outFile << std::endl;
+				return -1;
+			}
+		}
+
+		std::basic_ostream<char>& out = outf ? *outf : std::cout;
+
+		size_t first = 0;
+
+		if(cmd.contains("last"))
+		{
+			const auto last = static_cast<size_t>(cmd.getInt("last"));
+			if(last < entries.size())
+				first = entries.size() - last;
+		}
+
+		Opcodes opcodes;
+		Disassembler disasm(opcodes);
+		Peripherals56362 p;
+		p.setSymbols(disasm);
+		Peripherals56367 pY;
+		pY.setSymbols(disasm);
+
+		ExecutionTrace::decode(out, entries, code, disassemble ? &disasm : nullptr, first);
+
+		return 0;
+	}
+	catch (const std::exception& e)
+	{
+		std::cout << "Fatal error: " << e.what();
+		return -1;
+	}
+}